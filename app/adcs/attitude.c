@@ -0,0 +1,498 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: attitude.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Attitude estimation at the gyroscope rate, entirely in fixed-point. The
+attitude is a unit quaternion in Q2.30 (body to reference frame, scalar
+first). Each update:
+
+  - compares the measured field direction with the one predicted from the
+    attitude and the reference field, v_meas x v_pred giving the rotation
+    error (complementary filter, Mahony type, proportional only: the gyro
+    bias is already removed by gyrobias.c),
+  - rotates the quaternion by (gyro rate + KP * error) * dt, with a
+    second-order expansion of the rotation,
+  - renormalises it with one Newton step.
+
+The magnetic field alone only fixes two axes: the rotation about the field is
+propagated by the gyroscope only. Without an on-board field model, the
+reference field is the first field measured, expressed in the reference
+frame; the reference frame is the body frame at start.
+
+Each update measures its own cost with the cycle counter. When it exceeds
+ATT_BUDGET_CYCLES (the sensor task was preempted, or the update is too
+slow), the next field correction is skipped, which about halves its cost.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define ATT_Mul(a, b)           ((q30_t) (((int64_t) (a) * (b)) >> 30))
+
+// Half angle in Q30 rad from an angle in Q16 deg.ms: pi / 180 / 2 / 1000 * 2^40, used with >> 26
+#define ATT_HALF_RAD_K          9595049
+
+#define DEG_PER_RAD             57.29577951308232
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static BOOLEAN ATT_Normalize3(const q16_t v[3], q30_t u[3]);
+static void    ATT_Matrix(const q30_t q[4], q30_t r[3][3]);
+static INT32U  ATT_Sqrt64(uint64_t x);
+
+static void    ATT_TestRun(BOOLEAN noisy, BOOLEAN useMag, double *attErr, double *fieldErr);
+static void    ATT_TestRotate(double q[4], const double w[3], double h);
+static void    ATT_TestBodyField(const double q[4], const double ref[3], double b[3]);
+
+
+
+
+/********************************************************************************************************
+*                                         ATT_Init()
+*
+* @brief      Resets the attitude to the reference frame. The reference field is taken from the next
+*             measurement.
+*
+* @param[in]  att         estimator to initialise
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void ATT_Init(ATT *att){
+
+  memset(att, 0, sizeof(ATT));
+  att->q[0] = Q30_ONE;
+}
+
+
+
+/********************************************************************************************************
+*                                         ATT_Update()
+*
+* @brief      Propagates the attitude over a gyroscope sample and corrects it with the magnetic field
+*
+* @param[in]  att         estimator
+* @param[in]  rate        angular rates, body frame, bias removed (deg/s)
+* @param[in]  mag         calibrated magnetic field, body frame (mG), NULL for no correction
+* @param[in]  dtUs        time since the previous sample (us)
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) v_meas x v_pred is sin(error angle) times the axis that brings the prediction onto
+*                   the measurement, in the body frame; it is added to the rates with the gain KP.
+*
+*               (2) The rotation of q by the half angle vector d (|d| = angle/2) is
+*                   q * (cos|d|, sin|d| d/|d|) ~ q * (1 - |d|^2/2, d (1 - |d|^2/6)).
+*
+*               (3) Rates up to 2000 deg/s and steps up to 1 s stay within 2^63 in the intermediate
+*                   products.
+*
+********************************************************************************************************/
+
+void ATT_Update(ATT *att, const q16_t rate[3], const q16_t mag[3], INT32U dtUs){
+
+  INT32U  start = UTI_CycCntGet();
+  q30_t   v[3];
+  q30_t   vp[3];
+  q30_t   r[3][3];
+  q30_t   e[3] = { 0, 0, 0 };
+  q30_t   d[3];
+  q30_t   p[4];
+  q30_t   q[4];
+  q30_t   c, s, n2;
+  int64_t a;
+  int     i;
+
+  if(dtUs > ATT_MAX_DT_US)
+    dtUs = ATT_MAX_DT_US;
+
+  // Field direction error                                   Note(1)
+  if(mag != NULL && !att->shed && ATT_Normalize3(mag, v)){
+
+    ATT_Matrix(att->q, r);
+
+    if(!att->refValid){
+      for(i = 0; i < 3; i++)                                  // ref = R v
+        att->ref[i] = (q30_t) (((int64_t) r[i][0]*v[0] + (int64_t) r[i][1]*v[1] + (int64_t) r[i][2]*v[2]) >> 30);
+      att->refValid = true;
+    }
+
+    for(i = 0; i < 3; i++)                                    // v_pred = R' ref
+      vp[i] = (q30_t) (((int64_t) r[0][i]*att->ref[0] + (int64_t) r[1][i]*att->ref[1] + (int64_t) r[2][i]*att->ref[2]) >> 30);
+
+    e[0] = (q30_t) (((int64_t) v[1]*vp[2] - (int64_t) v[2]*vp[1]) >> 30);
+    e[1] = (q30_t) (((int64_t) v[2]*vp[0] - (int64_t) v[0]*vp[2]) >> 30);
+    e[2] = (q30_t) (((int64_t) v[0]*vp[1] - (int64_t) v[1]*vp[0]) >> 30);
+
+    att->corrections++;
+  }
+
+  // Half angle vector: (rate + KP e) dt / 2, Q30 rad       Note(3)
+  for(i = 0; i < 3; i++){
+    a    = (int64_t) rate[i] * dtUs / 1000;                   // Q16 deg.ms
+    d[i] = (q30_t) ((a * ATT_HALF_RAD_K) >> 26);
+    d[i] += (q30_t) ((((int64_t) e[i] * ATT_KP) >> 16) * dtUs / 2000000);
+  }
+
+  // Rotation                                                Note(2)
+  n2 = (q30_t) (((int64_t) d[0]*d[0] + (int64_t) d[1]*d[1] + (int64_t) d[2]*d[2]) >> 30);
+  c  = Q30_ONE - n2 / 2;
+  s  = Q30_ONE - n2 / 6;
+
+  q[0] = att->q[0];  q[1] = att->q[1];  q[2] = att->q[2];  q[3] = att->q[3];
+
+  p[0] = (q30_t) ((- (int64_t) q[1]*d[0] - (int64_t) q[2]*d[1] - (int64_t) q[3]*d[2]) >> 30);
+  p[1] = (q30_t) ((  (int64_t) q[0]*d[0] + (int64_t) q[2]*d[2] - (int64_t) q[3]*d[1]) >> 30);
+  p[2] = (q30_t) ((  (int64_t) q[0]*d[1] + (int64_t) q[3]*d[0] - (int64_t) q[1]*d[2]) >> 30);
+  p[3] = (q30_t) ((  (int64_t) q[0]*d[2] + (int64_t) q[1]*d[1] - (int64_t) q[2]*d[0]) >> 30);
+
+  for(i = 0; i < 4; i++)
+    q[i] = ATT_Mul(c, q[i]) + ATT_Mul(s, p[i]);
+
+  // Normalisation: q (3 - |q|^2) / 2
+  n2 = (q30_t) (((int64_t) q[0]*q[0] + (int64_t) q[1]*q[1] + (int64_t) q[2]*q[2] + (int64_t) q[3]*q[3]) >> 30);
+  c  = Q30_ONE + (Q30_ONE - n2) / 2;
+
+  OSSchedLock();                        // Consistent copy for ATT_GetQuaternion()
+  for(i = 0; i < 4; i++)
+    att->q[i] = ATT_Mul(c, q[i]);
+  OSSchedUnlock();
+
+  // Execution budget
+  att->updates++;
+  att->cycLast = UTI_CycCntGet() - start;
+  if(att->cycLast > att->cycMax)
+    att->cycMax = att->cycLast;
+
+  att->shed = (att->cycLast > ATT_BUDGET_CYCLES);
+  if(att->shed)
+    att->overruns++;
+}
+
+
+
+/********************************************************************************************************
+*                                         ATT_GetQuaternion()
+*
+* @brief      Returns the attitude quaternion
+*
+* @param[in]  att         estimator
+* @param[out] q           attitude, body to reference frame, scalar first (Q16.16)
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void ATT_GetQuaternion(const ATT *att, q16_t q[4]){
+
+  int i;
+
+  OSSchedLock();
+  for(i = 0; i < 4; i++)
+    q[i] = (att->q[i] + (1 << 13)) >> 14;
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         ATT_GetStatus()
+*
+* @brief      Returns the attitude and the counters of the estimator
+*
+* @param[in]  att         estimator
+* @param[out] status      ATT_STATUS structure to fill
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void ATT_GetStatus(const ATT *att, ATT_STATUS *status){
+
+  ATT_GetQuaternion(att, status->q);
+
+  OSSchedLock();
+  status->updates     = att->updates;
+  status->corrections = att->corrections;
+  status->cycLast     = att->cycLast;
+  status->cycMax      = att->cycMax;
+  status->overruns    = att->overruns;
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         ATT_SelfTest()
+*
+* @brief      Checks the estimator against simulated trajectories
+*
+* @param[out] res         ATT_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The body follows a varying rotation (up to ~6 deg/s on each axis) for
+*                   ATT_TEST_DURATION_S. The true attitude is propagated in double, the estimator is fed
+*                   the mean rate over each period.
+*
+*               (2) Three runs: exact rates without field correction (accuracy of the fixed-point
+*                   propagation); rates with noise and a residual bias, with and without the field
+*                   correction. Only the field direction is checked with the noisy rates, the rotation
+*                   about the field not being observable.
+*
+*               (3) Uses its own ATT instances, the flight estimator is not affected. A run takes a few
+*                   seconds on target.
+*
+*               (4) The caller task is delayed one tick every ATT_TEST_CHUNK steps, so that the lower
+*                   priority tasks keep running during the test.
+*
+********************************************************************************************************/
+
+void ATT_SelfTest(ATT_TEST *res){
+
+  double attErr;
+  double fieldErr;
+
+  ATT_TestRun(false, false, &attErr, &fieldErr);            // Note(2)
+  res->propErr = UTI_Q16FromFloat(attErr);
+
+  ATT_TestRun(true, true, &attErr, &fieldErr);
+  res->fieldErr = UTI_Q16FromFloat(fieldErr);
+
+  ATT_TestRun(true, false, &attErr, &fieldErr);
+  res->fieldErrNoMag = UTI_Q16FromFloat(fieldErr);
+
+  res->pass = (res->propErr < ATT_TEST_PROP_MAX && res->fieldErr < ATT_TEST_FIELD_MAX);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Unit vector of a Q16.16 vector. Returns false for a null vector.
+static BOOLEAN ATT_Normalize3(const q16_t v[3], q30_t u[3]){
+
+  INT32U n;
+  int i;
+
+  n = ATT_Sqrt64((uint64_t) ((int64_t) v[0]*v[0] + (int64_t) v[1]*v[1] + (int64_t) v[2]*v[2]));
+  if(n == 0)
+    return false;
+
+  for(i = 0; i < 3; i++)
+    u[i] = (q30_t) ((v[i] * ((int64_t) 1 << 30)) / n);
+
+  return true;
+}
+
+/******************************************************************************/
+
+// Rotation matrix (body to reference frame) of a unit quaternion
+static void ATT_Matrix(const q30_t q[4], q30_t r[3][3]){
+
+  q30_t q00 = ATT_Mul(q[0], q[0]), q11 = ATT_Mul(q[1], q[1]), q22 = ATT_Mul(q[2], q[2]), q33 = ATT_Mul(q[3], q[3]);
+  q30_t q01 = ATT_Mul(q[0], q[1]), q02 = ATT_Mul(q[0], q[2]), q03 = ATT_Mul(q[0], q[3]);
+  q30_t q12 = ATT_Mul(q[1], q[2]), q13 = ATT_Mul(q[1], q[3]), q23 = ATT_Mul(q[2], q[3]);
+
+  r[0][0] = q00 + q11 - q22 - q33;
+  r[0][1] = 2 * (q12 - q03);
+  r[0][2] = 2 * (q13 + q02);
+  r[1][0] = 2 * (q12 + q03);
+  r[1][1] = q00 - q11 + q22 - q33;
+  r[1][2] = 2 * (q23 - q01);
+  r[2][0] = 2 * (q13 - q02);
+  r[2][1] = 2 * (q23 + q01);
+  r[2][2] = q00 - q11 - q22 + q33;
+}
+
+/******************************************************************************/
+
+// Integer square root (bit by bit)
+static INT32U ATT_Sqrt64(uint64_t x){
+
+  uint64_t res = 0;
+  uint64_t bit = (uint64_t) 1 << 62;
+
+  while(bit > x)
+    bit >>= 2;
+
+  while(bit != 0){
+    if(x >= res + bit){
+      x  -= res + bit;
+      res = (res >> 1) + bit;
+    }
+    else
+      res >>= 1;
+    bit >>= 2;
+  }
+
+  return (INT32U) res;
+}
+
+/******************************************************************************/
+
+// One simulated trajectory (see ATT_SelfTest()). Returns the max. attitude error over the run and the
+// max. field direction error after the settling time, in degrees.
+static void ATT_TestRun(BOOLEAN noisy, BOOLEAN useMag, double *attErr, double *fieldErr){
+
+  static const double bias[3] = { 0.05, -0.03, 0.02 };     // Residual gyro bias (deg/s)
+  static const double ref[3]  = { 200.0, -300.0, 250.0 };  // Reference field (mG)
+  const double h = ATT_TEST_PERIOD_MS / 1000.0;
+  const int    sub = 4;                                     // Truth substeps per period
+
+  ATT    att;
+  uint32_t seed = 12345;
+  INT32U step;
+  INT32U nbSteps = (INT32U) ATT_TEST_DURATION_S * 1000 / ATT_TEST_PERIOD_MS;
+  double qt[4] = { 1.0, 0.0, 0.0, 0.0 };
+  double qe[4];
+  double w[3];
+  double wMean[3];
+  double b[3];
+  double be[3];
+  double t, tk;
+  double dot, nb, nbe;
+  q16_t  rate[3];
+  q16_t  mag[3];
+  q16_t  q[4];
+  int    i, k;
+
+  ATT_Init(&att);
+  *attErr   = 0.0;
+  *fieldErr = 0.0;
+
+  for(step = 0; step < nbSteps; step++){
+
+    t = step * h;
+
+    // Measured field at t
+    ATT_TestBodyField(qt, ref, b);
+    for(i = 0; i < 3; i++)
+      mag[i] = (q16_t) ((b[i] + (noisy ? 2.0 * UTI_RandUniform(&seed) : 0.0)) * 65536.0);
+
+    // True motion over the period, and mean rate
+    wMean[0] = wMean[1] = wMean[2] = 0.0;
+    for(k = 0; k < sub; k++){
+      tk = t + (k + 0.5) * h / sub;
+      w[0] = 5.0 * sin(0.10 * tk);
+      w[1] = 3.0 * cos(0.07 * tk);
+      w[2] = 2.0 + sin(0.05 * tk);
+      for(i = 0; i < 3; i++){
+        wMean[i] += w[i] / sub;
+        w[i] /= DEG_PER_RAD;
+      }
+      ATT_TestRotate(qt, w, h / sub);
+    }
+
+    for(i = 0; i < 3; i++)
+      rate[i] = (q16_t) ((wMean[i] + (noisy ? bias[i] + 0.05 * UTI_RandUniform(&seed) : 0.0)) * 65536.0);
+
+    ATT_Update(&att, rate, useMag ? mag : NULL, ATT_TEST_PERIOD_MS * 1000);
+
+    // Errors at t + h
+    for(i = 0; i < 4; i++)
+      qe[i] = att.q[i] / (double) Q30_ONE;
+
+    dot = fabs(qe[0]*qt[0] + qe[1]*qt[1] + qe[2]*qt[2] + qe[3]*qt[3]);
+    dot = 2.0 * acos(dot > 1.0 ? 1.0 : dot) * DEG_PER_RAD;
+    if(dot > *attErr)
+      *attErr = dot;
+
+    if(step % ATT_TEST_CHUNK == ATT_TEST_CHUNK - 1)       // Note(4) of ATT_SelfTest()
+      OSTimeDly(1);
+
+    if(t + h < ATT_TEST_SETTLE_S)
+      continue;
+
+    ATT_TestBodyField(qt, ref, b);
+    ATT_TestBodyField(qe, ref, be);
+    nb  = sqrt(b[0]*b[0] + b[1]*b[1] + b[2]*b[2]);
+    nbe = sqrt(be[0]*be[0] + be[1]*be[1] + be[2]*be[2]);
+    dot = (b[0]*be[0] + b[1]*be[1] + b[2]*be[2]) / (nb * nbe);
+    dot = acos(dot > 1.0 ? 1.0 : dot) * DEG_PER_RAD;
+    if(dot > *fieldErr)
+      *fieldErr = dot;
+  }
+
+  // Keep the quaternion conversion in the test
+  ATT_GetQuaternion(&att, q);
+  (void) q;
+}
+
+/******************************************************************************/
+
+// Rotates q (body to reference) by the body rate w (rad/s) during h seconds
+static void ATT_TestRotate(double q[4], const double w[3], double h){
+
+  double a = sqrt(w[0]*w[0] + w[1]*w[1] + w[2]*w[2]) * h / 2.0;
+  double c = cos(a);
+  double s = (a > 1e-12) ? sin(a) / (a * 2.0 / h) : h / 2.0;
+  double d[3], r[4];
+  int i;
+
+  for(i = 0; i < 3; i++)
+    d[i] = w[i] * s;
+
+  r[0] = c*q[0] - q[1]*d[0] - q[2]*d[1] - q[3]*d[2];
+  r[1] = c*q[1] + q[0]*d[0] + q[2]*d[2] - q[3]*d[1];
+  r[2] = c*q[2] + q[0]*d[1] + q[3]*d[0] - q[1]*d[2];
+  r[3] = c*q[3] + q[0]*d[2] + q[1]*d[1] - q[2]*d[0];
+
+  for(i = 0; i < 4; i++)
+    q[i] = r[i];
+}
+
+/******************************************************************************/
+
+// Field in the body frame, R(q)' ref
+static void ATT_TestBodyField(const double q[4], const double ref[3], double b[3]){
+
+  double r[3][3];
+  int i;
+
+  r[0][0] = 1 - 2*(q[2]*q[2] + q[3]*q[3]);
+  r[0][1] =     2*(q[1]*q[2] - q[0]*q[3]);
+  r[0][2] =     2*(q[1]*q[3] + q[0]*q[2]);
+  r[1][0] =     2*(q[1]*q[2] + q[0]*q[3]);
+  r[1][1] = 1 - 2*(q[1]*q[1] + q[3]*q[3]);
+  r[1][2] =     2*(q[2]*q[3] - q[0]*q[1]);
+  r[2][0] =     2*(q[1]*q[3] - q[0]*q[2]);
+  r[2][1] =     2*(q[2]*q[3] + q[0]*q[1]);
+  r[2][2] = 1 - 2*(q[1]*q[1] + q[2]*q[2]);
+
+  for(i = 0; i < 3; i++)
+    b[i] = r[0][i]*ref[0] + r[1][i]*ref[1] + r[2][i]*ref[2];
+}
+
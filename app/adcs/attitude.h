@@ -0,0 +1,111 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: attitude.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Fixed-point quaternion attitude propagation from the gyroscope, with a
+magnetometer-aided complementary filter
+
+******************************************************************************/
+
+
+
+#ifndef __ATTITUDE_H
+#define __ATTITUDE_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define Q30_ONE                 ((q30_t) 0x40000000)
+
+// Complementary filter gain: the field direction error is corrected with a ~1/KP s time constant
+#define ATT_KP                  UTI_Q16FromFloat(0.1)       // rad/s per rad
+
+#define ATT_MAX_DT_US           1000000 // Longer steps are clamped (gap in the data)
+
+// Execution budget of ATT_Update(): above it, the next field correction is skipped
+#define ATT_BUDGET_CYCLES       4000
+
+// Self-test (see ATT_SelfTest())
+#define ATT_TEST_PERIOD_MS      100
+#define ATT_TEST_DURATION_S     600
+#define ATT_TEST_SETTLE_S       60      // Field errors are checked after this time
+#define ATT_TEST_PROP_MAX       UTI_Q16FromFloat(0.1)       // Max. propagation error (deg)
+#define ATT_TEST_FIELD_MAX      UTI_Q16FromFloat(2.0)       // Max. field direction error (deg)
+#define ATT_TEST_CHUNK          20      // Steps between two yields (~10 ms on target)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef int32_t q30_t;                  // Fixed-point Q2.30, for unit quaternions and vectors
+
+typedef struct Att ATT;
+
+struct Att {
+  q30_t   q[4];                         // Body to reference frame rotation, scalar first
+  q30_t   ref[3];                       // Field direction in the reference frame
+  BOOLEAN refValid;
+  BOOLEAN shed;                         // Skip the next field correction (budget exceeded)
+  INT32U  updates;
+  INT32U  corrections;                  // Updates with a field correction
+  INT32U  cycLast;                      // Cycles used by the last update
+  INT32U  cycMax;
+  INT32U  overruns;                     // Updates above ATT_BUDGET_CYCLES
+};
+
+typedef struct AttStatus ATT_STATUS;
+
+struct AttStatus {
+  q16_t   q[4];                         // Attitude quaternion
+  INT32U  updates;
+  INT32U  corrections;
+  INT32U  cycLast;
+  INT32U  cycMax;
+  INT32U  overruns;
+};
+
+typedef struct AttTest ATT_TEST;
+
+struct AttTest {
+  q16_t   propErr;                      // Max. attitude error, exact gyro, no correction (deg)
+  q16_t   fieldErr;                     // Max. field direction error, noisy gyro, filter (deg)
+  q16_t   fieldErrNoMag;                // Same without the field correction (deg)
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    ATT_Init(ATT *att);
+void    ATT_Update(ATT *att, const q16_t rate[3], const q16_t mag[3], INT32U dtUs);
+void    ATT_GetQuaternion(const ATT *att, q16_t q[4]);
+void    ATT_GetStatus(const ATT *att, ATT_STATUS *status);
+
+void    ATT_SelfTest(ATT_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __ATTITUDE_H */
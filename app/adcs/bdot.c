@@ -0,0 +1,362 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: bdot.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+B-dot detumbling control law. A tumbling satellite sees the magnetic field
+rotate in its body frame; commanding a magnetic dipole opposed to the rate of
+change of the field
+
+    m = -K dB/dt
+
+gives a torque m x B that always removes rotational energy (except about the
+field direction). Only the magnetometer is needed.
+
+The field samples are kept in a small ring with their time stamps. dB/dt is
+the difference between the newest sample and the one BDOT_SPAN samples older,
+divided by the measured time between them, so a late or early sample does not
+bias the derivative. The command is saturated on its largest axis, keeping its
+direction.
+
+The law has no OS dependency: it is run by the ADCS task (app_adcs.c) and by
+the closed-loop self-test below.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define BDOT_RING_MASK          (BDOT_RING_SIZE - 1)
+
+#define DEG_PER_RAD             57.29577951308232
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void   BDOT_TestField(const double bi[3], const double q[4], double b[3]);
+static void   BDOT_TestDeriv(const double bi[3], const double q[4], const double w[3], const double m[3],
+                             double dq[4], double dw[3]);
+
+
+
+
+/********************************************************************************************************
+*                                         BDOT_Init()
+*
+* @brief      Clears the samples and the command
+*
+* @param[in]  ctl         controller to initialise
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void BDOT_Init(BDOT *ctl){
+  memset(ctl, 0, sizeof(BDOT));
+}
+
+
+
+/********************************************************************************************************
+*                                         BDOT_AddSample()
+*
+* @brief      Adds a magnetometer sample to the ring
+*
+* @param[in]  ctl         controller
+* @param[in]  mag         magnetic field, body frame (mG)
+* @param[in]  timeUs      time of the measurement (us)
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void BDOT_AddSample(BDOT *ctl, const q16_t mag[3], INT32U timeUs){
+
+  BDOT_SAMPLE *s = &ctl->ring[ctl->added & BDOT_RING_MASK];
+
+  s->mag[0] = mag[0];
+  s->mag[1] = mag[1];
+  s->mag[2] = mag[2];
+  s->timeUs = timeUs;
+
+  ctl->added++;
+}
+
+
+
+/********************************************************************************************************
+*                                         BDOT_Control()
+*
+* @brief      Computes the dipole command from the samples in the ring
+*
+* @param[in]  ctl         controller
+* @param[out] dipole      magnetorquer dipole command (A.m^2), 0 if none could be computed
+* @exception  none
+* @return     true if a command was computed
+*/
+/* Notes      :(1) With BDOT_MIN_DT_US the derivative stays below ~2^37 (Q16.16 mG/s) and its product
+*                   with the gain below 2^54. The command is scaled down to 31 bits before the
+*                   saturation so that the last product cannot overflow either.
+*
+********************************************************************************************************/
+
+BOOLEAN BDOT_Control(BDOT *ctl, q16_t dipole[3]){
+
+  const BDOT_SAMPLE *now;
+  const BDOT_SAMPLE *old;
+  int64_t m[3];
+  int64_t dBdt;
+  int64_t maxAbs = 0;
+  INT32U  dt;
+  int     i;
+
+  memset(ctl->dBdt, 0, sizeof(ctl->dBdt));
+  memset(ctl->dipole, 0, sizeof(ctl->dipole));
+  ctl->saturated = false;
+
+  if(ctl->added <= BDOT_SPAN){
+    memset(dipole, 0, 3 * sizeof(q16_t));
+    return false;
+  }
+
+  now = &ctl->ring[(ctl->added - 1) & BDOT_RING_MASK];
+  old = &ctl->ring[(ctl->added - 1 - BDOT_SPAN) & BDOT_RING_MASK];
+
+  // Gap in the data or samples too close: no reliable derivative
+  dt = now->timeUs - old->timeUs;
+  if(dt < BDOT_MIN_DT_US || dt > BDOT_MAX_DT_US){
+    memset(dipole, 0, 3 * sizeof(q16_t));
+    return false;
+  }
+
+  // m = -K dB/dt                                            Note(1)
+  for(i = 0; i < 3; i++){
+    dBdt = ((int64_t) now->mag[i] - old->mag[i]) * 1000000 / dt;
+    ctl->dBdt[i] = (q16_t) (dBdt > INT32_MAX ? INT32_MAX : (dBdt < -INT32_MAX ? -INT32_MAX : dBdt));
+
+    m[i] = -(dBdt * BDOT_GAIN_Q24) >> 24;
+    if(llabs(m[i]) > maxAbs)
+      maxAbs = llabs(m[i]);
+  }
+
+  while(maxAbs > INT32_MAX){
+    for(i = 0; i < 3; i++)
+      m[i] >>= 1;
+    maxAbs >>= 1;
+  }
+
+  // Saturation on the largest axis, same direction
+  if(maxAbs > BDOT_MAX_DIPOLE){
+    for(i = 0; i < 3; i++)
+      m[i] = m[i] * BDOT_MAX_DIPOLE / maxAbs;
+    ctl->saturated = true;
+  }
+
+  for(i = 0; i < 3; i++){
+    dipole[i] = (q16_t) m[i];
+    ctl->dipole[i] = dipole[i];
+  }
+
+  return true;
+}
+
+
+
+/********************************************************************************************************
+*                                         BDOT_SelfTest()
+*
+* @brief      Closed-loop simulation of the control law on a tumbling rigid body
+*
+* @param[out] res         BDOT_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) 3U body, inertia diag(0.02, 0.02, 0.006) kg.m^2, initial rates (10, -8, 6) deg/s. The
+*                   field turns in the inertial frame at twice the orbital rate (polar orbit, dipole
+*                   model), with 1 mG of noise on the measurements.
+*
+*               (2) The dynamics are integrated in double with the midpoint method, one step per control
+*                   period; the command is held between two periods. The inertial field is turned by a
+*                   fixed rotation each period rather than computed with sin() and cos(). A run still
+*                   takes ~10 s on target.
+*
+*               (3) Passes if the rate is below BDOT_TEST_RATE_OK at the end of the run.
+*
+*               (4) The caller task is delayed one tick every BDOT_TEST_CHUNK steps, so that the lower
+*                   priority tasks keep running during the test.
+*
+********************************************************************************************************/
+
+void BDOT_SelfTest(BDOT_TEST *res){
+
+  static const double w0[3] = { 10.0, -8.0, 6.0 };          // Note(1)
+  const double h = BDOT_TEST_PERIOD_MS / 1000.0;
+  const double du = 2.0 * 3.14159265358979 * h / 5400.0;   // Argument of latitude step, 90 min orbit
+
+  BDOT   ctl;
+  uint32_t seed = 12345;
+  INT32U step;
+  INT32U nbSteps = (INT32U) BDOT_TEST_DURATION_S * 1000 / BDOT_TEST_PERIOD_MS;
+  INT32U satSteps = 0;
+  double q[4] = { 1.0, 0.0, 0.0, 0.0 };
+  double w[3];
+  double b[3];
+  double m[3];
+  double qm[4], wm[3];
+  double dq[4], dw[3];
+  double bi[3];
+  double cu = 1.0, su = 0.0;
+  double c;
+  double t;
+  double n;
+  double rate;
+  q16_t  mag[3];
+  q16_t  dipole[3];
+  int    i;
+
+  BDOT_Init(&ctl);
+  memset(res, 0, sizeof(BDOT_TEST));
+
+  for(i = 0; i < 3; i++)
+    w[i] = w0[i] / DEG_PER_RAD;
+  res->rateStart = UTI_Q16FromFloat(sqrt(w[0]*w[0] + w[1]*w[1] + w[2]*w[2]) * DEG_PER_RAD);
+
+  for(step = 0; step < nbSteps; step++){
+
+    t = step * h;
+
+    // Inertial field (dipole model, polar orbit), assumed constant over the period
+    bi[0] =  250.0 * cu;
+    bi[1] =   50.0;
+    bi[2] = -500.0 * su;
+
+    c  = cu * cos(du) - su * sin(du);
+    su = su * cos(du) + cu * sin(du);
+    cu = c;
+
+    // Measurement and command
+    BDOT_TestField(bi, q, b);
+    for(i = 0; i < 3; i++)
+      mag[i] = (q16_t) ((b[i] + UTI_RandUniform(&seed)) * 65536.0);
+
+    BDOT_AddSample(&ctl, mag, step * BDOT_TEST_PERIOD_MS * 1000);
+    BDOT_Control(&ctl, dipole);
+    if(ctl.saturated)
+      satSteps++;
+
+    for(i = 0; i < 3; i++)
+      m[i] = dipole[i] / 65536.0;
+
+    // Dynamics over the period                              Note(2)
+    BDOT_TestDeriv(bi, q, w, m, dq, dw);
+    for(i = 0; i < 4; i++) qm[i] = q[i] + 0.5 * h * dq[i];
+    for(i = 0; i < 3; i++) wm[i] = w[i] + 0.5 * h * dw[i];
+
+    BDOT_TestDeriv(bi, qm, wm, m, dq, dw);
+    for(i = 0; i < 4; i++) q[i] += h * dq[i];
+    for(i = 0; i < 3; i++) w[i] += h * dw[i];
+
+    n = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    for(i = 0; i < 4; i++)
+      q[i] /= n;
+
+    rate = sqrt(w[0]*w[0] + w[1]*w[1] + w[2]*w[2]) * DEG_PER_RAD;
+    if(res->detumbleS == 0 && rate < UTI_Q16ToFloat(BDOT_TEST_RATE_OK))
+      res->detumbleS = (INT32U) (t + h);
+
+    if(step % BDOT_TEST_CHUNK == BDOT_TEST_CHUNK - 1)     // Note(4)
+      OSTimeDly(1);
+  }
+
+  res->rateEnd      = UTI_Q16FromFloat(rate);
+  res->saturatedPct = satSteps * 100 / nbSteps;
+
+  // Note(3)
+  res->pass = (res->rateEnd < BDOT_TEST_RATE_OK);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Field seen by the body with attitude q (body to inertial), bi being the inertial field
+static void BDOT_TestField(const double bi[3], const double q[4], double b[3]){
+
+  double r[3][3];
+  int i;
+
+  // Rotation matrix of q, the body frame field is r' * bi
+  r[0][0] = 1 - 2*(q[2]*q[2] + q[3]*q[3]);
+  r[0][1] =     2*(q[1]*q[2] - q[0]*q[3]);
+  r[0][2] =     2*(q[1]*q[3] + q[0]*q[2]);
+  r[1][0] =     2*(q[1]*q[2] + q[0]*q[3]);
+  r[1][1] = 1 - 2*(q[1]*q[1] + q[3]*q[3]);
+  r[1][2] =     2*(q[2]*q[3] - q[0]*q[1]);
+  r[2][0] =     2*(q[1]*q[3] - q[0]*q[2]);
+  r[2][1] =     2*(q[2]*q[3] + q[0]*q[1]);
+  r[2][2] = 1 - 2*(q[1]*q[1] + q[2]*q[2]);
+
+  for(i = 0; i < 3; i++)
+    b[i] = r[0][i]*bi[0] + r[1][i]*bi[1] + r[2][i]*bi[2];
+}
+
+/******************************************************************************/
+
+// Rigid body dynamics: Euler's equations with the magnetic torque m x B, and quaternion kinematics
+static void BDOT_TestDeriv(const double bi[3], const double q[4], const double w[3], const double m[3],
+                           double dq[4], double dw[3]){
+
+  static const double I[3] = { 0.02, 0.02, 0.006 };         // kg.m^2
+  double b[3];
+  double tq[3];
+  double hw[3];
+  int i;
+
+  BDOT_TestField(bi, q, b);
+  for(i = 0; i < 3; i++)
+    b[i] *= 1e-7;                                           // mG -> T
+
+  tq[0] = m[1]*b[2] - m[2]*b[1];
+  tq[1] = m[2]*b[0] - m[0]*b[2];
+  tq[2] = m[0]*b[1] - m[1]*b[0];
+
+  for(i = 0; i < 3; i++)
+    hw[i] = I[i] * w[i];
+
+  dw[0] = (tq[0] - (w[1]*hw[2] - w[2]*hw[1])) / I[0];
+  dw[1] = (tq[1] - (w[2]*hw[0] - w[0]*hw[2])) / I[1];
+  dw[2] = (tq[2] - (w[0]*hw[1] - w[1]*hw[0])) / I[2];
+
+  dq[0] = 0.5 * (-q[1]*w[0] - q[2]*w[1] - q[3]*w[2]);
+  dq[1] = 0.5 * ( q[0]*w[0] + q[2]*w[2] - q[3]*w[1]);
+  dq[2] = 0.5 * ( q[0]*w[1] + q[3]*w[0] - q[1]*w[2]);
+  dq[3] = 0.5 * ( q[0]*w[2] + q[1]*w[1] - q[2]*w[0]);
+}
+
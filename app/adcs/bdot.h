@@ -0,0 +1,100 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: bdot.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+B-dot detumbling control law: magnetorquer dipole commands from the rate of
+change of the magnetic field measured in the body frame
+
+******************************************************************************/
+
+
+
+#ifndef __BDOT_H
+#define __BDOT_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define BDOT_RING_SIZE          8       // Field samples kept (power of 2)
+#define BDOT_SPAN               2       // Samples between the two ends of the difference
+
+// Time between the two ends of the difference (us): outside, no command is computed
+#define BDOT_MIN_DT_US          10000
+#define BDOT_MAX_DT_US          1000000
+
+// Control law: m = -K dB/dt, saturated to BDOT_MAX_DIPOLE on the largest axis
+#define BDOT_GAIN_Q24           UTI_Q24FromFloat(0.005)     // A.m^2 per mG/s
+#define BDOT_MAX_DIPOLE         UTI_Q16FromFloat(0.2)       // A.m^2
+
+// Closed-loop self-test (see BDOT_SelfTest())
+#define BDOT_TEST_PERIOD_MS     100                         // Control period
+#define BDOT_TEST_DURATION_S    5400                        // One orbit
+#define BDOT_TEST_RATE_OK       UTI_Q16FromFloat(1.0)       // Detumbled below this rate (deg/s)
+#define BDOT_TEST_CHUNK         50                          // Steps between two yields (~10 ms on target)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct BdotSample BDOT_SAMPLE;
+
+struct BdotSample {
+  q16_t   mag[3];                       // Magnetic field, body frame (mG)
+  INT32U  timeUs;                       // Time of the measurement (us, wraps)
+};
+
+typedef struct Bdot BDOT;
+
+struct Bdot {
+  BDOT_SAMPLE ring[BDOT_RING_SIZE];
+  INT32U  added;                        // Samples added since BDOT_Init()
+  q16_t   dBdt[3];                      // Last field derivative (mG/s)
+  q16_t   dipole[3];                    // Last command (A.m^2)
+  BOOLEAN saturated;                    // Last command saturated
+};
+
+typedef struct BdotTest BDOT_TEST;
+
+struct BdotTest {
+  q16_t   rateStart;                    // Initial angular rate (deg/s)
+  q16_t   rateEnd;                      // Final angular rate (deg/s)
+  INT32U  detumbleS;                    // Time to go below BDOT_TEST_RATE_OK (s), 0 if never
+  INT32U  saturatedPct;                 // Control periods with a saturated command (%)
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    BDOT_Init(BDOT *ctl);
+void    BDOT_AddSample(BDOT *ctl, const q16_t mag[3], INT32U timeUs);
+BOOLEAN BDOT_Control(BDOT *ctl, q16_t dipole[3]);
+
+void    BDOT_SelfTest(BDOT_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __BDOT_H */
@@ -0,0 +1,245 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: gyrobias.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Online estimation of the gyroscope bias, replacing the single sample taken at
+boot. Whenever the satellite is at rest, the rates are the bias itself, and
+they are averaged together with the temperature to fit the linear model
+
+    bias(T) = bias(TREF) + slope * (T - TREF)
+
+The fit only needs running means of dT, dT^2, rate and dT*rate (dT = T - TREF)
+for the least-squares solution, so each sample costs a few multiplies and no
+sample is stored:
+
+    slope = (E[dT*rate] - E[dT]*E[rate]) / (E[dT^2] - E[dT]^2)
+    bias(TREF) = E[rate] - slope * E[dT]
+
+The slope is only updated once the temperature has varied enough.
+
+Rest is detected when the rates are steady (small deviation around their short
+term mean), the magnetic field does not change (rules out a constant spin) and,
+once the bias is known, the corrected rates are small.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Running means, Q32.32 (Q16.16 value with 16 extra fractional bits)
+static int64_t meanT;                   // E[dT]
+static int64_t meanT2;                  // E[dT^2]
+static int64_t meanY[3];                // E[rate]
+static int64_t meanTY[3];               // E[dT*rate]
+
+// Model
+static q16_t   offset[3];               // Bias at GYROBIAS_TREF
+static q16_t   slope[3];
+static q16_t   bias[3];                 // Bias at the current temperature
+
+// Rest detection
+static q16_t   fastMean[3];
+static q16_t   fastDev[3];
+static q16_t   magPrev[3];
+static BOOLEAN magValid;
+static INT32U  quietCtr;
+
+static BOOLEAN atRest;
+static BOOLEAN converged;
+static INT32U  restSamples;
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void GYROBIAS_Mean(int64_t *mean, q16_t x, INT8U shift);
+
+
+
+
+/********************************************************************************************************
+*                                         GYROBIAS_Init()
+*
+* @brief      Resets the estimator. The rates are not corrected until it has converged again.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void GYROBIAS_Init(void){
+
+  meanT  = 0;
+  meanT2 = 0;
+  memset(meanY,    0, sizeof(meanY));
+  memset(meanTY,   0, sizeof(meanTY));
+  memset(offset,   0, sizeof(offset));
+  memset(slope,    0, sizeof(slope));
+  memset(bias,     0, sizeof(bias));
+  memset(fastMean, 0, sizeof(fastMean));
+  memset(fastDev,  0, sizeof(fastDev));
+
+  magValid    = false;
+  quietCtr    = 0;
+  atRest      = false;
+  converged   = false;
+  restSamples = 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         GYROBIAS_Update()
+*
+* @brief      Processes a gyroscope sample: updates the estimate if at rest and removes the bias
+*
+* @param[in]  rate        angular rates (deg/s), corrected in place once the estimator has converged
+* @param[in]  temp        gyroscope temperature (deg C)
+* @param[in]  mag         magnetic field (mG)
+* @param[out] biasOut     bias removed from the rates (0 until converged)
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Until enough samples have been averaged, the averaging weight is 1/2^floor(log2(n)),
+*                   close to a cumulative mean, so that the first estimate converges quickly. After
+*                   2^GYROBIAS_SHIFT samples it becomes an exponential mean, following slow drifts.
+*
+********************************************************************************************************/
+
+void GYROBIAS_Update(q16_t rate[3], q16_t temp, const q16_t mag[3], q16_t biasOut[3]){
+
+  q16_t   dT = temp - GYROBIAS_TREF;
+  q16_t   mT;
+  q16_t   mY;
+  q16_t   var;
+  q16_t   cov;
+  BOOLEAN quiet = true;
+  INT8U   shift;
+  int     i;
+
+  // Rest detection
+  for(i = 0; i < 3; i++){
+
+    fastMean[i] += (rate[i] - fastMean[i]) >> GYROBIAS_FAST_SHIFT;
+    fastDev[i]  += (abs(rate[i] - fastMean[i]) - fastDev[i]) >> GYROBIAS_FAST_SHIFT;
+    if(fastDev[i] > GYROBIAS_DEV_THR)
+      quiet = false;
+
+    if(converged && abs(rate[i] - bias[i]) > GYROBIAS_RATE_THR)
+      quiet = false;
+
+    if(magValid && abs(mag[i] - magPrev[i]) > GYROBIAS_MAG_THR)
+      quiet = false;
+    magPrev[i] = mag[i];
+  }
+  magValid = true;
+
+  if(!quiet)
+    quietCtr = 0;
+  else if(quietCtr < GYROBIAS_REST_SAMPLES)
+    quietCtr++;
+
+  atRest = (quietCtr >= GYROBIAS_REST_SAMPLES);
+
+  // Estimation
+  if(atRest){
+
+    restSamples++;
+    shift = 31 - __CLZ(restSamples);                        // Note(1)
+    if(shift > GYROBIAS_SHIFT)
+      shift = GYROBIAS_SHIFT;
+
+    GYROBIAS_Mean(&meanT,  dT,                   shift);
+    GYROBIAS_Mean(&meanT2, UTI_Q16Mul(dT, dT),   shift);
+
+    mT  = (q16_t) (meanT >> 16);
+    var = (q16_t) (meanT2 >> 16) - UTI_Q16Mul(mT, mT);
+
+    for(i = 0; i < 3; i++){
+
+      GYROBIAS_Mean(&meanY[i],  rate[i],                 shift);
+      GYROBIAS_Mean(&meanTY[i], UTI_Q16Mul(dT, rate[i]), shift);
+
+      mY = (q16_t) (meanY[i] >> 16);
+      if(var > GYROBIAS_VAR_MIN){
+        cov      = (q16_t) (meanTY[i] >> 16) - UTI_Q16Mul(mT, mY);
+        slope[i] = UTI_Q16Div(cov, var);
+      }
+      offset[i] = mY - UTI_Q16Mul(slope[i], mT);
+    }
+
+    if(restSamples >= GYROBIAS_SEED_SAMPLES)
+      converged = true;
+  }
+
+  // Correction
+  for(i = 0; i < 3; i++){
+    bias[i] = offset[i] + UTI_Q16Mul(slope[i], dT);
+    biasOut[i] = converged ? bias[i] : 0;
+    rate[i] -= biasOut[i];
+  }
+}
+
+
+
+/********************************************************************************************************
+*                                         GYROBIAS_GetStatus()
+*
+* @brief      Returns the state of the estimator
+*
+* @param[out] status      GYROBIAS_STATUS structure to fill
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void GYROBIAS_GetStatus(GYROBIAS_STATUS *status){
+
+  OSSchedLock();                        // Only updated by the sensor task
+
+  memcpy(status->bias,  bias,  sizeof(bias));
+  memcpy(status->slope, slope, sizeof(slope));
+  status->tempMean    = (q16_t) (meanT >> 16) + GYROBIAS_TREF;
+  status->atRest      = atRest;
+  status->converged   = converged;
+  status->restSamples = restSamples;
+
+  OSSchedUnlock();
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Moves a Q32.32 running mean towards a Q16.16 sample by 1/2^shift of the difference
+static void GYROBIAS_Mean(int64_t *mean, q16_t x, INT8U shift){
+  *mean += ((int64_t) x * Q16_ONE - *mean) >> shift;
+}
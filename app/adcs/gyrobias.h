@@ -0,0 +1,81 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: gyrobias.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Online estimation of the gyroscope bias (zero-rate output) and of its
+temperature dependence
+
+******************************************************************************/
+
+
+
+#ifndef __GYROBIAS_H
+#define __GYROBIAS_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Temperature model: bias(T) = bias(TREF) + slope * (T - TREF)
+#define GYROBIAS_TREF           UTI_Q16FromInt(25)          // deg C
+
+// Averaging of the rest samples: 2^SHIFT samples time constant (~100 s at 10 Hz)
+#define GYROBIAS_SHIFT          10
+
+// Rest detection
+#define GYROBIAS_FAST_SHIFT     3                           // Short averaging for the stationarity test
+#define GYROBIAS_DEV_THR        UTI_Q16FromFloat(0.5)       // Max. mean deviation of the rates (deg/s)
+#define GYROBIAS_RATE_THR       UTI_Q16FromFloat(2.0)       // Max. corrected rate once converged (deg/s)
+#define GYROBIAS_MAG_THR        UTI_Q16FromFloat(20.0)      // Max. field change between samples (mG)
+#define GYROBIAS_REST_SAMPLES   20                          // Consecutive quiet samples before use
+
+#define GYROBIAS_SEED_SAMPLES   50                          // Rest samples before the bias is applied
+#define GYROBIAS_VAR_MIN        UTI_Q16FromFloat(1.0)       // Min. temperature variance for the slope (deg C^2)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct GyroBiasStatus GYROBIAS_STATUS;
+
+struct GyroBiasStatus {
+  q16_t   bias[3];                      // Bias at the current temperature (deg/s)
+  q16_t   slope[3];                     // Temperature coefficient (deg/s per deg C)
+  q16_t   tempMean;                     // Mean temperature of the rest samples (deg C)
+  BOOLEAN atRest;
+  BOOLEAN converged;                    // Bias applied to the rates
+  INT32U  restSamples;                  // Samples used for the estimation
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void GYROBIAS_Init(void);
+void GYROBIAS_Update(q16_t rate[3], q16_t temp, const q16_t mag[3], q16_t biasOut[3]);
+void GYROBIAS_GetStatus(GYROBIAS_STATUS *status);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __GYROBIAS_H */
@@ -0,0 +1,593 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: magcal.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Incremental hard-iron / soft-iron calibration of a magnetometer. Hard iron
+shifts the measured field sphere, soft iron (and unequal axis gains) turns it
+into an ellipsoid. The ellipsoid is fitted by least squares to the general
+quadric
+
+    a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz + 2g x + 2h y + 2i z = 1
+
+The samples are not stored: each sample only adds its terms to the sums of
+the normal equations (D'D and D'1, 54 integers), in 64-bit fixed-point. From
+time to time the 9x9 system is solved (in double, by a background task, see
+MAGCAL_Update()) and the centre (hard iron) and shape (soft iron) of the
+ellipsoid are extracted.
+
+The correction applied to each sample is out = W * (in - offset), a 3x3
+multiply in Q16.16. W is the symmetric square root of the ellipsoid matrix,
+scaled to a unit determinant: the calibrated field lies on a sphere whose
+radius is the geometric mean of the ellipsoid radii.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static INT8U   MAGCAL_Reject(MAGCAL *cal, INT8U err);
+static BOOLEAN MAGCAL_GaussSolve(double M[MAGCAL_NB_PARAM][MAGCAL_NB_PARAM], double b[MAGCAL_NB_PARAM],
+                                 double x[MAGCAL_NB_PARAM]);
+static void    MAGCAL_Eigen(double A[3][3], double lambda[3], double V[3][3]);
+static double  MAGCAL_TestNorm(const q16_t v[3]);
+
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_Init()
+*
+* @brief      Clears the sums and the calibration (identity)
+*
+* @param[in]  cal         calibration to initialise
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void MAGCAL_Init(MAGCAL *cal){
+
+  memset(cal, 0, sizeof(MAGCAL));
+
+  cal->sol.W[0][0] = Q16_ONE;
+  cal->sol.W[1][1] = Q16_ONE;
+  cal->sol.W[2][2] = Q16_ONE;
+}
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_Add()
+*
+* @brief      Adds a sample to the sums of the fit
+*
+* @param[in]  cal         calibration
+* @param[in]  mag         uncalibrated magnetic field (mG)
+* @exception  none
+* @return     true if the sample was used
+*/
+/* Notes      :(1) Samples too close to the previous one are skipped, so that a constant attitude does
+*                   not outweigh the rest of the ellipsoid.
+*
+*               (2) In 1 mG units the terms are below 2^23 for fields up to 2 G, their products below 2^46,
+*                   and the sums of MAGCAL_MAX_SAMPLES products below 2^58.
+*
+********************************************************************************************************/
+
+BOOLEAN MAGCAL_Add(MAGCAL *cal, const q16_t mag[3]){
+
+  int32_t d[MAGCAL_NB_PARAM];
+  int32_t x, y, z;
+  int i, j, k;
+
+  // Note(1)
+  if(cal->n > 0 && abs(mag[0] - cal->last[0]) < MAGCAL_MIN_STEP
+                && abs(mag[1] - cal->last[1]) < MAGCAL_MIN_STEP
+                && abs(mag[2] - cal->last[2]) < MAGCAL_MIN_STEP)
+    return false;
+
+  cal->last[0] = mag[0];
+  cal->last[1] = mag[1];
+  cal->last[2] = mag[2];
+
+  // Terms of the quadric, 1 mG units                        Note(2)
+  x = (mag[0] + Q16_ONE / 2) >> 16;
+  y = (mag[1] + Q16_ONE / 2) >> 16;
+  z = (mag[2] + Q16_ONE / 2) >> 16;
+
+  d[0] = x * x;      d[1] = y * y;      d[2] = z * z;
+  d[3] = 2 * x * y;  d[4] = 2 * x * z;  d[5] = 2 * y * z;
+  d[6] = 2 * x;      d[7] = 2 * y;      d[8] = 2 * z;
+
+  // Fade out the older samples
+  if(cal->n >= MAGCAL_MAX_SAMPLES){
+    for(k = 0; k < MAGCAL_NB_SUMS; k++)
+      cal->dtd[k] /= 2;
+    for(i = 0; i < MAGCAL_NB_PARAM; i++)
+      cal->dt1[i] /= 2;
+    cal->n /= 2;
+  }
+
+  for(i = 0, k = 0; i < MAGCAL_NB_PARAM; i++){
+    for(j = i; j < MAGCAL_NB_PARAM; j++)
+      cal->dtd[k++] += (int64_t) d[i] * d[j];
+    cal->dt1[i] += d[i];
+  }
+
+  cal->n++;
+  cal->sinceSolve++;
+
+  return true;
+}
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_Solve()
+*
+* @brief      Fits the ellipsoid to the accumulated samples and updates the calibration if the fit is good
+*
+* @param[in]  cal         calibration
+* @exception  none
+* @return     MAGCAL_OK, or MAGCAL_ERR_xxx if the calibration was left unchanged
+*/
+/* Notes      :(1) Works on a copy of the sums: samples can still be added by a higher priority task
+*                   while the system is solved.
+*
+*               (2) With Q the 3x3 matrix and u the linear terms of the quadric, the centre is c = -Q^-1 u,
+*                   and the ellipsoid is (m - c)' A (m - c) = 1 with A = Q / (1 + c' Q c).
+*
+*               (3) The equation residual d'v - 1 of a sample is ~2x its relative radius error. Its sum of
+*                   squares is v'(D'D)v - 2 v'(D'1) + n.
+*
+********************************************************************************************************/
+
+INT8U MAGCAL_Solve(MAGCAL *cal){
+
+  int64_t dtd[MAGCAL_NB_SUMS];
+  int64_t dt1[MAGCAL_NB_PARAM];
+  INT32U n;
+  double M[MAGCAL_NB_PARAM][MAGCAL_NB_PARAM];
+  double b[MAGCAL_NB_PARAM];
+  double v[MAGCAL_NB_PARAM];
+  double Q[3][3];
+  double Qi[3][3];
+  double A[3][3];
+  double V[3][3];
+  double lambda[3];
+  double c[3];
+  double s[3];
+  double det;
+  double r;
+  double radius;
+  double lmin, lmax;
+  double e2;
+  int i, j, k;
+
+  // Note(1)
+  OSSchedLock();
+  memcpy(dtd, cal->dtd, sizeof(dtd));
+  memcpy(dt1, cal->dt1, sizeof(dt1));
+  n = cal->n;
+  cal->sinceSolve = 0;
+  OSSchedUnlock();
+
+  if(n < MAGCAL_MIN_SAMPLES)
+    return MAGCAL_Reject(cal, MAGCAL_ERR_SAMPLES);
+
+  // Normal equations
+  for(i = 0, k = 0; i < MAGCAL_NB_PARAM; i++){
+    for(j = i; j < MAGCAL_NB_PARAM; j++, k++){
+      M[i][j] = (double) dtd[k];
+      M[j][i] = M[i][j];
+    }
+    b[i] = (double) dt1[i];
+  }
+
+  if(!MAGCAL_GaussSolve(M, b, v))         // M and b are overwritten
+    return MAGCAL_Reject(cal, MAGCAL_ERR_SINGULAR);
+
+  // Centre                                                  Note(2)
+  Q[0][0] = v[0];  Q[0][1] = v[3];  Q[0][2] = v[4];
+  Q[1][0] = v[3];  Q[1][1] = v[1];  Q[1][2] = v[5];
+  Q[2][0] = v[4];  Q[2][1] = v[5];  Q[2][2] = v[2];
+
+  Qi[0][0] = Q[1][1]*Q[2][2] - Q[1][2]*Q[2][1];
+  Qi[0][1] = Q[0][2]*Q[2][1] - Q[0][1]*Q[2][2];
+  Qi[0][2] = Q[0][1]*Q[1][2] - Q[0][2]*Q[1][1];
+  Qi[1][0] = Qi[0][1];
+  Qi[1][1] = Q[0][0]*Q[2][2] - Q[0][2]*Q[2][0];
+  Qi[1][2] = Q[0][2]*Q[1][0] - Q[0][0]*Q[1][2];
+  Qi[2][0] = Qi[0][2];
+  Qi[2][1] = Qi[1][2];
+  Qi[2][2] = Q[0][0]*Q[1][1] - Q[0][1]*Q[1][0];
+
+  det = Q[0][0]*Qi[0][0] + Q[0][1]*Qi[1][0] + Q[0][2]*Qi[2][0];
+  if(det == 0.0)
+    return MAGCAL_Reject(cal, MAGCAL_ERR_SINGULAR);
+
+  for(i = 0; i < 3; i++)
+    c[i] = -(Qi[i][0]*v[6] + Qi[i][1]*v[7] + Qi[i][2]*v[8]) / det;
+
+  r = 1.0;
+  for(i = 0; i < 3; i++)
+    r += c[i] * (Q[i][0]*c[0] + Q[i][1]*c[1] + Q[i][2]*c[2]);
+  if(r <= 0.0)
+    return MAGCAL_Reject(cal, MAGCAL_ERR_SHAPE);
+
+  // Shape: the axes of the ellipsoid are the eigenvectors of A, the radii 1/sqrt(eigenvalues)
+  for(i = 0; i < 3; i++)
+    for(j = 0; j < 3; j++)
+      A[i][j] = Q[i][j] / r;
+
+  MAGCAL_Eigen(A, lambda, V);
+
+  lmin = lambda[0];
+  lmax = lambda[0];
+  for(i = 1; i < 3; i++){
+    if(lambda[i] < lmin) lmin = lambda[i];
+    if(lambda[i] > lmax) lmax = lambda[i];
+  }
+  if(lmin <= 0.0 || lmax > lmin * MAGCAL_MAX_AXIS_RATIO * MAGCAL_MAX_AXIS_RATIO)
+    return MAGCAL_Reject(cal, MAGCAL_ERR_SHAPE);
+
+  // Quality of the fit                                      Note(3)
+  e2 = (double) n;
+  for(i = 0; i < MAGCAL_NB_PARAM; i++)
+    e2 -= 2.0 * v[i] * (double) dt1[i];
+  for(i = 0, k = 0; i < MAGCAL_NB_PARAM; i++)
+    for(j = i; j < MAGCAL_NB_PARAM; j++, k++)
+      e2 += (i == j ? 1.0 : 2.0) * v[i] * v[j] * (double) dtd[k];
+  e2 = (e2 > 0.0) ? sqrt(e2 / n) : 0.0;
+  if(e2 > MAGCAL_MAX_RESIDUAL)
+    return MAGCAL_Reject(cal, MAGCAL_ERR_FIT);
+
+  // W = V diag(sqrt(lambda) * radius) V', with radius = det(A)^(-1/6) for a unit determinant
+  radius = pow(lambda[0] * lambda[1] * lambda[2], -1.0 / 6.0);
+  for(k = 0; k < 3; k++)
+    s[k] = sqrt(lambda[k]) * radius;
+
+  OSSchedLock();                          // Consistent copy for MAGCAL_GetSolution()
+
+  for(i = 0; i < 3; i++){
+    for(j = 0; j < 3; j++)
+      cal->sol.W[i][j] = (q16_t) ((V[i][0]*s[0]*V[j][0] + V[i][1]*s[1]*V[j][1] + V[i][2]*s[2]*V[j][2]) * 65536.0);
+    cal->sol.offset[i] = (q16_t) (c[i] * 65536.0);
+  }
+  cal->sol.radius   = (q16_t) (radius * 65536.0);
+  cal->sol.residual = (q16_t) (e2 * 65536.0);
+  cal->sol.valid    = true;
+  cal->sol.lastErr  = MAGCAL_OK;
+  cal->sol.solves++;
+
+  OSSchedUnlock();
+
+  return MAGCAL_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_Apply()
+*
+* @brief      Calibrates a sample: out = W * (in - offset)
+*
+* @param[in]  cal         calibration
+* @param[in]  in          uncalibrated magnetic field (mG)
+* @param[out] out         calibrated magnetic field (mG), may be the same array as in
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void MAGCAL_Apply(const MAGCAL *cal, const q16_t in[3], q16_t out[3]){
+
+  q16_t d[3];
+  int i;
+
+  for(i = 0; i < 3; i++)
+    d[i] = in[i] - cal->sol.offset[i];
+
+  for(i = 0; i < 3; i++)
+    out[i] = UTI_Q16Mul(cal->sol.W[i][0], d[0])
+           + UTI_Q16Mul(cal->sol.W[i][1], d[1])
+           + UTI_Q16Mul(cal->sol.W[i][2], d[2]);
+}
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_Update()
+*
+* @brief      Processing of a new sample: adds it to the fit and calibrates the sample
+*
+* @param[in]  cal         calibration
+* @param[in]  in          uncalibrated magnetic field (mG)
+* @param[out] out         calibrated magnetic field (mG)
+* @exception  none
+* @return     true once MAGCAL_SOLVE_PERIOD new samples were added: MAGCAL_Solve() is due
+*/
+/* Notes      :(1) The solution (milliseconds of double arithmetic without an FPU) is left to the caller,
+*                   to be run from a low priority task. The flag stays raised until it has run.
+*
+********************************************************************************************************/
+
+BOOLEAN MAGCAL_Update(MAGCAL *cal, const q16_t in[3], q16_t out[3]){
+
+  MAGCAL_Add(cal, in);
+  MAGCAL_Apply(cal, in, out);
+
+  return (cal->sinceSolve >= MAGCAL_SOLVE_PERIOD);         // Note(1)
+}
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_GetSolution()
+*
+* @brief      Returns a copy of the current calibration
+*
+* @param[in]  cal         calibration
+* @param[out] sol         MAGCAL_SOLUTION structure to fill
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void MAGCAL_GetSolution(const MAGCAL *cal, MAGCAL_SOLUTION *sol){
+
+  OSSchedLock();
+  *sol = cal->sol;
+  sol->samples = cal->n;
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         MAGCAL_SelfTest()
+*
+* @brief      Checks the calibration against a synthetic distorted field: random orientations of a 450 mG
+*             field, distorted by a known soft-iron matrix and hard-iron offset, with +/-2 mG noise
+*
+* @param[out] res         MAGCAL_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Uses its own MAGCAL instance (on the stack), the flight calibration is not affected.
+*
+*               (2) Passes if the offset is found within 3 mG and the calibrated magnitudes are within 1%
+*                   of their mid-range, on samples not used for the fit.
+*
+********************************************************************************************************/
+
+void MAGCAL_SelfTest(MAGCAL_TEST *res){
+
+  static const double S[3][3] = { {  1.10,  0.05, -0.02 },
+                                  {  0.05,  0.92,  0.03 },
+                                  { -0.02,  0.03,  1.00 } };
+  static const double o[3]    = { 120.0, -80.0, 45.0 };
+
+  MAGCAL cal;                                               // Note(1)
+  uint32_t seed = 12345;
+  double u[3];
+  double n2;
+  double norm;
+  double nMin[2] = { 1e9, 1e9 };
+  double nMax[2] = { 0.0, 0.0 };
+  q16_t  m[3];
+  q16_t  out[3];
+  q16_t  err;
+  int    check;
+  int    i, k;
+
+  MAGCAL_Init(&cal);
+  memset(res, 0, sizeof(MAGCAL_TEST));
+
+  // Fit on MAGCAL_TEST_SAMPLES samples, then check on as many new ones
+  for(check = 0; check < 2; check++){
+
+    for(k = 0; k < MAGCAL_TEST_SAMPLES; k++){
+
+      // Random direction (uniform in the unit ball, normalised)
+      do {
+        for(i = 0; i < 3; i++)
+          u[i] = UTI_RandUniform(&seed);
+        n2 = u[0]*u[0] + u[1]*u[1] + u[2]*u[2];
+      } while(n2 > 1.0 || n2 < 0.01);
+
+      for(i = 0; i < 3; i++)
+        u[i] *= 450.0 / sqrt(n2);
+
+      for(i = 0; i < 3; i++)
+        m[i] = (q16_t) ((S[i][0]*u[0] + S[i][1]*u[1] + S[i][2]*u[2] + o[i] + 2.0 * UTI_RandUniform(&seed)) * 65536.0);
+
+      if(!check){
+        MAGCAL_Add(&cal, m);
+        continue;
+      }
+
+      MAGCAL_Apply(&cal, m, out);
+
+      for(i = 0; i < 2; i++){
+        norm = (i == 0) ? MAGCAL_TestNorm(m) : MAGCAL_TestNorm(out);
+        if(norm < nMin[i]) nMin[i] = norm;
+        if(norm > nMax[i]) nMax[i] = norm;
+      }
+    }
+
+    if(!check)
+      res->solveErr = MAGCAL_Solve(&cal);
+  }
+
+  // Offset error
+  for(i = 0; i < 3; i++){
+    err = (q16_t) abs(cal.sol.offset[i] - (q16_t) (o[i] * 65536.0));
+    if(err > res->offsetErr)
+      res->offsetErr = err;
+  }
+
+  // Half range of the magnitudes relative to their mid-range, raw and calibrated
+  res->rawSpread = (INT32U) ((nMax[0] - nMin[0]) / (nMax[0] + nMin[0]) * 10000.0);
+  res->spread    = (INT32U) ((nMax[1] - nMin[1]) / (nMax[1] + nMin[1]) * 10000.0);
+
+  // Note(2)
+  res->pass = (res->solveErr == MAGCAL_OK && res->offsetErr < UTI_Q16FromInt(3) && res->spread < 100);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Records a rejected solution, the current calibration is kept
+static INT8U MAGCAL_Reject(MAGCAL *cal, INT8U err){
+
+  cal->sol.lastErr = err;
+  cal->sol.rejected++;
+
+  return err;
+}
+
+/******************************************************************************/
+
+// Solves M x = b by Gaussian elimination with partial pivoting. Returns false if M is singular.
+static BOOLEAN MAGCAL_GaussSolve(double M[MAGCAL_NB_PARAM][MAGCAL_NB_PARAM], double b[MAGCAL_NB_PARAM],
+                                 double x[MAGCAL_NB_PARAM]){
+
+  double f;
+  double t;
+  double maxDiag = 0.0;
+  int i, j, k, p;
+
+  for(i = 0; i < MAGCAL_NB_PARAM; i++)
+    if(fabs(M[i][i]) > maxDiag)
+      maxDiag = fabs(M[i][i]);
+
+  for(k = 0; k < MAGCAL_NB_PARAM; k++){
+
+    // Pivot
+    p = k;
+    for(i = k + 1; i < MAGCAL_NB_PARAM; i++)
+      if(fabs(M[i][k]) > fabs(M[p][k]))
+        p = i;
+
+    if(fabs(M[p][k]) <= maxDiag * 1e-15)
+      return false;
+
+    if(p != k){
+      for(j = k; j < MAGCAL_NB_PARAM; j++){
+        t = M[k][j];  M[k][j] = M[p][j];  M[p][j] = t;
+      }
+      t = b[k];  b[k] = b[p];  b[p] = t;
+    }
+
+    // Elimination
+    for(i = k + 1; i < MAGCAL_NB_PARAM; i++){
+      f = M[i][k] / M[k][k];
+      for(j = k; j < MAGCAL_NB_PARAM; j++)
+        M[i][j] -= f * M[k][j];
+      b[i] -= f * b[k];
+    }
+  }
+
+  // Back substitution
+  for(i = MAGCAL_NB_PARAM - 1; i >= 0; i--){
+    t = b[i];
+    for(j = i + 1; j < MAGCAL_NB_PARAM; j++)
+      t -= M[i][j] * x[j];
+    x[i] = t / M[i][i];
+  }
+
+  return true;
+}
+
+/******************************************************************************/
+
+// Eigen-decomposition of a symmetric 3x3 matrix by Jacobi rotations: A = V diag(lambda) V'.
+// A is overwritten.
+static void MAGCAL_Eigen(double A[3][3], double lambda[3], double V[3][3]){
+
+  double theta, t, c, s;
+  double akp, akq;
+  int sweep, p, q, k;
+
+  for(p = 0; p < 3; p++)
+    for(q = 0; q < 3; q++)
+      V[p][q] = (p == q) ? 1.0 : 0.0;
+
+  for(sweep = 0; sweep < 50; sweep++){
+
+    if(fabs(A[0][1]) + fabs(A[0][2]) + fabs(A[1][2]) <= 1e-12 * (fabs(A[0][0]) + fabs(A[1][1]) + fabs(A[2][2])))
+      break;
+
+    for(p = 0; p < 2; p++){
+      for(q = p + 1; q < 3; q++){
+
+        if(A[p][q] == 0.0)
+          continue;
+
+        theta = (A[q][q] - A[p][p]) / (2.0 * A[p][q]);
+        t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+        if(theta < 0.0)
+          t = -t;
+        c = 1.0 / sqrt(t * t + 1.0);
+        s = t * c;
+
+        for(k = 0; k < 3; k++){                 // A = A J
+          akp = A[k][p];  akq = A[k][q];
+          A[k][p] = c * akp - s * akq;
+          A[k][q] = s * akp + c * akq;
+        }
+        for(k = 0; k < 3; k++){                 // A = J' A
+          akp = A[p][k];  akq = A[q][k];
+          A[p][k] = c * akp - s * akq;
+          A[q][k] = s * akp + c * akq;
+        }
+        for(k = 0; k < 3; k++){                 // V = V J
+          akp = V[k][p];  akq = V[k][q];
+          V[k][p] = c * akp - s * akq;
+          V[k][q] = s * akp + c * akq;
+        }
+      }
+    }
+  }
+
+  for(k = 0; k < 3; k++)
+    lambda[k] = A[k][k];
+}
+
+/******************************************************************************/
+
+// Magnitude of a Q16.16 vector
+static double MAGCAL_TestNorm(const q16_t v[3]){
+
+  double x = v[0] / 65536.0;
+  double y = v[1] / 65536.0;
+  double z = v[2] / 65536.0;
+
+  return sqrt(x*x + y*y + z*z);
+}
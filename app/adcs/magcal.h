@@ -0,0 +1,116 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: magcal.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Incremental hard-iron / soft-iron calibration of a magnetometer by least-
+squares ellipsoid fit
+
+******************************************************************************/
+
+
+
+#ifndef __MAGCAL_H
+#define __MAGCAL_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define MAGCAL_NB_PARAM         9       // Quadric coefficients
+#define MAGCAL_NB_SUMS          (MAGCAL_NB_PARAM * (MAGCAL_NB_PARAM + 1) / 2)
+
+#define MAGCAL_MIN_STEP         UTI_Q16FromInt(20)          // Min. distance to the last sample used (mG)
+#define MAGCAL_MAX_SAMPLES      4096    // The sums are halved when reached (older samples fade out)
+#define MAGCAL_MIN_SAMPLES      200     // Samples needed before a solution is computed
+#define MAGCAL_SOLVE_PERIOD     100     // New samples between two solutions
+
+#define MAGCAL_MAX_AXIS_RATIO   2.0     // Max. ratio between the ellipsoid axes
+#define MAGCAL_MAX_RESIDUAL     0.05    // Max. RMS residual of the fit (~2x the relative radius error)
+
+// MAGCAL_Solve() results
+#define MAGCAL_OK               0
+#define MAGCAL_ERR_SAMPLES      1       // Not enough samples
+#define MAGCAL_ERR_SINGULAR     2       // Samples do not span an ellipsoid (too few orientations)
+#define MAGCAL_ERR_SHAPE        3       // Not an ellipsoid, or too elongated
+#define MAGCAL_ERR_FIT          4       // Residual too large
+
+// Self-test
+#define MAGCAL_TEST_SAMPLES     1000
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Calibration applied to the measurements: out = W * (in - offset)
+typedef struct MagCalSolution MAGCAL_SOLUTION;
+
+struct MagCalSolution {
+  q16_t   offset[3];                    // Hard-iron offset (mG)
+  q16_t   W[3][3];                      // Soft-iron correction, unit determinant
+  q16_t   radius;                       // Mean magnitude of the calibrated field (mG)
+  q16_t   residual;                     // RMS residual of the fit
+  BOOLEAN valid;                        // False: identity (no calibration yet)
+  INT8U   lastErr;                      // Result of the last MAGCAL_Solve()
+  INT32U  solves;                       // Solutions accepted
+  INT32U  rejected;                     // Solutions rejected
+  INT32U  samples;                      // Samples in the accumulator
+};
+
+typedef struct MagCal MAGCAL;
+
+struct MagCal {
+  int64_t dtd[MAGCAL_NB_SUMS];          // D'D, upper triangle (1 mG units)
+  int64_t dt1[MAGCAL_NB_PARAM];         // D'1
+  INT32U  n;
+  INT32U  sinceSolve;
+  q16_t   last[3];                      // Last sample used
+  MAGCAL_SOLUTION sol;
+};
+
+typedef struct MagCalTest MAGCAL_TEST;
+
+struct MagCalTest {
+  INT8U   solveErr;                     // MAGCAL_Solve() result
+  q16_t   offsetErr;                    // Largest offset error (mG)
+  INT32U  spread;                       // Half range / mid-range of the calibrated magnitudes (1/10000)
+  INT32U  rawSpread;                    // Same, without calibration
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    MAGCAL_Init(MAGCAL *cal);
+BOOLEAN MAGCAL_Add(MAGCAL *cal, const q16_t mag[3]);
+INT8U   MAGCAL_Solve(MAGCAL *cal);
+void    MAGCAL_Apply(const MAGCAL *cal, const q16_t in[3], q16_t out[3]);
+BOOLEAN MAGCAL_Update(MAGCAL *cal, const q16_t in[3], q16_t out[3]);
+void    MAGCAL_GetSolution(const MAGCAL *cal, MAGCAL_SOLUTION *sol);
+
+void    MAGCAL_SelfTest(MAGCAL_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __MAGCAL_H */
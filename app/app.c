@@ -82,6 +82,7 @@ static OS_STK APP_SensorDataHandlerStk[APP_CFG_SEN_DATA_STK_SIZE];
 static OS_STK APP_SensorTimeHandlerStk[APP_CFG_SEN_TIME_STK_SIZE];
 static OS_STK APP_HKDataHandlerStk[APP_CFG_HK_DATA_STK_SIZE];
 static OS_STK APP_PLDataHandlerStk[APP_CFG_PL_DATA_STK_SIZE];
+static OS_STK APP_ADCSControlStk[APP_CFG_ADCS_STK_SIZE];
 
 
 /*
@@ -91,13 +92,46 @@ static OS_STK APP_PLDataHandlerStk[APP_CFG_PL_DATA_STK_SIZE];
 */
 
 // Task user data structure variable
-TASK_USER_DATA taskUserData[9];
+TASK_USER_DATA taskUserData[TASK_USER_NB];
 
 /* definition of global mailbox object for inter-task communication
  * extern declaration in includes.h */
 OS_EVENT *pSerialMsgObj;
 OS_EVENT *commandMsgObj;
-OS_EVENT *memMngmtMsgObj;
+
+/* definition of global semaphore objects for inter-task synchronisation
+ * extern declaration in includes.h */
+OS_EVENT *magReadySem;
+OS_EVENT *senReadySem;
+
+/* definition of global record pools and message queues for inter-task data flow
+ * extern declaration in includes.h */
+MSGQ_POOL  recordPool;
+MSGQ_QUEUE memMngmtQ;
+
+static uint64_t recordPoolStk[APP_CFG_RECORD_POOL_SIZE][(sizeof(MSGQ_RECORD) + 7) / 8];   // 64-bit time stamps
+static void*  memMngmtQTbl[APP_CFG_MEM_MAN_Q_SIZE];
+
+/* definition of the magnetometer calibration and of the attitude estimator, updated by the sensor task
+ * extern declaration in includes.h */
+MAGCAL mag1Cal;
+ATT    attEst;
+
+/* definition of the sensor log, of its retention tiers and of the HK log, appended by the memory
+ * management task (NAND1Mutex)
+ * extern declaration in includes.h */
+LOG      senLog;
+LOG      senTierLog[APP_CFG_RET_TIERS];
+RET_TIER senTier[APP_CFG_RET_TIERS];
+LOG      hkLog;
+
+/* definition of the parameter store, loaded at boot, on the NOR (NORMutex)
+ * extern declaration in includes.h */
+PARAM_STORE params;
+
+static FLASH_DEV norDev;
+static INT8U     norMem[APP_CFG_NOR_PAGE_SIZE * APP_CFG_NOR_PAGES_PER_BLOCK * APP_CFG_NOR_SIM_BLOCKS];
+static INT8U     norSpare[FLASH_SPARE_SIZE * APP_CFG_NOR_PAGES_PER_BLOCK * APP_CFG_NOR_SIM_BLOCKS];
 
 /* definition of global mutex objects for inter-task communication
  * extern declaration in includes.h */
@@ -107,6 +141,12 @@ OS_EVENT *NAND2Mutex;
 OS_EVENT *NORMutex;
 OS_EVENT *sysI2CMutex;
 
+/* definition of the PL request queue, on the subsystem bus (sysI2CMutex taken per transfer)
+ * extern declaration in includes.h */
+PLQ plQueue;
+
+static PLQ_LINK plLink;
+
 // I2C Init Handles
 I2C_Init_TypeDef sati2c_Init = I2C_INIT_DEFAULT;
 I2C_Init_TypeDef seni2c_Init = I2C_INIT_DEFAULT;
@@ -121,6 +161,7 @@ I2C_Init_TypeDef seni2c_Init = I2C_INIT_DEFAULT;
 static void APP_TaskStart (void *p_arg);
 static void APP_TaskCreate (void);
 static void APP_MailboxCreate(void);
+static void APP_EventCheck(void *pevent, INT8U err);
 
 /* static function for energyAware Profiler */
 //static void setupSWO(void);
@@ -205,6 +246,9 @@ int main(void)
 *
 *               (2) Interrupts are enabled once the task starts because the I-bit of the CCR register was
 *                   set to 0 by 'OSTaskCreate()'.
+*
+*               (3) Then the task runs the background computations, at the lowest application priority:
+*                   it is resumed by the sensor task when a magnetometer calibration solution is due.
 *********************************************************************************************************
 */
 static void APP_TaskStart(void *p_arg)
@@ -215,26 +259,50 @@ static void APP_TaskStart(void *p_arg)
   /* Initialize BSP functions                             */
   BSPOS_Init();
 
+#if (APP_CFG_VTIME_EN > 0)
+  /* Virtual time: the idle task drives the kernel clock  */
+  VTIME_Init();
+#else
+  /* Start the RTC used for tickless idle                 */
+  PWR_Init();
+
   /* Initialize the uC/OS-II ticker                       */
   OS_CPU_SysTickInit(CMU_ClockFreqGet(cmuClock_HFPER)/OS_TICKS_PER_SEC);
+#endif
+
+  /* Start the task execution time measurements           */
+  TMON_Init();
+
+  /* Reset the stack watermarks                           */
+  STKMON_Init();
 
 #if (OS_TASK_STAT_EN > 0)
   /* Determine CPU capacity                               */
   OSStatInit();
 #endif
   
-  // Initialise subsystem I2C bus
+  // Initialise subsystem I2C bus, and the PL requests on it
   SATI2C_Init(&sati2c_Init);
+  PLQ_I2CInit(&plLink);
+  PLQ_Init(&plQueue, &plLink);
   
   // Initialise sensor I2C bus  
   SENI2C_Init(&seni2c_Init);
   
+  /* Create application mailboxes, before the tasks using them
+   * can run                                              */
+  APP_MailboxCreate();
+
+  /* Load the parameters, before the tasks using them     */
+  FLASH_SimInit(&norDev, "nor", norMem, norSpare, APP_CFG_NOR_PAGE_SIZE,
+                APP_CFG_NOR_PAGES_PER_BLOCK, APP_CFG_NOR_SIM_BLOCKS);
+  PARAM_Init(&params, &norDev, 0);
+  PARAM_Load(&params);
+  PARAM_Apply(&params);
+
   /* Create application tasks                             */
   APP_TaskCreate();
 
-  /* Create application mailboxes                         */
-  APP_MailboxCreate();
-
 
 #ifdef USART_CONNECTED
   
@@ -242,6 +310,11 @@ static void APP_TaskStart(void *p_arg)
   RETARGET_SerialInit();
   RETARGET_SerialCrLf(1);
 
+#if (APP_CFG_VTIME_EN == 0)
+  /* The console does not receive in EM2: wake it on RX   */
+  PWR_ConsoleInit();
+#endif
+
   osVersion3 = OSVersion();
   osVersion1 = osVersion3 / 10000;
   osVersion3 -= osVersion1 * 10000;
@@ -265,12 +338,10 @@ static void APP_TaskStart(void *p_arg)
 
 #endif /* end of #ifndef USART_CONNECTED */
 
-  /* Suspend this task as it is only used once in one Reset cycle */
-  OSTaskSuspend(APP_CFG_TASK_START_PRIO);
-
   while (1)
-  {/* endless loop of Start task                          */
-    ;
+  {/* endless loop of Start task, Note(3)                 */
+    OSTaskSuspend(APP_CFG_TASK_START_PRIO);
+    MAGCAL_Solve(&mag1Cal);
   }
 }
 
@@ -285,15 +356,67 @@ static void APP_TaskStart(void *p_arg)
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) Each object takes an event control block: OS_MAX_EVENTS (os_cfg.h) must cover them,
+*                   and the two of the timer manager.
 *********************************************************************************************************
 */
 static void APP_MailboxCreate (void)
 {
+  INT8U err;
+  
   /* Create mailbox object for messaging received serial data between tasks */
   pSerialMsgObj = OSMboxCreate((void *)0);
+  APP_EventCheck(pSerialMsgObj, OS_ERR_NONE);
   commandMsgObj  = OSMboxCreate((void *)0);
-  memMngmtMsgObj = OSMboxCreate((void *)0);
+  APP_EventCheck(commandMsgObj, OS_ERR_NONE);
+  
+  /* Create the semaphores releasing the ADCS task on each magnetometer sample
+   * and the sensor task on each gyro data ready interrupt */
+  magReadySem = OSSemCreate(0);
+  APP_EventCheck(magReadySem, OS_ERR_NONE);
+  senReadySem = OSSemCreate(0);
+  APP_EventCheck(senReadySem, OS_ERR_NONE);
+  
+  /* Create the record pool and the queues carrying the records between tasks */
+  MSGQ_PoolCreate(&recordPool, recordPoolStk, APP_CFG_RECORD_POOL_SIZE, sizeof(recordPoolStk[0]));
+  APP_EventCheck(recordPool.mem, OS_ERR_NONE);
+  MSGQ_QueueCreate(&memMngmtQ, memMngmtQTbl, APP_CFG_MEM_MAN_Q_SIZE);
+  APP_EventCheck(memMngmtQ.event, OS_ERR_NONE);
+  
+  /* Create the mutex of the flash devices */
+  NAND1Mutex = OSMutexCreate(APP_CFG_NAND1_PIP, &err);
+  APP_EventCheck(NAND1Mutex, err);
+  NORMutex   = OSMutexCreate(APP_CFG_NOR_PIP, &err);
+  APP_EventCheck(NORMutex, err);
+  
+  /* Create the mutex of the app database and of the subsystem bus */
+  dataMutex   = OSMutexCreate(APP_CFG_DATA_PIP, &err);
+  APP_EventCheck(dataMutex, err);
+  sysI2CMutex = OSMutexCreate(APP_CFG_SYSI2C_PIP, &err);
+  APP_EventCheck(sysI2CMutex, err);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      App_EventCheck()
+*
+* Description : Checks the creation of a kernel object (event, memory partition)
+*
+* Argument(s) : pevent      created object, null if the creation failed.
+*
+*               err         error code returned by the creation, OS_ERR_NONE if there is none.
+*
+* Return(s)   : none.
+*
+* Note(s)     : (1) The tasks cannot run without their objects (e.g. a null mutex is dereferenced, as
+*                   OS_ARG_CHK_EN is 0): stop here, like main() when OSStart() returns.
+*********************************************************************************************************
+*/
+static void APP_EventCheck (void *pevent, INT8U err)
+{
+  if(pevent == (void *)0 || err != OS_ERR_NONE)
+    while(1) ;                                            /* Note(1) */
 }
 
 
@@ -403,6 +526,17 @@ static void APP_TaskCreate (void)
                   (INT32U          ) APP_CFG_PL_DATA_STK_SIZE,
                   (void           *) &taskUserData[PL_DATA_ID],
                   (INT16U          )(OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR));
+  
+  // Create the ADCSControl task
+  OSTaskCreateExt((void (*)(void *)) APP_ADCSControl,
+                  (void           *) 0,
+                  (OS_STK         *)&APP_ADCSControlStk[APP_CFG_ADCS_STK_SIZE - 1],
+                  (INT8U           ) APP_CFG_ADCS_PRIO,
+                  (INT16U          ) APP_CFG_ADCS_PRIO,
+                  (OS_STK         *)&APP_ADCSControlStk[0],
+                  (INT32U          ) APP_CFG_ADCS_STK_SIZE,
+                  (void           *) &taskUserData[ADCS_ID],
+                  (INT16U          )(OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR));
 
 
 #if (OS_TASK_NAME_EN > 0)
@@ -414,6 +548,7 @@ static void APP_TaskCreate (void)
   OSTaskNameSet(APP_CFG_SEN_TIME_PRIO, "Sensor Time", &err);
   OSTaskNameSet(APP_CFG_HK_DATA_PRIO, "HK Data", &err);
   OSTaskNameSet(APP_CFG_PL_DATA_PRIO, "PL Data", &err);
+  OSTaskNameSet(APP_CFG_ADCS_PRIO, "ADCS Control", &err);
 #endif
 }
 
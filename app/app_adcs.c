@@ -0,0 +1,262 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_adcs.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+ADCS control task. The task is not released by a timer but by the
+magnetometer samples: the sensor task hands each new field measurement, with
+its time stamp, to ADCS_MagSample(), which stores it in the B-dot sample ring
+and posts magReadySem. The control task has a high priority, so it runs right
+after the sample is taken and its rate follows the magnetometer exactly,
+without a second timer beating against the sensor task.
+
+In ADCS_BDOT mode the B-dot law (bdot.c) computes the magnetorquer dipole
+command, published in the app database. Once the body rate has stayed below
+ADCS_DETUMBLED_RATE for ADCS_MODE_SAMPLES samples the satellite is detumbled
+and goes to ADCS_FULL; it goes back to ADCS_BDOT if the rate stays above
+ADCS_TUMBLING_RATE as long. In the other modes, or when no
+sample has arrived for ADCS_TIMEOUT_MS, the command is zero.
+
+The loop measures its latency (from the sample time stamp to the output of
+the command) and its jitter (deviation of the time between two activations
+from the nominal sample period).
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static BDOT       bdot;
+static uint64_t   sampleTimeUs;         // Time stamp of the last sample
+static ADCS_STATS stats;
+static INT32U     modeCount;            // Consecutive samples meeting the mode transition condition
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void ADCS_Output(const q16_t dipole[3]);
+static void ADCS_Mode(void);
+
+
+
+
+/********************************************************************************************************
+*                                         APP_ADCSControl()
+*
+* @brief      ADCS control loop, run on every new magnetometer sample
+*
+* @param[in]  p_arg       Argument passed to 'APP_TaskOne()' by 'OSTaskCreate()'.
+* @exception  none
+* @return     none.
+*/
+/* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
+*                   used.  The compiler should not generate any code for this statement.
+*
+*               (2) The satellite starts in detumbling mode, the mode then follows the body rate (see
+*                   ADCS_Mode()).
+*
+*               (3) The statistics are only written by this task, which has a higher priority than the
+*                   readers (see ADCS_GetStats()).
+*
+********************************************************************************************************/
+
+void APP_ADCSControl(void *Ptr_Arg){
+
+  (void)Ptr_Arg; /* Note(1) */
+  INT8U   err;
+  INT32U  now;
+  INT32U  last = 0;
+  INT32U  period;
+  INT32U  jitter;
+  INT32U  latency;
+  BOOLEAN first = true;
+  q16_t   dipole[3];
+
+  OSMutexPend(dataMutex, 0, &err);
+  DB_Set(APP_AppDataPtr(), ADCS_MODE, ADCS_BDOT);              // Note(2)
+  OSMutexPost(dataMutex);
+
+  while(1){
+
+    OSSemPend(magReadySem, ADCS_TIMEOUT_MS * OS_TICKS_PER_SEC / 1000, &err);
+    now = (INT32U) TIME_NowUs();          // Differences only
+
+    // No sample: stop actuating on an old field
+    if(err != OS_ERR_NONE){
+      memset(dipole, 0, sizeof(dipole));
+      ADCS_Output(dipole);
+      stats.timeouts++;
+      first = true;
+      continue;
+    }
+
+    // Activation period and jitter                          Note(3)
+    stats.loops++;
+    if(!first){
+      period = now - last;
+      jitter = (period > ADCS_PERIOD_US) ? period - ADCS_PERIOD_US : ADCS_PERIOD_US - period;
+      if(period < stats.periodMin || stats.periodMin == 0)
+        stats.periodMin = period;
+      if(period > stats.periodMax)
+        stats.periodMax = period;
+      if(jitter > stats.jitterMax)
+        stats.jitterMax = jitter;
+    }
+    last  = now;
+    first = false;
+
+    // Detumbling or not
+    ADCS_Mode();
+
+    // Control law
+    if(DB_Get(APP_AppDataPtr(), ADCS_MODE) == ADCS_BDOT && BDOT_Control(&bdot, dipole)){
+      stats.commands++;
+      if(bdot.saturated)
+        stats.saturated++;
+    }
+    else
+      memset(dipole, 0, sizeof(dipole));
+
+    ADCS_Output(dipole);
+
+    // Latency
+    latency = (INT32U) (TIME_NowUs() - sampleTimeUs);
+    stats.latencyLast = latency;
+    stats.latencyMean += ((INT32S) (latency - stats.latencyMean)) >> ADCS_LAT_SHIFT;
+    if(latency > stats.latencyMax)
+      stats.latencyMax = latency;
+  }
+}
+
+
+
+/********************************************************************************************************
+*                                         ADCS_MagSample()
+*
+* @brief      Hands a new magnetometer sample to the control task. Called by the sensor task.
+*
+* @param[in]  mag         magnetic field, body frame (mG)
+* @param[in]  timeUs      time of the measurement (us, see TIME_NowUs())
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void ADCS_MagSample(const q16_t mag[3], uint64_t timeUs){
+
+  OSSchedLock();
+  BDOT_AddSample(&bdot, mag, (INT32U) timeUs);
+  sampleTimeUs = timeUs;
+  OSSchedUnlock();
+
+  OSSemPost(magReadySem);               // Releases the control task
+}
+
+
+
+/********************************************************************************************************
+*                                   ADCS_GetStats() / ADCS_GetCommand()
+*
+* @brief      Return a consistent copy of the control loop statistics (resp. of the current command)
+*
+* @param[out] s           ADCS_STATS structure to fill
+* @param[out] cmd         ADCS_COMMAND structure to fill
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void ADCS_GetStats(ADCS_STATS *s){
+
+  OSSchedLock();
+  *s = stats;
+  OSSchedUnlock();
+}
+
+void ADCS_GetCommand(ADCS_COMMAND *cmd){
+
+  OSSchedLock();
+  cmd->mode = DB_Get(APP_AppDataPtr(), ADCS_MODE);
+  memcpy(cmd->dBdt, bdot.dBdt, sizeof(cmd->dBdt));
+  cmd->dipole[0] = DB_Get(APP_AppDataPtr(), MTQ_X);
+  cmd->dipole[1] = DB_Get(APP_AppDataPtr(), MTQ_Y);
+  cmd->dipole[2] = DB_Get(APP_AppDataPtr(), MTQ_Z);
+  OSSchedUnlock();
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Publishes the dipole command in the app database (for the magnetorquer driver)
+static void ADCS_Output(const q16_t dipole[3]){
+
+  INT8U err;
+
+  OSMutexPend(dataMutex, 0, &err);
+  DB_Set(APP_AppDataPtr(), MTQ_X, dipole[0]);
+  DB_Set(APP_AppDataPtr(), MTQ_Y, dipole[1]);
+  DB_Set(APP_AppDataPtr(), MTQ_Z, dipole[2]);
+  OSMutexPost(dataMutex);
+}
+
+/******************************************************************************/
+
+// Mode transition: ADCS_BDOT to ADCS_FULL once the body rate has stayed below ADCS_DETUMBLED_RATE for
+// ADCS_MODE_SAMPLES samples, back to ADCS_BDOT if it stays above ADCS_TUMBLING_RATE as long. The rates
+// are the last ones written by the sensor task (drift removed), one field at a time.
+static void ADCS_Mode(void){
+
+  INT8U   err;
+  INT8U   mode;
+  q16_t   rate = 0;
+  q16_t   r;
+  BOOLEAN change;
+  int     i;
+
+  mode = (INT8U) DB_Get(APP_AppDataPtr(), ADCS_MODE);
+  if(mode != ADCS_BDOT && mode != ADCS_FULL)
+    return;
+
+  for(i = 0; i < 3; i++){
+    r = abs(DB_Get(APP_AppDataPtr(), GYRO_X + i));
+    if(r > rate)
+      rate = r;
+  }
+
+  change = (mode == ADCS_BDOT) ? (rate < ADCS_DETUMBLED_RATE) : (rate > ADCS_TUMBLING_RATE);
+  modeCount = change ? modeCount + 1 : 0;
+  if(modeCount < ADCS_MODE_SAMPLES)
+    return;
+
+  modeCount = 0;
+  stats.modeChanges++;
+
+  OSMutexPend(dataMutex, 0, &err);
+  DB_Set(APP_AppDataPtr(), ADCS_MODE, (mode == ADCS_BDOT) ? ADCS_FULL : ADCS_BDOT);
+  OSMutexPost(dataMutex);
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_adcs.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the ADCS control task, released by
+each new magnetometer sample, and of its control loop latency and jitter
+statistics.
+
+******************************************************************************/
+
+#ifndef __APP_ADCS_H
+#define __APP_ADCS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Nominal time between two magnetometer samples, and time without sample before the command is cut
+#define ADCS_PERIOD_US          (APP_CFG_SEN_DATA_PERIOD_MS * 1000u)
+#define ADCS_TIMEOUT_MS         (APP_CFG_SEN_DATA_PERIOD_MS * 3u)
+
+#define ADCS_LAT_SHIFT          4u      // Mean latency averaged over 2^SHIFT loops
+
+// Mode transitions on the body rate (largest axis of the corrected gyro rates), held for ADCS_MODE_SAMPLES
+#define ADCS_DETUMBLED_RATE     UTI_Q16FromFloat(1.0)       // ADCS_BDOT -> ADCS_FULL below (deg/s)
+#define ADCS_TUMBLING_RATE      UTI_Q16FromFloat(3.0)       // ADCS_FULL -> ADCS_BDOT above (deg/s)
+#define ADCS_MODE_SAMPLES       (60000u / APP_CFG_SEN_DATA_PERIOD_MS)   // One minute
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Control loop statistics (times in us)
+typedef struct AdcsStats ADCS_STATS;
+
+struct AdcsStats {
+  INT32U loops;                         // Activations on a new sample
+  INT32U timeouts;                      // No sample within ADCS_TIMEOUT_MS (command cut)
+  INT32U commands;                      // B-dot commands computed
+  INT32U saturated;                     // Commands saturated
+  INT32U latencyLast;                   // Sample time stamp to command output
+  INT32U latencyMean;
+  INT32U latencyMax;
+  INT32U periodMin;                     // Time between two activations
+  INT32U periodMax;
+  INT32U jitterMax;                     // Largest deviation from ADCS_PERIOD_US
+  INT32U modeChanges;                   // Transitions between ADCS_BDOT and ADCS_FULL
+};
+
+// Current command
+typedef struct AdcsCommand ADCS_COMMAND;
+
+struct AdcsCommand {
+  INT8U  mode;                          // ADCS_xxx (see app_database.h)
+  q16_t  dBdt[3];                       // Field derivative (mG/s)
+  q16_t  dipole[3];                     // Magnetorquer dipole command output (A.m^2)
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void APP_ADCSControl(void *Ptr_Arg);
+
+void ADCS_MagSample(const q16_t mag[3], uint64_t timeUs);
+
+void ADCS_GetStats(ADCS_STATS *s);
+void ADCS_GetCommand(ADCS_COMMAND *cmd);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
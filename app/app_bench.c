@@ -0,0 +1,164 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_bench.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+On-target benchmarks. The sensor conversions are now done in fixed-point
+(Q16.16). The floating-point versions they replace are kept here as a
+reference, to measure the cycles saved and the difference between the two
+over the range of the raw readings.
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+typedef struct BenchDesc BENCH_DESC;
+
+struct BenchDesc {
+  const char *name;
+  INT32S      rawMin;
+  INT32S      rawMax;
+  float     (*convFloat)(float value);
+  q16_t     (*convFixed)(int16_t value);
+};
+
+static float BENCH_GyroFloat(float value);
+static float BENCH_TempFloat(float value);
+static float BENCH_MagFloat(float value);
+
+// Raw ranges: full scale for the ITG3200, output range (-2048..2047) plus overflow (-4096) for the HMC5883L
+static const BENCH_DESC descTbl[BENCH_CONV_NB] = {
+  { "Gyro", -32768, 32767, BENCH_GyroFloat, ITG3200_ConvertGyro  },
+  { "Temp", -32768, 32767, BENCH_TempFloat, ITG3200_ConvertTemp  },
+  { "Mag ",  -4096,  2047, BENCH_MagFloat,  HMC5883L_ConvertMag  },
+};
+
+// Results are written here so that the compiler cannot drop the conversions
+static volatile float  sinkFloat;
+static volatile q16_t  sinkFixed;
+static volatile INT32S sinkRaw;
+
+
+
+
+/********************************************************************************************************
+*                                         BENCH_Conversion()
+*
+* @brief      Runs a conversion over its raw range in floating-point and in fixed-point, and compares
+*             the results
+*
+* @param[in]  conv        conversion (BENCH_CONV_xxx)
+* @param[out] res         BENCH_CONV structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The scheduler is locked during the timed loops, interrupts are not: run the benchmark
+*                   on a quiet system. The cost of the loop itself is measured and subtracted.
+*
+*               (2) The floating-point result is itself rounded to 24 bits of mantissa, part of the
+*                   difference at large values comes from the float path.
+*
+********************************************************************************************************/
+
+void BENCH_Conversion(INT8U conv, BENCH_CONV *res){
+
+  const BENCH_DESC *desc = &descTbl[conv];
+  INT32S raw;
+  INT32U start;
+  INT32U loop;
+  INT32U cycFloat;
+  INT32U cycFixed;
+  int64_t ref;
+  INT32U err;
+
+  // Execution time, cycle counter started by TMON_Init()  Note(1)
+  OSSchedLock();
+
+  start = UTI_CycCntGet();
+  for(raw = desc->rawMin; raw <= desc->rawMax; raw += BENCH_STEP)
+    sinkRaw = raw;
+  loop = UTI_CycCntGet() - start;
+
+  start = UTI_CycCntGet();
+  for(raw = desc->rawMin; raw <= desc->rawMax; raw += BENCH_STEP)
+    sinkFloat = desc->convFloat((float) raw);
+  cycFloat = UTI_CycCntGet() - start;
+
+  start = UTI_CycCntGet();
+  for(raw = desc->rawMin; raw <= desc->rawMax; raw += BENCH_STEP)
+    sinkFixed = desc->convFixed((int16_t) raw);
+  cycFixed = UTI_CycCntGet() - start;
+
+  OSSchedUnlock();
+
+  res->samples     = (desc->rawMax - desc->rawMin) / BENCH_STEP + 1;
+  res->floatCycles = (cycFloat - loop) / res->samples;
+  res->fixedCycles = (cycFixed - loop) / res->samples;
+
+  // Accuracy                                                Note(2)
+  res->maxErr    = 0;
+  res->maxErrRaw = desc->rawMin;
+
+  for(raw = desc->rawMin; raw <= desc->rawMax; raw++){
+    ref = (int64_t) ((double) desc->convFloat((float) raw) * 65536.0);
+    err = (INT32U) llabs(ref - desc->convFixed((int16_t) raw));
+    if(err > res->maxErr){
+      res->maxErr    = err;
+      res->maxErrRaw = raw;
+    }
+  }
+}
+
+
+
+/********************************************************************************************************
+*                                         BENCH_ConversionName()
+*
+* @brief      Name of a conversion
+*
+* @param[in]  conv        conversion (BENCH_CONV_xxx)
+* @exception  none
+* @return     name
+*
+********************************************************************************************************/
+
+const char* BENCH_ConversionName(INT8U conv){
+  return descTbl[conv].name;
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Floating-point conversions, as they were in itg3200.c and hmc5883l.c
+
+static float BENCH_GyroFloat(float value){
+  return (float) (value - GYRO_OFFSET)/GYRO_SENSITIVITY + GYRO_REFERENCE;
+}
+
+static float BENCH_TempFloat(float value){
+  return (float) ((value - TEMP_OFFSET)/TEMP_SENSITIVITY + TEMP_REFERENCE);
+}
+
+static float BENCH_MagFloat(float value){
+  return (float)  (value*HMC5883L_SENSITIVITY);
+}
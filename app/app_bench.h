@@ -0,0 +1,70 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_bench.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the on-target benchmarks: execution
+time (CPU cycles) and accuracy of the fixed-point sensor conversions against
+the former floating-point ones.
+
+******************************************************************************/
+
+#ifndef __APP_BENCH_H
+#define __APP_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Sensor conversions
+#define BENCH_CONV_GYRO         0       // ITG3200_ConvertGyro()
+#define BENCH_CONV_TEMP         1       // ITG3200_ConvertTemp()
+#define BENCH_CONV_MAG          2       // HMC5883L_ConvertMag()
+#define BENCH_CONV_NB           3
+
+#define BENCH_STEP              16      // Raw value increment between two samples
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct BenchConv BENCH_CONV;
+
+struct BenchConv {
+  INT32U samples;
+  INT32U floatCycles;                   // Average cycles per conversion, floating-point
+  INT32U fixedCycles;                   // Average cycles per conversion, fixed-point
+  INT32U maxErr;                        // Largest difference between the two (Q16.16 LSBs)
+  INT32S maxErrRaw;                     // Raw value where it occurs
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void        BENCH_Conversion(INT8U conv, BENCH_CONV *res);
+const char* BENCH_ConversionName(INT8U conv);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
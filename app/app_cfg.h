@@ -75,6 +75,7 @@ extern "C" {
 #define  APP_CFG_TASK_START_PRIO                 30U 
 #define  APP_CFG_SERIAL_DISP_PRIO                 5U
 #define  APP_CFG_LED_DISP_PRIO                    6U
+#define  APP_CFG_ADCS_PRIO                       10U
 #define  APP_CFG_COMMAND_PRIO                    18U
 #define  APP_CFG_MEM_MAN_PRIO                    20U
 #define  APP_CFG_SEN_DATA_PRIO                   22U
@@ -87,10 +88,10 @@ extern "C" {
 // PIP
 #define  APP_CFG_DATA_PIP                         4U
 #define  APP_CFG_SAT_I2C_PIP                     31U
-#define  APP_CFG_NAND1_PIP                       32U
+#define  APP_CFG_NAND1_PIP                       12U     // Above its users (command, memory management)
 #define  APP_CFG_NAND2_PIP                       33U
-#define  APP_CFG_NOR_PIP                         34U
-#define  APP_CFG_SYSI2C_PIP                      35U
+#define  APP_CFG_NOR_PIP                         14U     // Above its users (command)
+#define  APP_CFG_SYSI2C_PIP                      16U     // Above the users of the subsystem bus (command, HK, PL)
 
 
 /*
@@ -99,15 +100,16 @@ extern "C" {
 *                          Size of the task stacks (# of OS_STK entries)
 *********************************************************************************************************
 */
-#define  APP_CFG_TASK_START_STK_SIZE           128U
+#define  APP_CFG_TASK_START_STK_SIZE           512U
 #define  APP_CFG_SERIAL_DISP_STK_SIZE          256U
 #define  APP_CFG_LED_DISP_STK_SIZE              16U
 #define  APP_CFG_COMMAND_STK_SIZE             2048U
 #define  APP_CFG_MEM_MAN_STK_SIZE             1024U
-#define  APP_CFG_SEN_DATA_STK_SIZE             128U
+#define  APP_CFG_SEN_DATA_STK_SIZE             512U
 #define  APP_CFG_SEN_TIME_STK_SIZE             128U
 #define  APP_CFG_HK_DATA_STK_SIZE             1024U
 #define  APP_CFG_PL_DATA_STK_SIZE             1024U
+#define  APP_CFG_ADCS_STK_SIZE                 256U
 
 #define  APP_CFG_TOTAL_STK_SIZE   APP_CFG_TASK_START_STK_SIZE  + \
                                   APP_CFG_SERIAL_DISP_STK_SIZE + \
@@ -117,7 +119,8 @@ extern "C" {
                                   APP_CFG_SEN_DATA_STK_SIZE + \
                                   APP_CFG_SEN_TIME_STK_SIZE + \
                                   APP_CFG_HK_DATA_STK_SIZE + \
-                                  APP_CFG_PL_DATA_STK_SIZE
+                                  APP_CFG_PL_DATA_STK_SIZE + \
+                                  APP_CFG_ADCS_STK_SIZE
                                   
 
 /*
@@ -135,6 +138,173 @@ extern "C" {
 #define HK_DATA_ID              6
 #define PL_DATA_ID              7
 #define SEN_TIME_ID             8
+#define ADCS_ID                 9
+
+
+/*
+*********************************************************************************************************
+*                                     TASK TIMING CONTRACTS
+*               Period [ms], execution budget [us] and deadline after release [ms] (see app_timing.c)
+*********************************************************************************************************
+*/
+#define  APP_CFG_MEM_MAN_PERIOD_MS                0U      // Event driven: deadline per record, from its allocation
+#define  APP_CFG_MEM_MAN_BUDGET_US           100000U
+#define  APP_CFG_MEM_MAN_DEADLINE_MS           1000U
+
+#define  APP_CFG_SEN_DATA_PERIOD_MS             100U    // Database rate; jobs released by the ITG3200 data ready
+#define  APP_CFG_SEN_DATA_BUDGET_US           15000U
+#define  APP_CFG_SEN_DATA_DEADLINE_MS            50U
+
+#define  APP_CFG_HK_DATA_PERIOD_MS             1000U
+#define  APP_CFG_HK_DATA_BUDGET_US            50000U
+#define  APP_CFG_HK_DATA_DEADLINE_MS            500U
+
+#define  APP_CFG_PL_DATA_PERIOD_MS             1000U
+#define  APP_CFG_PL_DATA_BUDGET_US            50000U
+#define  APP_CFG_PL_DATA_DEADLINE_MS            500U
+
+#define  APP_CFG_SEN_TIME_PERIOD_MS            1000U
+#define  APP_CFG_SEN_TIME_BUDGET_US            1000U
+#define  APP_CFG_SEN_TIME_DEADLINE_MS           500U
+
+
+/*
+*********************************************************************************************************
+*                                         MESSAGE QUEUES
+*                          Number of records in the pool and of entries in the queues
+*********************************************************************************************************
+*/
+#define  APP_CFG_RECORD_POOL_SIZE                16U
+#define  APP_CFG_MEM_MAN_Q_SIZE                  16U
+
+
+/*
+*********************************************************************************************************
+*                                            SENSORS
+*********************************************************************************************************
+*/
+// The gyroscope is read OVERSAMPLING times per database period (APP_CFG_SEN_DATA_PERIOD_MS), the
+// magnetometers every MAG_DIVIDER gyro samples; the streams are decimated to the database rate
+// (see sensor.c). OVERSAMPLING must be a multiple of MAG_DIVIDER.
+#define  APP_CFG_SEN_OVERSAMPLING                10U
+#define  APP_CFG_SEN_MAG_DIVIDER                  2U
+
+// Set to 1U when the second magnetometer is fitted on the sensor I2C bus (see sensor.c). It uses
+// the HMC5883L register map; its address must differ from the one of MagMet1.
+#define  APP_CFG_SEN_MAG2_EN                      0U
+#define  APP_CFG_SEN_MAG2_ADDR                    0x00U   // 7-bit address shifted by 1 (see seni2c.c)
+
+
+/*
+*********************************************************************************************************
+*                                              I2C
+*********************************************************************************************************
+*/
+// A failed transfer is retried RETRIES times, after BACKOFF_US then twice as long before each
+// following retry (see i2cbus.c). Keep the total wait short of the sensor release period.
+#define  APP_CFG_I2C_RETRIES                      2U
+#define  APP_CFG_I2C_BACKOFF_US                  50U
+
+
+/*
+*********************************************************************************************************
+*                                            STORAGE
+*********************************************************************************************************
+*/
+// Records are compressed into blocks of one flash page (see tlmcomp.c). The coded size of a block
+// is counted on 16 bits: the page must not exceed 8 KB.
+#define  APP_CFG_LOG_PAGE_SIZE                  512U
+
+// The sensor log is kept on a NAND1 simulated in RAM until the NAND driver is written (see
+// flash.c): SIM_BLOCKS erase blocks of PAGES_PER_BLOCK pages. Each log starts with its two
+// checkpoint banks. A checkpoint (state, time index) is written every SYNC_PAGES pages (see
+// logstore.c).
+#define  APP_CFG_LOG_PAGES_PER_BLOCK              4U
+#define  APP_CFG_LOG_SIM_BLOCKS                  20U
+#define  APP_CFG_LOG_SYNC_PAGES                   8U
+
+// Retention tiers of the sensor log (see retain.c): count, min, max and mean of the records over
+// windows of T1_PERIOD_S, then of T2_PERIOD_S, each tier in a log of Tx_BLOCKS blocks at the end of
+// NAND1 (the raw log has the other blocks). The memory management task summarizes one page when it
+// has waited IDLE_TICKS for a record.
+#define  APP_CFG_RET_TIERS                        2U
+#define  APP_CFG_RET_T1_PERIOD_S                  1U
+#define  APP_CFG_RET_T1_BLOCKS                    6U
+#define  APP_CFG_RET_T2_PERIOD_S                 60U
+#define  APP_CFG_RET_T2_BLOCKS                    4U
+#define  APP_CFG_RET_RAW_BLOCKS                 (APP_CFG_LOG_SIM_BLOCKS - APP_CFG_RET_T1_BLOCKS - APP_CFG_RET_T2_BLOCKS - \
+                                                 APP_CFG_HK_LOG_BLOCKS)
+#define  APP_CFG_RET_IDLE_TICKS                  20U
+
+// Housekeeping log, on the last HK_LOG_BLOCKS blocks of NAND1: delta records of the database fields
+// changed beyond their deadband (see app_database.c), with a full snapshot every HK_KEYFRAME HK
+// periods so that the ground can rebuild the values after pages lost.
+#define  APP_CFG_HK_LOG_BLOCKS                    4U
+#define  APP_CFG_HK_KEYFRAME                    600U
+
+// Running statistics of the database fields over a sliding window of STAT_WINDOW_S by default (see
+// app_stats.c, PARAM_STAT_WINDOW_S), stored in the HK log at the end of each window.
+#define  APP_CFG_STAT_WINDOW_S                   60U
+
+
+/*
+*********************************************************************************************************
+*                                               PL
+*********************************************************************************************************
+*/
+// Set to 1U to query the scenario status of the PL every PL period (see APP_PLDataHandler()), as
+// a split-phase request collected at the next period (see plqueue.c).
+#define  APP_CFG_PL_STATUS_EN                     1U
+
+
+/*
+*********************************************************************************************************
+*                                            DOWNLINK
+*********************************************************************************************************
+*/
+// Log pages are sent in segments of DATA_SIZE bytes (see downlink.c): DATA_SIZE must divide the
+// page size. A pass sends at most PASS_PACKETS packets.
+#define  APP_CFG_DL_DATA_SIZE                   128U
+#define  APP_CFG_DL_PASS_PACKETS                 64U
+
+
+/*
+*********************************************************************************************************
+*                                           PARAMETERS
+*********************************************************************************************************
+*/
+// The parameter store uses two erase blocks of the NOR (see param.c), simulated in RAM until the
+// NOR driver is written. The periods above are the defaults of the parameters.
+#define  APP_CFG_NOR_PAGE_SIZE                  128U
+#define  APP_CFG_NOR_PAGES_PER_BLOCK              8U
+#define  APP_CFG_NOR_SIM_BLOCKS                   2U
+
+
+/*
+*********************************************************************************************************
+*                                         VIRTUAL TIME
+*********************************************************************************************************
+*/
+// Set to 1U to run the application on virtual time (see app_vtime.c): the SysTick is not
+// started and the kernel clock jumps to the next scheduled wake-up whenever all tasks are
+// blocked. For simulation runs only, never for flight.
+#define  APP_CFG_VTIME_EN                         0U
+
+
+/*
+*********************************************************************************************************
+*                                         POWER MANAGEMENT
+*********************************************************************************************************
+*/
+// Set to 1U to stop the SysTick and sleep on the RTC when the next task timeout is at least
+// APP_CFG_TICKLESS_MIN_TICKS away (see app_power.c). Longer waits are split at MAX_TICKS.
+#define  APP_CFG_TICKLESS_EN                      1U
+#define  APP_CFG_TICKLESS_MIN_TICKS               3U
+#define  APP_CFG_TICKLESS_MAX_TICKS           60000U
+
+// The console USART does not run in EM2: EM2 is blocked from a console input or output until
+// the console has been quiet for APP_CFG_CONSOLE_IDLE_MS (see PWR_ConsoleActivity()).
+#define  APP_CFG_CONSOLE_IDLE_MS              10000U
          
                          
                                     
@@ -53,9 +53,42 @@ can be seen by typing 'help'.
 #define DEL     12
 #define DISP    13
 #define STKCMD  14
+#define SIM     15
+#define PWR     16
+#define TMON    17
+#define STK     18
+#define MSGQ    19
+#define BENCH   20
+#define GBIAS   21
+#define MCAL    22
+#define MTEST   23
+#define ADCS    24
+#define BTEST   25
+#define ATT     26
+#define ATEST   27
+#define SENS    28
+#define DTEST   29
+#define I2C     30
+#define ITEST   31
+#define TIME    32
+#define CTEST   33
+#define LOGSTAT 34
+#define LTEST   35
+#define DLPASS  36
+#define PTEST   37
+#define PARAM   38
+#define NTEST   39
+#define RTEST   40
+#define CHG     41
+#define HTEST   42
+#define STAT    43
+#define STEST   44
+#define DB      45
+#define PLQ     46
+#define QTEST   47
 
 // Total number of commands
-#define NB_COM  15
+#define NB_COM  48
 
 
 
@@ -71,7 +104,14 @@ uint8_t currentState = DEFAULT_STATE;
 
 const char* commandList[NB_COM] = { "err", "tmp", "help", "exec", "mcl",
                                     "sci", "rdy", "fwup", "fwld", "swup",
-                                    "add", "alt", "del", "disp", "stkcmd"};
+                                    "add", "alt", "del", "disp", "stkcmd",
+                                    "sim", "pwr", "tmon", "stk", "msgq",
+                                    "bench", "gbias", "mcal", "mtest", "adcs",
+                                    "btest", "att", "atest", "sens", "dtest",
+                                    "i2c", "itest", "time", "ctest", "log",
+                                    "ltest", "dl", "ptest", "param", "ntest",
+                                    "rtest", "chg", "htest", "stat", "stest",
+                                    "db", "plq", "qtest"};
 
 
 typedef struct stackCmd
@@ -96,6 +136,40 @@ uint8_t interpretCommand(char* buffer);
 void defaultState(char* buffer);
 void displayState(char* buffer);
 
+void printSimStat();
+void printPwrStat();
+void printTmonStat();
+void printStkStat();
+void printMsgqStat();
+void printBench();
+void printGyroBias();
+void printMagCal();
+void printMagCalTest();
+void printAdcsStat();
+void printBdotTest();
+void printAttStat();
+void printAttTest();
+void printSensorStat();
+void printDecimTest();
+void printI2cStat();
+void printI2cTest();
+void printTimeStat();
+void printCompTest();
+void printLogStat();
+void printLogTest();
+void printDownlink();
+void printDlTest();
+void printParamStat();
+void printParamTest();
+void printRetTest();
+void printChgStat();
+void printChgTest();
+void printRunStat();
+void printRunStatTest();
+void printDbLayout();
+void printPlQueue();
+void printPlQueueTest();
+
 /*                                       linked list function                                          */
 uint8_t stackCmdNew (char* buffer, uint8_t bufferLength);
 void stackCmdBrowse ();
@@ -115,23 +189,23 @@ void stackCmdBrowse ();
 /* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                   used.  The compiler should not generate any code for this statement.
 *
+*             :(2) No resource is held while waiting for a command: each command takes the ones it
+*                   uses (dataMutex, the flash mutexes), and the PL calls take the subsystem bus per
+*                   transfer (see plqueue.c).
+*
 ********************************************************************************************************/
 
 
 void APP_Command(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
-  INT8U err;
   int i;
   char buffer[10] = {0};
   //static uint8_t currentContext
   
   while(1){
     
-    OSMutexPend(sysI2CMutex, 0, &err);    // Wait for resources to be available
-    OSMutexPend(dataMutex, 0, &err);
-    
-    // Empty buffer
+    // Empty buffer (Note(2))
     for(i = 0; i < 10; i++)
       buffer[i] = 0;
     
@@ -143,6 +217,9 @@ void APP_Command(void *Ptr_Arg){
     
     if(buffer[0] != 0) {
       
+      // Keep the console out of EM2 while the command prints
+      PWR_ConsoleActivity();
+      
       // Save in command stack
       if(!(stackCmdNew(buffer, 10)))
           printf("Error buffering cmd %s\n", buffer);
@@ -167,9 +244,6 @@ void APP_Command(void *Ptr_Arg){
     // Do stuff
     // Check mailbox to see if PL data transfer is under way
     
-    OSMutexPost(dataMutex);
-    OSMutexPost(sysI2CMutex);             // Make the resources available to other tasks
-    
     
     
     OSTimeDlyHMSM(0, 0, 0, 20);
@@ -254,7 +328,7 @@ void defaultState(char* buffer) {
   uint16_t errorFlag = 0;
   uint8_t  report[MAX_REPORT_LENGTH];
   
-  uint8_t dummy_desc[13] = {1, 0, 1, 0, 1, 0, 0, 0, 10, 0, 10, 0, 0};
+  uint8_t  desc[PARAM_SCN_SIZE];
   
   switch( interpretCommand(buffer) ){
         
@@ -385,7 +459,8 @@ void defaultState(char* buffer) {
   //---------------
        
   case ADD:
-    j = PL_FC_ScenarioCreate(0, 1, 0, dummy_desc, &errorFlag);
+    memcpy(desc, PARAM_GetBytes(&params, PARAM_SCN_DESC), PARAM_SCN_SIZE);
+    j = PL_FC_ScenarioCreate(0, 1, 0, desc, &errorFlag);
   
     if(errorFlag)
       printf("Communication error: %d\n", errorFlag);
@@ -418,6 +493,204 @@ void defaultState(char* buffer) {
     break;
     
   //---------------
+    
+  case SIM:
+    printSimStat();
+    break;
+    
+  //---------------
+    
+  case PWR:
+    printPwrStat();
+    break;
+    
+  //---------------
+    
+  case TMON:
+    printTmonStat();
+    break;
+    
+  //---------------
+    
+  case STK:
+    printStkStat();
+    break;
+    
+  //---------------
+    
+  case MSGQ:
+    printMsgqStat();
+    break;
+    
+  //---------------
+    
+  case BENCH:
+    printBench();
+    break;
+    
+  //---------------
+    
+  case GBIAS:
+    printGyroBias();
+    break;
+    
+  //---------------
+    
+  case MCAL:
+    printMagCal();
+    break;
+    
+  //---------------
+    
+  case MTEST:
+    printMagCalTest();
+    break;
+    
+  //---------------
+    
+  case ADCS:
+    printAdcsStat();
+    break;
+    
+  //---------------
+    
+  case BTEST:
+    printBdotTest();
+    break;
+    
+  //---------------
+    
+  case ATT:
+    printAttStat();
+    break;
+    
+  //---------------
+    
+  case ATEST:
+    printAttTest();
+    break;
+    
+  //---------------
+    
+  case SENS:
+    printSensorStat();
+    break;
+    
+  //---------------
+    
+  case DTEST:
+    printDecimTest();
+    break;
+    
+  //---------------
+    
+  case I2C:
+    printI2cStat();
+    break;
+    
+  //---------------
+    
+  case ITEST:
+    printI2cTest();
+    break;
+    
+  //---------------
+    
+  case TIME:
+    printTimeStat();
+    break;
+    
+  //---------------
+    
+  case CTEST:
+    printCompTest();
+    break;
+    
+  //---------------
+    
+  case LOGSTAT:
+    printLogStat();
+    break;
+    
+  //---------------
+    
+  case LTEST:
+    printLogTest();
+    break;
+    
+  //---------------
+    
+  case DLPASS:
+    printDownlink();
+    break;
+    
+  //---------------
+    
+  case PTEST:
+    printDlTest();
+    break;
+    
+  //---------------
+    
+  case PARAM:
+    printParamStat();
+    break;
+    
+  //---------------
+    
+  case NTEST:
+    printParamTest();
+    break;
+    
+  //---------------
+    
+  case RTEST:
+    printRetTest();
+    break;
+    
+  //---------------
+    
+  case CHG:
+    printChgStat();
+    break;
+    
+  //---------------
+    
+  case HTEST:
+    printChgTest();
+    break;
+    
+  //---------------
+    
+  case STAT:
+    printRunStat();
+    break;
+    
+  //---------------
+    
+  case STEST:
+    printRunStatTest();
+    break;
+    
+  //---------------
+    
+  case DB:
+    printDbLayout();
+    break;
+    
+  //---------------
+    
+  case PLQ:
+    printPlQueue();
+    break;
+    
+  //---------------
+    
+  case QTEST:
+    printPlQueueTest();
+    break;
+    
+  //---------------
         
   default:
     printf("\nUnrecognized command !");
@@ -439,24 +712,1193 @@ void displayState(char* buffer){
 void printHelp() {
   printf("\n\nAvailable CDMS commands for PL :\n");
   printf("-------------------------\n");
+  printf("  adcs : ADCS mode, command and control loop timing\n");
   printf("  add  : create a new scenario\n");
   printf("  alt  : modify an existing scenario\n");
+  printf("  atest: attitude estimator self-test on simulated trajectories\n");
+  printf("  att  : attitude quaternion and estimator cost\n");
+  printf("  bench: fixed-point vs floating-point conversion benchmark\n");
+  printf("  btest: B-dot closed-loop detumbling self-test (~10 s)\n");
+  printf("  chg  : database change tracking (delta records per consumer) and HK log\n");
+  printf("  db   : database layout (RAM of the blocks, cost of a display snapshot)\n");
+  printf("  ctest: telemetry compression self-test (ratio, cost, decoding)\n");
   printf("  del  : delete an existing scenario\n");
   printf("  disp : display diagnostics (any key to cancel)\n");
+  printf("  dl   : downlink pass of the last minute of sensor telemetry and HK (packets per class)\n");
+  printf("  dtest: decimation filter self-test (noise reduction, cost)\n");
   printf("  err  : get error codes\n");
   printf("  exec : allow measurement execution\n");
   printf("  fwld : firmware load\n");
   printf("  fwup : firmware update\n");
+  printf("  gbias: gyro drift estimation status\n");
   printf("  help : get list of available commands\n");
+  printf("  htest: HK delta records self-test on two simulated orbits (size, deadband errors)\n");
+  printf("  i2c  : I2C bus and device error, retry and recovery counters\n");
+  printf("  itest: I2C fault injection self-test on the sensor bus (recovery time)\n");
+  printf("  log  : sensor log, time index, retention tiers and records of the last minute\n");
+  printf("  ltest: log store self-test (mount, power cuts, queries, search cost up to 4 GB)\n");
+  printf("  mcal : magnetometer calibration status\n");
   printf("  mcl  : get Measurement Control List\n");
+  printf("  msgq : record pool and message queue statistics\n");
+  printf("  mtest: magnetometer calibration self-test\n");
+  printf("  ntest: parameter store self-test on a simulated NOR (power cuts, load time)\n");
+  printf("  param: parameter values and NOR store state\n");
+  printf("  plq  : PL request queue (split-phase requests, polls, latency, bus time)\n");
+  printf("  ptest: downlink scheduler self-test (quotas, fairness, packet rate)\n");
+  printf("  pwr  : energy mode statistics\n");
+  printf("  qtest: PL request queue self-test on a simulated PL (response delays, bus time)\n");
   printf("  rdy  : get scenario status\n");
+  printf("  rtest: retention tiers self-test (summaries, reset, cost of a step)\n");
   printf("  sci  : get scientific data\n");
+  printf("  sens : sensor devices and data ready acquisition statistics\n");
+  printf("  sim  : virtual time statistics\n");
+  printf("  stat : running statistics of the database fields (window and since boot)\n");
+  printf("  stest: running statistics self-test (precision, window, cost per sample)\n");
+  printf("  stk  : stack usage history and recommended sizes\n");
   printf("  swup : software update\n");
+  printf("  time : time stamps, mission elapsed time and time base checks\n");
+  printf("  tmon : task timing statistics\n");
   printf("  tmp : get temperature\n");
 }
 
 
+/******************************************************************************/
+
+void printSimStat() {
+  
+#if (APP_CFG_VTIME_EN > 0)
+  VTIME_STATS stats;
+  uint64_t simMs;
+  uint64_t wallMs;
+  
+  VTIME_GetStats(&stats);
+  
+  simMs  = ((uint64_t) stats.simTicks * 1000) / OS_TICKS_PER_SEC;
+  wallMs = stats.wallCycles / (CMU_ClockFreqGet(cmuClock_CORE) / 1000);
+  
+  printf("\nSimulated time : %lu ms\n", (unsigned long) simMs);
+  printf("Wall-clock time: %lu ms\n", (unsigned long) wallMs);
+  printf("Time jumps     : %lu (longest: %lu ticks)\n",
+         (unsigned long) stats.jumps, (unsigned long) stats.maxJump);
+  
+  if(wallMs > 0)
+    printf("Speedup        : %lu.%02lux\n",
+           (unsigned long) (simMs / wallMs),
+           (unsigned long) ((simMs * 100 / wallMs) % 100));
+#else
+  printf("\nVirtual time is disabled (APP_CFG_VTIME_EN in app_cfg.h)\n");
+#endif
+}
+
+
+/******************************************************************************/
+
+void printPwrStat() {
+  
+#if (APP_CFG_VTIME_EN == 0)
+  PWR_STATS stats;
+  uint64_t em0;
+  
+  PWR_GetStats(&stats);
+  
+  if(stats.total == 0)
+    return;
+  
+  em0 = stats.total - stats.em1 - stats.em2;
+  
+  // RTC ticks are converted to ms, residency in per mille
+  printf("\nEnergy mode residency (%lu s):\n", (unsigned long) (stats.total / PWR_RTC_FREQ));
+  printf("EM0 (run)   : %10lu ms | %3lu.%lu %%\n",
+         (unsigned long) (em0 * 1000 / PWR_RTC_FREQ),
+         (unsigned long) (em0 * 1000 / stats.total) / 10,
+         (unsigned long) (em0 * 1000 / stats.total) % 10);
+  printf("EM1 (sleep) : %10lu ms | %3lu.%lu %%\n",
+         (unsigned long) (stats.em1 * 1000 / PWR_RTC_FREQ),
+         (unsigned long) (stats.em1 * 1000 / stats.total) / 10,
+         (unsigned long) (stats.em1 * 1000 / stats.total) % 10);
+  printf("EM2 (deep)  : %10lu ms | %3lu.%lu %%\n",
+         (unsigned long) (stats.em2 * 1000 / PWR_RTC_FREQ),
+         (unsigned long) (stats.em2 * 1000 / stats.total) / 10,
+         (unsigned long) (stats.em2 * 1000 / stats.total) % 10);
+  printf("EM2 entries : %lu, early wake-ups: %lu\n",
+         (unsigned long) stats.em2Entries, (unsigned long) stats.earlyWakes);
+#else
+  printf("\nEnergy modes are not used in virtual time\n");
+#endif
+}
+
+
+/******************************************************************************/
+
+void printTmonStat() {
+  
+  int i;
+  TMON_STATS stats;
+  
+  // IMPORTANT!: MUST BE IN THE SAME ORDER AS THE TASK IDs DEFINED IN APP_CFG.H
+  const char* nameTable[TASK_USER_NB] = { "Tsk Start", "Serial D.", "LED Disp.",
+                                          "Command  ", "Mem. Man.", "Sen. Data",
+                                          "HK Data  ", "PL Data  ", "Sen. Time",
+                                          "ADCS Ctl." };
+  
+  printf("\nTask timing (us, percentiles are upper bounds):\n");
+  printf("-------------------------------------------------------------------------------------------\n");
+  printf("Task name | Per. ms | Jobs   | Resp max | p50     | p95     | p99     | Jit. max | Exec max \n");
+  printf("-------------------------------------------------------------------------------------------\n");
+  
+  for(i = 0; i < TASK_USER_NB; i++) {
+    
+    if(TMON_GetContract(i)->deadlineMs == 0)
+      continue;
+    
+    TMON_GetStats(i, &stats);
+    
+    // Event-driven tasks have no period
+    if(TMON_GetContract(i)->periodMs == 0)
+      printf("%s |   event | ", nameTable[i]);
+    else
+      printf("%s | %7lu | ", nameTable[i], (unsigned long) TMON_GetContract(i)->periodMs);
+    
+    printf("%6lu | %8lu | %7lu | %7lu | %7lu | %8lu | %8lu \n",
+           (unsigned long) stats.jobs,
+           (unsigned long) stats.respMax,
+           (unsigned long) TMON_Percentile(&stats, 500),
+           (unsigned long) TMON_Percentile(&stats, 950),
+           (unsigned long) TMON_Percentile(&stats, 990),
+           (unsigned long) stats.jitterMax,
+           (unsigned long) stats.execMax);
+  }
+  
+  printf("-------------------------------------------------------------------------------------------\n");
+  printf("Task name | Deadline miss | Budget overrun | Skipped releases \n");
+  printf("-------------------------------------------------------------------------------------------\n");
+  
+  for(i = 0; i < TASK_USER_NB; i++) {
+    
+    if(TMON_GetContract(i)->deadlineMs == 0)
+      continue;
+    
+    TMON_GetStats(i, &stats);
+    
+    printf("%s | %13lu | %14lu | %16lu \n",
+           nameTable[i],
+           (unsigned long) stats.deadlineMiss,
+           (unsigned long) stats.budgetOverrun,
+           (unsigned long) stats.skipped);
+  }
+}
+
+
+/******************************************************************************/
+
+void printStkStat() {
+  
+  int i;
+  unsigned int j;
+  STKMON_TASK task;
+  uint32_t rec;
+  uint32_t totalRec = 0;
+  
+  // IMPORTANT!: MUST BE IN THE SAME ORDER AS THE TASK IDs DEFINED IN APP_CFG.H
+  const char* nameTable[TASK_USER_NB] = { "Tsk Start", "Serial D.", "LED Disp.",
+                                          "Command  ", "Mem. Man.", "Sen. Data",
+                                          "HK Data  ", "PL Data  ", "Sen. Time",
+                                          "ADCS Ctl." };
+  
+  printf("\nStack peak usage (words), sampled every %lu s, oldest first:\n",
+         (unsigned long) (STKMON_HIST_PERIOD / 10));
+  printf("----------------------------------------------------------\n");
+  printf("Task name | Size | Peak | History \n");
+  printf("----------------------------------------------------------\n");
+  
+  for(i = 0; i < TASK_USER_NB; i++) {
+    
+    STKMON_GetTask(i, &task);
+    
+    printf("%s | %4lu | %4lu |", nameTable[i],
+           (unsigned long) task.size, (unsigned long) (task.size - task.free));
+    for(j = 0; j < STKMON_HIST_LEN; j++)
+      printf(" %4u", (unsigned int) task.hist[j]);
+    printf("\n");
+  }
+  
+  printf("----------------------------------------------------------\n");
+  printf("Recommended sizes (peak + %lu%%, at least %lu words):\n",
+         (unsigned long) STKMON_MARGIN_PCT, (unsigned long) STKMON_MARGIN_MIN);
+  
+  for(i = 0; i < TASK_USER_NB; i++) {
+    
+    STKMON_GetTask(i, &task);
+    rec = STKMON_Recommended(&task);
+    totalRec += rec;
+    
+    if(rec == 0)
+      printf("  %-30s (not checked yet)\n", STKMON_CfgName(i));
+    else
+      printf("  #define %-30s %4luU\n", STKMON_CfgName(i), (unsigned long) rec);
+  }
+  
+  printf("Total: %lu words (currently %lu)\n", (unsigned long) totalRec, (unsigned long) APP_CFG_TOTAL_STK_SIZE);
+}
+
+
+/******************************************************************************/
+
+void printMsgqStat() {
+  
+  MSGQ_POOL pool;
+  MSGQ_QUEUE queue;
+  INT32U nbFree;
+  INT16U depth;
+  
+  MSGQ_GetPoolStats(&recordPool, &pool, &nbFree);
+  MSGQ_GetQueueStats(&memMngmtQ, &queue, &depth);
+  
+  printf("\nRecord pool (%lu x %lu bytes):\n", (unsigned long) pool.nbBlks, (unsigned long) sizeof(MSGQ_RECORD));
+  printf("  Free       : %lu (lowest: %lu)\n", (unsigned long) nbFree, (unsigned long) pool.minFree);
+  printf("  Exhausted  : %lu\n", (unsigned long) pool.exhausted);
+  
+  printf("Memory management queue (%lu entries):\n", (unsigned long) queue.size);
+  printf("  Depth      : %lu (highest: %lu)\n", (unsigned long) depth, (unsigned long) queue.hwm);
+  printf("  Posted     : %lu\n", (unsigned long) queue.posted);
+  printf("  Received   : %lu\n", (unsigned long) queue.received);
+  printf("  Full       : %lu\n", (unsigned long) queue.full);
+}
+
+
+/******************************************************************************/
+
+void printBench() {
+  
+  int i;
+  BENCH_CONV res;
+  
+  printf("\nSensor conversions, cycles per sample and largest difference (Q16.16 LSB = 1/65536):\n");
+  printf("--------------------------------------------------------\n");
+  printf("Conv. | Samples | Float | Fixed | Max diff | at raw \n");
+  printf("--------------------------------------------------------\n");
+  
+  for(i = 0; i < BENCH_CONV_NB; i++) {
+    
+    BENCH_Conversion(i, &res);
+    
+    printf("%s  | %7lu | %5lu | %5lu | %8lu | %6ld \n",
+           BENCH_ConversionName(i),
+           (unsigned long) res.samples,
+           (unsigned long) res.floatCycles,
+           (unsigned long) res.fixedCycles,
+           (unsigned long) res.maxErr,
+           (long) res.maxErrRaw);
+  }
+}
+
+
+/******************************************************************************/
+
+void printGyroBias() {
+  
+  int i;
+  GYROBIAS_STATUS status;
+  const char axis[3] = { 'X', 'Y', 'Z' };
+  
+  GYROBIAS_GetStatus(&status);
+  
+  printf("\nGyro drift estimation: %s, %s, %lu rest samples, mean temp. %d (10*celsius)\n",
+         status.atRest    ? "at rest"   : "moving",
+         status.converged ? "converged" : "not converged",
+         (unsigned long) status.restSamples,
+         (int) (UTI_Q16ToFloat(status.tempMean)*10));
+  
+  for(i = 0; i < 3; i++)
+    printf("  %c: drift %6ld mdeg/s, temp. coeff. %6ld mdeg/s/C\n", axis[i],
+           (long) (UTI_Q16ToFloat(status.bias[i])*1000),
+           (long) (UTI_Q16ToFloat(status.slope[i])*1000));
+}
+
+
+/******************************************************************************/
+
+void printMagCal() {
+  
+  int i;
+  MAGCAL_SOLUTION sol;
+  const char* errName[] = { "ok", "not enough samples", "singular", "bad shape", "bad fit" };
+  
+  MAGCAL_GetSolution(&mag1Cal, &sol);
+  
+  printf("\nMag. calibration: %s, %lu samples, %lu solutions, %lu rejected, last: %s\n",
+         sol.valid ? "applied" : "none",
+         (unsigned long) sol.samples,
+         (unsigned long) sol.solves,
+         (unsigned long) sol.rejected,
+         errName[sol.lastErr]);
+  
+  if(!sol.valid)
+    return;
+  
+  printf("  radius %ld mG, residual %ld/10000\n",
+         (long) UTI_Q16ToInt(sol.radius),
+         (long) (UTI_Q16ToFloat(sol.residual)*10000));
+  
+  // Soft-iron matrix in 1/1000
+  for(i = 0; i < 3; i++)
+    printf("  offset %5ld mG   W %6ld %6ld %6ld\n",
+           (long) UTI_Q16ToInt(sol.offset[i]),
+           (long) (UTI_Q16ToFloat(sol.W[i][0])*1000),
+           (long) (UTI_Q16ToFloat(sol.W[i][1])*1000),
+           (long) (UTI_Q16ToFloat(sol.W[i][2])*1000));
+}
+
+
+/******************************************************************************/
+
+void printMagCalTest() {
+  
+  MAGCAL_TEST res;
+  
+  MAGCAL_SelfTest(&res);
+  
+  printf("\nMag. calibration self-test: %s\n", res.pass ? "PASS" : "FAIL");
+  printf("  solve result %u, offset error %ld/1000 mG\n",
+         (unsigned) res.solveErr,
+         (long) (UTI_Q16ToFloat(res.offsetErr)*1000));
+  printf("  magnitude spread %lu/10000 (uncalibrated %lu/10000)\n",
+         (unsigned long) res.spread,
+         (unsigned long) res.rawSpread);
+}
+
+
+/******************************************************************************/
+
+void printAdcsStat() {
+  
+  int i;
+  ADCS_STATS stats;
+  ADCS_COMMAND cmd;
+  const char axis[3] = { 'X', 'Y', 'Z' };
+  const char* modeName[] = { "off", "B-dot", "full" };
+  
+  ADCS_GetStats(&stats);
+  ADCS_GetCommand(&cmd);
+  
+  printf("\nADCS mode: %s, %lu mode changes\n", cmd.mode <= ADCS_FULL ? modeName[cmd.mode] : "?",
+         (unsigned long) stats.modeChanges);
+  
+  for(i = 0; i < 3; i++)
+    printf("  %c: dB/dt %7ld mG/s, dipole %6ld mA.m2\n", axis[i],
+           (long) UTI_Q16ToInt(cmd.dBdt[i]),
+           (long) (UTI_Q16ToFloat(cmd.dipole[i])*1000));
+  
+  printf("Control loop: %lu loops, %lu commands (%lu saturated), %lu timeouts\n",
+         (unsigned long) stats.loops,
+         (unsigned long) stats.commands,
+         (unsigned long) stats.saturated,
+         (unsigned long) stats.timeouts);
+  printf("  latency (us): last %lu, mean %lu, max %lu\n",
+         (unsigned long) stats.latencyLast,
+         (unsigned long) stats.latencyMean,
+         (unsigned long) stats.latencyMax);
+  printf("  period (us):  nominal %lu, min %lu, max %lu, jitter max %lu\n",
+         (unsigned long) ADCS_PERIOD_US,
+         (unsigned long) stats.periodMin,
+         (unsigned long) stats.periodMax,
+         (unsigned long) stats.jitterMax);
+}
+
+
+/******************************************************************************/
+
+void printBdotTest() {
+  
+  BDOT_TEST res;
+  
+  printf("\nRunning B-dot closed-loop simulation (%lu s)...\n", (unsigned long) BDOT_TEST_DURATION_S);
+  
+  BDOT_SelfTest(&res);
+  
+  printf("B-dot self-test: %s\n", res.pass ? "PASS" : "FAIL");
+  printf("  rate %ld -> %ld mdeg/s, detumbled after %lu s, %lu%% of commands saturated\n",
+         (long) (UTI_Q16ToFloat(res.rateStart)*1000),
+         (long) (UTI_Q16ToFloat(res.rateEnd)*1000),
+         (unsigned long) res.detumbleS,
+         (unsigned long) res.saturatedPct);
+}
+
+
+/******************************************************************************/
+
+void printAttStat() {
+  
+  ATT_STATUS status;
+  
+  ATT_GetStatus(&attEst, &status);
+  
+  printf("\nAttitude (x10000): q0 %6ld, q1 %6ld, q2 %6ld, q3 %6ld\n",
+         (long) (UTI_Q16ToFloat(status.q[0])*10000),
+         (long) (UTI_Q16ToFloat(status.q[1])*10000),
+         (long) (UTI_Q16ToFloat(status.q[2])*10000),
+         (long) (UTI_Q16ToFloat(status.q[3])*10000));
+  printf("  %lu updates, %lu field corrections\n",
+         (unsigned long) status.updates,
+         (unsigned long) status.corrections);
+  printf("  cycles: last %lu, max %lu, budget %lu, %lu overruns\n",
+         (unsigned long) status.cycLast,
+         (unsigned long) status.cycMax,
+         (unsigned long) ATT_BUDGET_CYCLES,
+         (unsigned long) status.overruns);
+}
+
+
+/******************************************************************************/
+
+void printAttTest() {
+  
+  ATT_TEST res;
+  
+  ATT_SelfTest(&res);
+  
+  printf("\nAttitude self-test: %s\n", res.pass ? "PASS" : "FAIL");
+  printf("  propagation error %ld mdeg\n",
+         (long) (UTI_Q16ToFloat(res.propErr)*1000));
+  printf("  field direction error %ld mdeg (without correction %ld mdeg)\n",
+         (long) (UTI_Q16ToFloat(res.fieldErr)*1000),
+         (long) (UTI_Q16ToFloat(res.fieldErrNoMag)*1000));
+}
+
+
+/******************************************************************************/
+
+void printSensorStat() {
+  
+  int i;
+  const SENSOR_DESC *desc;
+  const SENSOR_DATA *data;
+  SENSOR_ACQ acq;
+  
+  printf("\nDevice | Addr | Reads    | Errors   | Ratio | Outputs  | Cyc/out | Last output (ms)\n");
+  for(i = 0; i < SENSOR_NB; i++){
+    desc = SENSOR_GetDesc(i);
+    data = SENSOR_GetData(i);
+    printf("%-6s | 0x%02x | %8lu | %8lu | %2ux%-2u | %8lu | %7lu | %lu\n",
+           desc->name,
+           (unsigned) (desc->addr >> 1),
+           (unsigned long) data->reads,
+           (unsigned long) data->errors,
+           (unsigned) desc->divider,
+           (unsigned) desc->decim,
+           (unsigned long) data->outputs,
+           (unsigned long) data->cyclesPerOutput,
+           (unsigned long) (data->timeUs / 1000));
+  }
+  
+  SENSOR_GetAcq(&acq);
+  
+  printf("Data ready: %lu interrupts, %lu samples, %lu missed, %lu stale, %lu timeouts\n",
+         (unsigned long) acq.drdy,
+         (unsigned long) acq.samples,
+         (unsigned long) acq.missed,
+         (unsigned long) acq.stale,
+         (unsigned long) acq.timeouts);
+  printf("  latency (us): last %lu, max %lu\n",
+         (unsigned long) acq.latencyLast,
+         (unsigned long) acq.latencyMax);
+  printf("  interval (us): nominal %lu, min %lu, max %lu\n",
+         (unsigned long) SENSOR_RELEASE_US,
+         (unsigned long) acq.intervalMin,
+         (unsigned long) acq.intervalMax);
+}
+
+
+/******************************************************************************/
+
+void printDecimTest() {
+  
+  DECIM_TEST res;
+  
+  DECIM_SelfTest(&res);
+  
+  printf("\nDecimation self-test (CIC order %u, ratio %u): %s\n",
+         (unsigned) DECIM_ORDER,
+         (unsigned) DECIM_TEST_RATIO,
+         res.pass ? "PASS" : "FAIL");
+  printf("  noise %ld -> %ld (1/1000), reduction %ld/100 (expected %ld/100)\n",
+         (long) (UTI_Q16ToFloat(res.noiseIn)*1000),
+         (long) (UTI_Q16ToFloat(res.noiseOut)*1000),
+         (long) (UTI_Q16ToFloat(res.noiseRatio)*100),
+         (long) (UTI_Q16ToFloat(res.noiseRatioTheory)*100));
+  printf("  mean error %ld (1/1000000), %lu cycles per output\n",
+         (long) (UTI_Q16ToFloat(res.meanErr)*1000000),
+         (unsigned long) res.cyclesPerOutput);
+}
+
+
+/******************************************************************************/
+
+void printI2cStat() {
+  
+  int b, i;
+  I2CBUS *bus[2];
+  I2CBUS_STATS stats;
+  
+  bus[0] = SENI2C_GetBus();
+  bus[1] = SATI2C_GetBus();
+  
+  for(b = 0; b < 2; b++){
+    I2CBUS_GetStats(bus[b], &stats);
+    
+    printf("\n%s bus: %lu transfers, %lu errors, %lu retries\n",
+           bus[b]->name,
+           (unsigned long) stats.transfers,
+           (unsigned long) stats.errors,
+           (unsigned long) stats.retries);
+    printf("  failed attempts: %lu nack, %lu bus error, %lu arbitration lost, %lu timeout\n",
+           (unsigned long) stats.nack,
+           (unsigned long) stats.busErr,
+           (unsigned long) stats.arbLost,
+           (unsigned long) stats.timeout);
+    printf("  recoveries: %lu (%lu failed), last %lu us, max %lu us\n",
+           (unsigned long) stats.recoveries,
+           (unsigned long) stats.recoveryFail,
+           (unsigned long) stats.recoveryUsLast,
+           (unsigned long) stats.recoveryUsMax);
+    
+    printf("  Addr | Transfers | Errors   | Retries\n");
+    for(i = 0; i < I2CBUS_MAX_DEV && stats.dev[i].addr != 0; i++)
+      printf("  0x%02x | %9lu | %8lu | %lu\n",
+             (unsigned) (stats.dev[i].addr >> 1),
+             (unsigned long) stats.dev[i].transfers,
+             (unsigned long) stats.dev[i].errors,
+             (unsigned long) stats.dev[i].retries);
+  }
+}
+
+
+/******************************************************************************/
+
+void printI2cTest() {
+  
+  int i;
+  I2CBUS_TEST res[I2CBUS_TEST_NB];
+  
+  I2CBUS_SelfTest(SENI2C_GetBus(), ITG3200_ADDR, ITG3200_WHO_AM_I, res);
+  
+  printf("\nI2C fault injection on the sensor bus (gyro, %u retries, backoff %u us)\n",
+         (unsigned) APP_CFG_I2C_RETRIES,
+         (unsigned) APP_CFG_I2C_BACKOFF_US);
+  printf("Fault    | Status | Retries | Recoveries | Time (us)\n");
+  for(i = 0; i < I2CBUS_TEST_NB; i++)
+    printf("%-8s | %6d | %7lu | %10lu | %9lu  %s\n",
+           res[i].name,
+           (int) res[i].ret,
+           (unsigned long) res[i].retries,
+           (unsigned long) res[i].recoveries,
+           (unsigned long) res[i].timeUs,
+           res[i].pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printTimeStat() {
+  
+  TIME_STATS stats;
+  uint64_t now = TIME_NowUs();
+  uint64_t met = TIME_ToMet(now);
+  
+  TIME_GetStats(&stats);
+  
+  printf("\nTime stamp: %lu.%06lu s, MET: %lu.%06lu s, kernel: %lu ticks\n",
+         (unsigned long) (now / 1000000),
+         (unsigned long) (now % 1000000),
+         (unsigned long) (met / 1000000),
+         (unsigned long) (met % 1000000),
+         (unsigned long) OSTimeGet());
+  printf("Read cost: %lu cycles\n", (unsigned long) TIME_ReadCycles());
+  printf("Checks: %lu, backwards: %lu\n",
+         (unsigned long) stats.checks,
+         (unsigned long) stats.backwards);
+  printf("  offset to kernel time (us): last %ld, min %ld, max %ld\n",
+         (long) stats.tickOffset,
+         (long) stats.tickOffsetMin,
+         (long) stats.tickOffsetMax);
+}
+
+
+/******************************************************************************/
+
+void printCompTest() {
+  
+  TLMC_TEST res;
+  
+  TLMC_SelfTest(&res);
+  
+  printf("\nTelemetry compression: %lu records in %lu blocks of %u bytes\n",
+         (unsigned long) res.records,
+         (unsigned long) res.blocks,
+         (unsigned) TLMC_BLOCK_SIZE);
+  printf("Size: %lu -> %lu bytes, ratio %lu.%02lu\n",
+         (unsigned long) res.bytesIn,
+         (unsigned long) res.bytesOut,
+         (unsigned long) (res.ratio100 / 100),
+         (unsigned long) (res.ratio100 % 100));
+  printf("Cost: %lu cycles/byte coding, %lu cycles/byte decoding\n",
+         (unsigned long) res.cyclesPerByte,
+         (unsigned long) res.decodeCyclesPerByte);
+  printf("Mismatches: %lu  %s\n",
+         (unsigned long) res.mismatches,
+         res.pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printLogStat() {
+  
+  INT8U block[TLMC_BLOCK_SIZE];
+  TLMC_DEC dec;
+  LOG_QUERY q;
+  LOG_SUMMARY sum;
+  LOG_STATS stats;
+  FLASH_STATS flash;
+  BOOLEAN more;
+  uint64_t now = TIME_NowUs();
+  uint64_t from = (now > 60000000) ? now - 60000000 : 0;
+  uint64_t time;
+  int32_t val[MSGQ_SEN_NB_VAL];
+  INT32U page;
+  INT32U pages = 0;
+  INT32U records = 0;
+  INT32U tier[7];
+  INT8U i;
+  
+  // Records of the last minute, the device is held during each access only
+  if(!FLASH_Lock(NAND1Mutex)){
+    printf("\nNAND1 not available\n");
+    return;
+  }
+  LOG_QueryStart(&senLog, &q, from, now);
+  OSMutexPost(NAND1Mutex);
+  
+  do {
+    if(!FLASH_Lock(NAND1Mutex))
+      break;
+    more = (LOG_QueryNext(&q, &page, &time) &&
+            LOG_Read(&senLog, page, 0, block, TLMC_BLOCK_SIZE) == LOG_OK);
+    OSMutexPost(NAND1Mutex);
+    
+    if(more){
+      pages++;
+      if(TLMC_DecodeInit(&dec, block))
+        while(TLMC_DecodeNext(&dec, &time, val))
+          if(time >= from && time <= now)
+            records++;
+    }
+  } while(more);
+  
+  if(!FLASH_Lock(NAND1Mutex))
+    return;
+  sum   = senLog.sum;
+  stats = senLog.stats;
+  flash = senLog.dev->stats;
+  OSMutexPost(NAND1Mutex);
+  
+  printf("\nSensor log on %s: pages %lu to %lu (%lu of %lu stored), last at %lu ms\n",
+         senLog.dev->name,
+         (unsigned long) sum.tail,
+         (unsigned long) sum.head,
+         (unsigned long) (sum.head - sum.tail),
+         (unsigned long) senLog.dataPages,
+         (unsigned long) (sum.lastTime / 1000));
+  printf("Index: %lu entries, stride %lu pages; checkpoints: %lu (%lu slots)\n",
+         (unsigned long) sum.nbIdx,
+         (unsigned long) sum.stride,
+         (unsigned long) stats.syncs,
+         (unsigned long) (LOG_BANKS * senLog.ckptSlots));
+  printf("Mount: %s, %lu checkpoint pages read (%lu torn), %lu spare areas read, %lu cycles\n",
+         stats.mountSummary ? "checkpoint" : "scan",
+         (unsigned long) stats.mountReads,
+         (unsigned long) stats.mountRejects,
+         (unsigned long) stats.mountPages,
+         (unsigned long) stats.mountCycles);
+  printf("Wear: %lu data block erases (%lu per block), %lu checkpoint bank erases; pages lost: %lu\n",
+         (unsigned long) sum.erases,
+         (unsigned long) (sum.erases / (senLog.nbBlocks - senLog.sumBlocks)),
+         (unsigned long) sum.ckptErases,
+         (unsigned long) stats.errors);
+  printf("Flash: %lu reads, %lu spare reads, %lu programs, %lu erases, %lu errors\n",
+         (unsigned long) flash.reads,
+         (unsigned long) flash.spareReads,
+         (unsigned long) flash.progs,
+         (unsigned long) flash.erases,
+         (unsigned long) flash.errors);
+  printf("Last minute: %lu records in %lu pages (search: %lu spare reads, %lu cycles)\n",
+         (unsigned long) records,
+         (unsigned long) pages,
+         (unsigned long) stats.queryReads,
+         (unsigned long) stats.queryCycles);
+  
+  for(i = 0; i < APP_CFG_RET_TIERS; i++){
+    if(!FLASH_Lock(NAND1Mutex))
+      return;
+    tier[0] = senTierLog[i].sum.tail;
+    tier[1] = senTierLog[i].sum.head;
+    tier[2] = senTier[i].windows;
+    tier[3] = senTier[i].src->sum.head - senTier[i].next;
+    tier[4] = senTier[i].lost;
+    tier[5] = senTier[i].flushes;
+    tier[6] = senTier[i].cyclesMax;
+    OSMutexPost(NAND1Mutex);
+    
+    printf("Tier %u, %lu s windows: pages %lu to %lu, %lu windows, %lu pages to do, %lu lost, "
+           "%lu stored early, step %lu cycles max\n",
+           (unsigned) (i + 1),
+           (unsigned long) (senTier[i].period / 1000000),
+           (unsigned long) tier[0],
+           (unsigned long) tier[1],
+           (unsigned long) tier[2],
+           (unsigned long) tier[3],
+           (unsigned long) tier[4],
+           (unsigned long) tier[5],
+           (unsigned long) tier[6]);
+  }
+}
+
+
+/******************************************************************************/
+
+void printLogTest() {
+  
+  int i;
+  LOG_TEST res;
+  
+  LOG_SelfTest(&res);
+  
+  printf("\nLog store on a simulated device: %lu pages appended (%lu wraps), %lu checkpoints\n",
+         (unsigned long) res.pages,
+         (unsigned long) res.wraps,
+         (unsigned long) res.syncs);
+  printf("Mount from checkpoint: %s, without checkpoint: %s\n",
+         res.mountSummary ? "OK" : "FAIL",
+         res.mountScan ? "OK" : "FAIL");
+  printf("Queries: %lu, errors: %lu\n",
+         (unsigned long) res.queries,
+         (unsigned long) res.errors);
+  printf("Power cuts: %lu, errors: %lu; mount reads max %lu (bound %lu)\n",
+         (unsigned long) res.cuts,
+         (unsigned long) res.cutErrors,
+         (unsigned long) res.mountReadsMax,
+         (unsigned long) res.mountBound);
+  printf("Search on generated images (%u-byte pages):\n", (unsigned) LOG_PAGE_MAX);
+  printf("  Pages    | Size (MB) | Stride | Reads avg | Reads max | Cycles | Errors\n");
+  for(i = 0; i < LOG_TEST_SIZES; i++)
+    printf("  %8lu | %9lu | %6lu | %9lu | %9lu | %6lu | %lu\n",
+           (unsigned long) res.size[i].pages,
+           (unsigned long) ((uint64_t) res.size[i].pages * LOG_PAGE_MAX >> 20),
+           (unsigned long) res.size[i].stride,
+           (unsigned long) res.size[i].readsAvg,
+           (unsigned long) res.size[i].readsMax,
+           (unsigned long) res.size[i].cyclesAvg,
+           (unsigned long) res.size[i].errors);
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printDownlink() {
+  
+  INT8U cls;
+  INT8U pkt[DL_PKT_SIZE];
+  DL dl;
+  uint64_t now = TIME_NowUs();
+  
+  // Only the sensor telemetry and the HK are stored for now. There is no radio yet: the packets
+  // are dropped
+  DL_Init(&dl);
+  DL_Attach(&dl, DL_TLM, &senLog, NAND1Mutex);
+  DL_Attach(&dl, DL_HK, &hkLog, NAND1Mutex);
+  DL_Request(&dl, DL_TLM, (now > 60000000) ? now - 60000000 : 0, now);
+  DL_Request(&dl, DL_HK, (now > 60000000) ? now - 60000000 : 0, now);
+  DL_StartPass(&dl, APP_CFG_DL_PASS_PACKETS);
+  while(DL_NextPacket(&dl, pkt) > 0);
+  
+  printf("\nDownlink pass: %lu of %lu packets (%u bytes, %u of data), %lu cycles per packet\n",
+         (unsigned long) dl.sent,
+         (unsigned long) dl.budget,
+         (unsigned) DL_PKT_SIZE,
+         (unsigned) DL_DATA_SIZE,
+         (unsigned long) ((dl.sent > 0) ? dl.cycles / dl.sent : 0));
+  printf("  Class | Quota | Packets | Pages | Lost\n");
+  for(cls = 0; cls < DL_NB_CLASS; cls++)
+    printf("  %-5s | %4u%% | %7lu | %5lu | %lu%s\n",
+           DL_ClassName(cls),
+           (unsigned) DL_ClassQuota(cls),
+           (unsigned long) dl.src[cls].packets,
+           (unsigned long) dl.src[cls].pages,
+           (unsigned long) dl.src[cls].lost,
+           (dl.src[cls].log == NULL) ? " (no log)" : "");
+}
+
+
+/******************************************************************************/
+
+void printDlTest() {
+  
+  INT8U cls;
+  DL_TEST res;
+  
+  DL_SelfTest(&res);
+  
+  printf("\nDownlink scheduler on generated logs: passes of %u packets\n", (unsigned) DL_TEST_BUDGET);
+  printf("  Class | Quota | All backlogged | %u event pages\n", (unsigned) DL_TEST_SHORT);
+  for(cls = 0; cls < DL_NB_CLASS; cls++)
+    printf("  %-5s | %4u%% | %14lu | %lu\n",
+           DL_ClassName(cls),
+           (unsigned) DL_ClassQuota(cls),
+           (unsigned long) res.full[cls],
+           (unsigned long) res.shortEvt[cls]);
+  printf("Fairness (Jain, all backlogged): %lu.%02lu\n",
+         (unsigned long) (res.fairness / 100),
+         (unsigned long) (res.fairness % 100));
+  printf("Packets: %lu, %lu cycles per packet (%lu packets/s), errors: %lu\n",
+         (unsigned long) res.packets,
+         (unsigned long) res.cyclesPerPacket,
+         (unsigned long) ((res.cyclesPerPacket > 0) ? CMU_ClockFreqGet(cmuClock_CORE) / res.cyclesPerPacket : 0),
+         (unsigned long) res.errors);
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printParamStat() {
+  
+  INT8U id;
+  INT8U i;
+  const PARAM_DESC *desc;
+  const INT8U *bytes;
+  PARAM_STORE ps;
+  
+  if(!FLASH_Lock(NORMutex)){
+    printf("\nNOR not available\n");
+    return;
+  }
+  ps = params;
+  OSMutexPost(NORMutex);
+  
+  printf("\nParameter store on %s: record %lu, bank %u page %u, %s\n",
+         ps.dev->name,
+         (unsigned long) ps.seq,
+         (unsigned) ps.bank,
+         (unsigned) ps.next,
+         ps.dirty ? "changes not committed" : "committed");
+  printf("Boot load: %s, %lu pages read, %lu rejected, %lu cycles (%lu us)\n",
+         ps.stats.loaded ? "record" : "defaults",
+         (unsigned long) ps.stats.loadReads,
+         (unsigned long) ps.stats.loadRejects,
+         (unsigned long) ps.stats.loadCycles,
+         (unsigned long) (ps.stats.loadCycles / (CMU_ClockFreqGet(cmuClock_CORE) / 1000000)));
+  printf("Commits: %lu, errors: %lu, bank switches: %lu\n",
+         (unsigned long) ps.stats.commits,
+         (unsigned long) ps.stats.errors,
+         (unsigned long) ps.stats.bankSwitches);
+  printf("  Name    | Value      | Default    | Range\n");
+  for(id = 0; id < PARAM_NB; id++){
+    desc = PARAM_GetDesc(id);
+    if(desc->size == 4)
+      printf("  %-7s | %10lu | %10lu | %lu..%lu\n",
+             desc->name,
+             (unsigned long) PARAM_Get(&ps, id),
+             (unsigned long) desc->def,
+             (unsigned long) desc->min,
+             (unsigned long) desc->max);
+    else {
+      bytes = PARAM_GetBytes(&ps, id);
+      printf("  %-7s |", desc->name);
+      for(i = 0; i < desc->size; i++)
+        printf(" %02X", (unsigned) bytes[i]);
+      printf("\n");
+    }
+  }
+}
+
+
+/******************************************************************************/
+
+void printParamTest() {
+  
+  PARAM_TEST res;
+  
+  PARAM_SelfTest(&res);
+  
+  printf("\nParameter store on a simulated NOR (%u-byte pages, %u per bank)\n",
+         (unsigned) PARAM_TEST_PAGE_SIZE,
+         (unsigned) PARAM_TEST_PPB);
+  printf("Erased device: %s, %lu commits (%lu bank switches), reload: %s\n",
+         res.empty ? "defaults" : "FAIL",
+         (unsigned long) res.commits,
+         (unsigned long) res.bankSwitches,
+         res.reload ? "OK" : "FAIL");
+  printf("Power cuts: %lu (%lu torn records rejected), wrong values after reboot: %lu\n",
+         (unsigned long) res.cuts,
+         (unsigned long) res.torn,
+         (unsigned long) res.errors);
+  printf("Load: %lu cycles max (%lu us)\n",
+         (unsigned long) res.loadCycles,
+         (unsigned long) (res.loadCycles / (CMU_ClockFreqGet(cmuClock_CORE) / 1000000)));
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printRetTest() {
+  
+  RET_TEST res;
+  
+  RET_SelfTest(&res);
+  
+  printf("\nRetention tiers of a generated log: %lu records (%lu ms apart) in %lu pages\n",
+         (unsigned long) res.records,
+         (unsigned long) (RET_TEST_PERIOD_US / 1000),
+         (unsigned long) res.rawPages);
+  printf("Tier 1 (%lu ms windows): %lu windows, %lu checked\n",
+         (unsigned long) (RET_TEST_T1_US / 1000),
+         (unsigned long) res.windows[0],
+         (unsigned long) res.checked[0]);
+  printf("Tier 2 (%lu ms windows): %lu windows, %lu checked\n",
+         (unsigned long) (RET_TEST_T2_US / 1000),
+         (unsigned long) res.windows[1],
+         (unsigned long) res.checked[1]);
+  printf("Wrong, missing or repeated windows: %lu, source pages lost: %lu\n",
+         (unsigned long) res.errors,
+         (unsigned long) res.lost);
+  printf("Tier pages: %lu, step: %lu cycles max (%lu us)\n",
+         (unsigned long) res.tierPages,
+         (unsigned long) res.cyclesMax,
+         (unsigned long) (res.cyclesMax / (CMU_ClockFreqGet(cmuClock_CORE) / 1000000)));
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printChgStat() {
+  
+  INT8U err;
+  INT8U c;
+  DB_CHANGE chg;
+  LOG_SUMMARY sum;
+  const char* consName[DB_NB_CONS] = { "HK log", "Telemetry" };
+  
+  OSMutexPend(dataMutex, 0, &err);
+  DB_GetChange(APP_AppDataPtr(), &chg);
+  OSMutexPost(dataMutex);
+  
+  if(!FLASH_Lock(NAND1Mutex)){
+    printf("\nNAND1 not available\n");
+    return;
+  }
+  sum = hkLog.sum;
+  OSMutexPost(NAND1Mutex);
+  
+  printf("\nChange tracking: %lu values written, %lu beyond their deadband\n",
+         (unsigned long) chg.sets,
+         (unsigned long) chg.marks);
+  printf("  Consumer  | Records | Bytes    | Full snapshots | Saved | Pending\n");
+  for(c = 0; c < DB_NB_CONS; c++)
+    printf("  %-9s | %7lu | %8lu | %14lu | %4lu%% | 0x%06lx\n",
+           consName[c],
+           (unsigned long) chg.records[c],
+           (unsigned long) chg.bytes[c],
+           (unsigned long) chg.fullBytes[c],
+           (unsigned long) ((chg.fullBytes[c] > 0) ? 100 - (uint64_t) chg.bytes[c] * 100 / chg.fullBytes[c] : 0),
+           (unsigned long) chg.dirty[c]);
+  printf("HK log on %s: pages %lu to %lu (%lu of %lu stored), last at %lu ms\n",
+         hkLog.dev->name,
+         (unsigned long) sum.tail,
+         (unsigned long) sum.head,
+         (unsigned long) (sum.head - sum.tail),
+         (unsigned long) hkLog.dataPages,
+         (unsigned long) (sum.lastTime / 1000));
+}
+
+
+/******************************************************************************/
+
+void printChgTest() {
+  
+  DB_TEST res;
+  
+  DB_SelfTest(&res);
+  
+  printf("\nHK delta records of %lu simulated periods (%lu orbits): %lu records\n",
+         (unsigned long) res.samples,
+         (unsigned long) (res.samples / DB_TEST_ORBIT),
+         (unsigned long) res.records);
+  printf("  Full snapshots  : %lu bytes\n", (unsigned long) res.fullBytes);
+  printf("  Exact changes   : %lu bytes\n", (unsigned long) res.exactBytes);
+  printf("  Deadbands       : %lu bytes (%lu%% of full, %lu%% of exact)\n",
+         (unsigned long) res.deltaBytes,
+         (unsigned long) ((uint64_t) res.deltaBytes * 100 / res.fullBytes),
+         (unsigned long) ((uint64_t) res.deltaBytes * 100 / res.exactBytes));
+  printf("Slow values (temperature, drifts, modes): %lu of %lu bytes\n",
+         (unsigned long) res.slowDelta,
+         (unsigned long) res.slowFull);
+  printf("Largest error: %lu%% of the deadband, errors: %lu\n",
+         (unsigned long) res.errMax,
+         (unsigned long) res.errors);
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
+
 
+/******************************************************************************/
 
+void printRunStat() {
+  
+  INT8U err;
+  INT8U i;
+  RSTAT_ACC win;
+  RSTAT_ACC total;
+  float unit;
+  
+  printf("\nRunning statistics over %lu s and since boot (thousandths of the unit of the field):\n",
+         (unsigned long) (DB_Stats(APP_AppDataPtr())->windowMs / 1000));
+  printf("  Field       | Win. n | Min       | Max       | Mean      | Std       | Total n  | Mean      | Std\n");
+  for(i = 0; i < DB_NB_FIELDS; i++){
+    OSMutexPend(dataMutex, 0, &err);
+    RSTAT_Window(DB_Stats(APP_AppDataPtr()), i, OSTimeGet(), &win);
+    total = DB_Stats(APP_AppDataPtr())->ch[i].total;
+    OSMutexPost(dataMutex);
+    
+    unit = 1000.0f / (float) DB_FieldUnit(i);
+    printf("  %-11s | %6lu | %9ld | %9ld | %9ld | %9ld | %8lu | %9ld | %ld\n",
+           DB_FieldName(i),
+           (unsigned long) win.n,
+           (long) (win.min * unit),
+           (long) (win.max * unit),
+           (long) (win.mean * unit),
+           (long) (RSTAT_Std(&win) * unit),
+           (unsigned long) total.n,
+           (long) (total.mean * unit),
+           (long) (RSTAT_Std(&total) * unit));
+  }
+}
 
 
+/******************************************************************************/
+
+void printRunStatTest() {
+  
+  RSTAT_TEST res;
+  
+  RSTAT_SelfTest(&res);
+  
+  printf("\nRunning statistics of %lu samples (%lu ms apart, %lu ms window, gap after sample %lu)\n",
+         (unsigned long) res.samples,
+         (unsigned long) RSTAT_TEST_PERIOD_MS,
+         (unsigned long) RSTAT_TEST_WINDOW_MS,
+         (unsigned long) RSTAT_TEST_GAP);
+  printf("Window queries: %lu, wrong count, extremes or span: %lu\n",
+         (unsigned long) res.queries,
+         (unsigned long) res.errors);
+  printf("Largest error (ppm of the std): mean %lu, std %lu; std since reset %lu (naive sums %lu)\n",
+         (unsigned long) res.meanErrPpm,
+         (unsigned long) res.stdErrPpm,
+         (unsigned long) res.totalErrPpm,
+         (unsigned long) res.naiveErrPpm);
+  printf("Cost: %lu cycles per sample, %lu cycles per window query\n",
+         (unsigned long) res.addCycles,
+         (unsigned long) res.queryCycles);
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
+
+
+/******************************************************************************/
+
+void printDbLayout() {
+  
+  INT8U  err;
+  INT32U t0;
+  INT32U snapCyc;
+  INT32U fullCyc;
+  static APPDATA snap;
+  
+  OSMutexPend(dataMutex, 0, &err);
+  t0 = UTI_CycCntGet();
+  DB_Copy(&snap, APP_AppDataPtr(), DB_BLK_SENSOR);
+  snapCyc = UTI_CycCntGet() - t0;
+  t0 = UTI_CycCntGet();
+  DB_Copy(&snap, APP_AppDataPtr(), DB_BLK_SENSOR | DB_BLK_ADCS | DB_BLK_HK);
+  fullCyc = UTI_CycCntGet() - t0;
+  OSMutexPost(dataMutex);
+  
+  printf("\nDatabase: %lu bytes (sensor %lu, ADCS %lu, HK %lu)\n",
+         (unsigned long) sizeof(APPDATA),
+         (unsigned long) sizeof(DB_SENSOR),
+         (unsigned long) sizeof(DB_ADCS),
+         (unsigned long) sizeof(DB_HK));
+  printf("Change tracking: %lu bytes, running statistics: %lu bytes (%lu fields)\n",
+         (unsigned long) sizeof(DB_CHANGE),
+         (unsigned long) (DB_NB_FIELDS * sizeof(RSTAT_CH) + sizeof(RSTAT_SET)),
+         (unsigned long) DB_NB_FIELDS);
+  printf("Display snapshot (sensor block): %lu cycles, all the blocks: %lu cycles\n",
+         (unsigned long) snapCyc,
+         (unsigned long) fullCyc);
+}
+
+
+/******************************************************************************/
+
+void printPlQueue() {
+  
+  PLQ_STATS stats;
+  
+  PLQ_GetStats(&plQueue, &stats);
+  
+  printf("\nPL requests: %lu, completed %lu, errors %lu (timeouts %lu, without report %lu), outstanding %lu\n",
+         (unsigned long) stats.requests,
+         (unsigned long) stats.completed,
+         (unsigned long) stats.errors,
+         (unsigned long) stats.timeouts,
+         (unsigned long) stats.skipped,
+         (unsigned long) (stats.requests - stats.completed));
+  printf("Reports read: %lu, not ready %lu\n",
+         (unsigned long) stats.polls,
+         (unsigned long) stats.nrdy);
+  printf("Latency (ms): mean %lu, max %lu\n",
+         (unsigned long) ((stats.completed > 0) ? stats.latencySum / stats.completed : 0),
+         (unsigned long) stats.latencyMax);
+  printf("Subsystem bus held for the PL transfers: %lu ms\n",
+         (unsigned long) (plQueue.link->busUs / 1000));
+}
+
+
+/******************************************************************************/
+
+void printPlQueueTest() {
+  
+  PLQ_TEST res;
+  INT8U    i;
+  
+  PLQ_SelfTest(&res);
+  
+  printf("\nPL request queue: %lu requests per scenario, one every %lu ms, %lu outstanding at most\n",
+         (unsigned long) PLQ_TEST_REQUESTS,
+         (unsigned long) PLQ_TEST_PERIOD_MS,
+         (unsigned long) PLQ_SLOTS);
+  printf("  Delay (ms) | Done | Errors | Polls | Latency mean | max  | Bus split-phase | blocking\n");
+  for(i = 0; i < PLQ_TEST_NB; i++)
+    printf("  %10lu | %4lu | %6lu | %5lu | %12lu | %4lu | %13lu.%01lu%% | %lu.%01lu%%\n",
+           (unsigned long) res.sc[i].delayMs,
+           (unsigned long) res.sc[i].completed,
+           (unsigned long) res.sc[i].errors,
+           (unsigned long) res.sc[i].polls,
+           (unsigned long) res.sc[i].latencyMean,
+           (unsigned long) res.sc[i].latencyMax,
+           (unsigned long) (res.sc[i].busyPpm / 10000),
+           (unsigned long) (res.sc[i].busyPpm / 1000 % 10),
+           (unsigned long) (res.sc[i].blockBusyPpm / 10000),
+           (unsigned long) (res.sc[i].blockBusyPpm / 1000 % 10));
+  printf("%s\n", res.pass ? "PASS" : "FAIL");
+}
@@ -19,10 +19,45 @@ in order to store everything in the flash memory banks.
 
 
 
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static TLMC  senComp;                   // Compression of the sensor records
+static INT8U senBlock[TLMC_BLOCK_SIZE];
+
+// NAND1 simulated in RAM (see app_cfg.h), holds the sensor log
+static FLASH_DEV nand1;
+static INT8U     nand1Mem[APP_CFG_LOG_PAGE_SIZE * APP_CFG_LOG_PAGES_PER_BLOCK * APP_CFG_LOG_SIM_BLOCKS];
+static INT8U     nand1Spare[FLASH_SPARE_SIZE * APP_CFG_LOG_PAGES_PER_BLOCK * APP_CFG_LOG_SIM_BLOCKS];
+
+// Page of the HK log being filled: delta and statistics records, each after its length (0: end of
+// the page)
+static INT8U     hkPage[APP_CFG_LOG_PAGE_SIZE];
+static INT16U    hkPageLen;
+static uint64_t  hkPageTime;            // Time of the first record
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void APP_StoreSensor(const MSGQ_SEN_DATA *sen);
+static void APP_StoreHK(const MSGQ_RECORD *rec);
+static void APP_PostHK(uint64_t time);
+static void APP_PostHKStats(uint64_t time, INT32U window);
+
+
+
 /********************************************************************************************************
 *                                         APP_MemoryManagement()
 *
-* @brief      Manages the flash memory banks
+* @brief      Manages the flash memory banks. Stores the records posted by the data handlers.
 *
 * @param[in]  p_arg       Argument passed to 'APP_TaskOne()' by 'OSTaskCreate()'.
 * @exception  none
@@ -31,14 +66,91 @@ in order to store everything in the flash memory banks.
 /* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                   used.  The compiler should not generate any code for this statement.
 *
+*               (2) The records are processed in place and must be given back to the pool.
+*
+*               (3) The sensor records are compressed into blocks of one flash page (see tlmcomp.c),
+*                   appended to the sensor log (see logstore.c). Its retention tiers (see retain.c) and
+*                   the HK log are on the last blocks of NAND1.
+*
+*               (4) No record for APP_CFG_RET_IDLE_TICKS: one page of the sensor log or of a tier is
+*                   summarized (bounded cost), until the tiers are up to date.
+*
+*               (5) Any other pend error would come back at once: wait before retrying, so that the
+*                   lower priority tasks are not starved. The logs must be mounted before the first
+*                   record, their device is waited for in the same way.
+*
+*               (6) Each record is a job of the task: its deadline runs from the allocation of the
+*                   record by the data handler (see app_timing.c).
+*
 ********************************************************************************************************/
 
 void APP_MemoryManagement(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
+  INT8U err;
+  MSGQ_RECORD *rec;
+  uint64_t release;
+  
+  // Note(3)
+  FLASH_SimInit(&nand1, "NAND1", nand1Mem, nand1Spare, APP_CFG_LOG_PAGE_SIZE,
+                APP_CFG_LOG_PAGES_PER_BLOCK, APP_CFG_LOG_SIM_BLOCKS);
+  while(!FLASH_Lock(NAND1Mutex))                                // Note(5)
+    OSTimeDly(APP_CFG_RET_IDLE_TICKS);
+  LOG_Init(&senLog, "sensor", &nand1, 0, APP_CFG_RET_RAW_BLOCKS);
+  LOG_Mount(&senLog);
+  LOG_Init(&senTierLog[0], "sensor t1", &nand1, APP_CFG_RET_RAW_BLOCKS, APP_CFG_RET_T1_BLOCKS);
+  LOG_Mount(&senTierLog[0]);
+  LOG_Init(&senTierLog[1], "sensor t2", &nand1, APP_CFG_RET_RAW_BLOCKS + APP_CFG_RET_T1_BLOCKS,
+           APP_CFG_RET_T2_BLOCKS);
+  LOG_Mount(&senTierLog[1]);
+  LOG_Init(&hkLog, "hk", &nand1, APP_CFG_LOG_SIM_BLOCKS - APP_CFG_HK_LOG_BLOCKS, APP_CFG_HK_LOG_BLOCKS);
+  LOG_Mount(&hkLog);
+  RET_Init(&senTier[0], &senLog, false, &senTierLog[0], MSGQ_SEN_NB_VAL,
+           (uint64_t) APP_CFG_RET_T1_PERIOD_S * 1000000);
+  RET_Init(&senTier[1], &senTierLog[0], true, &senTierLog[1], MSGQ_SEN_NB_VAL,
+           (uint64_t) APP_CFG_RET_T2_PERIOD_S * 1000000);
+  OSMutexPost(NAND1Mutex);
+  
+  TLMC_Init(&senComp, MSGQ_SEN_NB_VAL, senBlock);
   
   while(1){
-    OSTimeDlyHMSM(0, 0, 1, 0);
+    
+    rec = MSGQ_Pend(&memMngmtQ, APP_CFG_RET_IDLE_TICKS, &err);   // Wait for a record from the data handlers
+    if(err == OS_ERR_TIMEOUT){
+      // Note(4)
+      if(FLASH_Lock(NAND1Mutex)){
+        RET_Compact(senTier, APP_CFG_RET_TIERS);
+        OSMutexPost(NAND1Mutex);
+      }
+      continue;
+    }
+    if(err != OS_ERR_NONE){
+      OSTimeDly(APP_CFG_RET_IDLE_TICKS);                        // Note(5)
+      continue;
+    }
+    
+    TMON_JobStart(MEM_MAN_ID);                                  // Note(6)
+    release = rec->time;
+    
+    switch(rec->type){
+      
+    case MSGQ_REC_SENSOR:
+      // Store sensor measurements
+      APP_StoreSensor(&rec->data.sen);
+      break;
+      
+    case MSGQ_REC_HK:
+      // Store housekeeping data (changes of the database)
+      APP_StoreHK(rec);
+      break;
+      
+    default:
+      break;
+    }
+    
+    MSGQ_Free(&recordPool, rec);          // Note(2)
+    
+    TMON_JobEnd(MEM_MAN_ID, release);
   }
   
 }
@@ -50,8 +162,9 @@ void APP_MemoryManagement(void *Ptr_Arg){
 /********************************************************************************************************
 *                                         APP_SensorDataHandler()
 *
-* @brief      Queries for sensor measurements and stores them in app database
-              Also initialises the sensors before entering the infinite loop.
+* @brief      Reads the sensor measurements on each gyro sample (data ready interrupt), and stores
+              the decimated ones in app database. Also initialises the sensors before entering the
+              infinite loop.
 *
 * @param[in]  p_arg       Argument passed to 'APP_TaskOne()' by 'OSTaskCreate()'.
 * @exception  none
@@ -60,59 +173,131 @@ void APP_MemoryManagement(void *Ptr_Arg){
 /* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                   used.  The compiler should not generate any code for this statement.
 *
+*               (2) Written through DB_Set(): the values changed beyond their deadband are flagged for
+*                   the HK log and the telemetry (see app_database.c). The time stamps are not tracked,
+*                   the delta records carry their own.
+*
+*               (3) Each data ready is a job of the task, its response time measured from the interrupt
+*                   (see app_timing.c). A release on the timeout has no interrupt time and is not timed.
+*
+*               (4) The estimations run before dataMutex is taken: its PIP is above the ADCS task. The
+*                   calibration solution is left to the start task, the lowest priority (see app.c). If
+*                   it is still running, the resume fails and is retried on the next sample.
+*
 ********************************************************************************************************/
 
 void APP_SensorDataHandler(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
   INT8U err;
+  uint64_t prevTime = 0;
+  BOOLEAN drdy;
   
   
   
-  // Initialise ITG3200 and make a first measurement to determine drift values
-  ITG3200_Init();
-  ITGV gyro = ITG3200_GetMeasurements();
-  APP_AppDataPtr()->gyro_Xdrift = gyro.X;
-  APP_AppDataPtr()->gyro_Ydrift = gyro.Y;
-  APP_AppDataPtr()->gyro_Zdrift = gyro.Z;
+  // Initialise the sensors of the descriptor table (see sensor.c)
+  SENSOR_Init();
   
-  // Initialise HMC5883L
-  HMC5883L_Init();
+  // Initialise the estimation of the gyro drift values and the magnetometer calibration
+  GYROBIAS_Init();
+  MAGCAL_Init(&mag1Cal);
   
+  // Attitude estimation from both
+  ATT_Init(&attEst);
   
   
   while(1){
     
-    //char c = 0;
-        
-    // Wait for resources to be available
+    MSGQ_RECORD *rec;
+    const SENSOR_DATA *gyro;
+    const SENSOR_DATA *mag1;
+#if (APP_CFG_SEN_MAG2_EN > 0)
+    const SENSOR_DATA *mag2;
+#endif
+    q16_t rate[3];
+    q16_t field[3];
+    q16_t drift[3];
+    q16_t att[4];
+    uint64_t magTime;
+    
+    // Released by the next gyro sample (or read anyway after a timeout, see sensor.c)
+    drdy = SENSOR_WaitDataReady();
+    if(drdy)
+      TMON_JobStart(SEN_DATA_ID);                               // Note(3)
+    
+    // Burst read of the sensors due, processing at the decimated (database) rate
+    if(!(SENSOR_Poll() & (1u << SENSOR_GYRO))){
+      if(drdy)
+        TMON_JobEnd(SEN_DATA_ID, SENSOR_SampleTimeUs());
+      continue;
+    }
+    
+    gyro = SENSOR_GetData(SENSOR_GYRO);
+    mag1 = SENSOR_GetData(SENSOR_MAG1);
+    magTime = mag1->timeUs;
+    
+    // Gyro drift estimation and correction
+    rate[0]  = gyro->out[0];  rate[1]  = gyro->out[1];  rate[2]  = gyro->out[2];
+    field[0] = mag1->out[0];  field[1] = mag1->out[1];  field[2] = mag1->out[2];
+    GYROBIAS_Update(rate, gyro->out[3], field, drift);
+    
+    // Hard/soft-iron calibration of the field, new solution computed by the start task   Note(4)
+    if(MAGCAL_Update(&mag1Cal, field, field))
+      OSTaskResume(APP_CFG_TASK_START_PRIO);
+    
+    // Attitude propagation and field correction
+    ATT_Update(&attEst, rate, field, (prevTime != 0) ? (INT32U) (gyro->timeUs - prevTime) : 0);
+    ATT_GetQuaternion(&attEst, att);
+    prevTime = gyro->timeUs;
+    
+    // Wait for resources to be available, only held for the writes
     OSMutexPend(dataMutex, 0, &err);      
-
     
-    // ITG3200
-    ITGV gyro = ITG3200_GetMeasurements();
-    APP_AppDataPtr()->gyro_X = gyro.X;
-    APP_AppDataPtr()->gyro_Y = gyro.Y;
-    APP_AppDataPtr()->gyro_Z = gyro.Z;
-    APP_AppDataPtr()->gyro_temp = gyro.temp;
-    APP_AppDataPtr()->gyro_time = gyro.time;
+    // Note(2)
+    DB_SetVec(APP_AppDataPtr(), GYRO_X, rate, 3);
+    DB_SetVec(APP_AppDataPtr(), GYRO_XDRIFT, drift, 3);
+    DB_Set(APP_AppDataPtr(), GYRO_TEMP, gyro->out[3]);
+    DB_SetTime(APP_AppDataPtr(), DB_TIME_GYRO, gyro->timeUs);
     
+    DB_SetVec(APP_AppDataPtr(), MAG1_X, field, 3);
+    DB_SetTime(APP_AppDataPtr(), DB_TIME_MAG1, magTime);
     
-    // HMC5883L
-    HMCV mag1 = HMC5883L_GetMeasurements();
-    APP_AppDataPtr()->mag1_X = mag1.X;
-    APP_AppDataPtr()->mag1_Y = mag1.Y;
-    APP_AppDataPtr()->mag1_Z = mag1.Z;
+#if (APP_CFG_SEN_MAG2_EN > 0)
+    mag2 = SENSOR_GetData(SENSOR_MAG2);
+    DB_Set(APP_AppDataPtr(), MAG2_X, UTI_Q16ToInt(mag2->out[0]));
+    DB_Set(APP_AppDataPtr(), MAG2_Y, UTI_Q16ToInt(mag2->out[1]));
+    DB_Set(APP_AppDataPtr(), MAG2_Z, UTI_Q16ToInt(mag2->out[2]));
+    DB_SetTime(APP_AppDataPtr(), DB_TIME_MAG2, mag2->timeUs);
+#endif
+    
+    DB_SetVec(APP_AppDataPtr(), ATT_Q0, att, 4);
     
-    // If successful
-    //c=1;
-  
     OSMutexPost(dataMutex);              // Make the resources available to other tasks             
     
-    //if(c)
-    //  OSMboxPost(memMngmtMsgObj, &c);     // If operation is succesful, signal memory management
+    // Release the ADCS control loop
+    ADCS_MagSample(field, magTime);
+    
+    // Send the measurements to memory management
+    rec = MSGQ_Alloc(&recordPool, MSGQ_REC_SENSOR);
+    if(rec != NULL){
+      rec->data.sen.gyro[0]  = rate[0];
+      rec->data.sen.gyro[1]  = rate[1];
+      rec->data.sen.gyro[2]  = rate[2];
+      rec->data.sen.gyroTemp = gyro->out[3];
+      rec->data.sen.gyroTime = gyro->timeUs;
+      rec->data.sen.mag1[0]  = field[0];
+      rec->data.sen.mag1[1]  = field[1];
+      rec->data.sen.mag1[2]  = field[2];
+      rec->data.sen.att[0]   = att[0];
+      rec->data.sen.att[1]   = att[1];
+      rec->data.sen.att[2]   = att[2];
+      rec->data.sen.att[3]   = att[3];
+      rec->len = sizeof(MSGQ_SEN_DATA);
+      MSGQ_Post(&memMngmtQ, &recordPool, rec);
+    }
     
-    OSTimeDlyHMSM(0, 0, 0, 100);
+    if(drdy)
+      TMON_JobEnd(SEN_DATA_ID, SENSOR_SampleTimeUs());
   }
   
 }
@@ -121,7 +306,8 @@ void APP_SensorDataHandler(void *Ptr_Arg){
 /********************************************************************************************************
 *                                         APP_SensorTimeHandler()
 *
-* @brief      Registers time of sensor measurements and stores them in app database
+* @brief      Checks the time base of the sensor measurements and records (see app_time.c): monotonic
+*             time stamps, offset to the kernel time
 *
 * @param[in]  p_arg       Argument passed to 'APP_TaskOne()' by 'OSTaskCreate()'.
 * @exception  none
@@ -136,8 +322,11 @@ void APP_SensorTimeHandler(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
   
+  TMON_Start(SEN_TIME_ID);
+  
   while(1){
-    OSTimeDlyHMSM(0, 0, 1, 0);
+    TIME_Check();
+    TMON_WaitNextPeriod(SEN_TIME_ID);
   }
   
 }
@@ -157,33 +346,58 @@ void APP_SensorTimeHandler(void *Ptr_Arg){
 /* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                   used.  The compiler should not generate any code for this statement.
 *
+*               (2) The fields of the database changed since the last HK period are sent to memory
+*                   management as delta records (see APP_PostHK()), a full snapshot every
+*                   APP_CFG_HK_KEYFRAME periods.
+*
+*               (3) At the end of each window of the running statistics, their values are sent as well
+*                   (see APP_PostHKStats()). OS ticks of 1 ms.
+*
+*               (4) The subsystem bus is taken per transfer (sysI2CMutex), and the database only to
+*                   write the results: neither is held while a subsystem prepares its answer.
+*
 ********************************************************************************************************/
 
 void APP_HKDataHandler(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
   INT8U err;
+  INT32U periods = 0;
+  INT32U statTime = OSTimeGet();
+  INT32U window;
+  
+  TMON_Start(HK_DATA_ID);
   
   while(1){
     
     char c = 0;
     
-    OSMutexPend(sysI2CMutex, 0, &err);    // Wait for resources to be available
-    OSMutexPend(dataMutex, 0, &err);
-  
-    // Query all other subsystems in order to aquire housekeeping data
-    // Query PL to check if current scenario is finished
+    // Query all other subsystems in order to aquire housekeeping data (Note(4))
     
     // If successful
       c=1;
-  
-    OSMutexPost(dataMutex);
-    OSMutexPost(sysI2CMutex);             // Make the resources available to other tasks
     
-    if(c)
-      OSMboxPost(memMngmtMsgObj, &c);     // If operation is succesful, signal memory management
+    if(c){
+      OSMutexPend(dataMutex, 0, &err);    // Wait for resources to be available
+      DB_SetTime(APP_AppDataPtr(), DB_TIME_HK, TIME_NowUs());
+      OSMutexPost(dataMutex);             // Make the resources available to other tasks
+    }
+    
+    if(c){
+      // Note(2)
+      if(periods++ % APP_CFG_HK_KEYFRAME == 0)
+        DB_Force(APP_AppDataPtr(), DB_STORE);
+      APP_PostHK(DB_GetTime(APP_AppDataPtr(), DB_TIME_HK));      // If operation is succesful, send the data to memory management
+      
+      // Note(3)
+      window = PARAM_Get(&params, PARAM_STAT_WINDOW_S) * 1000;
+      if(OSTimeGet() - statTime >= window){
+        statTime = OSTimeGet();
+        APP_PostHKStats(DB_GetTime(APP_AppDataPtr(), DB_TIME_HK), window);
+      }
+    }
    
-    OSTimeDlyHMSM(0, 0, 1, 0);
+    TMON_WaitNextPeriod(HK_DATA_ID);
   }
   
 }
@@ -202,34 +416,178 @@ void APP_HKDataHandler(void *Ptr_Arg){
 /* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                   used.  The compiler should not generate any code for this statement.
 *
+*               (2) Split-phase request (see plqueue.c): the scenario status requested in a period is
+*                   collected in the next one, the bus held for the transfers only. The queue is
+*                   stepped twice per period: the report polled, then the next request sent. The
+*                   scenario reaches memory management with the HK changes of the database, no record
+*                   is posted.
+*
 ********************************************************************************************************/
 
 void APP_PLDataHandler(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
   INT8U err;
+  INT8U    tag = 0;
+  INT16U   errorFlag;
+  int8_t   scenario = 0;
+  uint8_t  request[HDR_SZ + PL_NODATA_REQ_SZ];
+  static uint8_t report[HDR_SZ + PL_FC_SCENARIO_STATUS_REP_SZ];
   
-  while(1){
-    
-    char c = 0;
-    
-    OSMutexPend(sysI2CMutex, 0, &err);    // Wait for resources to be available
-    OSMutexPend(dataMutex, 0, &err);
+  TMON_Start(PL_DATA_ID);
   
-    // Query all other subsystems in order to aquire housekeeping data
-    // Query PL to check if current scenario is finished
+  while(1){
     
-    // If successful
-      c=1;
-  
-    OSMutexPost(dataMutex);
-    OSMutexPost(sysI2CMutex);             // Make the resources available to other tasks
+#if (APP_CFG_PL_STATUS_EN > 0)
+    // Note(2)
+    PLQ_Step(&plQueue, OSTimeGet());      // Report of the previous period
+    errorFlag = 0;
+    if(tag != 0 && PLQ_Collect(&plQueue, tag, &errorFlag)){
+      tag = 0;
+      if(errorFlag == 0)
+        scenario = PL_FC_ParseScenarioStatus(report, sizeof(report), &errorFlag);
+      if(errorFlag == 0){
+        OSMutexPend(dataMutex, 0, &err);  // Wait for resources to be available
+        DB_Set(APP_AppDataPtr(), PL_SCENARIO, scenario);
+        OSMutexPost(dataMutex);           // Make the resources available to other tasks
+      }
+    }
+    if(tag == 0){
+      tag = PLQ_Submit(&plQueue, request, PL_Request(request, PL_MT_FC_REQ, PL_FC_SCENARIO_STATUS),
+                       report, sizeof(report));
+      PLQ_Step(&plQueue, OSTimeGet());    // Request of this period
+    }
+#endif
     
-    if(c)
-      OSMboxPost(memMngmtMsgObj, &c);     // If operation is succesful, signal memory management
-   
-    OSTimeDlyHMSM(0, 0, 1, 0);
+    TMON_WaitNextPeriod(PL_DATA_ID);
   }
   
 }
 
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Adds a sensor record to the current block. A full block is sealed by the encoder, appended to the
+// sensor log, and a new one is started with the record.
+static void APP_StoreSensor(const MSGQ_SEN_DATA *sen){
+
+  int32_t  val[MSGQ_SEN_NB_VAL];
+  uint64_t first;
+  uint64_t last;
+
+  val[0]  = sen->gyro[0];
+  val[1]  = sen->gyro[1];
+  val[2]  = sen->gyro[2];
+  val[3]  = sen->gyroTemp;
+  val[4]  = sen->mag1[0];
+  val[5]  = sen->mag1[1];
+  val[6]  = sen->mag1[2];
+  val[7]  = sen->att[0];
+  val[8]  = sen->att[1];
+  val[9]  = sen->att[2];
+  val[10] = sen->att[3];
+
+  if(TLMC_Add(&senComp, sen->gyroTime, val))
+    return;
+
+  TLMC_BlockTimes(senBlock, &first, &last);
+
+  if(FLASH_Lock(NAND1Mutex)){                                   // Block dropped otherwise
+    LOG_Append(&senLog, senBlock, first);
+    if(senLog.sum.head - senLog.synced >= APP_CFG_LOG_SYNC_PAGES)
+      LOG_Sync(&senLog);
+    OSMutexPost(NAND1Mutex);
+  }
+
+  TLMC_Start(&senComp, senBlock);
+  TLMC_Add(&senComp, sen->gyroTime, val);
+}
+
+/******************************************************************************/
+
+// Sends the fields changed for the HK log as delta records, as many as needed. A record is
+// allocated before the fields are taken: when the pool is empty, the changes stay flagged for the
+// next period.
+static void APP_PostHK(uint64_t time){
+
+  MSGQ_RECORD *rec;
+  INT32U mask;
+  INT8U  err;
+
+  OSMutexPend(dataMutex, 0, &err);
+  while(DB_Pending(APP_AppDataPtr(), DB_STORE) != 0){
+    rec = MSGQ_Alloc(&recordPool, MSGQ_REC_HK);
+    if(rec == NULL)
+      break;
+    mask = DB_Take(APP_AppDataPtr(), DB_STORE, MSGQ_REC_PAYLOAD - DB_DELTA_HDR);
+    rec->len = DB_Pack(APP_AppDataPtr(), DB_STORE, mask, time, rec->data.raw);
+    MSGQ_Post(&memMngmtQ, &recordPool, rec);
+  }
+  OSMutexPost(dataMutex);
+}
+
+/******************************************************************************/
+
+// Sends the statistics of all the fields over the window as statistics records. A new window length
+// (parameter changed) restarts the windows: nothing is sent for this one.
+static void APP_PostHKStats(uint64_t time, INT32U window){
+
+  MSGQ_RECORD *rec;
+  INT8U field = 0;
+  INT8U err;
+
+  OSMutexPend(dataMutex, 0, &err);
+  if(DB_Stats(APP_AppDataPtr())->windowMs != window)
+    RSTAT_SetWindow(DB_Stats(APP_AppDataPtr()), window);
+  else
+    while(field < DB_NB_FIELDS){
+      rec = MSGQ_Alloc(&recordPool, MSGQ_REC_HK);
+      if(rec == NULL)
+        break;
+      rec->len = DB_PackStats(APP_AppDataPtr(), &field, time, rec->data.raw, MSGQ_REC_PAYLOAD);
+      if(rec->len == 0){
+        MSGQ_Free(&recordPool, rec);
+        break;
+      }
+      MSGQ_Post(&memMngmtQ, &recordPool, rec);
+    }
+  OSMutexPost(dataMutex);
+}
+
+/******************************************************************************/
+
+// Adds a HK record (delta or statistics) to the current page, after its length. A page without room left is
+// appended to the HK log, its end marked by a null length, and a new one is started with the record.
+static void APP_StoreHK(const MSGQ_RECORD *rec){
+
+  uint64_t time = 0;
+  INT8U    i;
+
+  if(rec->len < DB_DELTA_HDR)
+    return;
+  for(i = 0; i < 8; i++)
+    time |= (uint64_t) rec->data.raw[DB_DELTA_TIME + i] << (8 * i);
+
+  if(hkPageLen + 1u + rec->len > APP_CFG_LOG_PAGE_SIZE){
+    memset(&hkPage[hkPageLen], 0, APP_CFG_LOG_PAGE_SIZE - hkPageLen);
+    if(FLASH_Lock(NAND1Mutex)){                                 // Page dropped otherwise
+      LOG_Append(&hkLog, hkPage, hkPageTime);
+      if(hkLog.sum.head - hkLog.synced >= APP_CFG_LOG_SYNC_PAGES)
+        LOG_Sync(&hkLog);
+      OSMutexPost(NAND1Mutex);
+    }
+    hkPageLen = 0;
+  }
+
+  if(hkPageLen == 0)
+    hkPageTime = time;
+  hkPage[hkPageLen++] = rec->len;
+  memcpy(&hkPage[hkPageLen], rec->data.raw, rec->len);
+  hkPageLen += rec->len;
+}
@@ -12,6 +12,14 @@ Description:
 app_data.c nests the declaration of the AppData structure, as well as the
 function allowing the system to access the data.
 
+The writers of the database go through DB_Set(), which tracks the changes:
+each consumer of the data (HK log, serial telemetry) has a mask of the fields
+changed beyond their deadband since it last emitted them. The consumer takes
+its mask (cleared atomically) and packs the fields of the mask only in a delta
+record (DB_Pack()); the fields it does not emit stay within their deadband of
+the value it emitted last. Slowly varying values (temperatures, drifts, modes)
+are then sent about once per deadband crossing instead of every period.
+
 ******************************************************************************/
 
 
@@ -21,36 +29,109 @@ function allowing the system to access the data.
 
 
 
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+// Type of a field
+#define DB_Q16          4       // q16_t
+#define DB_S16          2       // INT16S
+#define DB_U8           1       // INT8U (size of the type)
 
-static APPDATA data = {
+// Self-test: slowly varying fields (see DB_TEST)
+#define DB_SLOW         ((1uL << GYRO_XDRIFT) | (1uL << GYRO_YDRIFT) | (1uL << GYRO_ZDRIFT) | \
+                         (1uL << GYRO_TEMP) | (1uL << ADCS_MODE) | (1uL << PL_SCENARIO))
+
+// Orbit phase step of the self-test: cos and sin of 2 pi / DB_TEST_ORBIT (Q30), and of half of it
+#define DB_TEST_COS     1073741097
+#define DB_TEST_SIN     1249355
+#define DB_TEST_HCOS    1073741642
+#define DB_TEST_HSIN    624678
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Field descriptor
+typedef struct DbField DB_FIELD;
+struct DbField {
+  const char *name;
+  INT16U      offset;                   // In APPDATA
+  INT8U       type;
+  int32_t     deadband;                 // Largest change not emitted (0: any change is emitted)
+};
+
+// Tracked fields, in the order of the indexes of app_database.h
+static const DB_FIELD dbFields[DB_NB_FIELDS] = {
+  // Name          Offset                                  Type     Deadband
+  { "gyro_X",      offsetof(APPDATA, sen.gyro[0]),         DB_Q16,  UTI_Q16FromFloat(0.05)   },  // deg/s
+  { "gyro_Y",      offsetof(APPDATA, sen.gyro[1]),         DB_Q16,  UTI_Q16FromFloat(0.05)   },
+  { "gyro_Z",      offsetof(APPDATA, sen.gyro[2]),         DB_Q16,  UTI_Q16FromFloat(0.05)   },
+  { "gyro_Xdrift", offsetof(APPDATA, sen.gyroDrift[0]),    DB_Q16,  UTI_Q16FromFloat(0.005)  },
+  { "gyro_Ydrift", offsetof(APPDATA, sen.gyroDrift[1]),    DB_Q16,  UTI_Q16FromFloat(0.005)  },
+  { "gyro_Zdrift", offsetof(APPDATA, sen.gyroDrift[2]),    DB_Q16,  UTI_Q16FromFloat(0.005)  },
+  { "gyro_temp",   offsetof(APPDATA, sen.gyroTemp),        DB_Q16,  UTI_Q16FromFloat(0.25)   },  // deg C
+  { "mag1_X",      offsetof(APPDATA, sen.mag1[0]),         DB_Q16,  UTI_Q16FromFloat(5.0)    },  // mG
+  { "mag1_Y",      offsetof(APPDATA, sen.mag1[1]),         DB_Q16,  UTI_Q16FromFloat(5.0)    },
+  { "mag1_Z",      offsetof(APPDATA, sen.mag1[2]),         DB_Q16,  UTI_Q16FromFloat(5.0)    },
+  { "mag2_X",      offsetof(APPDATA, sen.mag2[0]),         DB_S16,  5                        },
+  { "mag2_Y",      offsetof(APPDATA, sen.mag2[1]),         DB_S16,  5                        },
+  { "mag2_Z",      offsetof(APPDATA, sen.mag2[2]),         DB_S16,  5                        },
+  { "mtq_X",       offsetof(APPDATA, adcs.mtq[0]),         DB_Q16,  UTI_Q16FromFloat(0.005)  },  // A.m^2
+  { "mtq_Y",       offsetof(APPDATA, adcs.mtq[1]),         DB_Q16,  UTI_Q16FromFloat(0.005)  },
+  { "mtq_Z",       offsetof(APPDATA, adcs.mtq[2]),         DB_Q16,  UTI_Q16FromFloat(0.005)  },
+  { "att_q0",      offsetof(APPDATA, sen.att[0]),          DB_Q16,  UTI_Q16FromFloat(0.002)  },
+  { "att_q1",      offsetof(APPDATA, sen.att[1]),          DB_Q16,  UTI_Q16FromFloat(0.002)  },
+  { "att_q2",      offsetof(APPDATA, sen.att[2]),          DB_Q16,  UTI_Q16FromFloat(0.002)  },
+  { "att_q3",      offsetof(APPDATA, sen.att[3]),          DB_Q16,  UTI_Q16FromFloat(0.002)  },
+  { "adcs_mode",   offsetof(APPDATA, adcs.mode),           DB_U8,   0                        },
+  { "pl_scenario", offsetof(APPDATA, hk.plScenario),       DB_U8,   0                        },
+};
+
+// Time stamps, in the order of the indexes of app_database.h
+static const INT16U dbTimes[DB_NB_TIMES] = {
+  offsetof(APPDATA, sen.gyroTime),
+  offsetof(APPDATA, sen.mag1Time),
+  offsetof(APPDATA, sen.mag2Time),
+  offsetof(APPDATA, hk.time),
+};
 
-  .gyro_X = 0,
-  .gyro_Xdrift = 0,
-  .gyro_Y = 0,
-  .gyro_Ydrift = 0,
-  .gyro_Z = 0,
-  .gyro_Zdrift = 0,
-  .gyro_temp = 0,
-  .gyro_time = 0,  
-  
-  .mag1_X = 0, 
-  .mag1_Y = 0,
-  .mag1_Z = 0,
-  .mag1_time = 0,   
-  
-  .mag2_X = 0, 
-  .mag2_Y = 0,
-  .mag2_Z = 0,
-  .mag2_time = 0,    
-
-  .changeTbl = {0,0,0,0,0,0,0,0,0},
-
-  .hk_time = 0,  
-  
-  .adcs_mode = ADCS_FULL,
-  .pl_scenario = 0,
+// Blocks (DB_BLK_xxx bits)
+static const INT16U dbBlocks[DB_NB_BLOCKS][2] = {
+  { offsetof(APPDATA, sen),  sizeof(DB_SENSOR) },
+  { offsetof(APPDATA, adcs), sizeof(DB_ADCS)   },
+  { offsetof(APPDATA, hk),   sizeof(DB_HK)     },
 };
 
+// Running statistics of the fields (window: PARAM_STAT_WINDOW_S, applied by the HK task)
+static RSTAT_CH  dbStatCh[DB_NB_FIELDS];
+static RSTAT_SET dbStats = { dbStatCh, DB_NB_FIELDS, APP_CFG_STAT_WINDOW_S * 1000,
+                             APP_CFG_STAT_WINDOW_S * 1000 / RSTAT_BUCKETS };
+
+static DB_CHANGE dbChange = { .dirty = {DB_ALL, DB_ALL} };    // Everything emitted first
+
+static APPDATA data = {
+  .adcs   = { .mode = ADCS_FULL },
+  .change = &dbChange,
+  .stats  = &dbStats,
+};
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static int32_t DB_Noise(uint32_t *seed, int32_t amp);
+
+
 
 /*********************************************************************************************************
 *                                         APP_AppDataPtr()
@@ -69,4 +150,638 @@ static APPDATA data = {
 
 APPDATA* APP_AppDataPtr(){
   return &data;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Set()
+* @brief      Writes a field of the database, flags it for the consumers that emitted a value further
+*             than its deadband, and adds it to the running statistics of the field
+*
+* @param[in]  d           database (APP_AppDataPtr(), or a copy)
+* @param[in]  field       GYRO_X...
+* @param[in]  value       on the type of the field (q16_t, or integer)
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The writers and the consumers hold dataMutex: the values last emitted (ref) do not
+*                   change under a writer. The masks are also updated in a critical section, so that a
+*                   consumer may take them without the mutex.
+*
+*               (2) OS ticks of 1 ms (OS_TICKS_PER_SEC).
+*
+*********************************************************************************************************/
+
+void DB_Set(APPDATA *d, INT8U field, int32_t value){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  const DB_FIELD *f = &dbFields[field];
+  INT8U  *p = (INT8U *) d + f->offset;
+  INT32U  mark = 0;
+  int64_t diff;
+  INT8U   c;
+
+  switch(f->type){
+  case DB_Q16: *(q16_t *) p  = value;            break;
+  case DB_S16: *(INT16S *) p = (INT16S) value;  value = *(INT16S *) p;  break;
+  default:     *p            = (INT8U) value;   value = *p;             break;
+  }
+
+  if(d->stats != NULL)
+    RSTAT_Add(d->stats, field, value, OSTimeGet());               // Note(2)
+
+  if(d->change == NULL)
+    return;
+  d->change->sets++;
+
+  for(c = 0; c < DB_NB_CONS; c++){
+    diff = (int64_t) value - d->change->ref[c][field];
+    if(diff > f->deadband || diff < -f->deadband)
+      mark |= 1u << c;
+  }
+  if(mark == 0)
+    return;
+
+  d->change->marks++;
+  OS_ENTER_CRITICAL();                  // Note(1)
+  for(c = 0; c < DB_NB_CONS; c++)
+    if(mark & (1u << c))
+      d->change->dirty[c] |= 1uL << field;
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Get()
+* @brief      Reads a field of the database
+*
+* @param[in]  d           database
+* @param[in]  field       GYRO_X...
+* @exception  none
+* @return     value, sign or zero extended from the type of the field
+*/
+/*********************************************************************************************************/
+
+int32_t DB_Get(const APPDATA *d, INT8U field){
+
+  const DB_FIELD *f = &dbFields[field];
+  const INT8U *p = (const INT8U *) d + f->offset;
+
+  switch(f->type){
+  case DB_Q16: return *(const q16_t *) p;
+  case DB_S16: return *(const INT16S *) p;
+  default:     return *p;
+  }
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_SetVec()
+* @brief      Writes consecutive fields of the database (e.g. the 3 axes of a measurement)
+*
+* @param[in]  d           database
+* @param[in]  field       first field (GYRO_X...)
+* @param[in]  value       nb values
+* @param[in]  nb          fields
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void DB_SetVec(APPDATA *d, INT8U field, const int32_t *value, INT8U nb){
+
+  INT8U i;
+
+  for(i = 0; i < nb; i++)
+    DB_Set(d, field + i, value[i]);
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_SetTime() / DB_GetTime()
+* @brief      Writes / reads a time stamp of the database (not tracked for changes)
+*
+* @param[in]  d           database
+* @param[in]  id          DB_TIME_GYRO...
+* @param[in]  time        us (see TIME_NowUs())
+* @exception  none
+* @return     DB_GetTime(): time stamp
+*/
+/*********************************************************************************************************/
+
+void DB_SetTime(APPDATA *d, INT8U id, uint64_t time){
+  *(uint64_t *) ((INT8U *) d + dbTimes[id]) = time;
+}
+
+uint64_t DB_GetTime(const APPDATA *d, INT8U id){
+  return *(const uint64_t *) ((const INT8U *) d + dbTimes[id]);
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Copy()
+* @brief      Copies blocks of the database, so that a reader holds dataMutex for the copy only
+*
+* @param[out] dst         copy, read with DB_Get() / DB_GetTime() (no change tracking, no statistics)
+* @param[in]  src         database
+* @param[in]  blocks      DB_BLK_xxx
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void DB_Copy(APPDATA *dst, const APPDATA *src, INT8U blocks){
+
+  INT8U i;
+
+  for(i = 0; i < DB_NB_BLOCKS; i++)
+    if(blocks & (1u << i))
+      memcpy((INT8U *) dst + dbBlocks[i][0], (const INT8U *) src + dbBlocks[i][0], dbBlocks[i][1]);
+  dst->change = NULL;
+  dst->stats  = NULL;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Pending()
+* @brief      Fields flagged for a consumer, not taken yet
+*
+* @param[in]  d           database
+* @param[in]  cons        DB_STORE...
+* @exception  none
+* @return     mask of the fields
+*/
+/*********************************************************************************************************/
+
+INT32U DB_Pending(const APPDATA *d, INT8U cons){
+  return (d->change != NULL) ? d->change->dirty[cons] : 0;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_GetChange()
+* @brief      Copy of the change tracking state (statistics of the consumers)
+*
+* @param[in]  d           database
+* @param[out] change      copy (zero when not tracked)
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void DB_GetChange(const APPDATA *d, DB_CHANGE *change){
+
+  if(d->change != NULL)
+    *change = *d->change;
+  else
+    memset(change, 0, sizeof(DB_CHANGE));
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Stats()
+* @brief      Running statistics of the fields (see app_stats.c)
+*
+* @param[in]  d           database
+* @exception  none
+* @return     statistics (NULL: none)
+*/
+/*********************************************************************************************************/
+
+RSTAT_SET* DB_Stats(APPDATA *d){
+  return d->stats;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Force()
+* @brief      Flags all the fields for a consumer: its next records are a full snapshot (e.g. so that
+*             the ground rebuilds the values after records lost)
+*
+* @param[in]  d           database
+* @param[in]  cons        DB_STORE...
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void DB_Force(APPDATA *d, INT8U cons){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  d->change->dirty[cons] = DB_ALL;
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Take()
+* @brief      Takes the fields flagged for a consumer, lowest index first, as many as fit in a record.
+*             The fields taken are cleared from the mask atomically.
+*
+* @param[in]  d           database
+* @param[in]  cons        DB_STORE...
+* @param[in]  room        bytes of the record for the values (record size - DB_DELTA_HDR)
+* @exception  none
+* @return     mask of the fields taken (0: no change), to be given to DB_Pack()
+*/
+/* Notes      :(1) Fields flagged by a writer between DB_Take() and DB_Pack() stay in the mask, and are
+*                   emitted again by the next record.
+*
+*********************************************************************************************************/
+
+INT32U DB_Take(APPDATA *d, INT8U cons, INT8U room){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT32U dirty;
+  INT32U mask = 0;
+  INT8U  i;
+
+  OS_ENTER_CRITICAL();
+  dirty = d->change->dirty[cons];
+  for(i = 0; i < DB_NB_FIELDS && (dirty >> i) != 0; i++){
+    if(!(dirty & (1uL << i)))
+      continue;
+    if(dbFields[i].type > room)
+      break;
+    room -= dbFields[i].type;
+    mask |= 1uL << i;
+  }
+  d->change->dirty[cons] = dirty & ~mask;
+  OS_EXIT_CRITICAL();
+
+  return mask;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Pack()
+* @brief      Writes the delta record of the fields of a mask, and records the values as emitted to the
+*             consumer
+*
+* @param[in]  d           database
+* @param[in]  cons        DB_STORE...
+* @param[in]  mask        fields (see DB_Take())
+* @param[in]  time        of the record (us)
+* @param[out] buf         delta record (DB_DeltaSize(mask) bytes)
+* @exception  none
+* @return     size of the record
+*/
+/*********************************************************************************************************/
+
+INT8U DB_Pack(APPDATA *d, INT8U cons, INT32U mask, uint64_t time, INT8U *buf){
+
+  INT8U   len = DB_DELTA_HDR;
+  INT8U   i;
+  INT8U   b;
+  int32_t val;
+
+  for(b = 0; b < 8; b++)
+    buf[DB_DELTA_TIME + b] = (INT8U) (time >> (8 * b));
+  for(b = 0; b < 4; b++)
+    buf[DB_DELTA_MASK + b] = (INT8U) (mask >> (8 * b));
+
+  for(i = 0; i < DB_NB_FIELDS; i++){
+    if(!(mask & (1uL << i)))
+      continue;
+    val = DB_Get(d, i);
+    d->change->ref[cons][i] = val;
+    for(b = 0; b < dbFields[i].type; b++)
+      buf[len++] = (INT8U) ((INT32U) val >> (8 * b));
+  }
+
+  d->change->records[cons]++;
+  d->change->bytes[cons]     += len;
+  d->change->fullBytes[cons] += DB_DeltaSize(DB_ALL) - 4;     // Time and all the fields, no mask
+
+  return len;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_Unpack()
+* @brief      Applies a delta record to a set of values (ground side, and self-test)
+*
+* @param[in]  buf         delta record
+* @param[in]  len         bytes available in buf
+* @param[out] time        of the record (us)
+* @param[out] val         DB_NB_FIELDS values, the fields of the record are updated
+* @exception  none
+* @return     size of the record (0: not a delta record)
+*/
+/*********************************************************************************************************/
+
+INT8U DB_Unpack(const INT8U *buf, INT8U len, uint64_t *time, int32_t *val){
+
+  INT32U mask = 0;
+  INT32U v;
+  INT8U  pos = DB_DELTA_HDR;
+  INT8U  i;
+  INT8U  b;
+
+  if(len < DB_DELTA_HDR)
+    return 0;
+  for(b = 0; b < 4; b++)
+    mask |= (INT32U) buf[DB_DELTA_MASK + b] << (8 * b);
+  if((mask & ~DB_ALL) != 0 || DB_DeltaSize(mask) > len)
+    return 0;
+
+  *time = 0;
+  for(b = 0; b < 8; b++)
+    *time |= (uint64_t) buf[DB_DELTA_TIME + b] << (8 * b);
+
+  for(i = 0; i < DB_NB_FIELDS; i++){
+    if(!(mask & (1uL << i)))
+      continue;
+    v = 0;
+    for(b = 0; b < dbFields[i].type; b++)
+      v |= (INT32U) buf[pos++] << (8 * b);
+    switch(dbFields[i].type){
+    case DB_Q16: val[i] = (int32_t) v;           break;
+    case DB_S16: val[i] = (INT16S) (INT16U) v;   break;
+    default:     val[i] = (int32_t) v;           break;
+    }
+  }
+
+  return pos;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_DeltaSize()
+* @brief      Size of the delta record of a mask
+*
+* @param[in]  mask        fields
+* @exception  none
+* @return     bytes
+*/
+/*********************************************************************************************************/
+
+INT8U DB_DeltaSize(INT32U mask){
+
+  INT8U len = DB_DELTA_HDR;
+  INT8U i;
+
+  for(i = 0; i < DB_NB_FIELDS; i++)
+    if(mask & (1uL << i))
+      len += dbFields[i].type;
+
+  return len;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_PackStats()
+* @brief      Writes the statistics record of the fields from *field on over the window, as many as fit
+*
+* @param[in]  d           database (with running statistics)
+* @param[in]  field       first field, updated to the first one not written (DB_NB_FIELDS: done)
+* @param[in]  time        of the record (us)
+* @param[out] buf         statistics record
+* @param[in]  size        bytes available in buf
+* @exception  none
+* @return     size of the record (0: no field written)
+*/
+/* Notes      :(1) Mean and standard deviation are rounded to the unit of the field (1 / 65536 in
+*                   Q16.16).
+*
+*********************************************************************************************************/
+
+INT8U DB_PackStats(APPDATA *d, INT8U *field, uint64_t time, INT8U *buf, INT8U size){
+
+  RSTAT_ACC win;
+  INT32U  mask = DB_STAT_REC;
+  INT32U  now = OSTimeGet();
+  int32_t val[4];
+  INT8U   len = DB_DELTA_HDR;
+  INT8U   i;
+  INT8U   j;
+  INT8U   b;
+
+  for(i = *field; i < DB_NB_FIELDS && len + 2 + 4 * dbFields[i].type <= size; i++){
+    RSTAT_Window(d->stats, i, now, &win);
+    mask |= 1uL << i;
+    buf[len++] = (INT8U) ((win.n > 0xFFFF) ? 0xFF : win.n);
+    buf[len++] = (INT8U) ((win.n > 0xFFFF) ? 0xFF : win.n >> 8);
+    val[0] = win.min;                   // Note(1)
+    val[1] = win.max;
+    val[2] = (int32_t) lrintf(win.mean);
+    val[3] = (int32_t) lrintf(RSTAT_Std(&win));
+    for(j = 0; j < 4; j++)
+      for(b = 0; b < dbFields[i].type; b++)
+        buf[len++] = (INT8U) ((INT32U) val[j] >> (8 * b));
+  }
+  if(i == *field)
+    return 0;
+  *field = i;
+
+  for(b = 0; b < 8; b++)
+    buf[DB_DELTA_TIME + b] = (INT8U) (time >> (8 * b));
+  for(b = 0; b < 4; b++)
+    buf[DB_DELTA_MASK + b] = (INT8U) (mask >> (8 * b));
+
+  return len;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_FieldName()
+* @brief      Name of a field
+*
+* @param[in]  field       GYRO_X...
+* @exception  none
+* @return     name (as in APPDATA)
+*/
+/*********************************************************************************************************/
+
+const char* DB_FieldName(INT8U field){
+  return (field < DB_NB_FIELDS) ? dbFields[field].name : "?";
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_FieldUnit()
+* @brief      Raw value of one unit of a field
+*
+* @param[in]  field       GYRO_X...
+* @exception  none
+* @return     Q16_ONE for the fields in Q16.16, else 1
+*/
+/*********************************************************************************************************/
+
+INT32U DB_FieldUnit(INT8U field){
+  return (dbFields[field].type == DB_Q16) ? Q16_ONE : 1;
+}
+
+
+
+/*********************************************************************************************************
+*                                         DB_SelfTest()
+* @brief      Simulates two orbits of the database at the HK rate, stored as delta records, and rebuilds
+*             the values from the records
+*
+* @param[out] res         sizes of the records and errors
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Nadir pointing: rates near the orbital rate, field and attitude turning once per orbit,
+*                   temperature and drifts following the sun, all with sensor noise. The ADCS detumbles
+*                   for the first 10 minutes, two PL scenarios run.
+*
+*               (2) Records are taken until no change is left, each one at most the payload of a HK
+*                   record, with a full snapshot every APP_CFG_HK_KEYFRAME periods (as in
+*                   APP_HKDataHandler()).
+*
+*               (3) "Exact": the size of the records with a field emitted whenever it differs from its
+*                   previous value (no deadband), as a lossless delta encoding would.
+*
+*               (4) Every value rebuilt from the records must be within its deadband of the database.
+*
+*********************************************************************************************************/
+
+void DB_SelfTest(DB_TEST *res){
+
+  static APPDATA   sim;
+  static DB_CHANGE simChange;
+  int32_t  val[DB_NB_FIELDS];
+  int32_t  prev[DB_NB_FIELDS];
+  INT8U    buf[MSGQ_REC_PAYLOAD];
+  int64_t  c = 1 << 30;                 // Orbit phase (Q30)
+  int64_t  s = 0;
+  int64_t  hc = 1 << 30;                // Half of it, for the attitude
+  int64_t  hs = 0;
+  int64_t  t;
+  uint32_t seed = 12345;
+  INT32U   k;
+  INT32U   mask;
+  INT32U   exact;
+  INT32U   err;
+  uint64_t time;
+  INT8U    len;
+  INT8U    i;
+
+  memset(res, 0, sizeof(DB_TEST));
+  memset(&sim, 0, sizeof(sim));
+  memset(&simChange, 0, sizeof(simChange));
+  sim.change = &simChange;
+  memset(val, 0, sizeof(val));
+  memset(prev, 0, sizeof(prev));
+  simChange.dirty[DB_STORE] = DB_ALL;
+  simChange.dirty[DB_TLM]   = DB_ALL;
+
+  for(k = 0; k < DB_TEST_SAMPLES; k++){
+
+    // Note(1): values of the end of the HK period (Q30 sin and cos to Q16)
+    DB_Set(&sim, GYRO_X,      DB_Noise(&seed, UTI_Q16FromFloat(0.02)));
+    DB_Set(&sim, GYRO_Y,      UTI_Q16FromFloat(-0.067) + DB_Noise(&seed, UTI_Q16FromFloat(0.02)));
+    DB_Set(&sim, GYRO_Z,      DB_Noise(&seed, UTI_Q16FromFloat(0.02)));
+    DB_Set(&sim, GYRO_XDRIFT, UTI_Q16FromFloat(0.5)  + (int32_t) ((s * UTI_Q16FromFloat(0.02)) >> 30)
+                              + DB_Noise(&seed, UTI_Q16FromFloat(0.001)));
+    DB_Set(&sim, GYRO_YDRIFT, UTI_Q16FromFloat(-0.3) + (int32_t) ((c * UTI_Q16FromFloat(0.02)) >> 30)
+                              + DB_Noise(&seed, UTI_Q16FromFloat(0.001)));
+    DB_Set(&sim, GYRO_ZDRIFT, UTI_Q16FromFloat(0.1)  + DB_Noise(&seed, UTI_Q16FromFloat(0.001)));
+    DB_Set(&sim, GYRO_TEMP,   UTI_Q16FromFloat(20.0) + (int32_t) ((s * UTI_Q16FromFloat(10.0)) >> 30)
+                              + DB_Noise(&seed, UTI_Q16FromFloat(0.05)));
+    DB_Set(&sim, MAG1_X,      (int32_t) ((c * UTI_Q16FromFloat(400.0)) >> 30) + DB_Noise(&seed, UTI_Q16FromFloat(2.0)));
+    DB_Set(&sim, MAG1_Y,      (int32_t) ((s * UTI_Q16FromFloat(300.0)) >> 30) + DB_Noise(&seed, UTI_Q16FromFloat(2.0)));
+    DB_Set(&sim, MAG1_Z,      (int32_t) ((((s * c) >> 30) * UTI_Q16FromFloat(400.0)) >> 30)
+                              + DB_Noise(&seed, UTI_Q16FromFloat(2.0)));
+    for(i = 0; i < 3; i++)
+      DB_Set(&sim, MAG2_X + i, UTI_Q16ToInt(DB_Get(&sim, MAG1_X + i)) + DB_Noise(&seed, 3));
+    DB_Set(&sim, MTQ_X,       (int32_t) ((-s * UTI_Q16FromFloat(0.1)) >> 30) + DB_Noise(&seed, UTI_Q16FromFloat(0.001)));
+    DB_Set(&sim, MTQ_Y,       (int32_t) ((c * UTI_Q16FromFloat(0.1)) >> 30) + DB_Noise(&seed, UTI_Q16FromFloat(0.001)));
+    DB_Set(&sim, MTQ_Z,       DB_Noise(&seed, UTI_Q16FromFloat(0.001)));
+    DB_Set(&sim, ATT_Q0,      (int32_t) (hc >> 14) + DB_Noise(&seed, UTI_Q16FromFloat(0.0005)));
+    DB_Set(&sim, ATT_Q1,      DB_Noise(&seed, UTI_Q16FromFloat(0.0005)));
+    DB_Set(&sim, ATT_Q2,      (int32_t) (hs >> 14) + DB_Noise(&seed, UTI_Q16FromFloat(0.0005)));
+    DB_Set(&sim, ATT_Q3,      DB_Noise(&seed, UTI_Q16FromFloat(0.0005)));
+    DB_Set(&sim, ADCS_MODE,   (k < 600) ? ADCS_BDOT : ADCS_FULL);
+    DB_Set(&sim, PL_SCENARIO, (k >= 3000 && k < 3600) ? 1 : (k >= 8000 && k < 8300) ? 2 : 0);
+
+    // Note(2)
+    if(k % APP_CFG_HK_KEYFRAME == 0)
+      DB_Force(&sim, DB_STORE);
+    while((mask = DB_Take(&sim, DB_STORE, MSGQ_REC_PAYLOAD - DB_DELTA_HDR)) != 0){
+      len = DB_Pack(&sim, DB_STORE, mask, (uint64_t) k * 1000000, buf);
+      if(DB_Unpack(buf, len, &time, val) != len || time != (uint64_t) k * 1000000)
+        res->errors++;
+      res->records++;
+      res->deltaBytes += len;
+      res->slowDelta  += DB_DeltaSize(mask & DB_SLOW) - DB_DELTA_HDR;
+    }
+
+    // Note(3)
+    exact = 0;
+    for(i = 0; i < DB_NB_FIELDS; i++){
+      if(k == 0 || DB_Get(&sim, i) != prev[i])
+        exact |= 1uL << i;
+      prev[i] = DB_Get(&sim, i);
+    }
+    if(exact != 0)
+      res->exactBytes += DB_DeltaSize(exact);
+    res->fullBytes += DB_DeltaSize(DB_ALL) - 4;
+    res->slowFull  += DB_DeltaSize(DB_SLOW) - DB_DELTA_HDR;
+
+    // Note(4)
+    for(i = 0; i < DB_NB_FIELDS; i++){
+      t = (int64_t) val[i] - DB_Get(&sim, i);
+      if(t < 0)
+        t = -t;
+      if(t > dbFields[i].deadband)
+        res->errors++;
+      if(dbFields[i].deadband > 0){
+        err = (INT32U) (t * 100 / dbFields[i].deadband);
+        if(err > res->errMax)
+          res->errMax = err;
+      }
+    }
+
+    // Next phase
+    t  = (c * DB_TEST_COS - s * DB_TEST_SIN) >> 30;
+    s  = (s * DB_TEST_COS + c * DB_TEST_SIN) >> 30;
+    c  = t;
+    t  = (hc * DB_TEST_HCOS - hs * DB_TEST_HSIN) >> 30;
+    hs = (hs * DB_TEST_HCOS + hc * DB_TEST_HSIN) >> 30;
+    hc = t;
+  }
+
+  res->samples = DB_TEST_SAMPLES;
+  res->pass = (res->errors == 0 && res->deltaBytes < res->exactBytes);
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Uniform noise in [-amp, amp]
+static int32_t DB_Noise(uint32_t *seed, int32_t amp){
+
+  return (int32_t) ((int64_t) (UTI_Rand(seed) >> 8) * (2 * amp + 1) >> 24) - amp;
 }
\ No newline at end of file
@@ -23,20 +23,74 @@ extern "C" {
 #endif
 
 
+#define ADCS_OFF        0
 #define ADCS_BDOT       1
 #define ADCS_FULL       2
   
-#define GYRO_X          1
-#define GYRO_Y          2
-#define GYRO_Z          3
+// Fields of the database tracked for changes (bit of the change masks, see DB_Set())
+#define GYRO_X          0
+#define GYRO_Y          1
+#define GYRO_Z          2
+#define GYRO_XDRIFT     3
+#define GYRO_YDRIFT     4
+#define GYRO_ZDRIFT     5
+#define GYRO_TEMP       6
   
-#define MAG1_X          4
-#define MAG1_Y          5
-#define MAG1_Z          6
+#define MAG1_X          7
+#define MAG1_Y          8
+#define MAG1_Z          9
   
-#define MAG2_X          7
-#define MAG2_Y          8
-#define MAG3_Z          9
+#define MAG2_X          10
+#define MAG2_Y          11
+#define MAG2_Z          12
+  
+#define MTQ_X           13
+#define MTQ_Y           14
+#define MTQ_Z           15
+  
+#define ATT_Q0          16
+#define ATT_Q1          17
+#define ATT_Q2          18
+#define ATT_Q3          19
+  
+#define ADCS_MODE       20
+#define PL_SCENARIO     21
+  
+#define DB_NB_FIELDS    22
+#define DB_ALL          ((INT32U) ((1uL << DB_NB_FIELDS) - 1))
+  
+// Consumers of the changes, each with its own change mask
+#define DB_STORE        0       // HK log (see app_data_management.c)
+#define DB_TLM          1       // Serial telemetry (see app_display.c)
+#define DB_NB_CONS      2
+  
+// Time stamps (see DB_SetTime())
+#define DB_TIME_GYRO    0
+#define DB_TIME_MAG1    1
+#define DB_TIME_MAG2    2
+#define DB_TIME_HK      3
+#define DB_NB_TIMES     4
+  
+// Blocks of the database (see DB_Copy())
+#define DB_BLK_SENSOR   0x01
+#define DB_BLK_ADCS     0x02
+#define DB_BLK_HK       0x04
+#define DB_NB_BLOCKS    3
+  
+// Delta record: time, mask of the fields, then the value of each field of the mask in field order,
+// on the size of the field (little-endian)
+#define DB_DELTA_TIME   0       // 8: time (us)
+#define DB_DELTA_MASK   8       // 4
+#define DB_DELTA_HDR    12
+  
+// Statistics record: header of a delta record, DB_STAT_REC in the mask, then for each field of the
+// mask: samples over the window (2, saturated), min, max, mean and standard deviation on the size of
+// the field (see DB_PackStats())
+#define DB_STAT_REC     0x80000000uL
+  
+// Self-test (see DB_SelfTest())
+#define DB_TEST_SAMPLES 10800   // HK periods of 1 s (two orbits)
+#define DB_TEST_ORBIT   5400    // Orbit period (HK periods)
   
   
 /********************************************************************************************************
@@ -44,42 +98,84 @@ extern "C" {
 ********************************************************************************************************/
 
 
-// Application database structure
+// Change tracking: each field written is compared to the value last emitted to each consumer, and
+// flagged in the mask of the consumer when beyond the deadband of the field
+typedef struct DbChange DB_CHANGE;
+struct DbChange {
+  INT32U  dirty[DB_NB_CONS];                 // Fields to emit, per consumer (bit: field)
+  int32_t ref[DB_NB_CONS][DB_NB_FIELDS];     // Values last emitted
+  // Statistics
+  INT32U  sets;                              // Values written
+  INT32U  marks;                             // Values flagged (any consumer)
+  INT32U  records[DB_NB_CONS];               // Delta records emitted
+  INT32U  bytes[DB_NB_CONS];                 // Size of the delta records
+  INT32U  fullBytes[DB_NB_CONS];             // Size of the same records as full snapshots
+};
+
+
+// Self-test results: two orbits of simulated HK and sensor values, stored as delta records
+typedef struct DbTest DB_TEST;
+struct DbTest {
+  INT32U  samples;
+  INT32U  records;                           // Delta records (HK record payload at most)
+  INT32U  fullBytes;                         // Full snapshot every sample
+  INT32U  exactBytes;                        // Delta records of the fields changed by any amount
+  INT32U  deltaBytes;                        // Delta records with the deadbands
+  INT32U  slowFull;                          // The same for the slowly varying values (temperature,
+  INT32U  slowDelta;                         // drifts, modes)
+  INT32U  errMax;                            // Largest error of a value rebuilt from the records,
+                                             // in percent of its deadband
+  INT32U  errors;                            // Values beyond their deadband, or records not decoded
+  BOOLEAN pass;
+};
+
+
+// Blocks of the database, one per writer, in the order of their update rate. Each one is naturally
+// aligned (64-bit time stamps first, then 32, 16 and 8-bit values), raw integers only.
+
+// Sensor task, database rate (APP_CFG_SEN_DATA_PERIOD_MS)
+typedef struct DbSensor DB_SENSOR;
+struct DbSensor {
+  uint64_t gyroTime;     // Gyroscope time of last measurement (us, see TIME_NowUs())
+  uint64_t mag1Time;     // MagMet1 time of last measurement
+  uint64_t mag2Time;     // MagMet2 time of last measurement
+  q16_t    gyro[3];      // Gyroscope measurements, drift removed (deg/s, Q16.16)
+  q16_t    gyroDrift[3]; // Estimated drift (see gyrobias.c)
+  q16_t    gyroTemp;     // Gyroscope temperature (deg C, Q16.16)
+  q16_t    mag1[3];      // MagMet1 measurements (mG, Q16.16)
+  q16_t    att[4];       // Attitude quaternion, body to reference frame (Q16.16, see attitude.c)
+  INT16S   mag2[3];      // MagMet2 measurements (mG, see APP_CFG_SEN_MAG2_EN)
+  INT16U   spare;
+};
+
+// ADCS control task, magnetometer rate
+typedef struct DbAdcs DB_ADCS;
+struct DbAdcs {
+  q16_t    mtq[3];       // Magnetorquer dipole commands (A.m^2, Q16.16, see app_adcs.c)
+  INT8U    mode;         // Current ADCS mode
+  INT8U    spare[3];
+};
+
+// Housekeeping task, HK period
+typedef struct DbHk DB_HK;
+struct DbHk {
+  uint64_t time;         // Housekeeping time of last measurement
+  INT8U    plScenario;   // Current PL scenario (0 if no scenario is running)
+  INT8U    spare[7];
+};
+
+// Application database structure. Accessed through the DB_xxx functions only (dataMutex held), so
+// that the layout can change without touching the callers.
 typedef struct AppData APPDATA;
 struct AppData {
-  
-  float gyro_X;          // Gyroscope measurements
-  float gyro_Xdrift;
-  float gyro_Y;
-  float gyro_Ydrift;
-  float gyro_Z;
-  float gyro_Zdrift;
-  float gyro_temp;
-  INT32U gyro_time;      // Gyroscope time of last measurement
-  
-  float mag1_X;         // MagMet1 measurements
-  float mag1_Y;
-  float mag1_Z;
-  INT32U mag1_time;      // MagMet1 time of last measurement
-  
-  INT16S mag2_X;         // MagMet2 measurements
-  INT16S mag2_Y;
-  INT16S mag2_Z;
-  INT32U mag2_time;      // MagMet2 time of last measurement
+  DB_SENSOR  sen;
+  DB_ADCS    adcs;
+  DB_HK      hk;
+  DB_CHANGE *change;     // Change tracking (NULL: none, see DB_Set())
+  RSTAT_SET *stats;      // Running statistics of the fields (NULL: none, see app_stats.c)
+};
 
-  BOOLEAN changeTbl[9];  // Variable change flag
 
-  //                     // Housekeeping variables
-  INT32U hk_time;        // Housekeeping time of last measurement
-  
-  //                     // Statistics variables
-  
-  INT8U adcs_mode;       // Current ADCS mode
-  INT8U pl_scenario;     // Current PL scenario (0 if no scenario is running)
-  
-};
-  
-  
 
 
 /********************************************************************************************************
@@ -88,6 +184,26 @@ struct AppData {
 
 APPDATA* APP_AppDataPtr();
 
+void        DB_Set(APPDATA *d, INT8U field, int32_t value);
+void        DB_SetVec(APPDATA *d, INT8U field, const int32_t *value, INT8U nb);
+int32_t     DB_Get(const APPDATA *d, INT8U field);
+void        DB_SetTime(APPDATA *d, INT8U id, uint64_t time);
+uint64_t    DB_GetTime(const APPDATA *d, INT8U id);
+void        DB_Copy(APPDATA *dst, const APPDATA *src, INT8U blocks);
+INT32U      DB_Pending(const APPDATA *d, INT8U cons);
+void        DB_GetChange(const APPDATA *d, DB_CHANGE *change);
+RSTAT_SET*  DB_Stats(APPDATA *d);
+void        DB_Force(APPDATA *d, INT8U cons);
+INT32U      DB_Take(APPDATA *d, INT8U cons, INT8U room);
+INT8U       DB_Pack(APPDATA *d, INT8U cons, INT32U mask, uint64_t time, INT8U *buf);
+INT8U       DB_Unpack(const INT8U *buf, INT8U len, uint64_t *time, int32_t *val);
+INT8U       DB_DeltaSize(INT32U mask);
+INT8U       DB_PackStats(APPDATA *d, INT8U *field, uint64_t time, INT8U *buf, INT8U size);
+const char* DB_FieldName(INT8U field);
+INT32U      DB_FieldUnit(INT8U field);
+
+void        DB_SelfTest(DB_TEST *res);
+
 
 
 #ifdef __cplusplus
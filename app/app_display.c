@@ -38,9 +38,11 @@ uint8_t allowDisplay = false;
 */
 
 void printOSStat();
-void printGyro();
-void printMag1();
-void printMag2();
+void printGyro(const APPDATA *d);
+void printMag1(const APPDATA *d);
+void printMag2(const APPDATA *d);
+INT8U takeDelta(INT8U *rec);
+void printDelta(const INT8U *rec, INT8U len);
 
 
 
@@ -63,32 +65,46 @@ void printMag2();
 /* Notes      :(1) The first line of code is used to prevent a compiler warning because 'p_arg' is not
 *                   used.  The compiler should not generate any code for this statement.
 *
+*             :(2) The sensor block and the pending changes are copied under dataMutex, and printed
+*                   once it is released: the writers are not held for the duration of the UART output.
+*
 ********************************************************************************************************/
 
 void APP_SerialDisplay(void *Ptr_Arg){
   
   (void)Ptr_Arg; /* Note(1) */
   INT8U err;
+  static APPDATA snap;
+  static INT8U   delta[DB_DELTA_HDR + 4 * DB_NB_FIELDS];
+  INT8U          deltaLen = 0;
   
   while(1){
     
     if( allowDisplay == true ) {
       
       OSMutexPend(dataMutex, 0, &err);    // Wait for resource to be available
+      DB_Copy(&snap, APP_AppDataPtr(), DB_BLK_SENSOR);                // Note(2)
+      #if (PRINT_DELTA_EN > 0)
+        deltaLen = takeDelta(delta);
+      #endif
+      OSMutexPost(dataMutex);             // Make the resource available to other tasks
+    
+      // Keep the console out of EM2 while it is in use
+      PWR_ConsoleActivity();
     
       // Print Gyro measurements
       #if (PRINT_GYRO_EN > 0)
-        printGyro();
+        printGyro(&snap);
       #endif
     
       // Print Mag1 measurements
       #if (PRINT_MAG1_EN > 0)
-        printMag1();
+        printMag1(&snap);
       #endif
     
       // Print Mag2 measurements
       #if (PRINT_MAG2_EN > 0)
-        printMag2();
+        printMag2(&snap);
       #endif
   
       // Print OS statistics (task usage, CPU usage, etc)
@@ -96,13 +112,16 @@ void APP_SerialDisplay(void *Ptr_Arg){
         printOSStat();
       #endif
     
+      // Print the fields changed since the last display (delta telemetry)
+      #if (PRINT_DELTA_EN > 0)
+        printDelta(delta, deltaLen);
+      #endif
+    
       // Print separation carriage return
       printf("\n");
-    
-      OSMutexPost(dataMutex);             // Make the resource available to other tasks
     }
     
-    OSTimeDlyHMSM(0, 0, DISP_FREQ_S, DISP_FREQ_MS);
+    OSTimeDly(PARAM_Get(&params, PARAM_DISP_PERIOD_MS) * OS_TICKS_PER_SEC / 1000);
   }
 }
 
@@ -196,7 +215,7 @@ void printOSStat(){
   int i;
   uint16_t totalFreeMem = 0;
   uint16_t totalUsedMem = 0;
-  OS_STK_DATA data[TASK_USER_NB];
+  STKMON_TASK data[TASK_USER_NB];
   
   // Create priority table 
   // IMPORTANT!: MUST BE IN THE SAME ORDER AS THE PRIORITY TASK IDs DEFINED IN APP_CFG.H
@@ -208,13 +227,14 @@ void printOSStat(){
                                 APP_CFG_SEN_DATA_PRIO,
                                 APP_CFG_HK_DATA_PRIO,
                                 APP_CFG_PL_DATA_PRIO,
-                                APP_CFG_SEN_TIME_PRIO };  
+                                APP_CFG_SEN_TIME_PRIO,
+                                APP_CFG_ADCS_PRIO };  
   
-  // Compute stack statistics and total free and used memory
+  // Get the stack watermarks (maintained by the statistics task) and total free and used memory
   for(i = 0; i < TASK_USER_NB; i++){
-    OSTaskStkChk(prioTable[i], data+i);
-    totalFreeMem += data[i].OSFree;
-    totalUsedMem += data[i].OSUsed;
+    STKMON_GetTask(i, data+i);
+    totalFreeMem += data[i].free;
+    totalUsedMem += data[i].size - data[i].free;
   }
  
     
@@ -224,15 +244,16 @@ void printOSStat(){
   printf("------------------------------------------- \n");
   printf("Task name | Prio | Tot. | Free | Used | CPU \n");
   printf("------------------------------------------- \n");
-  printf("Serial D. | %4d | %4d | %4d | %4d | -- \n", prioTable[SERIAL_DISP_ID], APP_CFG_SERIAL_DISP_STK_SIZE, data[SERIAL_DISP_ID].OSFree, data[SERIAL_DISP_ID].OSUsed);
-  printf("LED Disp. | %4d | %4d | %4d | %4d | -- \n", prioTable[LED_DISP_ID], APP_CFG_LED_DISP_STK_SIZE, data[LED_DISP_ID].OSFree, data[LED_DISP_ID].OSUsed);
-  printf("Command   | %4d | %4d | %4d | %4d | -- \n", prioTable[COMMAND_ID], APP_CFG_COMMAND_STK_SIZE, data[COMMAND_ID].OSFree, data[COMMAND_ID].OSUsed);
-  printf("Mem. Man. | %4d | %4d | %4d | %4d | -- \n", prioTable[MEM_MAN_ID], APP_CFG_MEM_MAN_STK_SIZE, data[MEM_MAN_ID].OSFree, data[MEM_MAN_ID].OSUsed);
-  printf("Sen. Data | %4d | %4d | %4d | %4d | -- \n", prioTable[SEN_DATA_ID], APP_CFG_SEN_DATA_STK_SIZE, data[SEN_DATA_ID].OSFree, data[SEN_DATA_ID].OSUsed);
-  printf("HK Data   | %4d | %4d | %4d | %4d | -- \n", prioTable[HK_DATA_ID], APP_CFG_HK_DATA_STK_SIZE, data[HK_DATA_ID].OSFree, data[HK_DATA_ID].OSUsed);
-  printf("PL Data   | %4d | %4d | %4d | %4d | -- \n", prioTable[PL_DATA_ID], APP_CFG_PL_DATA_STK_SIZE, data[PL_DATA_ID].OSFree, data[PL_DATA_ID].OSUsed);
-  printf("Sen. Time | %4d | %4d | %4d | %4d | -- \n", prioTable[SEN_TIME_ID], APP_CFG_PL_DATA_STK_SIZE, data[SEN_TIME_ID].OSFree, data[SEN_TIME_ID].OSUsed);
-  printf("Tsk Start | %4d | %4d | %4d | %4d | -- \n", prioTable[TASK_START_ID], APP_CFG_TASK_START_STK_SIZE, data[TASK_START_ID].OSFree, data[TASK_START_ID].OSUsed);
+  printf("Serial D. | %4d | %4d | %4d | %4d | -- \n", prioTable[SERIAL_DISP_ID], APP_CFG_SERIAL_DISP_STK_SIZE, (int) data[SERIAL_DISP_ID].free, (int) (data[SERIAL_DISP_ID].size - data[SERIAL_DISP_ID].free));
+  printf("LED Disp. | %4d | %4d | %4d | %4d | -- \n", prioTable[LED_DISP_ID], APP_CFG_LED_DISP_STK_SIZE, (int) data[LED_DISP_ID].free, (int) (data[LED_DISP_ID].size - data[LED_DISP_ID].free));
+  printf("Command   | %4d | %4d | %4d | %4d | -- \n", prioTable[COMMAND_ID], APP_CFG_COMMAND_STK_SIZE, (int) data[COMMAND_ID].free, (int) (data[COMMAND_ID].size - data[COMMAND_ID].free));
+  printf("Mem. Man. | %4d | %4d | %4d | %4d | -- \n", prioTable[MEM_MAN_ID], APP_CFG_MEM_MAN_STK_SIZE, (int) data[MEM_MAN_ID].free, (int) (data[MEM_MAN_ID].size - data[MEM_MAN_ID].free));
+  printf("Sen. Data | %4d | %4d | %4d | %4d | -- \n", prioTable[SEN_DATA_ID], APP_CFG_SEN_DATA_STK_SIZE, (int) data[SEN_DATA_ID].free, (int) (data[SEN_DATA_ID].size - data[SEN_DATA_ID].free));
+  printf("HK Data   | %4d | %4d | %4d | %4d | -- \n", prioTable[HK_DATA_ID], APP_CFG_HK_DATA_STK_SIZE, (int) data[HK_DATA_ID].free, (int) (data[HK_DATA_ID].size - data[HK_DATA_ID].free));
+  printf("PL Data   | %4d | %4d | %4d | %4d | -- \n", prioTable[PL_DATA_ID], APP_CFG_PL_DATA_STK_SIZE, (int) data[PL_DATA_ID].free, (int) (data[PL_DATA_ID].size - data[PL_DATA_ID].free));
+  printf("Sen. Time | %4d | %4d | %4d | %4d | -- \n", prioTable[SEN_TIME_ID], APP_CFG_SEN_TIME_STK_SIZE, (int) data[SEN_TIME_ID].free, (int) (data[SEN_TIME_ID].size - data[SEN_TIME_ID].free));
+  printf("ADCS Ctl. | %4d | %4d | %4d | %4d | -- \n", prioTable[ADCS_ID], APP_CFG_ADCS_STK_SIZE, (int) data[ADCS_ID].free, (int) (data[ADCS_ID].size - data[ADCS_ID].free));
+  printf("Tsk Start | %4d | %4d | %4d | %4d | -- \n", prioTable[TASK_START_ID], APP_CFG_TASK_START_STK_SIZE, (int) data[TASK_START_ID].free, (int) (data[TASK_START_ID].size - data[TASK_START_ID].free));
   printf("------------------------------------------- \n");
   printf("Total     |  --  | %4d | %4d | %4d | %2d \n", APP_CFG_TOTAL_STK_SIZE, totalFreeMem, totalUsedMem, OSCPUUsage);
   printf("------------------------------------------- \n");
@@ -243,30 +264,74 @@ void printOSStat(){
 
 /******************************************************************************/
 
-void printGyro(){
-  printf("Gyro measurements (deg/s and 10*celsius): \n");
-  printf("X:%3d / Y:%3d / Z:%3d / T: %d / t: %d\n", 
-         (int) (APP_AppDataPtr()->gyro_X/*-APP_AppDataPtr()->gyro_Xdrift*/),
-         (int) (APP_AppDataPtr()->gyro_Y/*-APP_AppDataPtr()->gyro_Ydrift*/),
-         (int) (APP_AppDataPtr()->gyro_Z/*-APP_AppDataPtr()->gyro_Zdrift*/),
-         (int) (APP_AppDataPtr()->gyro_temp*10),
-         (int) (APP_AppDataPtr()->gyro_time));
+void printGyro(const APPDATA *d){
+  printf("Gyro measurements, drift corrected (deg/s and 10*celsius, t in ms): \n");
+  printf("X:%3d / Y:%3d / Z:%3d / T: %d / t: %lu\n", 
+         (int) UTI_Q16ToFloat(DB_Get(d, GYRO_X)),
+         (int) UTI_Q16ToFloat(DB_Get(d, GYRO_Y)),
+         (int) UTI_Q16ToFloat(DB_Get(d, GYRO_Z)),
+         (int) (UTI_Q16ToFloat(DB_Get(d, GYRO_TEMP))*10),
+         (unsigned long) (DB_GetTime(d, DB_TIME_GYRO) / 1000));
 }
 
 /******************************************************************************/
 
-void printMag1(){
+void printMag1(const APPDATA *d){
   printf("Mag1 measurements (mG): \n");
   printf("X:%4d / Y:%4d / Z:%4d \n",
-         (int) (APP_AppDataPtr()->mag1_X),
-         (int) (APP_AppDataPtr()->mag1_Y),
-         (int) (APP_AppDataPtr()->mag1_Z));
+         (int) UTI_Q16ToFloat(DB_Get(d, MAG1_X)),
+         (int) UTI_Q16ToFloat(DB_Get(d, MAG1_Y)),
+         (int) UTI_Q16ToFloat(DB_Get(d, MAG1_Z)));
 }
 
 /******************************************************************************/
 
-void printMag2(){
+void printMag2(const APPDATA *d){
+#if (APP_CFG_SEN_MAG2_EN > 0)
+  printf("Mag2 measurements (mG): \n");
+  printf("X:%4d / Y:%4d / Z:%4d \n",
+         (int) DB_Get(d, MAG2_X),
+         (int) DB_Get(d, MAG2_Y),
+         (int) DB_Get(d, MAG2_Z));
+#else
+  (void) d;
   printf("Mag2 measurements: \nUNAVAILABLE \n");
+#endif
+}
+
+/******************************************************************************/
+
+// Changes for the telemetry consumer, taken as one delta record. Called with dataMutex held.
+INT8U takeDelta(INT8U *rec){
+  
+  INT32U mask;
+  
+  mask = DB_Take(APP_AppDataPtr(), DB_TLM, 4 * DB_NB_FIELDS);
+  if(mask == 0)
+    return 0;
+  return DB_Pack(APP_AppDataPtr(), DB_TLM, mask, DB_GetTime(APP_AppDataPtr(), DB_TIME_GYRO), rec);
+}
+
+/******************************************************************************/
+
+// Delta record taken by takeDelta() (raw values, Q16.16 for the measurements)
+void printDelta(const INT8U *rec, INT8U len){
+  
+  int32_t  val[DB_NB_FIELDS];
+  uint64_t time;
+  INT32U   mask;
+  INT8U    i;
+  
+  if(len == 0 || DB_Unpack(rec, len, &time, val) == 0)
+    return;
+  mask = (INT32U) rec[DB_DELTA_MASK] | ((INT32U) rec[DB_DELTA_MASK + 1] << 8) |
+         ((INT32U) rec[DB_DELTA_MASK + 2] << 16) | ((INT32U) rec[DB_DELTA_MASK + 3] << 24);
+  
+  printf("Changes (%u bytes): \n", (unsigned) len);
+  for(i = 0; i < DB_NB_FIELDS; i++)
+    if(mask & (1uL << i))
+      printf("%s:%ld ", DB_FieldName(i), (long) val[i]);
+  printf("\n");
 }
 
 
@@ -34,8 +34,9 @@ extern "C" {
 #define PRINT_MAG1_EN           1U
 #define PRINT_MAG2_EN           0U
 #define PRINT_OS_STAT_EN        1U
+#define PRINT_DELTA_EN          1U      // Fields changed beyond their deadband only (see app_database.c)
 
-// Defines the refresh rate of the display (refresh rate = S + MS)
+// Defines the default refresh rate of the display (refresh rate = S + MS, see PARAM_DISP_PERIOD_MS)
 #define DISP_FREQ_S             0       // Max 59
 #define DISP_FREQ_MS            250     // Max 999
   
@@ -121,8 +121,13 @@ void App_TaskDelHook(OS_TCB *ptcb)
 #if OS_VERSION >= 251
 void App_TaskIdleHook(void)
 {
-  /* Go to Energy Mode 1 depending on application      */
-  EMU_EnterEM1();
+#if (APP_CFG_VTIME_EN > 0)
+  /* Virtual time: jump to the next scheduled wake-up  */
+  VTIME_IdleHook();
+#else
+  /* Sleep until the next task timeout (EM1 or EM2)    */
+  PWR_IdleHook();
+#endif
 }
 #endif
 
@@ -178,6 +183,9 @@ void App_TaskStatHook(void) //have the lowest priority (exec when CPU's idle)
       taskUserData[i].taskExecTime = 0;
     }
   }
+  
+  // Check a slice of the task stacks
+  STKMON_StatHook();
 }
 
 
@@ -211,6 +219,9 @@ void App_TaskSwHook(void)       //Statistic acquirement
   puser = OSTCBCur->OSTCBExtPtr;
   if(puser != (TASK_USER_DATA*)0)
     puser->taskExecTime += delay;
+  
+  // Cycle accurate execution time for the timing monitor
+  TMON_SwitchHook();
 }
 #endif
 
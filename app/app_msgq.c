@@ -0,0 +1,260 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_msgq.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Inter-task message pipeline. A producer takes a fixed-size record from a pool
+(uC/OS-II memory partition), fills it and posts its address to a queue. The
+consumer pends on the queue, processes the record in place and gives it back
+to the pool. No data is copied, and several messages can be waiting for the
+consumer, unlike with a mailbox.
+
+The pools keep their low-water mark and the number of failed allocations, the
+queues their high-water mark and the number of failed posts.
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+
+/********************************************************************************************************
+*                                         MSGQ_PoolCreate()
+*
+* @brief      Creates a pool of fixed-size records
+*
+* @param[in]  pool        pool to initialise
+* @param[in]  storage     memory of the pool, nbBlks * blkSize bytes, 32-bit aligned
+* @param[in]  nbBlks      number of records
+* @param[in]  blkSize     size of a record (bytes)
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void MSGQ_PoolCreate(MSGQ_POOL *pool, void *storage, INT32U nbBlks, INT32U blkSize){
+
+  INT8U err;
+
+  pool->mem       = OSMemCreate(storage, nbBlks, blkSize, &err);
+  pool->seq       = 0;
+  pool->nbBlks    = nbBlks;
+  pool->minFree   = nbBlks;
+  pool->exhausted = 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         MSGQ_Alloc()
+*
+* @brief      Takes a record from a pool and initialises its header
+*
+* @param[in]  pool        pool to allocate from
+* @param[in]  type        record type (MSGQ_REC_xxx)
+* @exception  none
+* @return     the record, NULL if the pool is empty
+*
+********************************************************************************************************/
+
+MSGQ_RECORD* MSGQ_Alloc(MSGQ_POOL *pool, INT8U type){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  MSGQ_RECORD *rec;
+  INT8U err;
+
+  rec = (MSGQ_RECORD *) OSMemGet(pool->mem, &err);
+
+  OS_ENTER_CRITICAL();
+  if(rec == (MSGQ_RECORD *)0){
+    pool->exhausted++;
+    OS_EXIT_CRITICAL();
+    return rec;
+  }
+  if(pool->mem->OSMemNFree < pool->minFree)
+    pool->minFree = pool->mem->OSMemNFree;
+  rec->seq = pool->seq++;
+  OS_EXIT_CRITICAL();
+
+  rec->type = type;
+  rec->len  = 0;
+  rec->time = TIME_NowUs();
+
+  return rec;
+}
+
+
+
+/********************************************************************************************************
+*                                         MSGQ_Free()
+*
+* @brief      Gives a record back to its pool
+*
+* @param[in]  pool        pool the record was allocated from
+* @param[in]  rec         record
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void MSGQ_Free(MSGQ_POOL *pool, MSGQ_RECORD *rec){
+
+  OSMemPut(pool->mem, (void *)rec);
+}
+
+
+
+/********************************************************************************************************
+*                                         MSGQ_QueueCreate()
+*
+* @brief      Creates a message queue
+*
+* @param[in]  queue       queue to initialise
+* @param[in]  storage     array of size pointers for the queue entries
+* @param[in]  size        maximum number of messages in the queue
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void MSGQ_QueueCreate(MSGQ_QUEUE *queue, void **storage, INT16U size){
+
+  queue->event    = OSQCreate(storage, size);
+  queue->size     = size;
+  queue->hwm      = 0;
+  queue->posted   = 0;
+  queue->received = 0;
+  queue->full     = 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         MSGQ_Post()
+*
+* @brief      Posts a record to a queue. If the queue is full, the record is given back to its pool.
+*
+* @param[in]  queue       queue
+* @param[in]  pool        pool the record was allocated from
+* @param[in]  rec         record
+* @exception  none
+* @return     OS_ERR_NONE, or OS_ERR_Q_FULL if the record was dropped
+*/
+/* Notes      :(1) The consumer may run (and empty the queue) inside OSQPost(), so the depth is taken
+*                   just before the post.
+*
+********************************************************************************************************/
+
+INT8U MSGQ_Post(MSGQ_QUEUE *queue, MSGQ_POOL *pool, MSGQ_RECORD *rec){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT16U depth;
+  INT8U  err;
+
+  OS_ENTER_CRITICAL();                                      // Note(1)
+  depth = ((OS_Q *)queue->event->OSEventPtr)->OSQEntries + 1;
+  OS_EXIT_CRITICAL();
+
+  err = OSQPost(queue->event, (void *)rec);
+
+  OS_ENTER_CRITICAL();
+  if(err == OS_ERR_NONE){
+    queue->posted++;
+    if(depth > queue->hwm)
+      queue->hwm = depth;
+  }
+  else
+    queue->full++;
+  OS_EXIT_CRITICAL();
+
+  if(err != OS_ERR_NONE)
+    MSGQ_Free(pool, rec);
+
+  return err;
+}
+
+
+
+/********************************************************************************************************
+*                                         MSGQ_Pend()
+*
+* @brief      Waits for a record on a queue
+*
+* @param[in]  queue       queue
+* @param[in]  timeout     timeout (ticks), 0 to wait forever
+* @param[out] err         OS_ERR_NONE, OS_ERR_TIMEOUT, ... (see OSQPend())
+* @exception  none
+* @return     the record, NULL on error. It must be given back to its pool once processed.
+*
+********************************************************************************************************/
+
+MSGQ_RECORD* MSGQ_Pend(MSGQ_QUEUE *queue, INT32U timeout, INT8U *err){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  MSGQ_RECORD *rec;
+
+  rec = (MSGQ_RECORD *) OSQPend(queue->event, timeout, err);
+
+  if(*err == OS_ERR_NONE){
+    OS_ENTER_CRITICAL();
+    queue->received++;
+    OS_EXIT_CRITICAL();
+  }
+
+  return rec;
+}
+
+
+
+/********************************************************************************************************
+*                                   MSGQ_GetPoolStats() / MSGQ_GetQueueStats()
+*
+* @brief      Return a consistent copy of the statistics of a pool (resp. queue) and its current number
+*             of free blocks (resp. queued messages)
+*
+* @param[in]  pool/queue  pool (resp. queue)
+* @param[out] stats       copy of the pool (resp. queue) structure
+* @param[out] nbFree/depth  current number of free blocks (resp. queued messages)
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void MSGQ_GetPoolStats(MSGQ_POOL *pool, MSGQ_POOL *stats, INT32U *nbFree){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  *stats  = *pool;
+  *nbFree = pool->mem->OSMemNFree;
+  OS_EXIT_CRITICAL();
+}
+
+/******************************************************************************/
+
+void MSGQ_GetQueueStats(MSGQ_QUEUE *queue, MSGQ_QUEUE *stats, INT16U *depth){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  *stats = *queue;
+  *depth = ((OS_Q *)queue->event->OSEventPtr)->OSQEntries;
+  OS_EXIT_CRITICAL();
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_msgq.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the inter-task message pipeline:
+fixed-size record pools (uC/OS-II memory partitions) and message queues
+carrying pointers to these records, with their usage statistics.
+
+******************************************************************************/
+
+#ifndef __APP_MSGQ_H
+#define __APP_MSGQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Record types
+#define MSGQ_REC_SENSOR         1       // Sensor measurements (MSGQ_SEN_DATA)
+#define MSGQ_REC_HK             2       // Housekeeping data
+
+#define MSGQ_REC_PAYLOAD        56u     // Payload size of a record (bytes)
+
+#define MSGQ_SEN_NB_VAL         11      // Values of MSGQ_SEN_DATA (time excluded)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Sensor measurements record payload
+typedef struct MsgqSenData MSGQ_SEN_DATA;
+
+struct MsgqSenData {
+  uint64_t gyroTime;                    // us (see TIME_NowUs())
+  q16_t    gyro[3];                     // deg/s
+  q16_t    gyroTemp;                    // deg C
+  q16_t    mag1[3];                     // mG
+  q16_t    att[4];                      // Attitude quaternion
+};
+
+// Record exchanged between tasks. Allocated from a MSGQ_POOL, the queue only carries its address.
+typedef struct MsgqRecord MSGQ_RECORD;
+
+struct MsgqRecord {
+  INT8U  type;                          // MSGQ_REC_xxx
+  INT8U  len;                           // Number of payload bytes used
+  INT16U seq;                           // Sequence number (per pool)
+  uint64_t time;                        // Time when the record was allocated (us, see TIME_NowUs())
+  union {
+    INT8U         raw[MSGQ_REC_PAYLOAD];
+    MSGQ_SEN_DATA sen;
+  } data;
+};
+
+// Fixed-size block pool
+typedef struct MsgqPool MSGQ_POOL;
+
+struct MsgqPool {
+  OS_MEM *mem;
+  INT16U  seq;                          // Sequence number of the next record
+  INT32U  nbBlks;
+  INT32U  minFree;                      // Lowest number of free blocks seen (low-water mark)
+  INT32U  exhausted;                    // Allocations that failed, pool empty
+};
+
+// Message queue
+typedef struct MsgqQueue MSGQ_QUEUE;
+
+struct MsgqQueue {
+  OS_EVENT *event;
+  INT16U    size;
+  INT16U    hwm;                        // Highest number of queued messages seen (high-water mark)
+  INT32U    posted;
+  INT32U    received;
+  INT32U    full;                       // Posts that failed, queue full
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void         MSGQ_PoolCreate(MSGQ_POOL *pool, void *storage, INT32U nbBlks, INT32U blkSize);
+MSGQ_RECORD* MSGQ_Alloc(MSGQ_POOL *pool, INT8U type);
+void         MSGQ_Free(MSGQ_POOL *pool, MSGQ_RECORD *rec);
+
+void         MSGQ_QueueCreate(MSGQ_QUEUE *queue, void **storage, INT16U size);
+INT8U        MSGQ_Post(MSGQ_QUEUE *queue, MSGQ_POOL *pool, MSGQ_RECORD *rec);
+MSGQ_RECORD* MSGQ_Pend(MSGQ_QUEUE *queue, INT32U timeout, INT8U *err);
+
+void         MSGQ_GetPoolStats(MSGQ_POOL *pool, MSGQ_POOL *stats, INT32U *nbFree);
+void         MSGQ_GetQueueStats(MSGQ_QUEUE *queue, MSGQ_QUEUE *stats, INT16U *depth);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,430 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_power.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Power management of the CDMS. The idle task no longer wakes up on every 1 ms
+SysTick: when the next task timeout is far enough, the SysTick is stopped, the
+RTC (LFXO, keeps running in EM2) is programmed to wake the core at that
+timeout, and the core enters EM2. On wake-up the time actually slept is read
+back from the RTC and the kernel tick count is corrected accordingly.
+
+Peripherals that stop in EM2 can forbid it with PWR_EM2Block(); the tickless
+sleep then happens in EM1. The console USART only blocks EM2 during a console
+session: from an input or output until the console has been quiet for
+APP_CFG_CONSOLE_IDLE_MS.
+
+The time spent in each energy mode is accumulated with the RTC, so the run
+time (EM0) is known as well.
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static volatile INT32U rtcOverflows  = 0;   // Number of 24-bit RTC counter wraps
+static uint64_t        rtcStart      = 0;   // RTC time when PWR_Init() was called
+
+static INT32U          em2BlockCtr   = 0;   // Number of users preventing EM2
+static INT32U          tickRemainder = 0;   // Fraction of a tick carried between sleeps
+
+static BOOLEAN         consoleOpen   = FALSE;   // Console session holding an EM2 block
+static INT32U          consoleLast   = 0;   // OSTime of the last console activity
+
+static PWR_STATS       stats;
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void PWR_ConsoleWake(uint8_t pin);
+static void PWR_ConsoleClose(void);
+
+
+
+/********************************************************************************************************
+*                                         PWR_Init()
+*
+* @brief      Starts the RTC on the LFXO and resets the energy mode statistics
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void PWR_Init(void){
+
+  RTC_Init_TypeDef init = RTC_INIT_DEFAULT;
+
+  // Low frequency domain clocked by the 32.768 kHz crystal
+  CMU_ClockEnable(cmuClock_CORELE, true);
+  CMU_OscillatorEnable(cmuOsc_LFXO, true, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+  CMU_ClockEnable(cmuClock_RTC, true);
+
+  // Free running over the full 24-bit range, COMP0 is only used to wake up
+  init.comp0Top = false;
+  RTC_Init(&init);
+
+  RTC_IntClear(RTC_IF_OF | RTC_IF_COMP0);
+  RTC_IntEnable(RTC_IEN_OF);
+  NVIC_ClearPendingIRQ(RTC_IRQn);
+  NVIC_EnableIRQ(RTC_IRQn);
+
+  rtcStart = PWR_RtcGet();
+  tickRemainder = 0;
+  memset(&stats, 0, sizeof(stats));
+}
+
+
+
+/********************************************************************************************************
+*                                         PWR_IdleHook()
+*
+* @brief      Called by the idle task: sleeps until the next task timeout
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The sleep and the tick correction are done with interrupts disabled: WFI still wakes up
+*                   on a pending interrupt, but its handler only runs once the kernel time has been
+*                   advanced, so that neither the handler nor a task it readies sees a stale OSTime (a delay
+*                   started in between would otherwise be shortened by the correction). The context switch
+*                   requested by VTIME_Advance() is taken once interrupts are enabled again.
+*
+*               (2) The sub-tick phase of the SysTick is lost each time it is stopped (less than one tick
+*                   per sleep). The RTC time is exact, and its fraction of a tick is carried over.
+*
+*               (3) Waits shorter than APP_CFG_TICKLESS_MIN_TICKS are not worth reprogramming the RTC:
+*                   sleep in EM1 until the next SysTick interrupt as before. Also with interrupts disabled,
+*                   so that the handler, and the task it readies, run after the sleep has been measured
+*                   and are not counted as EM1 time.
+*
+*               (4) The last character written to the console may still be shifted out when its task
+*                   blocks: EM2 waits for the end of the transfer.
+*
+********************************************************************************************************/
+
+void PWR_IdleHook(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT32U start;
+  INT32U elapsed;
+#if (APP_CFG_TICKLESS_EN > 0)
+  INT32U next;
+  INT32U sleep;
+  INT32U ticks;
+  uint64_t scaled;
+  BOOLEAN deep;
+
+  PWR_ConsoleClose();
+
+  next = VTIME_NextWake();
+
+  if(next >= APP_CFG_TICKLESS_MIN_TICKS){
+
+    if(next > APP_CFG_TICKLESS_MAX_TICKS)
+      next = APP_CFG_TICKLESS_MAX_TICKS;
+
+    sleep = next * PWR_RTC_FREQ / OS_TICKS_PER_SEC;
+
+    OS_ENTER_CRITICAL();                                    // Note(1)
+
+    // Stop the tick and program the wake-up
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    start = RTC->CNT;
+    RTC_IntClear(RTC_IF_COMP0);
+    RTC_CompareSet(0, (start + sleep) & PWR_RTC_MASK);
+    RTC_IntEnable(RTC_IEN_COMP0);
+
+    deep = (em2BlockCtr == 0);
+#ifdef USART_CONNECTED
+    if(!(RETARGET_UART->STATUS & USART_STATUS_TXC))       // Note(4)
+      deep = FALSE;
+#endif
+    if(deep)
+      EMU_EnterEM2(true);                                   // Restore HFXO on wake-up
+    else
+      EMU_EnterEM1();
+
+    elapsed = (RTC->CNT - start) & PWR_RTC_MASK;
+    RTC_IntDisable(RTC_IEN_COMP0);
+    if(!(RTC->IF & RTC_IF_COMP0))
+      stats.earlyWakes++;
+    RTC_IntClear(RTC_IF_COMP0);
+
+    // Convert the time slept into kernel ticks                Note(2)
+    scaled = (uint64_t) elapsed * OS_TICKS_PER_SEC + tickRemainder;
+    ticks  = (INT32U) (scaled / PWR_RTC_FREQ);
+    tickRemainder = (INT32U) (scaled % PWR_RTC_FREQ);
+
+    // Restart the tick from a full period
+    SysTick->VAL   = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    if(deep){
+      stats.em2 += elapsed;
+      stats.em2Entries++;
+    }
+    else
+      stats.em1 += elapsed;
+
+    // Correct the kernel time and release the tasks that timed out
+    VTIME_Advance(ticks);
+
+    OS_EXIT_CRITICAL();
+    return;
+  }
+#endif
+
+  // Short wait: sleep in EM1 until the next interrupt      Note(3)
+  OS_ENTER_CRITICAL();
+  start = RTC->CNT;
+  EMU_EnterEM1();
+  elapsed = (RTC->CNT - start) & PWR_RTC_MASK;
+  stats.em1 += elapsed;
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/********************************************************************************************************
+*                                   PWR_EM2Block() / PWR_EM2Unblock()
+*
+* @brief      Prevents (resp. allows again) the idle task from entering EM2. Calls are counted, so
+*             several users can block EM2 independently.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void PWR_EM2Block(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  em2BlockCtr++;
+  OS_EXIT_CRITICAL();
+}
+
+/******************************************************************************/
+
+void PWR_EM2Unblock(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  if(em2BlockCtr > 0)
+    em2BlockCtr--;
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/********************************************************************************************************
+*                                         PWR_ConsoleInit()
+*
+* @brief      Wakes the console on its RX line: a falling edge (start bit) opens a console session
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) GPIO edge interrupts run in EM2, the USART does not: the first character typed on a
+*                   quiet console only wakes it up and is lost.
+*
+********************************************************************************************************/
+
+void PWR_ConsoleInit(void){
+
+  GPIOINT_CallbackRegister(RETARGET_RXPIN, PWR_ConsoleWake);
+  GPIO_IntConfig(RETARGET_RXPORT, RETARGET_RXPIN, FALSE, TRUE, TRUE);      // Note(1)
+
+  PWR_ConsoleActivity();
+}
+
+
+
+/********************************************************************************************************
+*                                         PWR_ConsoleActivity()
+*
+* @brief      Console input or output: blocks EM2 until the console has been quiet for
+*             APP_CFG_CONSOLE_IDLE_MS. Called by the tasks before they print, and on every received
+*             character.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void PWR_ConsoleActivity(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  consoleLast = OSTime;
+  if(!consoleOpen){
+    consoleOpen = TRUE;
+    em2BlockCtr++;
+  }
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/********************************************************************************************************
+*                                         PWR_GetStats()
+*
+* @brief      Returns the energy mode residency since PWR_Init() (in RTC ticks)
+*
+* @param[out] stats       PWR_STATS structure to fill
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void PWR_GetStats(PWR_STATS *res){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  uint64_t now = PWR_RtcGet();
+
+  OS_ENTER_CRITICAL();
+  *res = stats;
+  OS_EXIT_CRITICAL();
+
+  res->total = now - rtcStart;
+}
+
+
+
+/********************************************************************************************************
+*                                         RTC_IRQHandler()
+*
+* @brief      RTC interrupt: counts the counter overflows. COMP0 only wakes up the core, the idle hook
+*             handles and clears it.
+*
+********************************************************************************************************/
+
+void RTC_IRQHandler(void){
+
+  INT32U flags = RTC->IF;
+
+  if(flags & RTC_IF_OF)
+    rtcOverflows++;
+
+  RTC_IntClear(flags);
+}
+
+
+
+
+/********************************************************************************************************
+*                                         PWR_RtcGet()
+*
+* @brief      Free-running RTC time: the 24-bit counter extended to 64 bits with the overflow count
+*
+* @param[in]  none
+* @exception  none
+* @return     RTC ticks (PWR_RTC_FREQ) since the RTC was started
+*/
+/* Notes      :(1) The overflow flag is checked as well, so that the result is also correct with
+*                   interrupts disabled (e.g. from the idle hook or an interrupt handler).
+*
+********************************************************************************************************/
+
+uint64_t PWR_RtcGet(void){
+
+  INT32U ovf;
+  INT32U cnt;
+  INT32U wraps;
+
+  do {
+    ovf   = rtcOverflows;
+    wraps = ovf;
+    cnt   = RTC->CNT;
+    if(RTC->IF & RTC_IF_OF){    // Wrapped, but not serviced yet: read the counter again past the wrap
+      cnt = RTC->CNT;
+      wraps++;
+    }
+  } while(ovf != rtcOverflows);
+
+  return ((uint64_t) wraps << 24) | cnt;
+}
+
+
+
+/********************************************************************************************************
+*                                         PWR_ConsoleWake()
+*
+* @brief      GPIO interrupt callback of the console RX line
+*
+* @param[in]  pin         interrupt pin
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+static void PWR_ConsoleWake(uint8_t pin){
+  if(pin == RETARGET_RXPIN)
+    PWR_ConsoleActivity();
+}
+
+
+
+/********************************************************************************************************
+*                                         PWR_ConsoleClose()
+*
+* @brief      Ends the console session, and releases its EM2 block, once the console has been quiet for
+*             APP_CFG_CONSOLE_IDLE_MS
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+static void PWR_ConsoleClose(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  if(consoleOpen && OSTime - consoleLast >= APP_CFG_CONSOLE_IDLE_MS * OS_TICKS_PER_SEC / 1000){
+    consoleOpen = FALSE;
+    em2BlockCtr--;
+  }
+  OS_EXIT_CRITICAL();
+}
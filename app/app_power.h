@@ -0,0 +1,73 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_power.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the power management module: tickless
+idle on the RTC, EM1/EM2 selection and energy mode residency statistics.
+
+******************************************************************************/
+
+#ifndef __APP_POWER_H
+#define __APP_POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define PWR_RTC_FREQ            32768u          // RTC clock (LFXO, no prescaler) [Hz]
+#define PWR_RTC_MASK            0x00FFFFFFu     // The RTC counter is 24-bit wide
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct PwrStats PWR_STATS;
+
+struct PwrStats {
+  uint64_t total;       // RTC ticks elapsed since PWR_Init()
+  uint64_t em1;         // RTC ticks spent in EM1
+  uint64_t em2;         // RTC ticks spent in EM2
+  INT32U em2Entries;    // Number of tickless sleeps in EM2
+  INT32U earlyWakes;    // Tickless sleeps ended by an interrupt before the programmed wake-up
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void PWR_Init(void);
+void PWR_IdleHook(void);
+
+void PWR_EM2Block(void);
+void PWR_EM2Unblock(void);
+
+void PWR_ConsoleInit(void);
+void PWR_ConsoleActivity(void);
+
+void PWR_GetStats(PWR_STATS *stats);
+uint64_t PWR_RtcGet(void);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
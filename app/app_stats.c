@@ -0,0 +1,405 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_stats.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Running statistics of the database channels (see DB_Set()): count, min, max,
+mean and variance of the values since reset, and over a sliding window, for
+the shell and the HK records, without going back to the stored values.
+
+Each sample updates two accumulators in constant time, with the update of
+Welford: the mean and the sum of squared deviations from it, instead of the
+sums of the values and of their squares, whose difference loses all the
+precision of a float for values far from 0 (a temperature in Q16.16 is about
+1.3e6, its square 1.7e12).
+
+The sliding window is a ring of RSTAT_BUCKETS sub-windows of windowMs /
+RSTAT_BUCKETS: a sample goes to the current sub-window, or starts the next one
+(which drops the oldest) when the current one is older than its length. A
+query merges the sub-windows that started less than windowMs ago (merge of
+Chan et al.): it covers at least the last windowMs - windowMs / RSTAT_BUCKETS,
+at most windowMs. Sub-windows without a sample (gap in the data) are never
+started, stale ones are skipped by the query.
+
+The accumulators are in float: on the EFM32GG (no FPU) a sample costs a few
+hundred cycles (see RSTAT_SelfTest()), the channels written at 10 Hz take
+well under 1 % of the CPU.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void RSTAT_Acc(RSTAT_ACC *a, int32_t value);
+static void RSTAT_Merge(RSTAT_ACC *a, const RSTAT_ACC *b);
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_Init()
+* @brief      Initialises a set of channels, no sample
+*
+* @param[out] s           set
+* @param[in]  ch          nbCh channels (storage)
+* @param[in]  nbCh        channels
+* @param[in]  windowMs    length of the sliding window (ms, at least RSTAT_BUCKETS)
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void RSTAT_Init(RSTAT_SET *s, RSTAT_CH *ch, INT8U nbCh, INT32U windowMs){
+
+  s->ch   = ch;
+  s->nbCh = nbCh;
+  memset(ch, 0, nbCh * sizeof(RSTAT_CH));
+  RSTAT_SetWindow(s, windowMs);
+}
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_SetWindow()
+* @brief      Changes the length of the sliding window. The windows start again empty, the statistics
+*             since reset are kept.
+*
+* @param[in]  s           set
+* @param[in]  windowMs    ms, at least RSTAT_BUCKETS
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void RSTAT_SetWindow(RSTAT_SET *s, INT32U windowMs){
+
+  INT8U i;
+
+  if(windowMs < RSTAT_BUCKETS)
+    windowMs = RSTAT_BUCKETS;
+  s->windowMs = windowMs;
+  s->bucketMs = windowMs / RSTAT_BUCKETS;
+
+  for(i = 0; i < s->nbCh; i++){
+    memset(s->ch[i].bucket, 0, sizeof(s->ch[i].bucket));
+    s->ch[i].cur = 0;
+  }
+}
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_Reset()
+* @brief      Clears the statistics since reset of all the channels
+*
+* @param[in]  s           set
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void RSTAT_Reset(RSTAT_SET *s){
+
+  INT8U i;
+
+  for(i = 0; i < s->nbCh; i++)
+    memset(&s->ch[i].total, 0, sizeof(RSTAT_ACC));
+}
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_Add()
+* @brief      Adds a sample to a channel
+*
+* @param[in]  s           set
+* @param[in]  ch          channel
+* @param[in]  value       sample
+* @param[in]  now         time of the sample (ms, wraps: differences only)
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void RSTAT_Add(RSTAT_SET *s, INT8U ch, int32_t value, INT32U now){
+
+  RSTAT_CH  *c = &s->ch[ch];
+  RSTAT_ACC *b = &c->bucket[c->cur];
+
+  // Current sub-window over: the next one (the oldest) starts with the sample
+  if(b->n != 0 && now - c->start[c->cur] >= s->bucketMs){
+    c->cur = (c->cur + 1) % RSTAT_BUCKETS;
+    b = &c->bucket[c->cur];
+    b->n = 0;
+  }
+  if(b->n == 0)
+    c->start[c->cur] = now;
+
+  RSTAT_Acc(b, value);
+  RSTAT_Acc(&c->total, value);
+}
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_Window()
+* @brief      Statistics of a channel over the sliding window
+*
+* @param[in]  s           set
+* @param[in]  ch          channel
+* @param[in]  now         time of the query (ms)
+* @param[out] win         statistics (n = 0: no sample in the window)
+* @exception  none
+* @return     time of the first sample included (ms, now if none)
+*/
+/*********************************************************************************************************/
+
+INT32U RSTAT_Window(const RSTAT_SET *s, INT8U ch, INT32U now, RSTAT_ACC *win){
+
+  const RSTAT_CH *c = &s->ch[ch];
+  INT32U from = now;
+  INT8U  i;
+
+  memset(win, 0, sizeof(RSTAT_ACC));
+  for(i = 0; i < RSTAT_BUCKETS; i++){
+    if(c->bucket[i].n == 0 || now - c->start[i] >= s->windowMs)
+      continue;
+    RSTAT_Merge(win, &c->bucket[i]);
+    if(now - c->start[i] > now - from)
+      from = c->start[i];
+  }
+
+  return from;
+}
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_Std()
+* @brief      Standard deviation of an accumulator (sample, n - 1)
+*
+* @param[in]  a           accumulator
+* @exception  none
+* @return     standard deviation (0 below 2 samples)
+*/
+/*********************************************************************************************************/
+
+float RSTAT_Std(const RSTAT_ACC *a){
+  return (a->n > 1 && a->m2 > 0) ? sqrtf(a->m2 / (float) (a->n - 1)) : 0;
+}
+
+
+
+/*********************************************************************************************************
+*                                         RSTAT_SelfTest()
+* @brief      Feeds a channel with a slow triangle on a large offset, with noise and a gap in the data,
+*             and compares the window queries and the statistics since reset with the ones computed
+*             from the samples
+*
+* @param[out] res         errors and cost
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The reference is computed from the last RSTAT_TEST_HIST samples, in 64-bit integers
+*                   relative to the first one (exact), then in double.
+*
+*               (2) A query covers the samples since the time it returns, and the window leaves none out
+*                   newer than windowMs - bucketMs. Right after the gap, the window is empty.
+*
+*               (3) The std of the window also computed as in a naive implementation (float sums of the
+*                   values and of their squares), to show the loss of precision that Welford avoids.
+*
+*********************************************************************************************************/
+
+void RSTAT_SelfTest(RSTAT_TEST *res){
+
+  static int32_t hv[RSTAT_TEST_HIST];
+  static INT32U  ht[RSTAT_TEST_HIST];
+  RSTAT_SET s;
+  RSTAT_CH  ch;
+  RSTAT_ACC win;
+  uint32_t  seed = 1;
+  INT32U    now = 0;
+  INT32U    from;
+  INT32U    cycles;
+  INT32U    addCycles = 0;
+  INT32U    queryCycles = 0;
+  INT32U    k;
+  INT32U    i;
+  INT32U    n;
+  INT32U    tri;
+  int32_t   v;
+  int32_t   v0 = 0;
+  int32_t   mn;
+  int32_t   mx;
+  int64_t   sum;
+  int64_t   sq;
+  int64_t   d;
+  int64_t   tSum = 0;
+  int64_t   tSq = 0;
+  float     fSum;
+  float     fSq;
+  double    mean;
+  double    std;
+  double    e;
+
+  memset(res, 0, sizeof(RSTAT_TEST));
+  RSTAT_Init(&s, &ch, 1, RSTAT_TEST_WINDOW_MS);
+
+  for(k = 0; k < RSTAT_TEST_SAMPLES; k++){
+
+    now += (k == RSTAT_TEST_GAP + 1) ? 2 * RSTAT_TEST_WINDOW_MS : RSTAT_TEST_PERIOD_MS;
+
+    // Note(2)
+    if(k == RSTAT_TEST_GAP + 1){
+      RSTAT_Window(&s, 0, now, &win);
+      res->queries++;
+      if(win.n != 0)
+        res->errors++;
+    }
+
+    // 20 deg C (Q16.16), +-5 deg C triangle over 6000 samples, +-0.1 deg C noise
+    tri  = k % 6000;
+    tri  = (tri < 3000) ? tri : 6000 - tri;
+    v    = UTI_Q16FromInt(15) + (int32_t) (tri * (UTI_Q16FromInt(10) / 3000))
+           + (int32_t) ((int64_t) (UTI_Rand(&seed) >> 8) * (2 * UTI_Q16FromFloat(0.1) + 1) >> 24) - UTI_Q16FromFloat(0.1);
+    if(k == 0)
+      v0 = v;
+
+    cycles = UTI_CycCntGet();
+    RSTAT_Add(&s, 0, v, now);
+    addCycles += UTI_CycCntGet() - cycles;
+
+    hv[k % RSTAT_TEST_HIST] = v;
+    ht[k % RSTAT_TEST_HIST] = now;
+    d     = v - v0;
+    tSum += d;
+    tSq  += d * d;
+
+    if(k % RSTAT_TEST_QUERY != 0 || k < RSTAT_TEST_HIST)
+      continue;
+
+    cycles = UTI_CycCntGet();
+    from = RSTAT_Window(&s, 0, now, &win);
+    queryCycles += UTI_CycCntGet() - cycles;
+    res->queries++;
+
+    // Note(1)
+    n = 0; sum = 0; sq = 0; mn = 0x7FFFFFFF; mx = -0x7FFFFFFF; fSum = 0; fSq = 0;
+    for(i = 0; i < RSTAT_TEST_HIST; i++){
+      if(now - ht[i] > now - from){
+        // Note(2)
+        if(now - ht[i] < RSTAT_TEST_WINDOW_MS - s.bucketMs)
+          res->errors++;
+        continue;
+      }
+      d = hv[i] - v0;
+      n++; sum += d; sq += d * d;
+      fSum += (float) hv[i];            // Note(3)
+      fSq  += (float) hv[i] * (float) hv[i];
+      mn = (hv[i] < mn) ? hv[i] : mn;
+      mx = (hv[i] > mx) ? hv[i] : mx;
+    }
+    if(n != win.n || mn != win.min || mx != win.max || now - from >= RSTAT_TEST_WINDOW_MS){
+      res->errors++;
+      continue;
+    }
+    mean = (double) sum / n;
+    std  = sqrt(((double) sq - (double) sum * sum / n) / (n - 1));
+    e = fabs(win.mean - (v0 + mean)) / std * 1e6;
+    if(e > res->meanErrPpm)
+      res->meanErrPpm = (INT32U) e;
+    e = fabs(RSTAT_Std(&win) - std) / std * 1e6;
+    if(e > res->stdErrPpm)
+      res->stdErrPpm = (INT32U) e;
+    
+    // Note(3)
+    e = (fSq - fSum * fSum / n) / (n - 1);
+    e = (e > 0) ? fabs(sqrt(e) - std) / std * 1e6 : 1e9;
+    e = (e < 1e9) ? e : 1e9;
+    if(e > res->naiveErrPpm)
+      res->naiveErrPpm = (INT32U) e;
+  }
+
+  // Since reset
+  n    = RSTAT_TEST_SAMPLES;
+  std  = sqrt(((double) tSq - (double) tSum * tSum / n) / (n - 1));
+  e    = fabs(RSTAT_Std(&ch.total) - std) / std * 1e6;
+  res->totalErrPpm = (INT32U) e;
+  if(ch.total.n != n)
+    res->errors++;
+
+  res->samples     = RSTAT_TEST_SAMPLES;
+  res->addCycles   = addCycles / RSTAT_TEST_SAMPLES;
+  res->queryCycles = (res->queries > 0) ? queryCycles / res->queries : 0;
+  res->pass = (res->errors == 0 && res->meanErrPpm < 1000 && res->stdErrPpm < 1000 &&
+               res->totalErrPpm < 1000);
+}
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Welford update of an accumulator with a sample
+static void RSTAT_Acc(RSTAT_ACC *a, int32_t value){
+
+  float delta;
+
+  if(a->n++ == 0){
+    a->min  = value;
+    a->max  = value;
+    a->mean = (float) value;
+    a->m2   = 0;
+    return;
+  }
+  if(value < a->min)
+    a->min = value;
+  if(value > a->max)
+    a->max = value;
+
+  delta    = (float) value - a->mean;
+  a->mean += delta / (float) a->n;
+  a->m2   += delta * ((float) value - a->mean);
+}
+
+/******************************************************************************/
+
+// Merges two accumulators into the first one (Chan et al.)
+static void RSTAT_Merge(RSTAT_ACC *a, const RSTAT_ACC *b){
+
+  float  delta;
+  INT32U n;
+
+  if(b->n == 0)
+    return;
+  if(a->n == 0){
+    *a = *b;
+    return;
+  }
+
+  n       = a->n + b->n;
+  delta   = b->mean - a->mean;
+  a->mean += delta * (float) b->n / (float) n;
+  a->m2   += b->m2 + delta * delta * ((float) a->n * (float) b->n / (float) n);
+  a->min   = (b->min < a->min) ? b->min : a->min;
+  a->max   = (b->max > a->max) ? b->max : a->max;
+  a->n     = n;
+}
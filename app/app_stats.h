@@ -0,0 +1,116 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_stats.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the running statistics of the
+database channels: count, min, max, mean and variance since reset and over a
+sliding window, updated in constant time per sample.
+
+******************************************************************************/
+
+#ifndef __APP_STATS_H
+#define __APP_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define RSTAT_BUCKETS           8       // Sub-windows of the sliding window
+
+// Self-test (see RSTAT_SelfTest())
+#define RSTAT_TEST_SAMPLES      20000
+#define RSTAT_TEST_PERIOD_MS    100
+#define RSTAT_TEST_WINDOW_MS    10000
+#define RSTAT_TEST_GAP          12000   // Sample followed by a gap longer than the window
+#define RSTAT_TEST_QUERY        97      // Samples between two queries
+#define RSTAT_TEST_HIST         256     // Samples kept for the reference (> window / period)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Accumulator: count, extremes, mean and sum of squared deviations (Welford)
+typedef struct RstatAcc RSTAT_ACC;
+
+struct RstatAcc {
+  INT32U  n;
+  int32_t min;
+  int32_t max;
+  float   mean;
+  float   m2;
+};
+
+// Channel: statistics since reset, and ring of sub-windows of the sliding window
+typedef struct RstatCh RSTAT_CH;
+
+struct RstatCh {
+  RSTAT_ACC total;
+  RSTAT_ACC bucket[RSTAT_BUCKETS];
+  INT32U    start[RSTAT_BUCKETS];       // Time of the first sample of each sub-window (ms)
+  INT8U     cur;                        // Sub-window being filled
+};
+
+// Set of channels sharing a window
+typedef struct RstatSet RSTAT_SET;
+
+struct RstatSet {
+  RSTAT_CH *ch;
+  INT8U     nbCh;
+  INT32U    windowMs;
+  INT32U    bucketMs;                   // windowMs / RSTAT_BUCKETS
+};
+
+// Self-test results: a sampled signal with a large offset, compared to statistics recomputed from
+// the samples
+typedef struct RstatTest RSTAT_TEST;
+
+struct RstatTest {
+  INT32U  samples;
+  INT32U  queries;
+  INT32U  errors;                       // Queries with another count, min or max, or outside the window
+  INT32U  meanErrPpm;                   // Largest error of the mean, of the std (ppm of the std)
+  INT32U  stdErrPpm;
+  INT32U  totalErrPpm;                  // Error of the std since reset
+  INT32U  naiveErrPpm;                  // Window std from float sums of squares (saturated)
+  INT32U  addCycles;                    // Average cost of a sample
+  INT32U  queryCycles;                  // Average cost of a window query
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    RSTAT_Init(RSTAT_SET *s, RSTAT_CH *ch, INT8U nbCh, INT32U windowMs);
+void    RSTAT_SetWindow(RSTAT_SET *s, INT32U windowMs);
+void    RSTAT_Reset(RSTAT_SET *s);
+void    RSTAT_Add(RSTAT_SET *s, INT8U ch, int32_t value, INT32U now);
+INT32U  RSTAT_Window(const RSTAT_SET *s, INT8U ch, INT32U now, RSTAT_ACC *win);
+float   RSTAT_Std(const RSTAT_ACC *a);
+
+void    RSTAT_SelfTest(RSTAT_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __APP_STATS_H */
@@ -0,0 +1,223 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_stkmon.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Stack watermark monitor. OSTaskStkChk() walks the whole free part of a stack
+on every call, which is expensive for the large stacks (2048 words for the
+Command task). Since the tasks are created with OS_TASK_OPT_STK_CLR, the
+unused part of a stack is still zero, and the high-water mark can only move
+down. The check is therefore done incrementally: each statistics task cycle
+checks STKMON_SLICE_WORDS words of one task, from the bottom of its stack up
+to the last known watermark. When a non-zero word is found the watermark is
+lowered and the check of that task starts over.
+
+The peak usage of each task is sampled periodically to keep a history, and
+recommended stack sizes are derived from it.
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// IMPORTANT!: MUST BE IN THE SAME ORDER AS THE TASK IDs DEFINED IN APP_CFG.H
+static const INT8U prioTable[TASK_USER_NB] = { APP_CFG_TASK_START_PRIO,
+                                               APP_CFG_SERIAL_DISP_PRIO,
+                                               APP_CFG_LED_DISP_PRIO,
+                                               APP_CFG_COMMAND_PRIO,
+                                               APP_CFG_MEM_MAN_PRIO,
+                                               APP_CFG_SEN_DATA_PRIO,
+                                               APP_CFG_HK_DATA_PRIO,
+                                               APP_CFG_PL_DATA_PRIO,
+                                               APP_CFG_SEN_TIME_PRIO,
+                                               APP_CFG_ADCS_PRIO };
+
+static const char* const cfgNameTable[TASK_USER_NB] = { "APP_CFG_TASK_START_STK_SIZE",
+                                                         "APP_CFG_SERIAL_DISP_STK_SIZE",
+                                                         "APP_CFG_LED_DISP_STK_SIZE",
+                                                         "APP_CFG_COMMAND_STK_SIZE",
+                                                         "APP_CFG_MEM_MAN_STK_SIZE",
+                                                         "APP_CFG_SEN_DATA_STK_SIZE",
+                                                         "APP_CFG_HK_DATA_STK_SIZE",
+                                                         "APP_CFG_PL_DATA_STK_SIZE",
+                                                         "APP_CFG_SEN_TIME_STK_SIZE",
+                                                         "APP_CFG_ADCS_STK_SIZE" };
+
+static STKMON_TASK taskTbl[TASK_USER_NB];
+
+static INT8U  currentTask = 0;          // Task checked by the next call
+static INT32U histCtr     = 0;          // Cycles since the last history sample
+
+
+
+
+/********************************************************************************************************
+*                                         STKMON_Init()
+*
+* @brief      Initialises the watermarks. Must be called before the statistics task runs.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void STKMON_Init(void){
+
+  memset(taskTbl, 0, sizeof(taskTbl));
+  currentTask = 0;
+  histCtr = 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         STKMON_StatHook()
+*
+* @brief      Checks one slice of one task's stack. Called from App_TaskStatHook().
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Tasks are picked up on their first check, so the monitor does not depend on the task
+*                   creation order. A priority without a task (or reserved by a mutex PIP) is skipped.
+*
+*               (2) Words above the watermark are known to be used, only [cursor, free) has to be checked.
+*
+********************************************************************************************************/
+
+void STKMON_StatHook(void){
+
+  STKMON_TASK *task = &taskTbl[currentTask];
+  OS_TCB *ptcb;
+  OS_STK *bottom;
+  INT32U  end;
+  INT32U  i;
+  BOOLEAN done = false;
+
+  ptcb = OSTCBPrioTbl[prioTable[currentTask]];
+
+  if(ptcb != (OS_TCB *)0 && ptcb != OS_TCB_RESERVED){
+
+    if(task->size == 0){                                     // Note(1)
+      task->size   = ptcb->OSTCBStkSize;
+      task->free   = task->size;
+      task->cursor = 0;
+    }
+
+    bottom = ptcb->OSTCBStkBottom;
+
+    end = task->cursor + STKMON_SLICE_WORDS;                 // Note(2)
+    if(end > task->free)
+      end = task->free;
+
+    for(i = task->cursor; i < end; i++){
+      if(bottom[i] != 0){
+        task->free = i;
+        break;
+      }
+    }
+
+    task->cursor = i;
+    if(task->cursor >= task->free){                          // Check complete, start over
+      task->cursor = 0;
+      done = true;
+    }
+  }
+  else
+    done = true;
+
+  // Move to the next task once this one is fully checked
+  if(done && ++currentTask >= TASK_USER_NB)
+    currentTask = 0;
+
+  // Periodic sample of the peak usage of every task
+  if(++histCtr >= STKMON_HIST_PERIOD){
+    histCtr = 0;
+    for(i = 0; i < TASK_USER_NB; i++){
+      memmove(&taskTbl[i].hist[0], &taskTbl[i].hist[1], (STKMON_HIST_LEN - 1) * sizeof(INT16U));
+      taskTbl[i].hist[STKMON_HIST_LEN - 1] = (INT16U) (taskTbl[i].size - taskTbl[i].free);
+    }
+  }
+}
+
+
+
+/********************************************************************************************************
+*                                         STKMON_GetTask()
+*
+* @brief      Returns a copy of the watermark data of a task
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @param[out] task        STKMON_TASK structure to fill
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void STKMON_GetTask(INT8U taskId, STKMON_TASK *task){
+
+  OSSchedLock();                        // Only updated by the statistics task
+  *task = taskTbl[taskId];
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         STKMON_Recommended()
+*
+* @brief      Recommended stack size for a task: peak usage plus a safety margin, rounded up
+*
+* @param[in]  task        watermark data of the task
+* @exception  none
+* @return     recommended size (# of OS_STK entries), 0 if the task was not checked yet
+*
+********************************************************************************************************/
+
+INT32U STKMON_Recommended(const STKMON_TASK *task){
+
+  INT32U used;
+  INT32U margin;
+
+  if(task->size == 0)
+    return 0;
+
+  used   = task->size - task->free;
+  margin = used * STKMON_MARGIN_PCT / 100;
+  if(margin < STKMON_MARGIN_MIN)
+    margin = STKMON_MARGIN_MIN;
+
+  return (used + margin + STKMON_ROUND - 1) / STKMON_ROUND * STKMON_ROUND;
+}
+
+
+
+/********************************************************************************************************
+*                                         STKMON_CfgName()
+*
+* @brief      Name of the stack size define of a task in app_cfg.h
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @exception  none
+* @return     define name
+*
+********************************************************************************************************/
+
+const char* STKMON_CfgName(INT8U taskId){
+  return cfgNameTable[taskId];
+}
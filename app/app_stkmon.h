@@ -0,0 +1,73 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_stkmon.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the stack watermark monitor, which
+tracks the peak stack usage of the application tasks incrementally from the
+statistics task and recommends stack sizes.
+
+******************************************************************************/
+
+#ifndef __APP_STKMON_H
+#define __APP_STKMON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define STKMON_SLICE_WORDS      64u     // Stack words checked per statistics task cycle
+#define STKMON_HIST_LEN         8u      // Number of peak usage samples kept per task
+#define STKMON_HIST_PERIOD      600u    // Statistics task cycles between samples (60 s at 10 Hz)
+
+#define STKMON_MARGIN_PCT       25u     // Safety margin applied to the peak usage...
+#define STKMON_MARGIN_MIN       32u     // ...but at least this many words
+#define STKMON_ROUND            8u      // Recommended sizes are rounded up to this many words
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct StkMonTask STKMON_TASK;
+
+struct StkMonTask {
+  INT32U size;                          // Stack size (# of OS_STK entries)
+  INT32U free;                          // Words never used so far (from the bottom of the stack)
+  INT32U cursor;                        // Position of the ongoing check
+  INT16U hist[STKMON_HIST_LEN];         // Peak usage samples, oldest first
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void   STKMON_Init(void);
+void   STKMON_StatHook(void);
+
+void   STKMON_GetTask(INT8U taskId, STKMON_TASK *task);
+INT32U STKMON_Recommended(const STKMON_TASK *task);
+const char* STKMON_CfgName(INT8U taskId);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_time.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Time service. All the time stamps of the application (sensor samples,
+database, records) come from TIME_NowUs(): microseconds since the start of
+the RTC, on 64 bits, monotonic and never wrapping.
+
+The base is the free-running RTC (32768 Hz, running in EM2 and across the
+tickless idle periods): its 24-bit counter is extended with the overflow
+count of its interrupt (see PWR_RtcGet()), with a resolution of 30.5 us.
+The kernel tick counter (OSTime) is 32-bit and stops in EM2 until the idle
+hook catches up, so it is only used to check the time base. The read path
+takes no lock and does not disable interrupts: it retries when an overflow
+happens during the read, and converts with a multiply and a shift. It can
+be called from the interrupt handlers.
+
+The mission elapsed time (MET) is the time stamp plus an offset, set when
+the MET is known (TIME_SetMet()). Records keep the monotonic time stamp, and
+are converted to MET when they leave the satellite (TIME_ToMet()), so that
+setting the MET never makes stored times jump.
+
+With virtual time (APP_CFG_VTIME_EN), there is no RTC: the time stamps come
+from the virtual kernel clock (TMON_NowUs()).
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+// RTC ticks to us: 1000000 / 32768 = 15625 / 512
+#define TIME_US_MUL             15625u
+#define TIME_US_SHIFT           9
+
+#define US_PER_TICK             (1000000u / OS_TICKS_PER_SEC)
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static volatile int64_t metOffset;      // MET - time stamp (us)
+static volatile INT32U  metSeq;         // Incremented on each update of metOffset
+
+static uint64_t   lastCheck;            // Time stamp of the last check
+static TIME_STATS stats;
+
+
+
+
+/********************************************************************************************************
+*                                         TIME_NowUs()
+*
+* @brief      Current time stamp, lock-free (also from interrupt handlers)
+*
+* @param[in]  none
+* @exception  none
+* @return     time since the start of the RTC [us]
+*
+*
+********************************************************************************************************/
+
+uint64_t TIME_NowUs(void){
+
+#if (APP_CFG_VTIME_EN > 0)
+  return TMON_NowUs();                  // No RTC on virtual time
+#else
+  return (PWR_RtcGet() * TIME_US_MUL) >> TIME_US_SHIFT;
+#endif
+}
+
+
+
+/********************************************************************************************************
+*                                    TIME_MetUs() / TIME_ToMet()
+*
+* @brief      Current mission elapsed time (resp. MET of a time stamp)
+*
+* @param[in]  timeUs      time stamp (TIME_NowUs())
+* @exception  none
+* @return     MET [us]
+*/
+/* Notes      :(1) The offset is 64-bit: a reader preempted between its two halves by TIME_SetMet() reads
+*                   it again. The update itself cannot be preempted (critical section), so the loop
+*                   ends after one retry at most.
+*
+********************************************************************************************************/
+
+uint64_t TIME_MetUs(void){
+
+  return TIME_ToMet(TIME_NowUs());
+}
+
+uint64_t TIME_ToMet(uint64_t timeUs){
+
+  INT32U  seq;
+  int64_t offset;
+
+  do {                                                        // Note(1)
+    seq    = metSeq;
+    offset = metOffset;
+  } while(seq != metSeq);
+
+  return timeUs + offset;
+}
+
+
+
+/********************************************************************************************************
+*                                         TIME_SetMet()
+*
+* @brief      Sets the current mission elapsed time
+*
+* @param[in]  metUs       MET now [us]
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void TIME_SetMet(uint64_t metUs){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  metOffset = (int64_t) (metUs - TIME_NowUs());
+  metSeq++;
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/********************************************************************************************************
+*                                         TIME_Check()
+*
+* @brief      Checks that the time stamps are monotonic and measures their offset to the kernel time.
+*             Called periodically by the sensor time task.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The kernel time catches up with the RTC after each tickless sleep: the offset stays
+*                   within a tick, unless ticks are lost.
+*
+********************************************************************************************************/
+
+void TIME_Check(void){
+
+  uint64_t now;
+  INT32U   ticks;
+  INT32S   offset;
+
+  OSSchedLock();
+  now   = TIME_NowUs();
+  ticks = OSTimeGet();
+  OSSchedUnlock();
+
+  if(now < lastCheck)
+    stats.backwards++;
+  lastCheck = now;
+
+  offset = (INT32S) ((INT32U) now - ticks * US_PER_TICK);    // Note(1)
+  if(stats.checks == 0 || offset < stats.tickOffsetMin)
+    stats.tickOffsetMin = offset;
+  if(stats.checks == 0 || offset > stats.tickOffsetMax)
+    stats.tickOffsetMax = offset;
+  stats.tickOffset = offset;
+  stats.checks++;
+}
+
+
+
+/********************************************************************************************************
+*                                         TIME_GetStats()
+*
+* @brief      Returns a consistent copy of the time base checks
+*
+* @param[out] res         TIME_STATS structure to fill
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void TIME_GetStats(TIME_STATS *res){
+
+  OSSchedLock();
+  *res = stats;
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         TIME_ReadCycles()
+*
+* @brief      Measures the cost of a time stamp
+*
+* @param[in]  none
+* @exception  none
+* @return     CPU cycles per TIME_NowUs() call (loop included)
+*
+*
+********************************************************************************************************/
+
+INT32U TIME_ReadCycles(void){
+
+  volatile uint64_t t;
+  INT32U start;
+  INT32U i;
+
+  start = UTI_CycCntGet();
+  for(i = 0; i < TIME_COST_LOOPS; i++)
+    t = TIME_NowUs();
+
+  (void) t;
+
+  return (UTI_CycCntGet() - start) / TIME_COST_LOOPS;
+}
@@ -0,0 +1,72 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_time.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the time service: 64-bit monotonic
+time stamps for all the producers of records, and the conversion to mission
+elapsed time (MET).
+
+******************************************************************************/
+
+#ifndef __APP_TIME_H
+#define __APP_TIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define TIME_COST_LOOPS         100     // Reads averaged by TIME_ReadCycles()
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Consistency of the time base, checked by the sensor time task (times in us)
+typedef struct TimeStats TIME_STATS;
+
+struct TimeStats {
+  INT32U checks;
+  INT32U backwards;                     // Time stamps lower than the previous one (must stay 0)
+  INT32S tickOffset;                    // Time stamp - kernel time (OSTime), last check
+  INT32S tickOffsetMin;
+  INT32S tickOffsetMax;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+uint64_t TIME_NowUs(void);
+
+uint64_t TIME_MetUs(void);
+uint64_t TIME_ToMet(uint64_t timeUs);
+void     TIME_SetMet(uint64_t metUs);
+
+void     TIME_Check(void);
+void     TIME_GetStats(TIME_STATS *stats);
+INT32U   TIME_ReadCycles(void);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,488 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_timing.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Task timing monitor. Each periodic task has a timing contract (period,
+execution budget, deadline) declared in app_cfg.h. Instead of a relative
+OSTimeDlyHMSM() at the end of their loop, the tasks call
+TMON_WaitNextPeriod(), which:
+  - measures the response time of the job that just ended (from its nominal
+    release) and its execution time (CPU time charged by the switch hook),
+  - checks both against the contract and reports violations,
+  - sleeps until the next nominal release (drift-free, missed releases are
+    skipped and counted),
+  - measures the release jitter when the task is resumed.
+
+Event-driven tasks (period 0) have no nominal release: each job is bracketed
+with TMON_JobStart() and TMON_JobEnd(), the response time is measured from
+the event that released it (e.g. the data ready interrupt, the post of a
+record) and checked against the same deadline and budget.
+
+Time stamps have a sub-tick resolution: the tick count is combined with the
+current SysTick counter value.
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define US_PER_TICK     (1000000u / OS_TICKS_PER_SEC)
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Timing contracts, indexed by task ID (periods may be changed by TMON_SetPeriod())
+static TMON_CONTRACT contractTbl[TASK_USER_NB] = {
+  [MEM_MAN_ID]  = { APP_CFG_MEM_MAN_PERIOD_MS,  APP_CFG_MEM_MAN_BUDGET_US,  APP_CFG_MEM_MAN_DEADLINE_MS  },   // Per record
+  [SEN_DATA_ID] = { 0,                          APP_CFG_SEN_DATA_BUDGET_US, APP_CFG_SEN_DATA_DEADLINE_MS },   // Per data ready
+  [HK_DATA_ID]  = { APP_CFG_HK_DATA_PERIOD_MS,  APP_CFG_HK_DATA_BUDGET_US,  APP_CFG_HK_DATA_DEADLINE_MS  },
+  [PL_DATA_ID]  = { APP_CFG_PL_DATA_PERIOD_MS,  APP_CFG_PL_DATA_BUDGET_US,  APP_CFG_PL_DATA_DEADLINE_MS  },
+  [SEN_TIME_ID] = { APP_CFG_SEN_TIME_PERIOD_MS, APP_CFG_SEN_TIME_BUDGET_US, APP_CFG_SEN_TIME_DEADLINE_MS },
+};
+
+// Run-time state of the monitored tasks
+typedef struct {
+  INT32U releaseTick;       // Nominal release of the current job
+  INT32U execStart;         // CPU cycles charged to the task when the current job started
+} TMON_JOB;
+
+static TMON_JOB      jobTbl[TASK_USER_NB];
+static TMON_STATS    statsTbl[TASK_USER_NB];
+
+static TMON_CALLBACK violationCallback = (TMON_CALLBACK) 0;
+
+static INT32U        swCycles = 0;          // Cycle counter at the last context switch
+static INT32U        cyclesPerUs = 1;
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static INT32U TMON_ExecCycles(INT8U taskId);
+static void   TMON_Record(INT8U taskId, INT32U resp, INT32U exec);
+static void   TMON_Violation(INT8U taskId, INT8U violation, INT32U value);
+
+
+
+
+/********************************************************************************************************
+*                                         TMON_Init()
+*
+* @brief      Starts the cycle counter used to measure the execution time of the tasks
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_Init(void){
+
+  UTI_CycCntInit();
+  swCycles = UTI_CycCntGet();
+
+  cyclesPerUs = CMU_ClockFreqGet(cmuClock_CORE) / 1000000;
+  if(cyclesPerUs == 0)
+    cyclesPerUs = 1;
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_Start()
+*
+* @brief      Marks the release of the first job of a task. Called once, before the task's loop.
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_Start(INT8U taskId){
+
+  jobTbl[taskId].releaseTick = OSTimeGet();
+  jobTbl[taskId].execStart   = TMON_ExecCycles(taskId);
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_WaitNextPeriod()
+*
+* @brief      Ends the current job of a task, checks it against the task's contract and sleeps until
+*             the next release
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) A job that is still running when its next release is due has overrun: the missed
+*                   releases are skipped (and counted) instead of being run back to back.
+*
+*               (2) OSTimeDly() is called right after reading the tick count, the job is released on
+*                   the nominal tick unless a tick occurs in between (one tick late at worst).
+*
+********************************************************************************************************/
+
+void TMON_WaitNextPeriod(INT8U taskId){
+
+  const TMON_CONTRACT *contract = &contractTbl[taskId];
+  TMON_JOB *job = &jobTbl[taskId];
+  INT32U period;
+  INT32U next;
+  INT32U now;
+  INT32U resp;
+  INT32U exec;
+  INT32U jitter;
+
+  // No contract for this task: just yield for one tick
+  if(contract->periodMs == 0){
+    OSTimeDly(1);
+    return;
+  }
+
+  // Job completed: response and execution times
+  resp = (INT32U) (TMON_NowUs() - (uint64_t) job->releaseTick * US_PER_TICK);
+  exec = (TMON_ExecCycles(taskId) - job->execStart) / cyclesPerUs;
+  TMON_Record(taskId, resp, exec);
+
+  // Next release                                             Note(1)
+  period = contract->periodMs * OS_TICKS_PER_SEC / 1000;
+  if(period == 0)
+    period = 1;
+
+  next = job->releaseTick + period;
+  now  = OSTimeGet();
+  while((INT32S) (next - now) <= 0){
+    next += period;
+    statsTbl[taskId].skipped++;
+    TMON_Violation(taskId, TMON_VIOL_OVERRUN, (now - job->releaseTick) * US_PER_TICK);
+  }
+  job->releaseTick = next;
+
+  OSTimeDly(next - now);                                    // Note(2)
+
+  // Resumed: release jitter and start of the next job
+  jitter = (INT32U) (TMON_NowUs() - (uint64_t) next * US_PER_TICK);
+  if(jitter > statsTbl[taskId].jitterMax)
+    statsTbl[taskId].jitterMax = jitter;
+
+  job->execStart = TMON_ExecCycles(taskId);
+}
+
+
+
+/********************************************************************************************************
+*                                    TMON_JobStart() / TMON_JobEnd()
+*
+* @brief      Start (resp. end) of a job of an event-driven task. The end checks the job against the
+*             task's contract.
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @param[in]  releaseUs   time of the event that released the job (see TIME_NowUs())
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_JobStart(INT8U taskId){
+
+  jobTbl[taskId].execStart = TMON_ExecCycles(taskId);
+}
+
+/******************************************************************************/
+
+void TMON_JobEnd(INT8U taskId, uint64_t releaseUs){
+
+  INT32U resp;
+  INT32U exec;
+
+  resp = (INT32U) (TIME_NowUs() - releaseUs);
+  exec = (TMON_ExecCycles(taskId) - jobTbl[taskId].execStart) / cyclesPerUs;
+  TMON_Record(taskId, resp, exec);
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_SwitchHook()
+*
+* @brief      Charges the cycles elapsed since the last context switch to the task being switched out.
+*             Called from App_TaskSwHook(), interrupts disabled.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_SwitchHook(void){
+
+  TASK_USER_DATA *puser;
+  INT32U now = UTI_CycCntGet();
+
+  puser = OSTCBCur->OSTCBExtPtr;
+  if(puser != (TASK_USER_DATA*)0)
+    puser->taskCycles += now - swCycles;
+
+  swCycles = now;
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_NowUs()
+*
+* @brief      Current time with the resolution of the SysTick counter
+*
+* @param[in]  none
+* @exception  none
+* @return     time since start [us]
+*
+********************************************************************************************************/
+
+uint64_t TMON_NowUs(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT32U ticks;
+  INT32U load;
+  INT32U val;
+
+  OS_ENTER_CRITICAL();
+  ticks = OSTime;
+  load  = SysTick->LOAD + 1;
+  val   = SysTick->VAL;
+  if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk){     // Tick elapsed but not processed yet
+    ticks++;
+    val = SysTick->VAL;
+  }
+  if(!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+    val = load;                               // No tick running (virtual time)
+  OS_EXIT_CRITICAL();
+
+  return (uint64_t) ticks * US_PER_TICK + (uint64_t) (load - val) * US_PER_TICK / load;
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_SetCallback()
+*
+* @brief      Registers a function called on every contract violation (from the violating task)
+*
+* @param[in]  callback    violation callback, 0 to remove it
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_SetCallback(TMON_CALLBACK callback){
+  violationCallback = callback;
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_GetContract()
+*
+* @brief      Timing contract access function
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @exception  none
+* @return     pointer on the task's contract
+*
+********************************************************************************************************/
+
+const TMON_CONTRACT* TMON_GetContract(INT8U taskId){
+  return &contractTbl[taskId];
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_SetPeriod()
+*
+* @brief      Changes the period of a monitored task (parameter store), from its next release
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @param[in]  periodMs    new period, not 0
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_SetPeriod(INT8U taskId, INT32U periodMs){
+
+  if(contractTbl[taskId].periodMs != 0 && periodMs != 0)
+    contractTbl[taskId].periodMs = periodMs;
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_GetStats()
+*
+* @brief      Returns a consistent copy of the measurements of a task
+*
+* @param[in]  taskId      task ID (see app_cfg.h)
+* @param[out] stats       TMON_STATS structure to fill
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void TMON_GetStats(INT8U taskId, TMON_STATS *stats){
+
+  OSSchedLock();                        // Statistics are only updated by the tasks themselves
+  *stats = statsTbl[taskId];
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         TMON_Percentile()
+*
+* @brief      Response time percentile from the histogram of a task
+*
+* @param[in]  stats       measurements of the task
+* @param[in]  permille    percentile to compute (e.g. 990 for the 99th percentile)
+* @exception  none
+* @return     upper bound of the histogram bucket holding the percentile [us], 0 if no data
+*
+********************************************************************************************************/
+
+INT32U TMON_Percentile(const TMON_STATS *stats, INT16U permille){
+
+  INT32U total = 0;
+  INT32U target;
+  INT32U cum = 0;
+  int i;
+  int octave;
+
+  for(i = 0; i < TMON_HIST_BUCKETS; i++)
+    total += stats->hist[i];
+
+  if(total == 0)
+    return 0;
+
+  target = (total * permille + 999) / 1000;
+
+  for(i = 0; i < TMON_HIST_BUCKETS; i++){
+    cum += stats->hist[i];
+    if(cum >= target)
+      break;
+  }
+
+  // Upper bound of bucket i (see TMON_Record())
+  if(i < 4)
+    return i + 1;
+
+  octave = (i - 4) / 4 + 2;
+  return (INT32U) (5 + (i - 4) % 4) << (octave - 2);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// CPU cycles charged to a task so far, including the current slice if it is running
+static INT32U TMON_ExecCycles(INT8U taskId){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT32U cycles;
+
+  OS_ENTER_CRITICAL();
+  cycles = taskUserData[taskId].taskCycles;
+  if(OSTCBCur->OSTCBExtPtr == &taskUserData[taskId])
+    cycles += UTI_CycCntGet() - swCycles;
+  OS_EXIT_CRITICAL();
+
+  return cycles;
+}
+
+/******************************************************************************/
+
+// Updates the statistics of a task with a completed job and checks the contract
+static void TMON_Record(INT8U taskId, INT32U resp, INT32U exec){
+
+  const TMON_CONTRACT *contract = &contractTbl[taskId];
+  TMON_STATS *stats = &statsTbl[taskId];
+  int bucket;
+  int octave;
+  int i;
+
+  stats->jobs++;
+  if(resp > stats->respMax)
+    stats->respMax = resp;
+  if(exec > stats->execMax)
+    stats->execMax = exec;
+
+  // Histogram: values below 4 us have their own bucket, then 4 buckets per power of 2
+  if(resp < 4)
+    bucket = resp;
+  else {
+    octave = 31 - __CLZ(resp);
+    if(octave >= TMON_HIST_MAX_OCTAVE)
+      bucket = TMON_HIST_BUCKETS - 1;
+    else
+      bucket = 4 + (octave - 2) * 4 + (int) ((resp >> (octave - 2)) - 4);
+  }
+
+  // Halve the whole histogram rather than saturating a bucket, to keep the distribution
+  if(stats->hist[bucket] == 0xFFFF)
+    for(i = 0; i < TMON_HIST_BUCKETS; i++)
+      stats->hist[i] >>= 1;
+  stats->hist[bucket]++;
+
+  if(resp > contract->deadlineMs * 1000){
+    stats->deadlineMiss++;
+    TMON_Violation(taskId, TMON_VIOL_DEADLINE, resp);
+  }
+
+  if(exec > contract->budgetUs){
+    stats->budgetOverrun++;
+    TMON_Violation(taskId, TMON_VIOL_BUDGET, exec);
+  }
+}
+
+/******************************************************************************/
+
+static void TMON_Violation(INT8U taskId, INT8U violation, INT32U value){
+
+  if(violationCallback != (TMON_CALLBACK) 0)
+    violationCallback(taskId, violation, value);
+}
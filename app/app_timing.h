@@ -0,0 +1,101 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_timing.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the task timing monitor: periodic
+release of the tasks from their timing contract (period, execution budget,
+deadline), measurement of response time, release jitter and execution time,
+and reporting of the violations.
+
+******************************************************************************/
+
+#ifndef __APP_TIMING_H
+#define __APP_TIMING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Response time histogram: 4 sub-buckets per power of 2, from 1 us up to 2^24 us (~16 s)
+#define TMON_HIST_MAX_OCTAVE    24
+#define TMON_HIST_BUCKETS       (4 + (TMON_HIST_MAX_OCTAVE - 2) * 4)
+
+// Violation types passed to the violation callback
+#define TMON_VIOL_DEADLINE      1       // Response time above the deadline
+#define TMON_VIOL_BUDGET        2       // Execution time above the budget
+#define TMON_VIOL_OVERRUN       3       // Job still running at its next release (release skipped)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Timing contract of a task. A period of 0 means the task is event driven: each job is timed with
+// TMON_JobStart() / TMON_JobEnd() from the event releasing it. A deadline of 0 means the task is
+// not monitored.
+typedef struct TmonContract TMON_CONTRACT;
+
+struct TmonContract {
+  INT32U periodMs;
+  INT32U budgetUs;
+  INT32U deadlineMs;
+};
+
+// Measurements of a task (times in us)
+typedef struct TmonStats TMON_STATS;
+
+struct TmonStats {
+  INT32U jobs;
+  INT32U respMax;
+  INT32U jitterMax;
+  INT32U execMax;
+  INT32U deadlineMiss;
+  INT32U budgetOverrun;
+  INT32U skipped;
+  INT16U hist[TMON_HIST_BUCKETS];   // Response time histogram
+};
+
+typedef void (*TMON_CALLBACK)(INT8U taskId, INT8U violation, INT32U value);
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void   TMON_Init(void);
+void   TMON_Start(INT8U taskId);
+void   TMON_WaitNextPeriod(INT8U taskId);
+void   TMON_JobStart(INT8U taskId);
+void   TMON_JobEnd(INT8U taskId, uint64_t releaseUs);
+void   TMON_SwitchHook(void);
+uint64_t TMON_NowUs(void);
+
+void   TMON_SetCallback(TMON_CALLBACK callback);
+
+const TMON_CONTRACT* TMON_GetContract(INT8U taskId);
+void   TMON_SetPeriod(INT8U taskId, INT32U periodMs);
+void   TMON_GetStats(INT8U taskId, TMON_STATS *stats);
+INT32U TMON_Percentile(const TMON_STATS *stats, INT16U permille);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,223 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_vtime.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Virtual time tick source. When APP_CFG_VTIME_EN is set, the SysTick is not
+started and the kernel clock only moves when the idle task runs: at that point
+every task is blocked, so the clock can jump straight to the earliest pending
+timeout. Tasks take zero virtual time to execute, which makes runs fully
+deterministic and lets a day of operations elapse in seconds.
+
+The helpers VTIME_NextWake() and VTIME_Advance() only rely on the kernel's
+task list, and are also usable by any other module that needs to step the
+kernel clock by more than one tick at a time.
+
+******************************************************************************/
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static INT32U vtimeStart   = 0;        // OSTime when VTIME_Init() was called
+static INT32U lastCycles   = 0;        // Cycle counter at the last idle hook call
+static uint64_t wallCycles = 0;        // Accumulated wall-clock cycles
+static INT32U jumps        = 0;
+static INT32U maxJump      = 0;
+
+
+
+
+/********************************************************************************************************
+*                                         VTIME_Init()
+*
+* @brief      Initialises the virtual time statistics. Called in place of OS_CPU_SysTickInit().
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void VTIME_Init(void){
+
+  UTI_CycCntInit();
+
+  vtimeStart = OSTimeGet();
+  lastCycles = UTI_CycCntGet();
+  wallCycles = 0;
+  jumps      = 0;
+  maxJump    = 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         VTIME_NextWake()
+*
+* @brief      Number of ticks until the earliest task timeout (delay or pend timeout)
+*
+* @param[in]  none
+* @exception  none
+* @return     ticks until the next wake-up, VTIME_NO_WAKE if no task is waiting on a timeout
+*
+********************************************************************************************************/
+
+INT32U VTIME_NextWake(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  OS_TCB *ptcb;
+  INT32U  next = VTIME_NO_WAKE;
+
+  OS_ENTER_CRITICAL();
+  ptcb = OSTCBList;
+  while(ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO){    // The idle task is always last in the list
+    if(ptcb->OSTCBDly != 0 && ptcb->OSTCBDly < next)
+      next = ptcb->OSTCBDly;
+    ptcb = ptcb->OSTCBNext;
+  }
+  OS_EXIT_CRITICAL();
+
+  return next;
+}
+
+
+
+/********************************************************************************************************
+*                                         VTIME_Advance()
+*
+* @brief      Moves the kernel clock forward by several ticks at once
+*
+* @param[in]  ticks       number of ticks to advance
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) All but the last tick are removed from the pending delays in a single pass. The last
+*                   one goes through OSTimeTick() so that the kernel itself readies the tasks that time
+*                   out, exactly as it would on a hardware tick.
+*
+*               (2) Delays shorter than the jump are clamped to 1 so that they expire on the final tick
+*                   instead of being skipped.
+*
+*               (3) Releasing the scheduler lock runs the scheduler, so a task made ready by the jump
+*                   preempts the caller immediately (or as soon as the caller enables interrupts again,
+*                   see PWR_IdleHook()).
+*
+********************************************************************************************************/
+
+void VTIME_Advance(INT32U ticks){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  OS_TCB *ptcb;
+  INT32U  skip;
+
+  if(ticks == 0)
+    return;
+
+  skip = ticks - 1;                                 // Note(1)
+
+  OSSchedLock();
+
+  if(skip > 0){
+    OS_ENTER_CRITICAL();
+    ptcb = OSTCBList;
+    while(ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO){
+      if(ptcb->OSTCBDly != 0)
+        ptcb->OSTCBDly = (ptcb->OSTCBDly > skip) ? ptcb->OSTCBDly - skip : 1;   // Note(2)
+      ptcb = ptcb->OSTCBNext;
+    }
+    OSTime += skip;
+    OS_EXIT_CRITICAL();
+  }
+
+  OSTimeTick();
+
+  OSSchedUnlock();                                  // Note(3)
+}
+
+
+
+/********************************************************************************************************
+*                                         VTIME_IdleHook()
+*
+* @brief      Called by the idle task in virtual time mode. Jumps to the next scheduled wake-up.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The cycle counter wraps after 2^32 cycles (~89 s at 48 MHz), it must be sampled more
+*                   often than that. The idle task runs after every jump, so this is always the case.
+*
+*               (2) With no timeout pending, only an interrupt can release a task: keep spinning.
+*
+********************************************************************************************************/
+
+void VTIME_IdleHook(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT32U now;
+  INT32U next;
+
+  // Account for the wall-clock time spent since the last call
+  now = UTI_CycCntGet();                            // Note(1)
+  OS_ENTER_CRITICAL();
+  wallCycles += (INT32U)(now - lastCycles);
+  OS_EXIT_CRITICAL();
+  lastCycles = now;
+
+  next = VTIME_NextWake();
+  if(next == VTIME_NO_WAKE)                         // Note(2)
+    return;
+
+  VTIME_Advance(next);
+
+  jumps++;
+  if(next > maxJump)
+    maxJump = next;
+}
+
+
+
+/********************************************************************************************************
+*                                         VTIME_GetStats()
+*
+* @brief      Returns the simulated and wall-clock time elapsed since VTIME_Init()
+*
+* @param[out] stats       VTIME_STATS structure to fill
+* @exception  none
+* @return     none
+*
+********************************************************************************************************/
+
+void VTIME_GetStats(VTIME_STATS *stats){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  stats->simTicks   = OSTime - vtimeStart;
+  stats->wallCycles = wallCycles;
+  stats->jumps      = jumps;
+  stats->maxJump    = maxJump;
+  OS_EXIT_CRITICAL();
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: app_vtime.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+This header contains the declarations of the virtual time module. In virtual
+time mode the SysTick is never started: whenever every task is blocked, the
+idle task advances the kernel clock straight to the next scheduled wake-up,
+turning the application into a deterministic discrete-event simulation.
+
+******************************************************************************/
+
+#ifndef __APP_VTIME_H
+#define __APP_VTIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Returned by VTIME_NextWake() when no task is waiting on a timeout
+#define VTIME_NO_WAKE           0xFFFFFFFFu
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct VTimeStats VTIME_STATS;
+
+struct VTimeStats {
+  INT32U simTicks;      // Kernel ticks elapsed since VTIME_Init()
+  uint64_t wallCycles;  // Core clock cycles elapsed since VTIME_Init()
+  INT32U jumps;         // Number of time jumps performed by the idle task
+  INT32U maxJump;       // Longest single jump (ticks)
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void   VTIME_Init(void);
+INT32U VTIME_NextWake(void);
+void   VTIME_Advance(INT32U ticks);
+void   VTIME_IdleHook(void);
+void   VTIME_GetStats(VTIME_STATS *stats);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
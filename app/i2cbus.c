@@ -0,0 +1,482 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: i2cbus.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Common layer of the I2C bus drivers. SENI2C (sensors, I2C1) and SATI2C
+(subsystems, I2C0) each keep a static I2CBUS and send all their transfers
+through I2CBUS_Transfer(), which:
+
+  - polls the transfer, and reports I2CBUS_TIMEOUT when it does not
+    complete within the attempts of the bus,
+  - retries a failed transfer up to APP_CFG_I2C_RETRIES times, waiting
+    APP_CFG_I2C_BACKOFF_US before the first retry and twice as long before
+    each following one,
+  - recovers the bus after a bus error, a lost arbitration or a timeout:
+    the slave left in the middle of a byte keeps SDA low and blocks the
+    bus. The controller is aborted, SCL is clocked by hand until the slave
+    releases SDA, a STOP is sent and the controller is given the pins back.
+    Its configuration is kept: no re-init of the bus is needed,
+  - counts the transfers, errors and retries of the bus and of each device.
+
+Faults can be injected on a bus (I2CBUS_InjectFault()): NACKs, transfers
+never completing, or a slave holding SDA low for a number of SCL pulses.
+The faulty attempts do not reach the controller, while the retries and the
+recovery run on the real bus, so that I2CBUS_SelfTest() measures the actual
+recovery time of each scenario on target.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define I2CBUS_HALF_CLOCK_US    5       // SCL half period of the recovery (100 kHz)
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Self-test scenarios, in the order of the results
+static const struct {
+  const char *name;
+  INT8U       type;
+  INT8U       count;
+  BOOLEAN     done;                     // Expected to complete
+} i2cbusTest[I2CBUS_TEST_NB] = {
+  { "none",      I2CBUS_FAULT_NONE,    0,   true                          },
+  { "nack x2",   I2CBUS_FAULT_NACK,    2,   (2 <= APP_CFG_I2C_RETRIES)    },
+  { "timeout",   I2CBUS_FAULT_TIMEOUT, 1,   (1 <= APP_CFG_I2C_RETRIES)    },
+  { "stuck 5",   I2CBUS_FAULT_STUCK,   5,   true                          },
+  { "stuck",     I2CBUS_FAULT_STUCK,   255, false                         },
+};
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static I2C_TransferReturn_TypeDef I2CBUS_Attempt(I2CBUS *bus, I2C_TransferSeq_TypeDef *seq);
+static I2CBUS_DEV* I2CBUS_Dev(I2CBUS *bus, INT8U addr);
+static BOOLEAN     I2CBUS_SdaLow(I2CBUS *bus);
+static void        I2CBUS_Clock(I2CBUS *bus);
+static void        I2CBUS_WaitUs(INT32U us);
+static INT32U      I2CBUS_CyclesToUs(INT32U cycles);
+
+
+
+
+/********************************************************************************************************
+*                                         I2CBUS_Init()
+*
+* @brief      Initialisation of the controller and the pins of a bus, as master. The clocks of the
+*             controller are enabled by the driver.
+*
+* @param[in]  bus         bus to initialise
+* @param[in]  init        I2C_Init_TypeDef containing initialisation parameters
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void I2CBUS_Init(I2CBUS *bus, const I2C_Init_TypeDef *init){
+
+  INT8U i;
+
+  memset(&bus->stats, 0, sizeof(I2CBUS_STATS));
+  bus->faultType = I2CBUS_FAULT_NONE;
+
+  // Set GPIO pins to 1 to avoid driving the lines low
+  // Configure SCL first to ensure that it is high before SDA
+  GPIO_PinModeSet(bus->port, bus->scl, gpioModeWiredAnd, 1);
+  GPIO_PinModeSet(bus->port, bus->sda, gpioModeWiredAnd, 1);
+
+  // The slave device could be left in an unknown state:
+  //    -> send 9 clock pulses just in case
+  for(i = 0; i < I2CBUS_RECOVERY_CLOCKS; i++)
+    I2CBUS_Clock(bus);
+
+  // Enable the pins at the location of the bus
+  bus->i2c->ROUTE = I2C_ROUTE_SDAPEN |
+                    I2C_ROUTE_SCLPEN |
+                    (bus->location << _I2C_ROUTE_LOCATION_SHIFT);
+
+  I2C_Init(bus->i2c, init);
+}
+
+
+
+/********************************************************************************************************
+*                                         I2CBUS_Transfer()
+*
+* @brief      Transfer with retries and recovery of the bus
+*
+* @param[in]  bus         bus
+* @param[in]  seq         contains information on the message to be sent/received
+* @exception  none
+* @return     i2cTransferDone, or the error of the last attempt (I2CBUS_TIMEOUT when not completed)
+*/
+/* Notes      :(1) After a bus error, a lost arbitration or a timeout, the state of the bus is unknown:
+*                   it is recovered before the next attempt. A NACK leaves the bus idle (the device is
+*                   busy or absent) and is only retried.
+*
+*               (2) Usage and software faults come from the transfer itself and would fail again.
+*
+********************************************************************************************************/
+
+I2C_TransferReturn_TypeDef I2CBUS_Transfer(I2CBUS *bus, I2C_TransferSeq_TypeDef *seq){
+
+  I2C_TransferReturn_TypeDef ret;
+  I2CBUS_DEV *dev = I2CBUS_Dev(bus, seq->addr);
+  INT32U backoff  = APP_CFG_I2C_BACKOFF_US;
+  INT8U  attempt;
+
+  bus->stats.transfers++;
+  if(dev != NULL)
+    dev->transfers++;
+
+  for(attempt = 0; ; attempt++){
+
+    ret = I2CBUS_Attempt(bus, seq);
+    if(ret == i2cTransferDone)
+      return ret;
+
+    switch((int) ret){
+      case i2cTransferNack:     bus->stats.nack++;     break;
+      case i2cTransferBusErr:   bus->stats.busErr++;   break;
+      case i2cTransferArbLost:  bus->stats.arbLost++;  break;
+      case I2CBUS_TIMEOUT:      bus->stats.timeout++;  break;
+      default:                                          break;
+    }
+
+    // Note(1)
+    if(ret == i2cTransferBusErr || ret == i2cTransferArbLost || ret == I2CBUS_TIMEOUT)
+      I2CBUS_Recover(bus);
+
+    // Note(2)
+    if(attempt >= APP_CFG_I2C_RETRIES || ret == i2cTransferUsageFault || ret == i2cTransferSwFault)
+      break;
+
+    bus->stats.retries++;
+    if(dev != NULL)
+      dev->retries++;
+
+    I2CBUS_WaitUs(backoff);
+    backoff *= 2;
+  }
+
+  bus->stats.errors++;
+  if(dev != NULL)
+    dev->errors++;
+
+  return ret;
+}
+
+
+
+/********************************************************************************************************
+*                                         I2CBUS_Recover()
+*
+* @brief      Frees a bus blocked by a slave, without re-initialising the controller
+*
+* @param[in]  bus         bus to recover
+* @exception  none
+* @return     true when SDA is released
+*/
+/* Notes      :(1) A slave interrupted while sending a byte waits for SCL to shift its remaining bits:
+*                   at most 8 bits and the acknowledge. SCL is clocked until SDA reads high.
+*
+*               (2) SDA falling then rising while SCL is high: START then STOP, which resets the bus
+*                   logic of all the slaves.
+*
+*               (3) The abort brings the controller back to idle, the clear commands empty its transmit
+*                   buffer and pending commands. The configuration registers are not touched.
+*
+********************************************************************************************************/
+
+BOOLEAN I2CBUS_Recover(I2CBUS *bus){
+
+  INT32U  start = UTI_CycCntGet();
+  BOOLEAN released;
+  INT8U   i;
+
+  // Abort the transfer and give the pins to the GPIO (output 1: released)
+  bus->i2c->CMD   = I2C_CMD_ABORT;
+  bus->i2c->ROUTE = 0;
+  GPIO_PinModeSet(bus->port, bus->scl, gpioModeWiredAnd, 1);
+  GPIO_PinModeSet(bus->port, bus->sda, gpioModeWiredAnd, 1);
+
+  // Note(1)
+  for(i = 0; i < I2CBUS_RECOVERY_CLOCKS && I2CBUS_SdaLow(bus); i++)
+    I2CBUS_Clock(bus);
+
+  released = !I2CBUS_SdaLow(bus);
+
+  // Note(2)
+  GPIO_PinOutClear(bus->port, bus->sda);
+  I2CBUS_WaitUs(I2CBUS_HALF_CLOCK_US);
+  GPIO_PinOutSet(bus->port, bus->sda);
+  I2CBUS_WaitUs(I2CBUS_HALF_CLOCK_US);
+
+  // Note(3)
+  bus->i2c->ROUTE = I2C_ROUTE_SDAPEN |
+                    I2C_ROUTE_SCLPEN |
+                    (bus->location << _I2C_ROUTE_LOCATION_SHIFT);
+  bus->i2c->CMD   = I2C_CMD_ABORT | I2C_CMD_CLEARTX | I2C_CMD_CLEARPC;
+  bus->i2c->IFC   = _I2C_IFC_MASK;
+
+  // Simulated slave released
+  if(bus->faultType == I2CBUS_FAULT_STUCK && released)
+    bus->faultType = I2CBUS_FAULT_NONE;
+
+  bus->stats.recoveries++;
+  if(!released)
+    bus->stats.recoveryFail++;
+
+  bus->stats.recoveryUsLast = I2CBUS_CyclesToUs(UTI_CycCntGet() - start);
+  if(bus->stats.recoveryUsLast > bus->stats.recoveryUsMax)
+    bus->stats.recoveryUsMax = bus->stats.recoveryUsLast;
+
+  return released;
+}
+
+
+
+/********************************************************************************************************
+*                                         I2CBUS_InjectFault()
+*
+* @brief      Injects a fault on the next transfers of a bus (see I2CBUS_FAULT_xxx)
+*
+* @param[in]  bus         bus
+* @param[in]  type        I2CBUS_FAULT_xxx, I2CBUS_FAULT_NONE to remove the fault
+* @param[in]  count       attempts failing (NACK, TIMEOUT), or SCL pulses before SDA is released (STUCK)
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void I2CBUS_InjectFault(I2CBUS *bus, INT8U type, INT8U count){
+
+  OSSchedLock();
+  bus->faultType   = type;
+  bus->faultCount  = count;
+  bus->faultClocks = 0;
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         I2CBUS_GetStats()
+*
+* @brief      Returns a consistent copy of the counters of a bus
+*
+* @param[in]  bus         bus
+* @param[out] stats       I2CBUS_STATS structure to fill
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void I2CBUS_GetStats(const I2CBUS *bus, I2CBUS_STATS *stats){
+
+  OSSchedLock();
+  *stats = bus->stats;
+  OSSchedUnlock();
+}
+
+
+
+/********************************************************************************************************
+*                                         I2CBUS_SelfTest()
+*
+* @brief      Reads a register of a device under each injected fault, and measures the time to the
+*             status of the transfer (retries, backoff and recovery included)
+*
+* @param[in]  bus         bus
+* @param[in]  addr        device address (must acknowledge)
+* @param[in]  reg         register to read
+* @param[out] res         I2CBUS_TEST_NB results to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The scheduler is locked for the whole test, so that the task using the bus does not
+*                   interleave its transfers. It may miss samples meanwhile.
+*
+*               (2) The transfers of the test are counted in the statistics of the bus.
+*
+********************************************************************************************************/
+
+void I2CBUS_SelfTest(I2CBUS *bus, INT8U addr, INT8U reg, I2CBUS_TEST *res){
+
+  I2C_TransferSeq_TypeDef seq;
+  INT8U  data;
+  INT32U start;
+  INT32U retries, recoveries;
+  INT8U  i;
+
+  seq.addr  = addr;
+  seq.flags = I2C_FLAG_WRITE_READ;
+  seq.buf[0].data = &reg;
+  seq.buf[0].len  = 1;
+  seq.buf[1].data = &data;
+  seq.buf[1].len  = 1;
+
+  OSSchedLock();                                              // Note(1)
+
+  for(i = 0; i < I2CBUS_TEST_NB; i++){
+    bus->faultType   = i2cbusTest[i].type;
+    bus->faultCount  = i2cbusTest[i].count;
+    bus->faultClocks = 0;
+
+    retries    = bus->stats.retries;
+    recoveries = bus->stats.recoveries;
+    start      = UTI_CycCntGet();
+
+    res[i].ret        = I2CBUS_Transfer(bus, &seq);
+    res[i].timeUs     = I2CBUS_CyclesToUs(UTI_CycCntGet() - start);
+    res[i].retries    = bus->stats.retries - retries;
+    res[i].recoveries = bus->stats.recoveries - recoveries;
+    res[i].name       = i2cbusTest[i].name;
+    res[i].pass       = ((res[i].ret == i2cTransferDone) == i2cbusTest[i].done);
+  }
+
+  bus->faultType = I2CBUS_FAULT_NONE;
+
+  OSSchedUnlock();
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Single polled attempt of a transfer, or the injected fault
+static I2C_TransferReturn_TypeDef I2CBUS_Attempt(I2CBUS *bus, I2C_TransferSeq_TypeDef *seq){
+
+  I2C_TransferReturn_TypeDef ret;
+  INT32U timeout = bus->timeout;
+
+  switch(bus->faultType){
+    case I2CBUS_FAULT_NACK:
+      if(bus->faultCount > 0){
+        bus->faultCount--;
+        return i2cTransferNack;
+      }
+      break;
+
+    case I2CBUS_FAULT_TIMEOUT:
+      if(bus->faultCount > 0){
+        bus->faultCount--;
+        while(timeout--)                                      // Same polling time as a real timeout
+          (void) bus->i2c->STATE;
+        return I2CBUS_TIMEOUT;
+      }
+      break;
+
+    case I2CBUS_FAULT_STUCK:
+      return i2cTransferBusErr;                               // START on a low SDA
+
+    default:
+      break;
+  }
+
+  // Do a polled transfer
+  ret = I2C_TransferInit(bus->i2c, seq);
+
+  while(ret == i2cTransferInProgress && timeout--){
+    ret = I2C_Transfer(bus->i2c);
+  }
+
+  return (ret == i2cTransferInProgress) ? I2CBUS_TIMEOUT : ret;
+}
+
+/******************************************************************************/
+
+// Counters of a device, allocated on its first transfer (NULL when the table is full)
+static I2CBUS_DEV* I2CBUS_Dev(I2CBUS *bus, INT8U addr){
+
+  INT8U i;
+
+  for(i = 0; i < I2CBUS_MAX_DEV; i++){
+    if(bus->stats.dev[i].addr == addr)
+      return &bus->stats.dev[i];
+    if(bus->stats.dev[i].addr == 0){
+      bus->stats.dev[i].addr = addr;
+      return &bus->stats.dev[i];
+    }
+  }
+
+  return NULL;
+}
+
+/******************************************************************************/
+
+// SDA held low by a slave (or by the simulated one)
+static BOOLEAN I2CBUS_SdaLow(I2CBUS *bus){
+
+  if(bus->faultType == I2CBUS_FAULT_STUCK)
+    return (bus->faultClocks < bus->faultCount);
+
+  return (GPIO_PinInGet(bus->port, bus->sda) == 0);
+}
+
+/******************************************************************************/
+
+// One SCL pulse driven by the GPIO
+static void I2CBUS_Clock(I2CBUS *bus){
+
+  GPIO_PinOutClear(bus->port, bus->scl);
+  I2CBUS_WaitUs(I2CBUS_HALF_CLOCK_US);
+  GPIO_PinOutSet(bus->port, bus->scl);
+  I2CBUS_WaitUs(I2CBUS_HALF_CLOCK_US);
+
+  if(bus->faultType == I2CBUS_FAULT_STUCK && bus->faultClocks < 255)
+    bus->faultClocks++;
+}
+
+/******************************************************************************/
+
+// Busy wait on the cycle counter (short delays, below the OS tick)
+static void I2CBUS_WaitUs(INT32U us){
+
+  INT32U start  = UTI_CycCntGet();
+  INT32U cycles = us * (CMU_ClockFreqGet(cmuClock_CORE) / 1000000);
+
+  while(UTI_CycCntGet() - start < cycles);
+}
+
+/******************************************************************************/
+
+static INT32U I2CBUS_CyclesToUs(INT32U cycles){
+
+  return cycles / (CMU_ClockFreqGet(cmuClock_CORE) / 1000000);
+}
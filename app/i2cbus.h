@@ -0,0 +1,132 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: i2cbus.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Common layer of the I2C bus drivers (SENI2C, SATI2C): polled transfers with
+status codes, retry and backoff policy, stuck bus recovery at runtime, error
+counters per bus and per device, and fault injection for the self-test.
+
+******************************************************************************/
+
+
+
+#ifndef __I2CBUS_H
+#define __I2CBUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Status of a transfer polled for 'timeout' attempts without completing (in addition to the
+// I2C_TransferReturn_TypeDef codes of emlib)
+#define I2CBUS_TIMEOUT          ((I2C_TransferReturn_TypeDef) -16)
+
+#define I2CBUS_MAX_DEV          4       // Devices with their own counters, per bus
+#define I2CBUS_RECOVERY_CLOCKS  9       // SCL pulses to release a slave holding SDA low
+
+// Injected faults (see I2CBUS_InjectFault())
+#define I2CBUS_FAULT_NONE       0
+#define I2CBUS_FAULT_NACK       1       // 'count' transfers not acknowledged
+#define I2CBUS_FAULT_TIMEOUT    2       // 'count' transfers never completing
+#define I2CBUS_FAULT_STUCK      3       // SDA held low by a slave, released after 'count' SCL pulses
+
+// Self-test (see I2CBUS_SelfTest())
+#define I2CBUS_TEST_NB          5       // Scenarios
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Counters of a device (I2C address)
+typedef struct I2cBusDev I2CBUS_DEV;
+
+struct I2cBusDev {
+  INT8U  addr;                          // 0: free entry
+  INT32U transfers;
+  INT32U errors;                        // Transfers failed after all the retries
+  INT32U retries;
+};
+
+// Counters of a bus (times in us)
+typedef struct I2cBusStats I2CBUS_STATS;
+
+struct I2cBusStats {
+  INT32U transfers;
+  INT32U errors;                        // Transfers failed after all the retries
+  INT32U retries;
+  INT32U nack;                          // Failed attempts, by cause
+  INT32U busErr;
+  INT32U arbLost;
+  INT32U timeout;
+  INT32U recoveries;                    // Stuck bus recoveries
+  INT32U recoveryFail;                  // SDA still low after I2CBUS_RECOVERY_CLOCKS pulses
+  INT32U recoveryUsLast;
+  INT32U recoveryUsMax;
+  I2CBUS_DEV dev[I2CBUS_MAX_DEV];
+};
+
+// Bus, static in its driver
+typedef struct I2cBus I2CBUS;
+
+struct I2cBus {
+  const char        *name;
+  I2C_TypeDef       *i2c;
+  GPIO_Port_TypeDef  port;              // SCL and SDA pins (same port)
+  INT8U              scl;
+  INT8U              sda;
+  INT8U              location;          // Route location of the pins
+  INT32U             timeout;           // Attempts for a transfer
+  I2CBUS_STATS       stats;
+  INT8U              faultType;         // Injected fault (I2CBUS_FAULT_xxx)
+  INT8U              faultCount;
+  INT8U              faultClocks;       // SCL pulses seen by the stuck slave
+};
+
+// Result of a self-test scenario
+typedef struct I2cBusTest I2CBUS_TEST;
+
+struct I2cBusTest {
+  const char                *name;
+  I2C_TransferReturn_TypeDef ret;       // Status of the transfer
+  INT32U                     retries;
+  INT32U                     recoveries;
+  INT32U                     timeUs;    // From the first attempt to the status
+  BOOLEAN                    pass;      // Expected status
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void                       I2CBUS_Init(I2CBUS *bus, const I2C_Init_TypeDef *init);
+I2C_TransferReturn_TypeDef I2CBUS_Transfer(I2CBUS *bus, I2C_TransferSeq_TypeDef *seq);
+BOOLEAN                    I2CBUS_Recover(I2CBUS *bus);
+
+void                       I2CBUS_InjectFault(I2CBUS *bus, INT8U type, INT8U count);
+void                       I2CBUS_GetStats(const I2CBUS *bus, I2CBUS_STATS *stats);
+void                       I2CBUS_SelfTest(I2CBUS *bus, INT8U addr, INT8U reg, I2CBUS_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __I2CBUS_H */
@@ -73,7 +73,9 @@ extern "C" {
 #include  <stdarg.h>
 #include  <stdio.h>
 #include  <stdlib.h>
+#include  <stddef.h>
 #include  <string.h>
+#include  <math.h>
 
 
 /*
@@ -106,10 +108,19 @@ extern "C" {
 #include  "bspos.h"
 #include  "retargetserial.h"
 
+#include  "app_stats.h"
 #include  "app_database.h"
 #include  "app_display.h"
 #include  "app_command.h"
 #include  "app_data_management.h"
+#include  "app_vtime.h"
+#include  "app_power.h"
+#include  "app_timing.h"
+#include  "app_time.h"
+#include  "app_stkmon.h"
+#include  "app_msgq.h"
+#include  "app_bench.h"
+#include  "app_adcs.h"
 
 /*
 *********************************************************************************************************
@@ -133,6 +144,7 @@ extern "C" {
 #include <em_usart.h>
 #include <em_chip.h>
 #include <em_i2c.h>
+#include <em_rtc.h>
   
 #include <gpiointerrupt.h>
 
@@ -142,15 +154,33 @@ extern "C" {
 *                                          DRIVER FILES
 *********************************************************************************************************
 */
+#include <i2cbus.h>
 #include <seni2c.h>
 #include <sati2c.h>
 
 // Sensors  
+#include <decim.h>
+#include <sensor.h>
 #include <itg3200.h>
 #include <hmc5883l.h>
   
 // Subsystems
 #include <PL.h>
+#include <plqueue.h>
+
+// ADCS
+#include <gyrobias.h>
+#include <magcal.h>
+#include <bdot.h>
+#include <attitude.h>
+
+// Storage
+#include <flash.h>
+#include <logstore.h>
+#include <downlink.h>
+#include <param.h>
+#include <tlmcomp.h>
+#include <retain.h>
 
 /*
 *********************************************************************************************************
@@ -160,7 +190,7 @@ extern "C" {
 /* Uncomment this macro definition if USART1 or LEUART0 is connected to your STK board! */
 #define USART_CONNECTED
   
-#define TASK_USER_NB 9
+#define TASK_USER_NB 10
 
 
 /*
@@ -173,6 +203,7 @@ extern "C" {
 // User task stat structure
 typedef struct {
   uint32_t taskExecTime;
+  uint32_t taskCycles;          // CPU cycles used since start (wraps, use differences)
   uint32_t taskCPUUsage;
 } TASK_USER_DATA;
 extern TASK_USER_DATA taskUserData[TASK_USER_NB];
@@ -180,7 +211,30 @@ extern TASK_USER_DATA taskUserData[TASK_USER_NB];
 // Declaration of global mailbox objects for inter-task communication
 extern OS_EVENT *pSerialMsgObj;
 extern OS_EVENT *commandMsgObj;
-extern OS_EVENT *memMngmtMsgObj;
+
+// Declaration of global semaphore objects
+extern OS_EVENT *magReadySem;
+extern OS_EVENT *senReadySem;
+
+// Declaration of global record pools and message queues
+extern MSGQ_POOL  recordPool;
+extern MSGQ_QUEUE memMngmtQ;
+
+// Declaration of the magnetometer calibration and of the attitude estimator
+extern MAGCAL mag1Cal;
+extern ATT    attEst;
+
+// Declaration of the logs
+extern LOG      senLog;
+extern LOG      senTierLog[APP_CFG_RET_TIERS];
+extern RET_TIER senTier[APP_CFG_RET_TIERS];
+extern LOG      hkLog;
+
+// Declaration of the parameter store
+extern PARAM_STORE params;
+
+// Declaration of the PL request queue
+extern PLQ plQueue;
 
 // Declaration of global mutex objects
 extern OS_EVENT *dataMutex;
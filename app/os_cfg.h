@@ -30,7 +30,7 @@ extern "C" {
 #endif
 
                                        /* ---------------------- MISCELLANEOUS ----------------------- */
-#define OS_APP_HOOKS_EN           0u   /* Application-defined hooks are called from the uC/OS-II hooks */
+#define OS_APP_HOOKS_EN           1u   /* Application-defined hooks are called from the uC/OS-II hooks */
 #define OS_ARG_CHK_EN             0u   /* Enable (1) or Disable (0) argument checking                  */
 #define OS_CPU_HOOKS_EN           1u   /* uC/OS-II hooks are found in the processor port files         */
 
@@ -42,7 +42,7 @@ extern "C" {
 #define OS_LOWEST_PRIO           63u   /* Defines the lowest priority that can be assigned ...         */
                                        /* ... MUST NEVER be higher than 254!                           */
 
-#define OS_MAX_EVENTS            10u   /* Max. number of event control blocks in your application      */
+#define OS_MAX_EVENTS            12u   /* Max. number of event control blocks in your application      */
 #define OS_MAX_FLAGS              5u   /* Max. number of Event Flag Groups    in your application      */
 #define OS_MAX_MEM_PART           5u   /* Max. number of memory partitions                             */
 #define OS_MAX_QS                 4u   /* Max. number of queue control blocks in your application      */
@@ -72,7 +72,7 @@ extern "C" {
 #define OS_TASK_QUERY_EN          1u   /*     Include code for OSTaskQuery()                           */
 #define OS_TASK_REG_TBL_SIZE      1u   /*     Size of task variables array (#of INT32U entries)        */
 #define OS_TASK_STAT_EN           1u   /*     Enable (1) or Disable(0) the statistics task             */
-#define OS_TASK_STAT_STK_CHK_EN   1u   /*     Check task stacks from statistic task                    */
+#define OS_TASK_STAT_STK_CHK_EN   0u   /*     Check task stacks from statistic task (see app_stkmon.c) */
 #define OS_TASK_SUSPEND_EN        1u   /*     Include code for OSTaskSuspend() and OSTaskResume()      */
 #define OS_TASK_SW_HOOK_EN        1u   /*     Include code for OSTaskSwHook()                          */
 
@@ -111,12 +111,12 @@ extern "C" {
 
 
                                        /* ---------------------- MESSAGE QUEUES ---------------------- */
-#define OS_Q_EN                   0u   /* Enable (1) or Disable (0) code generation for QUEUES         */
+#define OS_Q_EN                   1u   /* Enable (1) or Disable (0) code generation for QUEUES         */
 #define OS_Q_ACCEPT_EN            0u   /*     Include code for OSQAccept()                             */
 #define OS_Q_DEL_EN               0u   /*     Include code for OSQDel()                                */
 #define OS_Q_FLUSH_EN             0u   /*     Include code for OSQFlush()                              */
 #define OS_Q_PEND_ABORT_EN        0u   /*     Include code for OSQPendAbort()                          */
-#define OS_Q_POST_EN              0u   /*     Include code for OSQPost()                               */
+#define OS_Q_POST_EN              1u   /*     Include code for OSQPost()                               */
 #define OS_Q_POST_FRONT_EN        0u   /*     Include code for OSQPostFront()                          */
 #define OS_Q_POST_OPT_EN          0u   /*     Include code for OSQPostOpt()                            */
 #define OS_Q_QUERY_EN             0u   /*     Include code for OSQQuery()                              */
@@ -0,0 +1,248 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: decim.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Fixed-point CIC (cascaded integrator-comb) decimation filter. The sensors
+are read faster than the database rate, and each stream is reduced by its
+own ratio R:
+
+  - DECIM_ORDER integrators run on every input (additions only),
+  - every R inputs, DECIM_ORDER combs (differences) produce the output,
+    divided by the DC gain R^DECIM_ORDER.
+
+The response is the convolution of DECIM_ORDER moving averages of length R:
+zeros at all the multiples of the output rate, which reject the noise and
+the components that would alias onto the low frequencies. White noise is
+reduced by about sqrt(3R/2) for the second order. The group delay is
+DECIM_ORDER * (R - 1) / 2 input periods.
+
+The integrators grow without bound on a non-zero input: they are unsigned
+64-bit and wrap around. The combs take their differences modulo 2^64 as
+well, and the result is exact as long as the true output fits, which it
+does: at most R^DECIM_ORDER times the largest input, below 2^47 for Q16.16
+inputs and ratios up to 255. Each filter counts its cycles, to report the
+cost per output sample.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/********************************************************************************************************
+*                                         DECIM_Init()
+*
+* @brief      Resets a decimation filter
+*
+* @param[in]  dec         filter to initialise
+* @param[in]  nbCh        number of channels (<= DECIM_MAX_CH)
+* @param[in]  ratio       inputs per output (1: no decimation)
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void DECIM_Init(DECIM *dec, INT8U nbCh, INT8U ratio){
+
+  INT8U k;
+
+  memset(dec, 0, sizeof(DECIM));
+  dec->nbCh   = (nbCh > DECIM_MAX_CH) ? DECIM_MAX_CH : nbCh;
+  dec->ratio  = (ratio == 0) ? 1 : ratio;
+  dec->warmup = DECIM_ORDER - 1;
+
+  dec->gain = 1;
+  for(k = 0; k < DECIM_ORDER; k++)
+    dec->gain *= dec->ratio;
+}
+
+
+
+/********************************************************************************************************
+*                                         DECIM_Input()
+*
+* @brief      Adds a sample to the filter, and computes the output every 'ratio' samples
+*
+* @param[in]  dec         filter
+* @param[in]  in          input sample, one value per channel
+* @param[out] out         output sample, written only when one is produced
+* @exception  none
+* @return     true when an output was produced
+*/
+/* Notes      :(1) The first DECIM_ORDER - 1 outputs after init are computed on a partly filled window
+*                   and are discarded.
+*
+*               (2) Modular arithmetic: the wrap-around of the integrators cancels in the differences of
+*                   the combs, the result is converted back to signed.
+*
+*               (3) Both cost counters are halved before the cycles overflow (after days at the gyro
+*                   rate): their ratio is kept, and the older outputs weigh less and less.
+*
+********************************************************************************************************/
+
+BOOLEAN DECIM_Input(DECIM *dec, const q16_t *in, q16_t *out){
+
+  INT32U   start = UTI_CycCntGet();
+  uint64_t y, prev;
+  int64_t  sum;
+  INT8U    ch, k;
+  BOOLEAN  ready = false;
+
+  // Integrators                                              Note(2)
+  for(ch = 0; ch < dec->nbCh; ch++){
+    dec->integ[ch][0] += (uint64_t) in[ch];
+    for(k = 1; k < DECIM_ORDER; k++)
+      dec->integ[ch][k] += dec->integ[ch][k - 1];
+  }
+
+  // Combs, at the output rate
+  if(++dec->count >= dec->ratio){
+    dec->count = 0;
+
+    for(ch = 0; ch < dec->nbCh; ch++){
+      y = dec->integ[ch][DECIM_ORDER - 1];
+      for(k = 0; k < DECIM_ORDER; k++){
+        prev = dec->comb[ch][k];
+        dec->comb[ch][k] = y;
+        y -= prev;
+      }
+      sum = (int64_t) y;
+      out[ch] = (q16_t) ((sum + ((sum >= 0) ? dec->gain / 2 : -dec->gain / 2)) / dec->gain);
+    }
+
+    if(dec->warmup > 0)                                       // Note(1)
+      dec->warmup--;
+    else {
+      dec->outputs++;
+      ready = true;
+    }
+  }
+
+  dec->cycles += UTI_CycCntGet() - start;
+  if(dec->cycles >= DECIM_CYCLES_HALVE){                      // Note(3)
+    dec->cycles  /= 2;
+    dec->outputs /= 2;
+  }
+
+  return ready;
+}
+
+
+
+/********************************************************************************************************
+*                                         DECIM_CyclesPerOutput()
+*
+* @brief      Returns the cost of the filter per output sample (all its inputs included)
+*
+* @param[in]  dec         filter
+* @exception  none
+* @return     cycles per output, 0 before the first output
+*
+*
+********************************************************************************************************/
+
+INT32U DECIM_CyclesPerOutput(const DECIM *dec){
+
+  return (dec->outputs > 0) ? dec->cycles / dec->outputs : 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         DECIM_SelfTest()
+*
+* @brief      Measures the noise reduction, the DC accuracy and the cost of the filter on a synthetic
+*             stream
+*
+* @param[out] res         DECIM_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The input is a constant plus uniform white noise. The expected ratio of standard
+*                   deviations is 1 / sqrt(sum(h^2)) for the normalised impulse response h of the filter,
+*                   computed here by convolving DECIM_ORDER moving averages.
+*
+*               (2) Passes if the noise ratio is within 20 % of the expected one and the mean is kept
+*                   within 1/1000 of the noise amplitude.
+*
+********************************************************************************************************/
+
+void DECIM_SelfTest(DECIM_TEST *res){
+
+  const double level = 100.0;
+  const double noise = UTI_Q16ToFloat(DECIM_TEST_NOISE);
+  double h[DECIM_ORDER * (DECIM_TEST_RATIO - 1) + 1];
+  double conv[DECIM_ORDER * (DECIM_TEST_RATIO - 1) + 1];
+  double sumIn = 0.0, sqIn = 0.0, sumOut = 0.0, sqOut = 0.0;
+  double x, y, mean, var, sumH2;
+  DECIM  dec;
+  uint32_t seed = 4321;
+  INT32U nIn = 0, nOut = 0;
+  q16_t  in, out;
+  int    len, i, j, k;
+
+  // Expected noise reduction                                 Note(1)
+  len  = 1;
+  h[0] = 1.0;
+  for(k = 0; k < DECIM_ORDER; k++){
+    for(i = 0; i < len + DECIM_TEST_RATIO - 1; i++){
+      conv[i] = 0.0;
+      for(j = 0; j < DECIM_TEST_RATIO; j++)
+        if(i - j >= 0 && i - j < len)
+          conv[i] += h[i - j] / DECIM_TEST_RATIO;
+    }
+    len += DECIM_TEST_RATIO - 1;
+    for(i = 0; i < len; i++)
+      h[i] = conv[i];
+  }
+  sumH2 = 0.0;
+  for(i = 0; i < len; i++)
+    sumH2 += h[i] * h[i];
+
+  // Filtered stream
+  DECIM_Init(&dec, 1, DECIM_TEST_RATIO);
+
+  while(nOut < DECIM_TEST_OUTPUTS){
+    x  = level + noise * UTI_RandUniform(&seed);
+    in = UTI_Q16FromFloat(x);
+    x  = UTI_Q16ToFloat(in);
+    sumIn += x;
+    sqIn  += x * x;
+    nIn++;
+
+    if(DECIM_Input(&dec, &in, &out)){
+      y = UTI_Q16ToFloat(out);
+      sumOut += y;
+      sqOut  += y * y;
+      nOut++;
+    }
+  }
+
+  mean = sumIn / nIn;
+  var  = sqIn / nIn - mean * mean;
+  res->noiseIn = UTI_Q16FromFloat(sqrt(var));
+
+  y   = sumOut / nOut;
+  var = sqOut / nOut - y * y;
+  res->noiseOut = UTI_Q16FromFloat(sqrt(var));
+  res->meanErr  = UTI_Q16FromFloat(y - mean);
+
+  res->noiseRatio       = UTI_Q16Div(res->noiseIn, res->noiseOut);
+  res->noiseRatioTheory = UTI_Q16FromFloat(1.0 / sqrt(sumH2));
+  res->cyclesPerOutput  = DECIM_CyclesPerOutput(&dec);
+
+  // Note(2)
+  res->pass = (res->noiseRatio > res->noiseRatioTheory - res->noiseRatioTheory / 5 &&
+               res->noiseRatio < res->noiseRatioTheory + res->noiseRatioTheory / 5 &&
+               abs(res->meanErr) < DECIM_TEST_NOISE / 1000);
+}
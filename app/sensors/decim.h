@@ -0,0 +1,90 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: decim.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Fixed-point CIC decimation filter for the oversampled sensor streams
+
+******************************************************************************/
+
+
+
+#ifndef __DECIM_H
+#define __DECIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define DECIM_ORDER             2       // Number of integrator/comb stages
+#define DECIM_MAX_CH            4       // Channels per filter (values of a device)
+#define DECIM_CYCLES_HALVE      0x80000000uL  // The cost counters are halved when the cycles reach it
+
+// Self-test (see DECIM_SelfTest())
+#define DECIM_TEST_RATIO        10
+#define DECIM_TEST_OUTPUTS      1000
+#define DECIM_TEST_NOISE        UTI_Q16FromFloat(1.0)       // Input noise amplitude (uniform)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct Decim DECIM;
+
+struct Decim {
+  INT8U    nbCh;
+  INT8U    ratio;                       // Inputs per output
+  INT8U    count;                       // Inputs since the last output
+  INT8U    warmup;                      // Outputs still to discard after init
+  int64_t  gain;                        // ratio^DECIM_ORDER
+  uint64_t integ[DECIM_MAX_CH][DECIM_ORDER];    // Wrap around (modular arithmetic, see decim.c)
+  uint64_t comb[DECIM_MAX_CH][DECIM_ORDER];
+  INT32U   outputs;                     // Halved together with the cycles (see DECIM_Input())
+  INT32U   cycles;                      // Cycles spent in the filter (inputs and outputs)
+};
+
+typedef struct DecimTest DECIM_TEST;
+
+struct DecimTest {
+  q16_t   noiseIn;                      // Standard deviation of the input
+  q16_t   noiseOut;                     // Standard deviation of the output
+  q16_t   noiseRatio;                   // noiseIn / noiseOut
+  q16_t   noiseRatioTheory;             // Expected for white noise
+  q16_t   meanErr;                      // Output mean - input mean
+  INT32U  cyclesPerOutput;
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    DECIM_Init(DECIM *dec, INT8U nbCh, INT8U ratio);
+BOOLEAN DECIM_Input(DECIM *dec, const q16_t *in, q16_t *out);
+INT32U  DECIM_CyclesPerOutput(const DECIM *dec);
+
+void    DECIM_SelfTest(DECIM_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __DECIM_H */
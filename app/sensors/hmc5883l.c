@@ -22,80 +22,53 @@ Functions for converting the values read from the ITG3200
 
 
 
-/********************************************************************************************************
-*                                         HMC5883L_Init()
-*
-* @brief      Initialization of the HMC5883L configuration registers.
-*             Only call when I2C1 initizalized.   (See datasheet for more info)
-*
-* @param[in]  none
-* @exception  none
-* @return     node
-*
-*
-********************************************************************************************************/
-
-void  HMC5883L_Init(){
-  
-  // Write on the configuration registers of the HMC5883L
-  SENI2C_WriteRegister8U(HMC5883L_ADDR, HMC5883L_CFGA,    CFGA);
-  SENI2C_WriteRegister8U(HMC5883L_ADDR, HMC5883L_CFGB,    CFGB);
-  SENI2C_WriteRegister8U(HMC5883L_ADDR, HMC5883L_MODEREG, MODEREG);
-
-}
+// Configuration registers (see datasheet), written by SENSOR_Init()
+const SENSOR_INIT HMC5883L_InitSeq[HMC5883L_INIT_LEN] = {
+  { HMC5883L_CFGA,    CFGA    },
+  { HMC5883L_CFGB,    CFGB    },
+  { HMC5883L_MODEREG, MODEREG }
+};
 
 
 
 /********************************************************************************************************
-*                                         HMC5883L_GetMeasurements()
+*                                         HMC5883L_Convert()
 *
-* @brief      Get measurements from the HMC5883L sensor
+* @brief      Converts the data block of the HMC5883L (MAG_XH to MAG_YL)
 *
-* @param[in]  none
+* @param[in]  raw         data block, HMC5883L_DATA_LEN bytes, big endian, in X, Z, Y order
+* @param[out] out         X, Y, Z (mG, Q16.16)
 * @exception  none
-* @return     HMCV structure with X, Y and Z values
+* @return     none
 *
 *
 ********************************************************************************************************/
 
-HMCV  HMC5883L_GetMeasurements(){
-  
-  HMCV res;
-  int16_t i;
-  
-  // Get X magnetic field
-  i = SENI2C_ReadRegister16(HMC5883L_ADDR, HMC5883L_MAG_XH, HMC5883L_MAG_XL);
-  res.X = HMC5883L_ConvertMag((float)i);
-  
-  // Get Y magnetic field
-  i = SENI2C_ReadRegister16(HMC5883L_ADDR, HMC5883L_MAG_YH, HMC5883L_MAG_YL);
-  res.Y = HMC5883L_ConvertMag((float)i);
-  
-  // Get Z magnetic field
-  i = SENI2C_ReadRegister16(HMC5883L_ADDR, HMC5883L_MAG_ZH, HMC5883L_MAG_ZL);
-  res.Z = HMC5883L_ConvertMag((float)i);
+void HMC5883L_Convert(const INT8U *raw, q16_t *out){
   
-  return res;
+  out[0] = HMC5883L_ConvertMag((int16_t) ((raw[0] << 8) | raw[1]));
+  out[1] = HMC5883L_ConvertMag((int16_t) ((raw[4] << 8) | raw[5]));
+  out[2] = HMC5883L_ConvertMag((int16_t) ((raw[2] << 8) | raw[3]));
 }
 
 
 
 
 /********************************************************************************************************
-*                                         ITG3200_ConvertTemp()
+*                                         HMC5883L_ConvertMag()
 *
-* @brief      Converts temp reading into degrees Celsius
+* @brief      Converts magnetic field reading into mG
 *
-* @param[in]  value       temp reading
+* @param[in]  value       magnetic field reading
 * @exception  none
-* @return     result
+* @return     result (Q16.16)
 *
 *
 ********************************************************************************************************/
 
-float HMC5883L_ConvertMag(float value){
+q16_t HMC5883L_ConvertMag(int16_t value){
   
-  return (float)  (value*HMC5883L_SENSITIVITY);
+  return UTI_Q16Scale(value, HMC5883L_SCALE_Q24);
 }
 
 
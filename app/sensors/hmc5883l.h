@@ -29,6 +29,7 @@ extern "C" {
 
 // Conversion parameters (depends of Gain configuration, see datasheet)
 #define HMC5883L_SENSITIVITY    4.35    //mG/LSb
+#define HMC5883L_SCALE_Q24      UTI_Q24FromFloat(HMC5883L_SENSITIVITY)
 
 // HMC5883L Address and Registers definitions
 //      The 7-bit address is shifted by 1 bit to the left due to 
@@ -53,8 +54,8 @@ extern "C" {
 // HMC5883L configuration defines
 #define MA1     (0<<6)
 #define MA0     (0<<5)
-#define DO2     (1<<4)     
-#define DO1     (0<<3)
+#define DO2     (1<<4)      // 75 Hz output, above the read rate (see APP_CFG_SEN_MAG_DIVIDER)
+#define DO1     (1<<3)
 #define DO0     (0<<2)
 #define MS1     (0<<1)
 #define MS0     (0<<0)
@@ -69,32 +70,24 @@ extern "C" {
 #define MD1     (0<<1)
 #define MD0     (0<<0)
 #define MODEREG (HS|MD1|MD0)
-  
-  
-  
-/********************************************************************************************************
-*                                          STRUCTURES
-********************************************************************************************************/
 
+// Sensor framework descriptor (see sensor.c): init sequence and data block
+// MAG_XH to MAG_YL, converted into X, Y, Z (mG)
+#define HMC5883L_INIT_LEN       3
+#define HMC5883L_DATA_REG       HMC5883L_MAG_XH
+#define HMC5883L_DATA_LEN       6
+#define HMC5883L_NB_OUT         3
   
   
-typedef struct HMCValues HMCV;
-
-struct HMCValues {
-  float X;         
-  float Y;
-  float Z;
-};
-
-  
   
 /********************************************************************************************************
 *                                         FUNCTION PROTOTYPES
 ********************************************************************************************************/
  
-void  HMC5883L_Init();
-HMCV  HMC5883L_GetMeasurements();
-float HMC5883L_ConvertMag(float value);
+extern const SENSOR_INIT HMC5883L_InitSeq[HMC5883L_INIT_LEN];
+
+void  HMC5883L_Convert(const INT8U *raw, q16_t *out);
+q16_t HMC5883L_ConvertMag(int16_t value);
 
   
   
@@ -17,13 +17,21 @@ Functions for converting the values read from the ITG3200
 
 #include <includes.h>
 
-uint32_t time = 0;
+// Configuration registers (see datasheet), written by SENSOR_Init()
+const SENSOR_INIT ITG3200_InitSeq[ITG3200_INIT_LEN] = {
+  { ITG3200_SMPLRT_DIV, SMPLRT_DIV },
+  { ITG3200_DLPF_FS,    DLPF_FS    },
+  { ITG3200_INT_CFG,    INT_CFG    },
+  { ITG3200_PWR_MGM,    PWR_MGM    }
+};
+
+
 
 /********************************************************************************************************
 *                                         ITG3200_Init()
 *
-* @brief      Initialization of the ITG3200 configuration registers.
-*             Only call when I2C1 initizalized.   (See datasheet for more info)
+* @brief      Setup of the ITG3200 data ready interrupt pin, after its configuration registers are
+*             written (see ITG3200_InitSeq). Only call when I2C1 initizalized.
 *
 * @param[in]  none
 * @exception  none
@@ -33,70 +41,57 @@ uint32_t time = 0;
 ********************************************************************************************************/
 
 void  ITG3200_Init(){
-  
-    // Write on the configuration registers of the ITG3200
-    SENI2C_WriteRegister8U(ITG3200_ADDR, ITG3200_SMPLRT_DIV, SMPLRT_DIV);
-    SENI2C_WriteRegister8U(ITG3200_ADDR, ITG3200_DLPF_FS,    DLPF_FS);
-    SENI2C_WriteRegister8U(ITG3200_ADDR, ITG3200_INT_CFG,    INT_CFG);
-    SENI2C_WriteRegister8U(ITG3200_ADDR, ITG3200_PWR_MGM,    PWR_MGM);
 
-
-    //Enable measurement interruption to get time
-#if (OS_TIME_GET_SET_EN > 0)
+    // Enable the data ready interrupt (rising edge), which releases the sensor task
     GPIO_PinModeSet(gpioPortB, ITG3200_PIN, gpioModeInput, 0);
-    GPIOINT_CallbackRegister(ITG3200_PIN, ITG3200_GetTime);
+    GPIOINT_CallbackRegister(ITG3200_PIN, ITG3200_DataReady);
 
     GPIO_IntConfig(gpioPortB, ITG3200_PIN, TRUE, FALSE, TRUE);
-#endif
 }
 
 
 
 
 /********************************************************************************************************
-*                                         ITG3200_GetMeasurements()
+*                                         ITG3200_DataReady()
 *
-* @brief      Get measurements from the ITG3200 sensor
+* @brief      Data ready interrupt callback: time stamps the new sample and releases the sensor task
+*             (see SENSOR_DataReady())
 *
-* @param[in]  none
+* @param[in]  pin         interrupt pin
 * @exception  none
-* @return     ITGV structure with X, Y, Z and temp values.
+* @return     none
 *
 *
 ********************************************************************************************************/
 
-#if (OS_TIME_GET_SET_EN > 0)
-void ITG3200_GetTime (uint8_t pin) {
+void ITG3200_DataReady(uint8_t pin){
   if(pin == ITG3200_PIN)
-    time = OSTimeGet();
+    SENSOR_DataReady();
 }
-#endif
 
-ITGV  ITG3200_GetMeasurements(){
-  
-  ITGV res;
-  int16_t i;
-  
-  // Get X rotation
-  i = SENI2C_ReadRegister16(ITG3200_ADDR, ITG3200_GYRO_XOUT_H, ITG3200_GYRO_XOUT_L);
-  res.X = ITG3200_ConvertGyro((float)i);
-  
-  // Get Y rotation
-  i = SENI2C_ReadRegister16(ITG3200_ADDR, ITG3200_GYRO_YOUT_H, ITG3200_GYRO_YOUT_L);
-  res.Y = ITG3200_ConvertGyro((float)i);
-  
-  // Get Z rotation
-  i = SENI2C_ReadRegister16(ITG3200_ADDR, ITG3200_GYRO_ZOUT_H, ITG3200_GYRO_ZOUT_L);
-  res.Z = ITG3200_ConvertGyro((float)i);
-  
-  // Get temperature
-  i = SENI2C_ReadRegister16(ITG3200_ADDR, ITG3200_TEMP_OUT_H, ITG3200_TEMP_OUT_L);
-  res.temp = ITG3200_ConvertTemp((float)i);
-  
-  // Get time
-  res.time = time;
+
+
+
+/********************************************************************************************************
+*                                         ITG3200_Convert()
+*
+* @brief      Converts the data block of the ITG3200 (TEMP_OUT_H to GYRO_ZOUT_L)
+*
+* @param[in]  raw         data block, ITG3200_DATA_LEN bytes, big endian
+* @param[out] out         X, Y, Z (deg/s) and temp (deg C), Q16.16
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void ITG3200_Convert(const INT8U *raw, q16_t *out){
   
-  return res;
+  out[0] = ITG3200_ConvertGyro((int16_t) ((raw[2] << 8) | raw[3]));
+  out[1] = ITG3200_ConvertGyro((int16_t) ((raw[4] << 8) | raw[5]));
+  out[2] = ITG3200_ConvertGyro((int16_t) ((raw[6] << 8) | raw[7]));
+  out[3] = ITG3200_ConvertTemp((int16_t) ((raw[0] << 8) | raw[1]));
 }
 
 
@@ -110,14 +105,14 @@ ITGV  ITG3200_GetMeasurements(){
 *
 * @param[in]  value       gyro reading
 * @exception  none
-* @return     result
+* @return     result (Q16.16)
 *
 *
 ********************************************************************************************************/
 
-float ITG3200_ConvertGyro(float value){
+q16_t ITG3200_ConvertGyro(int16_t value){
   
-  return (float) (value - GYRO_OFFSET)/GYRO_SENSITIVITY + GYRO_REFERENCE;
+  return UTI_Q16Scale((int32_t) value - GYRO_OFFSET, GYRO_SCALE_Q24) + UTI_Q16FromInt(GYRO_REFERENCE);
 
 }
 
@@ -130,12 +125,12 @@ float ITG3200_ConvertGyro(float value){
 *
 * @param[in]  value       temp reading
 * @exception  none
-* @return     result
+* @return     result (Q16.16)
 *
 *
 ********************************************************************************************************/
 
-float ITG3200_ConvertTemp(float value){
+q16_t ITG3200_ConvertTemp(int16_t value){
   
-  return (float) ((value - TEMP_OFFSET)/TEMP_SENSITIVITY + TEMP_REFERENCE);
+  return UTI_Q16Scale((int32_t) value - TEMP_OFFSET, TEMP_SCALE_Q24) + UTI_Q16FromInt(TEMP_REFERENCE);
 }
\ No newline at end of file
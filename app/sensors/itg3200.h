@@ -37,6 +37,10 @@ extern "C" {
 #define TEMP_OFFSET       (-13200)
 #define TEMP_REFERENCE    35
 #define TEMP_SENSITIVITY  280
+
+// Fixed-point conversion factors (Q8.24, see UTI_Q16Scale)
+#define GYRO_SCALE_Q24    UTI_Q24FromFloat(1.0 / GYRO_SENSITIVITY)
+#define TEMP_SCALE_Q24    UTI_Q24FromFloat(1.0 / TEMP_SENSITIVITY)
   
 
 // ITG3200 Address and Registers definitions
@@ -63,10 +67,13 @@ extern "C" {
 #define ITG3200_PIN				10 		//ITG3200 
 
 // ITG3200 configuration defines
-#define SMPLRT_DIV      9
+//      Output rate = 1 kHz internal rate / (SMPLRT_DIV + 1): APP_CFG_SEN_OVERSAMPLING samples
+//      (and data ready interrupts) per database period. DLPF_CFG 3: 42 Hz bandwidth, 1 kHz
+//      internal rate, below the Nyquist frequency of the 100 Hz output.
+#define SMPLRT_DIV      (APP_CFG_SEN_DATA_PERIOD_MS / APP_CFG_SEN_OVERSAMPLING - 1)
   
 #define FS_SEL          (3<<3)
-#define DLPF_CFG        (0<<0)
+#define DLPF_CFG        (3<<0)
 #define DLPF_FS         (FS_SEL|DLPF_CFG)
   
 #define ACTL            (0<<7)
@@ -85,27 +92,12 @@ extern "C" {
 #define CLK_SEL         (1<<0)
 #define PWR_MGM         (H_RESET|SLEEP|STBY_XG|STBY_YG|STBY_ZG|CLK_SEL)
 
-  
-  
-/********************************************************************************************************
-*                                          STRUCTURES
-********************************************************************************************************/
-
-  
-  
-typedef struct ITGValues ITGV;
-
-struct ITGValues {
-  float X;         
-  float Y;
-  float Z;
-  float temp;
-
-#if (OS_TIME_GET_SET_EN > 0)
-  uint32_t time;
-#endif
-
-};
+// Sensor framework descriptor (see sensor.c): init sequence and data block
+// TEMP_OUT_H to GYRO_ZOUT_L, converted into X, Y, Z (deg/s) and temp (deg C)
+#define ITG3200_INIT_LEN        4
+#define ITG3200_DATA_REG        ITG3200_TEMP_OUT_H
+#define ITG3200_DATA_LEN        8
+#define ITG3200_NB_OUT          4
 
   
   
@@ -113,14 +105,14 @@ struct ITGValues {
 *                                         FUNCTION PROTOTYPES
 ********************************************************************************************************/
  
+extern const SENSOR_INIT ITG3200_InitSeq[ITG3200_INIT_LEN];
+
 void  ITG3200_Init();
-ITGV  ITG3200_GetMeasurements();
-float ITG3200_ConvertGyro(float value);
-float ITG3200_ConvertTemp(float value);
+void  ITG3200_Convert(const INT8U *raw, q16_t *out);
+q16_t ITG3200_ConvertGyro(int16_t value);
+q16_t ITG3200_ConvertTemp(int16_t value);
 
-#if (OS_TIME_GET_SET_EN > 0)
-void ITG3200_GetTime (uint8_t pin);
-#endif
+void  ITG3200_DataReady(uint8_t pin);
   
   
   
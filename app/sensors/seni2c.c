@@ -6,11 +6,13 @@ Filename: seni2c.c
 Author:   Louis Masson
 
 Created:  16/05/2013
-Modified: 16/05/2013
+Modified: 19/10/2026
 
 Description:
 This library contains the driver and the functions for communication with the 
-sensors through the EFM32GG880's I2C1 bus.
+sensors through the EFM32GG880's I2C1 bus. The transfers, retries and bus
+recovery are handled by the common layer (i2cbus.c); all the functions return
+the status of their transfer.
 
 ******************************************************************************/
 
@@ -21,6 +23,17 @@ sensors through the EFM32GG880's I2C1 bus.
 
 
 
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// I2C1, SCL on PB12 and SDA on PB11 (location 1)
+static I2CBUS seni2cBus = { "Sensor", I2C1, gpioPortB, 12, 11, 1, SENI2C_TIMEOUT, { 0 }, 0, 0, 0 };
+
+
+
 
 
 /********************************************************************************************************
@@ -37,29 +50,10 @@ sensors through the EFM32GG880's I2C1 bus.
 
 void SENI2C_Init(const I2C_Init_TypeDef *init){
   
-   int i;
-  
   CMU_ClockEnable(cmuClock_HFPER, true);
   CMU_ClockEnable(cmuClock_I2C1,  true);
   
-  // Location 1: Set GPIO pins to 1 to avoid driving the lines low
-  // Configure SCL first to ensure that it is high before SDA
-  GPIO_PinModeSet(gpioPortB, 12, gpioModeWiredAnd, 1);  
-  GPIO_PinModeSet(gpioPortB, 11, gpioModeWiredAnd, 1);  
-  
-  // The slave device could be left in an unknown state:
-  //    -> send 9 clock pulses just in case
-  for(i=0; i<9; i++){
-    GPIO_PinModeSet(gpioPortB, 12, gpioModeWiredAnd, 0);
-    GPIO_PinModeSet(gpioPortB, 12, gpioModeWiredAnd, 1);
-  }
-  
-  // Enable I2C1 pins at location 1
-  I2C1->ROUTE = I2C_ROUTE_SDAPEN |
-                I2C_ROUTE_SCLPEN |
-                (1 << _I2C_ROUTE_LOCATION_SHIFT);
-  
-  I2C_Init(I2C1, init);
+  I2CBUS_Init(&seni2cBus, init);
 }
 
 
@@ -71,28 +65,18 @@ void SENI2C_Init(const I2C_Init_TypeDef *init){
 /********************************************************************************************************
 *                                         SENI2C_Transfer()
 *
-* @brief      Sensor I2C Transfer function.
+* @brief      Sensor I2C Transfer function, with retries and bus recovery (see I2CBUS_Transfer()).
 *
 * @param[in]  seq       Contains information on the message to be sent/received
 * @exception  none
-* @return     none.
+* @return     i2cTransferDone, or the error of the transfer
 *
 *
 ********************************************************************************************************/
 
 I2C_TransferReturn_TypeDef SENI2C_Transfer(I2C_TransferSeq_TypeDef *seq){
   
-  I2C_TransferReturn_TypeDef ret;
-  uint32_t timeout = SENI2C_TIMEOUT; 
-  
-  // Do a polled transfer
-  ret = I2C_TransferInit(I2C1, seq);
-  
-  while(ret == i2cTransferInProgress && timeout--){
-    ret = I2C_Transfer(I2C1);
-  }
-  
-  return (ret);
+  return I2CBUS_Transfer(&seni2cBus, seq);
 }
 
 
@@ -103,32 +87,16 @@ I2C_TransferReturn_TypeDef SENI2C_Transfer(I2C_TransferSeq_TypeDef *seq){
 *
 * @param[in]  device address       
 *             register address
+* @param[out] value      register value, unchanged on error
 * @exception  none
-* @return     value.
+* @return     i2cTransferDone, or the error of the transfer
 *
 *
 ********************************************************************************************************/
 
-uint8_t SENI2C_ReadRegister8U(uint8_t address, uint8_t reg){
+I2C_TransferReturn_TypeDef SENI2C_ReadRegister8U(uint8_t address, uint8_t reg, uint8_t *value){
  
-  uint8_t data;
-  
-  I2C_TransferReturn_TypeDef  ret;
-  I2C_TransferSeq_TypeDef     seq;
-  
-  // Read the register
-  data = reg;
-  seq.addr = address;
-  
-  seq.flags = I2C_FLAG_WRITE;
-  seq.buf[0].data = &data;
-  seq.buf[0].len = 1;
-  ret = SENI2C_Transfer(&seq);
-  
-  seq.flags = I2C_FLAG_READ;
-  ret = SENI2C_Transfer(&seq);
-  
-  return data;
+  return SENI2C_ReadBlock(address, reg, value, 1);
 }
 
 
@@ -143,16 +111,26 @@ uint8_t SENI2C_ReadRegister8U(uint8_t address, uint8_t reg){
 * @param[in]  device address       
 *             H register address
               L register address
+* @param[out] value      register value, unchanged on error
 * @exception  none
-* @return     value.
+* @return     i2cTransferDone, or the error of the first failed transfer
 *
 *
 ********************************************************************************************************/
 
-int16_t SENI2C_ReadRegister16(uint8_t address, uint8_t rh, uint8_t rl){
+I2C_TransferReturn_TypeDef SENI2C_ReadRegister16(uint8_t address, uint8_t rh, uint8_t rl, int16_t *value){
 
-  return (int16_t) ((SENI2C_ReadRegister8U(address, rh) << 8) |
-                     SENI2C_ReadRegister8U(address, rl));
+  I2C_TransferReturn_TypeDef ret;
+  uint8_t h, l;
+  
+  ret = SENI2C_ReadRegister8U(address, rh, &h);
+  if(ret == i2cTransferDone)
+    ret = SENI2C_ReadRegister8U(address, rl, &l);
+  
+  if(ret == i2cTransferDone)
+    *value = (int16_t) ((h << 8) | l);
+  
+  return ret;
 }
 
 
@@ -167,14 +145,13 @@ int16_t SENI2C_ReadRegister16(uint8_t address, uint8_t rh, uint8_t rl){
 *             register address
               value
 * @exception  none
-* @return     none.
+* @return     i2cTransferDone, or the error of the transfer
 *
 *
 ********************************************************************************************************/
 
-void SENI2C_WriteRegister8U(uint8_t address, uint8_t reg, uint8_t value){
+I2C_TransferReturn_TypeDef SENI2C_WriteRegister8U(uint8_t address, uint8_t reg, uint8_t value){
   
-  I2C_TransferReturn_TypeDef  ret;
   I2C_TransferSeq_TypeDef     seq;
   
   // Write the register
@@ -185,7 +162,61 @@ void SENI2C_WriteRegister8U(uint8_t address, uint8_t reg, uint8_t value){
   seq.buf[0].len = 1;
   seq.buf[1].data = &value;
   seq.buf[1].len = 1;
-  ret = SENI2C_Transfer(&seq);
+  
+  return SENI2C_Transfer(&seq);
 }
 
 
+
+
+/********************************************************************************************************
+*                                         SENI2C_ReadBlock()
+*
+* @brief      Burst read of consecutive registers in a single transfer (register address write,
+*             repeated start, read)
+*
+* @param[in]  device address       
+*             first register address
+* @param[out] buf        received bytes
+* @param[in]  len        number of registers to read
+* @exception  none
+* @return     i2cTransferDone, or the error of the transfer
+*/
+/* Notes      :(1) The devices increment their register pointer after each byte read.
+*
+********************************************************************************************************/
+
+I2C_TransferReturn_TypeDef SENI2C_ReadBlock(uint8_t address, uint8_t reg, uint8_t *buf, uint16_t len){
+  
+  I2C_TransferSeq_TypeDef seq;
+  
+  seq.addr  = address;
+  seq.flags = I2C_FLAG_WRITE_READ;
+  
+  seq.buf[0].data = &reg;
+  seq.buf[0].len  = 1;
+  seq.buf[1].data = buf;
+  seq.buf[1].len  = len;
+  
+  return SENI2C_Transfer(&seq);
+}
+
+
+
+
+/********************************************************************************************************
+*                                         SENI2C_GetBus()
+*
+* @brief      Returns the sensor bus, for its statistics and the fault injection (see i2cbus.h)
+*
+* @param[in]  none
+* @exception  none
+* @return     sensor bus
+*
+*
+********************************************************************************************************/
+
+I2CBUS* SENI2C_GetBus(void){
+  
+  return &seni2cBus;
+}
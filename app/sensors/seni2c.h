@@ -44,9 +44,12 @@ extern "C" {
 void SENI2C_Init(const I2C_Init_TypeDef *init);
 I2C_TransferReturn_TypeDef SENI2C_Transfer(I2C_TransferSeq_TypeDef *seq);
 
-uint8_t  SENI2C_ReadRegister8U(uint8_t address, uint8_t reg);
-int16_t SENI2C_ReadRegister16(uint8_t address, uint8_t rh, uint8_t rl);
-void    SENI2C_WriteRegister8U(uint8_t address, uint8_t reg, uint8_t value);
+I2C_TransferReturn_TypeDef SENI2C_ReadRegister8U(uint8_t address, uint8_t reg, uint8_t *value);
+I2C_TransferReturn_TypeDef SENI2C_ReadRegister16(uint8_t address, uint8_t rh, uint8_t rl, int16_t *value);
+I2C_TransferReturn_TypeDef SENI2C_WriteRegister8U(uint8_t address, uint8_t reg, uint8_t value);
+I2C_TransferReturn_TypeDef SENI2C_ReadBlock(uint8_t address, uint8_t reg, uint8_t *buf, uint16_t len);
+
+I2CBUS* SENI2C_GetBus(void);
 
 
 
@@ -0,0 +1,364 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: sensor.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Table-driven sensor framework. The devices on the sensor I2C bus are listed
+in sensorTable, one constant descriptor per device:
+
+  - I2C address and init sequence (register/value pairs written in order,
+    then an optional setup function for pins and interrupts),
+  - data block (first register and length), read in a single burst
+    transfer: the devices auto-increment their register pointer,
+  - conversion function from the block to Q16.16 values,
+  - rate, as a divider of the sensor task release rate,
+  - decimation ratio: the values read are filtered and decimated to the
+    database rate by a CIC filter (decim.c), one per device.
+
+The gyroscope is oversampled APP_CFG_SEN_OVERSAMPLING times and releases
+the task; the magnetometers are read every APP_CFG_SEN_MAG_DIVIDER releases
+and decimated by the remaining ratio, so that all the devices produce one
+output per database period (APP_CFG_SEN_DATA_PERIOD_MS).
+
+The sensor task is released by the data ready interrupt of the device
+flagged 'drdy' (the ITG3200): SENSOR_WaitDataReady() pends on senReadySem,
+posted by SENSOR_DataReady() from the interrupt, which also latches the time
+of the sample (TIME_NowUs(), on the free-running RTC).
+The samples are then read once each, at the output rate of the device, with
+a known latency from the interrupt. A counter of interrupts tells missed
+samples (overwritten before being read) from stale posts (sample already
+read), which are skipped. Without interrupt for SENSOR_DRDY_TIMEOUT_MS, the
+devices are read anyway: reading the data clears the latched interrupt line
+of the ITG3200, so that the next sample raises a new edge.
+
+SENSOR_Poll(), called on each release, services the devices due and keeps
+their last output, time stamp and counters.
+
+Adding a device is a data-only change: an index in sensor.h, its init
+sequence and conversion function in its driver, and a line in sensorTable.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Device descriptors, in the order of the indexes of sensor.h
+static const SENSOR_DESC sensorTable[SENSOR_NB] = {
+  // Name    Address                 Init sequence      Length               Setup         Data block                              Conversion         Values            Divider, decimation, data ready
+  { "Gyro",  ITG3200_ADDR,           ITG3200_InitSeq,   ITG3200_INIT_LEN,    ITG3200_Init, ITG3200_DATA_REG,  ITG3200_DATA_LEN,    ITG3200_Convert,   ITG3200_NB_OUT,   1,                       APP_CFG_SEN_OVERSAMPLING,                           true  },
+  { "Mag1",  HMC5883L_ADDR,          HMC5883L_InitSeq,  HMC5883L_INIT_LEN,   NULL,         HMC5883L_DATA_REG, HMC5883L_DATA_LEN,   HMC5883L_Convert,  HMC5883L_NB_OUT,  APP_CFG_SEN_MAG_DIVIDER, APP_CFG_SEN_OVERSAMPLING / APP_CFG_SEN_MAG_DIVIDER, false },
+#if (APP_CFG_SEN_MAG2_EN > 0)
+  { "Mag2",  APP_CFG_SEN_MAG2_ADDR,  HMC5883L_InitSeq,  HMC5883L_INIT_LEN,   NULL,         HMC5883L_DATA_REG, HMC5883L_DATA_LEN,   HMC5883L_Convert,  HMC5883L_NB_OUT,  APP_CFG_SEN_MAG_DIVIDER, APP_CFG_SEN_OVERSAMPLING / APP_CFG_SEN_MAG_DIVIDER, false },
+#endif
+};
+
+static SENSOR_DATA sensorData[SENSOR_NB];
+static DECIM       sensorDecim[SENSOR_NB];
+static INT32U      sensorTick;          // Releases of the sensor task since init
+
+static volatile INT32U drdyCount;       // Data ready interrupts (written by the interrupt)
+static volatile uint64_t drdyTimeUs;    // Time of the last one
+static INT32U      drdyTaken;           // drdyCount of the last sample read
+static uint64_t    sampleTimeUs;        // Time of the sample being read
+static BOOLEAN     sampleValid;         // Released by a data ready (not by the timeout)
+static SENSOR_ACQ  acq;
+
+
+
+
+/********************************************************************************************************
+*                                         SENSOR_Init()
+*
+* @brief      Writes the init sequence of every device of the table and runs its setup function.
+*             Only call when I2C1 initialised. The failed writes are counted per device (initErrors).
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) A first read clears a data ready latched before its interrupt was enabled: the line
+*                   would stay high and never raise the edge releasing the task. Its data is discarded.
+*
+********************************************************************************************************/
+
+void SENSOR_Init(void){
+
+  const SENSOR_DESC *desc;
+  INT8U raw[SENSOR_MAX_BLOCK];
+  INT8U i, j;
+
+  memset(sensorData, 0, sizeof(sensorData));
+  memset(&acq, 0, sizeof(acq));
+  sensorTick  = 0;
+  drdyTaken   = drdyCount;
+  sampleValid = false;
+
+  for(i = 0; i < SENSOR_NB; i++){
+    desc = &sensorTable[i];
+
+    for(j = 0; j < desc->nbInit; j++)
+      if(SENI2C_WriteRegister8U(desc->addr, desc->init[j].reg, desc->init[j].value) != i2cTransferDone)
+        sensorData[i].initErrors++;
+
+    if(desc->setup != NULL)
+      desc->setup();
+
+    if(desc->drdy)
+      SENI2C_ReadBlock(desc->addr, desc->dataReg, raw, desc->dataLen);       // Note(1)
+
+    DECIM_Init(&sensorDecim[i], desc->nbOut, desc->decim);
+  }
+}
+
+
+
+/********************************************************************************************************
+*                                         SENSOR_WaitDataReady()
+*
+* @brief      Waits for the next sample of the data ready device. Called by the sensor task before
+*             SENSOR_Poll().
+*
+* @param[in]  none
+* @exception  none
+* @return     true on a new sample, false after SENSOR_DRDY_TIMEOUT_MS without interrupt
+*/
+/* Notes      :(1) The semaphore counts the interrupts: when the task is late, several posts are pending
+*                   but the device only holds the last sample. The first release reads it and counts the
+*                   overwritten ones as missed, the following ones find no new interrupt and are skipped,
+*                   so that a sample is never processed twice.
+*
+********************************************************************************************************/
+
+BOOLEAN SENSOR_WaitDataReady(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT8U    err;
+  INT32U   count;
+  uint64_t time;
+  INT32U   interval;
+
+  while(1){
+
+    OSSemPend(senReadySem, SENSOR_DRDY_TIMEOUT_MS * OS_TICKS_PER_SEC / 1000, &err);
+    if(err != OS_ERR_NONE){
+      acq.timeouts++;
+      sampleValid = false;
+      return false;
+    }
+
+    OS_ENTER_CRITICAL();
+    count = drdyCount;
+    time  = drdyTimeUs;
+    OS_EXIT_CRITICAL();
+
+    if(count == drdyTaken){                                   // Note(1)
+      acq.stale++;
+      continue;
+    }
+
+    acq.missed += count - drdyTaken - 1;
+    acq.samples++;
+
+    // Time between two consecutive samples
+    if(sampleValid && count - drdyTaken == 1){
+      interval = (INT32U) (time - sampleTimeUs);
+      if(interval < acq.intervalMin || acq.intervalMin == 0)
+        acq.intervalMin = interval;
+      if(interval > acq.intervalMax)
+        acq.intervalMax = interval;
+    }
+
+    drdyTaken    = count;
+    sampleTimeUs = time;
+    sampleValid  = true;
+    return true;
+  }
+}
+
+
+
+/********************************************************************************************************
+*                                         SENSOR_Poll()
+*
+* @brief      Reads, converts and decimates the data block of the devices due. Called on each release
+*             of the sensor task.
+*
+* @param[in]  none
+* @exception  none
+* @return     bit mask of the devices with a new output (bit = device index)
+*/
+/* Notes      :(1) A failed transfer is counted and its sample skipped: the filter goes on with the
+*                   other samples of its window.
+*
+*               (2) The data ready device is stamped with the time of its interrupt, the others with the
+*                   time of their read (their sampling instant is not known more precisely).
+*
+*               (3) The output is stamped at the centre of the filter window: its group delay,
+*                   DECIM_ORDER * (decim - 1) / 2 reads, is removed from the time of the last read.
+*
+********************************************************************************************************/
+
+INT32U SENSOR_Poll(void){
+
+  const SENSOR_DESC *desc;
+  SENSOR_DATA *data;
+  INT8U    raw[SENSOR_MAX_BLOCK];
+  q16_t    val[SENSOR_MAX_OUT];
+  INT32U   done = 0;
+  uint64_t time;
+  INT8U    i;
+
+  for(i = 0; i < SENSOR_NB; i++){
+    desc = &sensorTable[i];
+    data = &sensorData[i];
+
+    if(sensorTick % desc->divider != 0)
+      continue;
+
+    if(SENI2C_ReadBlock(desc->addr, desc->dataReg, raw, desc->dataLen) != i2cTransferDone){
+      data->errors++;                                         // Note(1)
+      continue;
+    }
+
+    desc->convert(raw, val);
+    data->reads++;
+
+    // Time stamp                                              Note(2)
+    if(desc->drdy && sampleValid){
+      time = sampleTimeUs;
+      acq.latencyLast = (INT32U) (TIME_NowUs() - sampleTimeUs);
+      if(acq.latencyLast > acq.latencyMax)
+        acq.latencyMax = acq.latencyLast;
+    }
+    else
+      time = TIME_NowUs();
+
+    // Decimation                                              Note(3)
+    if(!DECIM_Input(&sensorDecim[i], val, data->out))
+      continue;
+
+    data->timeUs = time - DECIM_ORDER * (desc->decim - 1u) * desc->divider * SENSOR_RELEASE_US / 2u;
+    data->outputs++;
+    data->cyclesPerOutput = DECIM_CyclesPerOutput(&sensorDecim[i]);
+    done |= 1u << i;
+  }
+
+  sensorTick++;
+
+  return done;
+}
+
+
+
+/********************************************************************************************************
+*                                         SENSOR_DataReady()
+*
+* @brief      Data ready interrupt: latches the time of the sample and releases the sensor task. Called
+*             by the driver from the GPIO interrupt callback.
+*
+* @param[in]  none
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void SENSOR_DataReady(void){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  OSIntEnter();                         // Called from the GPIO handler, outside of the kernel
+  OS_EXIT_CRITICAL();
+
+  drdyTimeUs = TIME_NowUs();
+  drdyCount++;
+  OSSemPost(senReadySem);
+
+  OSIntExit();
+}
+
+
+
+/********************************************************************************************************
+*                                    SENSOR_GetDesc() / SENSOR_GetData()
+*
+* @brief      Return the descriptor (resp. the last values) of a device
+*
+* @param[in]  id          device index (SENSOR_xxx)
+* @exception  none
+* @return     pointer to the descriptor (resp. values), NULL for an unknown device
+*
+*
+********************************************************************************************************/
+
+const SENSOR_DESC* SENSOR_GetDesc(INT8U id){
+
+  return (id < SENSOR_NB) ? &sensorTable[id] : NULL;
+}
+
+const SENSOR_DATA* SENSOR_GetData(INT8U id){
+
+  return (id < SENSOR_NB) ? &sensorData[id] : NULL;
+}
+
+
+
+/********************************************************************************************************
+*                                         SENSOR_SampleTimeUs()
+*
+* @brief      Time of the data ready interrupt of the sample being read. Only valid after
+*             SENSOR_WaitDataReady() returned true.
+*
+* @param[in]  none
+* @exception  none
+* @return     time stamp [us] (see TIME_NowUs())
+*
+*
+********************************************************************************************************/
+
+uint64_t SENSOR_SampleTimeUs(void){
+
+  return sampleTimeUs;
+}
+
+
+
+/********************************************************************************************************
+*                                         SENSOR_GetAcq()
+*
+* @brief      Returns a consistent copy of the data ready acquisition statistics
+*
+* @param[out] res         SENSOR_ACQ structure to fill
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void SENSOR_GetAcq(SENSOR_ACQ *res){
+
+  OSSchedLock();
+  *res = acq;
+  res->drdy = drdyCount;
+  OSSchedUnlock();
+}
@@ -0,0 +1,138 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: sensor.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Table-driven sensor framework: each device on the sensor I2C bus (SENI2C) is
+described by a constant descriptor (address, init sequence, data block,
+conversion, rate, decimation), and SENSOR_Poll() services all of them with
+one burst read per device. The sensor task is released by the data ready
+interrupt of the gyroscope, time stamped by the time service (app_time.c).
+
+******************************************************************************/
+
+
+
+#ifndef __SENSOR_H
+#define __SENSOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Devices (index in the descriptor table, see sensor.c)
+#define SENSOR_GYRO             0       // ITG3200
+#define SENSOR_MAG1             1       // HMC5883L
+#if (APP_CFG_SEN_MAG2_EN > 0)
+#define SENSOR_MAG2             2       // HMC5883L register map, at APP_CFG_SEN_MAG2_ADDR
+#define SENSOR_NB               3
+#else
+#define SENSOR_NB               2
+#endif
+
+#define SENSOR_MAX_BLOCK        16      // Largest data block (bytes)
+#define SENSOR_MAX_OUT          4       // Largest number of converted values
+
+// Release period of the sensor task (gyro output rate, oversampling the database rate), and wait
+// for a data ready interrupt before the devices are read anyway
+#define SENSOR_RELEASE_US       (APP_CFG_SEN_DATA_PERIOD_MS * 1000u / APP_CFG_SEN_OVERSAMPLING)
+#define SENSOR_DRDY_TIMEOUT_MS  (3u * APP_CFG_SEN_DATA_PERIOD_MS / APP_CFG_SEN_OVERSAMPLING + 1u)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Register write of an init sequence
+typedef struct SensorInit SENSOR_INIT;
+
+struct SensorInit {
+  INT8U reg;
+  INT8U value;
+};
+
+// Converts the data block of a device into its values (Q16.16, device units)
+typedef void (*SENSOR_CONVERT)(const INT8U *raw, q16_t *out);
+
+// Device descriptor
+typedef struct SensorDesc SENSOR_DESC;
+
+struct SensorDesc {
+  const char        *name;
+  INT8U              addr;              // I2C address (shifted, see seni2c.c)
+  const SENSOR_INIT *init;              // Registers written at init, in order
+  INT8U              nbInit;
+  void             (*setup)(void);      // Additional init (pins, interrupts), may be NULL
+  INT8U              dataReg;           // First register of the data block
+  INT8U              dataLen;           // Size of the data block (<= SENSOR_MAX_BLOCK)
+  SENSOR_CONVERT     convert;
+  INT8U              nbOut;             // Number of values (<= SENSOR_MAX_OUT)
+  INT8U              divider;           // Read every 'divider' releases of the sensor task
+  INT8U              decim;             // Reads per output (decimation ratio, see decim.c)
+  BOOLEAN            drdy;              // Releases the sensor task (time stamp = interrupt time)
+};
+
+// Last values of a device
+typedef struct SensorData SENSOR_DATA;
+
+struct SensorData {
+  q16_t  out[SENSOR_MAX_OUT];           // Last decimated output
+  uint64_t timeUs;                      // Time of the output, group delay removed (see TIME_NowUs())
+  INT32U reads;
+  INT32U errors;                        // Failed reads (sample skipped)
+  INT32U initErrors;                    // Failed writes of the init sequence
+  INT32U outputs;
+  INT32U cyclesPerOutput;               // Cost of the decimation filter
+};
+
+// Data ready acquisition statistics (times in us)
+typedef struct SensorAcq SENSOR_ACQ;
+
+struct SensorAcq {
+  INT32U drdy;                          // Data ready interrupts
+  INT32U samples;                       // Releases on a new sample
+  INT32U missed;                        // Samples overwritten before being read
+  INT32U stale;                         // Releases on a sample already read (skipped)
+  INT32U timeouts;                      // No interrupt within SENSOR_DRDY_TIMEOUT_MS (read anyway)
+  INT32U latencyLast;                   // Interrupt to end of the read
+  INT32U latencyMax;
+  INT32U intervalMin;                   // Between two interrupts
+  INT32U intervalMax;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void                SENSOR_Init(void);
+BOOLEAN             SENSOR_WaitDataReady(void);
+INT32U              SENSOR_Poll(void);
+void                SENSOR_DataReady(void);
+
+const SENSOR_DESC*  SENSOR_GetDesc(INT8U id);
+const SENSOR_DATA*  SENSOR_GetData(INT8U id);
+uint64_t            SENSOR_SampleTimeUs(void);
+void                SENSOR_GetAcq(SENSOR_ACQ *acq);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __SENSOR_H */
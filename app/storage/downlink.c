@@ -0,0 +1,524 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: downlink.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Downlink packetizer. The data to send is stored in logs (see logstore.c),
+one per class of data (events, housekeeping, sensor telemetry, payload
+science). The ground requests a time range of a class (DL_Request()): the
+pages of the range are sent in order, each one cut into segments of
+DL_DATA_SIZE bytes carried by fixed-size CCSDS space packets:
+
+  - primary header: APID of the class, sequence flags (first, continuation
+    or last segment of the page) and sequence count of the APID,
+  - secondary header: log page number and offset of the segment, so that the
+    ground puts the pages back together and sees the missing ones,
+  - the segment, read from the flash straight into the packet (no copy of
+    the page).
+
+A pass has a budget of packets (DL_StartPass()). Each class has a priority
+(its order in the class table) and a quota (share of the budget). The
+packets go first to the classes under their quota, in priority order, then
+what is left of the budget to the classes with data, in priority order: a
+class without enough data leaves its share to the others, and the budget is
+filled whenever there is data.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define DL_PRI_ID               0x0800  // Version 0, telemetry, secondary header present
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Classes, in priority order (DL_xxx)
+static const struct {
+  const char *name;
+  INT16U      apid;
+  INT8U       quota;                    // Share of the budget of a pass (%)
+} dlClass[DL_NB_CLASS] = {
+  { "evt",  0x040,  10 },
+  { "hk",   0x020,  20 },
+  { "tlm",  0x010,  30 },
+  { "pl",   0x030,  40 },
+};
+
+// Self-test: pages of the generated log of each class, first data page of a partition
+static INT32U dlTestPages[DL_NB_CLASS];
+static INT32U dlTestFirst;
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static BOOLEAN DL_Ready(DL_SOURCE *src);
+static BOOLEAN DL_Lock(DL_SOURCE *src);
+static void    DL_Unlock(DL_SOURCE *src);
+static void    DL_Put(INT8U *p, INT32U v, INT8U n);
+static INT32U  DL_Get(const INT8U *p, INT8U n);
+static void    DL_TestPass(DL *dl, INT32U *count, DL_TEST *res);
+static INT8U   DL_TestByte(INT32U cls, INT32U page, INT32U offset);
+static void    DL_TestGen(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare);
+
+
+
+
+/********************************************************************************************************
+*                                         DL_Init()
+*
+* @brief      Initialises the downlink, without sources
+*
+* @param[in]  dl          downlink
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void DL_Init(DL *dl){
+
+  memset(dl, 0, sizeof(DL));
+}
+
+
+
+/********************************************************************************************************
+*                                         DL_Attach()
+*
+* @brief      Sets the log of a class
+*
+* @param[in]  dl          downlink
+* @param[in]  cls         class (DL_xxx)
+* @param[in]  log         log holding the data of the class
+* @param[in]  mutex       mutex of the device of the log, NULL if the log is not shared
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void DL_Attach(DL *dl, INT8U cls, LOG *log, OS_EVENT *mutex){
+
+  DL_SOURCE *src = &dl->src[cls];
+
+  src->log     = log;
+  src->mutex   = mutex;
+  src->pending = false;
+  src->active  = false;
+}
+
+
+
+/********************************************************************************************************
+*                                         DL_Request()
+*
+* @brief      Requests the pages of a time range of a class (replaces the previous request)
+*
+* @param[in]  dl          downlink
+* @param[in]  cls         class (DL_xxx)
+* @param[in]  from        start of the range
+* @param[in]  to          end of the range
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void DL_Request(DL *dl, INT8U cls, uint64_t from, uint64_t to){
+
+  DL_SOURCE *src = &dl->src[cls];
+
+  if(src->log == NULL)
+    return;
+
+  if(!DL_Lock(src))
+    return;
+  LOG_QueryStart(src->log, &src->q, from, to);
+  DL_Unlock(src);
+
+  src->pending = true;
+  src->active  = false;
+}
+
+
+
+/********************************************************************************************************
+*                                         DL_StartPass()
+*
+* @brief      Starts a pass: budget of packets shared by the classes
+*
+* @param[in]  dl          downlink
+* @param[in]  budget      packets of the pass
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void DL_StartPass(DL *dl, INT32U budget){
+
+  INT8U cls;
+
+  dl->budget = budget;
+  dl->sent   = 0;
+  dl->cycles = 0;
+
+  for(cls = 0; cls < DL_NB_CLASS; cls++)
+    dl->src[cls].passPackets = 0;
+}
+
+
+
+/********************************************************************************************************
+*                                         DL_NextPacket()
+*
+* @brief      Builds the next packet of the pass
+*
+* @param[in]  dl          downlink
+* @param[out] pkt         packet (DL_PKT_SIZE bytes)
+* @exception  none
+* @return     DL_PKT_SIZE, or 0 when the budget is spent or there is no more data
+*/
+/* Notes      :(1) First the classes under their quota, then any class with data, in priority order.
+*
+*               (2) A page overwritten since the search (the log wrapped) is dropped, the class is
+*                   chosen again.
+*
+*               (3) DL_DATA_SIZE divides the page size: the last segment ends the page.
+*
+********************************************************************************************************/
+
+INT16U DL_NextPacket(DL *dl, INT8U *pkt){
+
+  INT32U     start = UTI_CycCntGet();
+  DL_SOURCE *src;
+  INT16U     flags;
+  INT8U      cls;
+  INT8S      ret;
+
+  if(dl->sent >= dl->budget)
+    return 0;
+
+  do {
+    // Note(1)
+    for(cls = 0; cls < DL_NB_CLASS; cls++)
+      if(dl->src[cls].passPackets * 100 < (INT32U) dlClass[cls].quota * dl->budget &&
+         DL_Ready(&dl->src[cls]))
+        break;
+    if(cls == DL_NB_CLASS)
+      for(cls = 0; cls < DL_NB_CLASS; cls++)
+        if(DL_Ready(&dl->src[cls]))
+          break;
+    if(cls == DL_NB_CLASS){
+      dl->cycles += UTI_CycCntGet() - start;
+      return 0;
+    }
+
+    // Segment straight from the flash
+    src = &dl->src[cls];
+    if(!DL_Lock(src)){
+      dl->cycles += UTI_CycCntGet() - start;                  // Device not available, retried later
+      return 0;
+    }
+    ret = LOG_Read(src->log, src->page, src->offset, &pkt[DL_HDR_SIZE], DL_DATA_SIZE);
+    DL_Unlock(src);
+
+    if(ret != LOG_OK){
+      src->lost++;                                            // Note(2)
+      src->active = false;
+    }
+  } while(ret != LOG_OK);
+
+  // Headers
+  flags = (src->offset == 0) ? DL_SEQ_FIRST : DL_SEQ_CONT;
+  if(src->offset + DL_DATA_SIZE >= src->log->dev->pageSize)
+    flags |= DL_SEQ_LAST;
+
+  DL_Put(&pkt[0], DL_PRI_ID | dlClass[cls].apid, 2);
+  DL_Put(&pkt[2], flags | src->seq, 2);
+  DL_Put(&pkt[4], DL_PKT_SIZE - DL_PRI_SIZE - 1, 2);
+  DL_Put(&pkt[DL_SEC_PAGE], src->page, 4);
+  DL_Put(&pkt[DL_SEC_OFFSET], src->offset, 2);
+
+  src->seq     = (src->seq + 1) & DL_SEQ_MASK;
+  src->offset += DL_DATA_SIZE;
+  if(flags & DL_SEQ_LAST){                                    // Note(3)
+    src->active = false;
+    src->pages++;
+  }
+
+  src->passPackets++;
+  src->packets++;
+  dl->sent++;
+  dl->cycles += UTI_CycCntGet() - start;
+
+  return DL_PKT_SIZE;
+}
+
+
+
+/********************************************************************************************************
+*                                    DL_ClassName() / DL_ClassQuota()
+*
+* @brief      Name (resp. quota in % of a pass) of a class
+*
+* @param[in]  cls         class (DL_xxx)
+* @exception  none
+* @return     name (resp. quota)
+*
+*
+********************************************************************************************************/
+
+const char* DL_ClassName(INT8U cls){
+
+  return dlClass[cls].name;
+}
+
+INT8U DL_ClassQuota(INT8U cls){
+
+  return dlClass[cls].quota;
+}
+
+
+
+/********************************************************************************************************
+*                                         DL_SelfTest()
+*
+* @brief      Runs two passes on generated logs and checks the packets and the shares of the classes
+*
+* @param[out] res         DL_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Each class has a generated log (partition of one generated device). All classes are
+*                   backlogged in the first pass: each one gets exactly its quota. The event class has
+*                   only DL_TEST_SHORT pages in the second pass: its share goes to the class of highest
+*                   priority with data.
+*
+*               (2) Jain index of the packets / quota ratios: 100 when every class gets its quota.
+*
+*               (3) The cost includes the generation of the page data in place of a flash read.
+*
+********************************************************************************************************/
+
+void DL_SelfTest(DL_TEST *res){
+
+  FLASH_DEV dev;
+  LOG       log[DL_NB_CLASS];
+  DL        dl;
+  INT32U    x[DL_NB_CLASS];
+  uint64_t  sum = 0;
+  uint64_t  sum2 = 0;
+  INT32U    total = 0;
+  INT32U    shortTotal = 0;
+  INT32U    cycles = 0;
+  INT8U     pass;
+  INT8U     cls;
+  BOOLEAN   shares = true;
+
+  memset(res, 0, sizeof(DL_TEST));
+
+  FLASH_GenInit(&dev, "dl", DL_TestGen, LOG_PAGE_MAX, DL_TEST_PPB, DL_TEST_BLOCKS * DL_NB_CLASS);
+
+  // Note(1)
+  for(pass = 0; pass < 2; pass++){
+    for(cls = 0; cls < DL_NB_CLASS; cls++)
+      dlTestPages[cls] = (pass == 1 && cls == DL_EVT) ? DL_TEST_SHORT : DL_TEST_PAGES;
+
+    DL_Init(&dl);
+    for(cls = 0; cls < DL_NB_CLASS; cls++){
+      LOG_Init(&log[cls], dlClass[cls].name, &dev, cls * DL_TEST_BLOCKS, DL_TEST_BLOCKS);
+      dlTestFirst = log[cls].sumBlocks * DL_TEST_PPB;
+      LOG_Mount(&log[cls]);
+      DL_Attach(&dl, cls, &log[cls], NULL);
+      DL_Request(&dl, cls, 0, ~(uint64_t) 0);
+    }
+    DL_TestPass(&dl, (pass == 0) ? res->full : res->shortEvt, res);
+    cycles += dl.cycles;
+  }
+
+  res->cyclesPerPacket = (res->packets > 0) ? cycles / res->packets : 0;   // Note(3)
+
+  for(cls = 0; cls < DL_NB_CLASS; cls++){
+    x[cls] = res->full[cls] * 100 / dlClass[cls].quota;
+    sum   += x[cls];
+    sum2  += (uint64_t) x[cls] * x[cls];
+    total      += res->full[cls];
+    shortTotal += res->shortEvt[cls];
+    if(res->full[cls] != (INT32U) dlClass[cls].quota * DL_TEST_BUDGET / 100 ||
+       (cls != DL_EVT && res->shortEvt[cls] < (INT32U) dlClass[cls].quota * DL_TEST_BUDGET / 100))
+      shares = false;
+  }
+  res->fairness = (sum2 > 0) ? (INT32U) (sum * sum * 100 / (DL_NB_CLASS * sum2)) : 0;   // Note(2)
+
+  res->pass = (res->errors == 0 && shares && total == DL_TEST_BUDGET && shortTotal == DL_TEST_BUDGET &&
+               res->shortEvt[DL_EVT] == DL_TEST_SHORT * LOG_PAGE_MAX / DL_DATA_SIZE);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// True when the class has a segment to send (takes the next page of the request if needed)
+static BOOLEAN DL_Ready(DL_SOURCE *src){
+
+  uint64_t time;
+
+  if(src->active)
+    return true;
+  if(!src->pending)
+    return false;
+
+  if(!DL_Lock(src))
+    return false;
+  src->pending = LOG_QueryNext(&src->q, &src->page, &time);
+  DL_Unlock(src);
+
+  src->active = src->pending;
+  src->offset = 0;
+
+  return src->active;
+}
+
+/******************************************************************************/
+
+static BOOLEAN DL_Lock(DL_SOURCE *src){
+
+  return (src->mutex == NULL) || FLASH_Lock(src->mutex);
+}
+
+static void DL_Unlock(DL_SOURCE *src){
+
+  if(src->mutex != NULL)
+    OSMutexPost(src->mutex);
+}
+
+/******************************************************************************/
+
+// Big endian fields (CCSDS)
+static void DL_Put(INT8U *p, INT32U v, INT8U n){
+
+  while(n-- > 0){
+    p[n] = (INT8U) v;
+    v  >>= 8;
+  }
+}
+
+static INT32U DL_Get(const INT8U *p, INT8U n){
+
+  INT32U v = 0;
+  INT8U  i;
+
+  for(i = 0; i < n; i++)
+    v = (v << 8) | p[i];
+
+  return v;
+}
+
+/******************************************************************************/
+
+// Runs a pass of the self-test: checks every packet and counts the packets of each class
+static void DL_TestPass(DL *dl, INT32U *count, DL_TEST *res){
+
+  INT8U  pkt[DL_PKT_SIZE];
+  INT32U page[DL_NB_CLASS] = { 0 };     // Expected segment of each class
+  INT32U offset[DL_NB_CLASS] = { 0 };
+  INT32U apid;
+  INT32U flags;
+  INT32U cls;
+  INT32U i;
+  BOOLEAN ok;
+
+  DL_StartPass(dl, DL_TEST_BUDGET);
+
+  while(DL_NextPacket(dl, pkt) == DL_PKT_SIZE){
+
+    apid = DL_Get(&pkt[0], 2) & 0x07FF;
+    for(cls = 0; cls < DL_NB_CLASS && dlClass[cls].apid != apid; cls++);
+    if(cls == DL_NB_CLASS){
+      res->errors++;
+      continue;
+    }
+
+    flags = DL_Get(&pkt[2], 2) & ~DL_SEQ_MASK;
+    ok = ((DL_Get(&pkt[0], 2) & 0xF800) == DL_PRI_ID &&
+          (DL_Get(&pkt[2], 2) & DL_SEQ_MASK) == (count[cls] & DL_SEQ_MASK) &&
+          DL_Get(&pkt[4], 2) == DL_PKT_SIZE - DL_PRI_SIZE - 1 &&
+          DL_Get(&pkt[DL_SEC_PAGE], 4) == page[cls] &&
+          DL_Get(&pkt[DL_SEC_OFFSET], 2) == offset[cls] &&
+          ((flags & DL_SEQ_FIRST) != 0) == (offset[cls] == 0) &&
+          ((flags & DL_SEQ_LAST) != 0) == (offset[cls] + DL_DATA_SIZE == LOG_PAGE_MAX));
+    for(i = 0; i < DL_DATA_SIZE && ok; i++)
+      ok = (pkt[DL_HDR_SIZE + i] == DL_TestByte(cls, page[cls], offset[cls] + i));
+    if(!ok)
+      res->errors++;
+
+    offset[cls] += DL_DATA_SIZE;
+    if(offset[cls] == LOG_PAGE_MAX){
+      offset[cls] = 0;
+      page[cls]++;
+    }
+    count[cls]++;
+    res->packets++;
+  }
+}
+
+/******************************************************************************/
+
+static INT8U DL_TestByte(INT32U cls, INT32U page, INT32U offset){
+
+  return (INT8U) (cls * 61 + page * 7 + offset);
+}
+
+/******************************************************************************/
+
+// Generated device: one partition per class, dlTestPages[] pages written (times 1 s apart)
+static void DL_TestGen(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare){
+
+  INT32U  cls = page / (DL_TEST_BLOCKS * DL_TEST_PPB);
+  INT32U  n = page % (DL_TEST_BLOCKS * DL_TEST_PPB);
+  BOOLEAN written = (n >= dlTestFirst && n - dlTestFirst < dlTestPages[cls]);
+  INT16U  i;
+
+  if(data != NULL){
+    for(i = 0; i < len; i++)
+      data[i] = written ? DL_TestByte(cls, n - dlTestFirst, offset + i) : 0xFF;
+  }
+  if(spare != NULL){
+    if(written)
+      LOG_SpareSet(spare, n - dlTestFirst, (uint64_t) (n - dlTestFirst) * 1000000, 0);
+    else
+      memset(spare, 0xFF, FLASH_SPARE_SIZE);
+  }
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: downlink.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Downlink packetizer: fixed-size CCSDS space packets built from the pages of
+the logs, scheduled by class priority and bandwidth quota over a pass
+
+******************************************************************************/
+
+
+
+#ifndef __DOWNLINK_H
+#define __DOWNLINK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Classes of data (index in the class table, in priority order, see downlink.c)
+#define DL_EVT                  0       // Event logs
+#define DL_HK                   1       // Housekeeping
+#define DL_TLM                  2       // Sensor telemetry
+#define DL_PL                   3       // Payload science data
+#define DL_NB_CLASS             4
+
+// Space packet: primary header (CCSDS 133.0-B), secondary header, segment of a log page
+#define DL_PRI_SIZE             6
+#define DL_SEC_PAGE             6       // 4: log page number
+#define DL_SEC_OFFSET           10      // 2: offset of the segment in the page
+#define DL_HDR_SIZE             12
+#define DL_DATA_SIZE            APP_CFG_DL_DATA_SIZE
+#define DL_PKT_SIZE             (DL_HDR_SIZE + DL_DATA_SIZE)
+
+#define DL_SEQ_FIRST            0x4000  // Sequence flags: first segment of a page
+#define DL_SEQ_CONT             0x0000  //                 continuation
+#define DL_SEQ_LAST             0x8000  //                 last segment
+#define DL_SEQ_MASK             0x3FFF  // Sequence count (per APID)
+
+// Self-test (see DL_SelfTest())
+#define DL_TEST_PPB             4       // Generated partition of each class
+#define DL_TEST_BLOCKS          18
+#define DL_TEST_PAGES           64      // Pages of a backlogged class
+#define DL_TEST_SHORT           2       // Pages of the event class in the second pass
+#define DL_TEST_BUDGET          200     // Packets of a pass
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Source of a class: a log, and the pages of the requested time range
+typedef struct DlSource DL_SOURCE;
+
+struct DlSource {
+  LOG       *log;                       // NULL: no data stored for the class
+  OS_EVENT  *mutex;                     // Device of the log (NULL: not shared)
+  LOG_QUERY  q;
+  BOOLEAN    pending;                   // Query not finished
+  BOOLEAN    active;                    // Page being sent
+  INT32U     page;
+  INT16U     offset;                    // Next segment
+  INT16U     seq;                       // Sequence count of the APID
+  // Statistics
+  INT32U     passPackets;               // Packets of the current pass
+  INT32U     packets;
+  INT32U     pages;
+  INT32U     lost;                      // Pages overwritten before being sent
+};
+
+typedef struct Dl DL;
+
+struct Dl {
+  DL_SOURCE src[DL_NB_CLASS];
+  INT32U    budget;                     // Packets of the current pass
+  INT32U    sent;
+  INT32U    cycles;                     // Spent building the packets of the pass
+};
+
+typedef struct DlTest DL_TEST;
+
+struct DlTest {
+  INT32U  full[DL_NB_CLASS];            // Packets per class, all classes backlogged
+  INT32U  shortEvt[DL_NB_CLASS];        // Packets per class, few events
+  INT32U  fairness;                     // Jain index of packets / quota, all backlogged (x100)
+  INT32U  packets;                      // Both passes
+  INT32U  cyclesPerPacket;
+  INT32U  errors;                       // Packets with a wrong header or content
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    DL_Init(DL *dl);
+void    DL_Attach(DL *dl, INT8U cls, LOG *log, OS_EVENT *mutex);
+void    DL_Request(DL *dl, INT8U cls, uint64_t from, uint64_t to);
+void    DL_StartPass(DL *dl, INT32U budget);
+INT16U  DL_NextPacket(DL *dl, INT8U *pkt);
+
+const char* DL_ClassName(INT8U cls);
+INT8U   DL_ClassQuota(INT8U cls);
+
+void    DL_SelfTest(DL_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __DOWNLINK_H */
@@ -0,0 +1,453 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: flash.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Page-level access to the flash devices. A device is described by its
+geometry (page size, pages per erase block, blocks) and its access
+functions, set by the init of its backend. The storage modules only use
+FLASH_Read(), FLASH_ReadSpare(), FLASH_Prog() and FLASH_Erase(), which check
+the ranges and count the accesses of the device.
+
+A page is programmed once (data and spare area together) after the erase of
+its block, which sets all its bytes to 0xFF. Reads may cover part of a page.
+
+Backends:
+  - simulated: the pages are kept in RAM with the rules of the NAND (program
+    of an erased page only). Stands for the NAND devices until their driver
+    is written, and for the tests of the storage modules,
+  - generated: the content of every page is given by a function, programs
+    and erases are only counted. Used to benchmark the storage modules on
+    images much larger than the RAM.
+
+The caller serialises the accesses to a device (NAND1Mutex, NAND2Mutex,
+NORMutex), taken with FLASH_Lock().
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static INT8S FLASH_SimRead(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len);
+static INT8S FLASH_SimReadSpare(FLASH_DEV *dev, INT32U page, INT8U *spare);
+static INT8S FLASH_SimProg(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare);
+static INT8S FLASH_SimErase(FLASH_DEV *dev, INT32U block);
+static BOOLEAN FLASH_SimCutNow(FLASH_DEV *dev);
+static INT8S FLASH_GenRead(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len);
+static INT8S FLASH_GenReadSpare(FLASH_DEV *dev, INT32U page, INT8U *spare);
+static INT8S FLASH_GenProg(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare);
+static INT8S FLASH_GenErase(FLASH_DEV *dev, INT32U block);
+
+
+
+
+/********************************************************************************************************
+*                                         FLASH_SimInit()
+*
+* @brief      Initialises a simulated device in RAM, erased
+*
+* @param[in]  dev            device
+* @param[in]  name           name of the device
+* @param[in]  mem            storage of the pages (pageSize * pagesPerBlock * blocks bytes)
+* @param[in]  spare          storage of the spare areas (FLASH_SPARE_SIZE * pagesPerBlock * blocks bytes)
+* @param[in]  pageSize       data bytes per page
+* @param[in]  pagesPerBlock  pages per erase block
+* @param[in]  blocks         erase blocks
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void FLASH_SimInit(FLASH_DEV *dev, const char *name, INT8U *mem, INT8U *spare,
+                   INT16U pageSize, INT16U pagesPerBlock, INT32U blocks){
+
+  memset(dev, 0, sizeof(FLASH_DEV));
+
+  dev->name          = name;
+  dev->pageSize      = pageSize;
+  dev->pagesPerBlock = pagesPerBlock;
+  dev->blocks        = blocks;
+  dev->read          = FLASH_SimRead;
+  dev->readSpare     = FLASH_SimReadSpare;
+  dev->prog          = FLASH_SimProg;
+  dev->erase         = FLASH_SimErase;
+  dev->mem           = mem;
+  dev->spare         = spare;
+  dev->cut           = -1;
+
+  memset(mem,   0xFF, (INT32U) pageSize * pagesPerBlock * blocks);
+  memset(spare, 0xFF, (INT32U) FLASH_SPARE_SIZE * pagesPerBlock * blocks);
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_GenInit()
+*
+* @brief      Initialises a generated device: reads return the content given by a function
+*
+* @param[in]  dev            device
+* @param[in]  name           name of the device
+* @param[in]  gen            content of the pages
+* @param[in]  pageSize       data bytes per page
+* @param[in]  pagesPerBlock  pages per erase block
+* @param[in]  blocks         erase blocks
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void FLASH_GenInit(FLASH_DEV *dev, const char *name, FLASH_GEN gen,
+                   INT16U pageSize, INT16U pagesPerBlock, INT32U blocks){
+
+  memset(dev, 0, sizeof(FLASH_DEV));
+
+  dev->name          = name;
+  dev->pageSize      = pageSize;
+  dev->pagesPerBlock = pagesPerBlock;
+  dev->blocks        = blocks;
+  dev->read          = FLASH_GenRead;
+  dev->readSpare     = FLASH_GenReadSpare;
+  dev->prog          = FLASH_GenProg;
+  dev->erase         = FLASH_GenErase;
+  dev->gen           = gen;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_SimCut()
+*
+* @brief      Simulates a power cut during a later program or erase of a simulated device (self-tests)
+*
+* @param[in]  dev         simulated device
+* @param[in]  ops         programs and erases still done before the cut, -1: power back, no cut
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The operation of the cut is half done: a program writes the first half of the data and
+*                   leaves the spare area erased, an erase erases the first half of the block. It returns
+*                   FLASH_ERR_IO, like all the programs and erases after it ('off' set). The reads still
+*                   work, for the checks of the test.
+*
+********************************************************************************************************/
+
+void FLASH_SimCut(FLASH_DEV *dev, INT32S ops){
+
+  dev->cut = ops;
+  dev->off = false;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_Read()
+*
+* @brief      Reads data bytes of a page
+*
+* @param[in]  dev         device
+* @param[in]  page        page number
+* @param[in]  offset      first byte in the page
+* @param[out] buf         bytes read
+* @param[in]  len         bytes to read (offset + len <= page size)
+* @exception  none
+* @return     FLASH_OK or FLASH_ERR_xxx
+*
+*
+********************************************************************************************************/
+
+INT8S FLASH_Read(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len){
+
+  INT8S ret = FLASH_ERR_RANGE;
+
+  if(page < FLASH_Pages(dev) && (INT32U) offset + len <= dev->pageSize)
+    ret = dev->read(dev, page, offset, buf, len);
+
+  dev->stats.reads++;
+  dev->stats.bytesRead += len;
+  if(ret != FLASH_OK)
+    dev->stats.errors++;
+
+  return ret;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_ReadSpare()
+*
+* @brief      Reads the spare area of a page
+*
+* @param[in]  dev         device
+* @param[in]  page        page number
+* @param[out] spare       FLASH_SPARE_SIZE bytes
+* @exception  none
+* @return     FLASH_OK or FLASH_ERR_xxx
+*
+*
+********************************************************************************************************/
+
+INT8S FLASH_ReadSpare(FLASH_DEV *dev, INT32U page, INT8U *spare){
+
+  INT8S ret = FLASH_ERR_RANGE;
+
+  if(page < FLASH_Pages(dev))
+    ret = dev->readSpare(dev, page, spare);
+
+  dev->stats.spareReads++;
+  if(ret != FLASH_OK)
+    dev->stats.errors++;
+
+  return ret;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_Prog()
+*
+* @brief      Programs a page (data and spare area) erased before
+*
+* @param[in]  dev         device
+* @param[in]  page        page number
+* @param[in]  data        page size bytes
+* @param[in]  spare       FLASH_SPARE_SIZE bytes
+* @exception  none
+* @return     FLASH_OK or FLASH_ERR_xxx
+*
+*
+********************************************************************************************************/
+
+INT8S FLASH_Prog(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare){
+
+  INT8S ret = FLASH_ERR_RANGE;
+
+  if(page < FLASH_Pages(dev))
+    ret = dev->prog(dev, page, data, spare);
+
+  dev->stats.progs++;
+  if(ret != FLASH_OK)
+    dev->stats.errors++;
+
+  return ret;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_Erase()
+*
+* @brief      Erases a block (all its bytes to 0xFF)
+*
+* @param[in]  dev         device
+* @param[in]  block       block number
+* @exception  none
+* @return     FLASH_OK or FLASH_ERR_xxx
+*
+*
+********************************************************************************************************/
+
+INT8S FLASH_Erase(FLASH_DEV *dev, INT32U block){
+
+  INT8S ret = FLASH_ERR_RANGE;
+
+  if(block < dev->blocks)
+    ret = dev->erase(dev, block);
+
+  dev->stats.erases++;
+  if(ret != FLASH_OK)
+    dev->stats.errors++;
+
+  return ret;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_Pages()
+*
+* @brief      Number of pages of a device
+*
+* @param[in]  dev         device
+* @exception  none
+* @return     pages
+*
+*
+********************************************************************************************************/
+
+INT32U FLASH_Pages(const FLASH_DEV *dev){
+
+  return (INT32U) dev->pagesPerBlock * dev->blocks;
+}
+
+
+
+/********************************************************************************************************
+*                                         FLASH_Lock()
+*
+* @brief      Takes the mutex of a device (no timeout). Give it back with OSMutexPost().
+*
+* @param[in]  mutex       mutex of the device
+* @exception  none
+* @return     true when the mutex is held, false on a pend error (device not to be accessed)
+*/
+/* Notes      :(1) The mutex is taken, but its PIP is not above the caller's priority (see app_cfg.h):
+*                   priority inheritance would not work. It is given back and the access refused, so
+*                   that the configuration error shows.
+*
+********************************************************************************************************/
+
+BOOLEAN FLASH_Lock(OS_EVENT *mutex){
+
+  INT8U err;
+
+  OSMutexPend(mutex, 0, &err);
+  if(err == OS_ERR_PIP_LOWER)                                 // Note(1)
+    OSMutexPost(mutex);
+
+  return (err == OS_ERR_NONE);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+static INT8S FLASH_SimRead(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len){
+
+  memcpy(buf, &dev->mem[page * dev->pageSize + offset], len);
+
+  return FLASH_OK;
+}
+
+/******************************************************************************/
+
+static INT8S FLASH_SimReadSpare(FLASH_DEV *dev, INT32U page, INT8U *spare){
+
+  memcpy(spare, &dev->spare[page * FLASH_SPARE_SIZE], FLASH_SPARE_SIZE);
+
+  return FLASH_OK;
+}
+
+/******************************************************************************/
+
+// A page is programmed once: all its bytes must be erased. Power cuts: see FLASH_SimCut().
+static INT8S FLASH_SimProg(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare){
+
+  INT8U *p = &dev->mem[page * dev->pageSize];
+  INT8U *s = &dev->spare[page * FLASH_SPARE_SIZE];
+  INT16U len = dev->pageSize;
+  INT16U i;
+
+  if(dev->off)
+    return FLASH_ERR_IO;
+  if(FLASH_SimCutNow(dev))
+    len = dev->pageSize / 2;
+
+  for(i = 0; i < dev->pageSize; i++)
+    if(p[i] != 0xFF)
+      return FLASH_ERR_PROG;
+  for(i = 0; i < FLASH_SPARE_SIZE; i++)
+    if(s[i] != 0xFF)
+      return FLASH_ERR_PROG;
+
+  memcpy(p, data, len);
+  if(dev->off)
+    return FLASH_ERR_IO;
+  memcpy(s, spare, FLASH_SPARE_SIZE);
+
+  return FLASH_OK;
+}
+
+/******************************************************************************/
+
+static INT8S FLASH_SimErase(FLASH_DEV *dev, INT32U block){
+
+  INT32U page  = block * dev->pagesPerBlock;
+  INT32U pages = dev->pagesPerBlock;
+
+  if(dev->off)
+    return FLASH_ERR_IO;
+  if(FLASH_SimCutNow(dev))
+    pages /= 2;
+
+  memset(&dev->mem[page * dev->pageSize],      0xFF, (INT32U) dev->pageSize * pages);
+  memset(&dev->spare[page * FLASH_SPARE_SIZE], 0xFF, (INT32U) FLASH_SPARE_SIZE * pages);
+
+  return dev->off ? FLASH_ERR_IO : FLASH_OK;
+}
+
+/******************************************************************************/
+
+// Counts a program or erase of a simulated device: true if it is the one of the power cut
+static BOOLEAN FLASH_SimCutNow(FLASH_DEV *dev){
+
+  if(dev->cut < 0 || dev->cut-- > 0)
+    return false;
+
+  dev->off = true;
+
+  return true;
+}
+
+/******************************************************************************/
+
+static INT8S FLASH_GenRead(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len){
+
+  dev->gen(page, offset, buf, len, NULL);
+
+  return FLASH_OK;
+}
+
+/******************************************************************************/
+
+static INT8S FLASH_GenReadSpare(FLASH_DEV *dev, INT32U page, INT8U *spare){
+
+  dev->gen(page, 0, NULL, 0, spare);
+
+  return FLASH_OK;
+}
+
+/******************************************************************************/
+
+// The content is given by the generator: the writes are only counted
+static INT8S FLASH_GenProg(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare){
+
+  (void) dev;
+  (void) page;
+  (void) data;
+  (void) spare;
+
+  return FLASH_OK;
+}
+
+/******************************************************************************/
+
+static INT8S FLASH_GenErase(FLASH_DEV *dev, INT32U block){
+
+  (void) dev;
+  (void) block;
+
+  return FLASH_OK;
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: flash.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Page-level access to the flash devices (NAND-like: pages with a spare area,
+programmed once after the erase of their block), and simulated backends
+
+******************************************************************************/
+
+
+
+#ifndef __FLASH_H
+#define __FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define FLASH_SPARE_SIZE        16      // Spare (out of band) bytes per page
+
+// Return values
+#define FLASH_OK                0
+#define FLASH_ERR_RANGE        -1       // Page, block or bytes outside the device
+#define FLASH_ERR_PROG         -2       // Program of a page not erased
+#define FLASH_ERR_IO           -3       // Device error
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct FlashDev FLASH_DEV;
+
+// Content of a page of a generated device (see FLASH_GenInit()): len bytes from offset into data,
+// or the spare area into spare (the other one is NULL)
+typedef void (*FLASH_GEN)(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare);
+
+typedef struct FlashStats FLASH_STATS;
+
+struct FlashStats {
+  INT32U reads;                         // Data reads (whole or part of a page)
+  INT32U spareReads;
+  INT32U bytesRead;
+  INT32U progs;
+  INT32U erases;
+  INT32U errors;
+};
+
+// Device descriptor. The access functions are set by the init of the backend.
+struct FlashDev {
+  const char *name;
+  INT16U      pageSize;                 // Data bytes per page
+  INT16U      pagesPerBlock;            // Pages per erase block
+  INT32U      blocks;
+  INT8S     (*read)(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len);
+  INT8S     (*readSpare)(FLASH_DEV *dev, INT32U page, INT8U *spare);
+  INT8S     (*prog)(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare);
+  INT8S     (*erase)(FLASH_DEV *dev, INT32U block);
+  INT8U      *mem;                      // Simulated: data of the pages
+  INT8U      *spare;                    // Simulated: spare areas
+  FLASH_GEN   gen;                      // Generated: content of the pages
+  INT32S      cut;                      // Simulated: operations left before a power cut (-1: none)
+  BOOLEAN     off;                      // Simulated: power cut, the programs and erases fail
+  FLASH_STATS stats;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void   FLASH_SimInit(FLASH_DEV *dev, const char *name, INT8U *mem, INT8U *spare,
+                     INT16U pageSize, INT16U pagesPerBlock, INT32U blocks);
+void   FLASH_GenInit(FLASH_DEV *dev, const char *name, FLASH_GEN gen,
+                     INT16U pageSize, INT16U pagesPerBlock, INT32U blocks);
+void   FLASH_SimCut(FLASH_DEV *dev, INT32S ops);
+
+INT8S  FLASH_Read(FLASH_DEV *dev, INT32U page, INT16U offset, INT8U *buf, INT16U len);
+INT8S  FLASH_ReadSpare(FLASH_DEV *dev, INT32U page, INT8U *spare);
+INT8S  FLASH_Prog(FLASH_DEV *dev, INT32U page, const INT8U *data, const INT8U *spare);
+INT8S  FLASH_Erase(FLASH_DEV *dev, INT32U block);
+
+INT32U FLASH_Pages(const FLASH_DEV *dev);
+
+BOOLEAN FLASH_Lock(OS_EVENT *mutex);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __FLASH_H */
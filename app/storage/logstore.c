@@ -0,0 +1,1112 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: logstore.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Circular log of pages on a partition of a flash device (see flash.c). The
+pages are appended in time order: each one carries its time (the time of its
+first record), its log page number and CRCs in its spare area. When the data
+blocks are full, the block of the oldest pages is erased and written again.
+
+Queries select the pages of a time range: the search of the first page must
+not read the whole log (a few GB of NAND: millions of pages). The log keeps
+a sparse time index in RAM: the time of one page every 'stride' pages, at
+most LOG_INDEX_MAX entries. When the index is full, every other entry is
+dropped and the stride doubles, so that the index covers any log size in a
+fixed amount of RAM. A search is:
+
+  - a binary search of the index, for the last entry not after the start of
+    the range,
+  - a binary search of the pages between this entry and the next one,
+    reading their spare areas only: log2(stride) reads,
+
+then the pages follow one by one until the end of the range. The cost is
+logarithmic in the number of pages (LOG_SelfTest() measures it on generated
+images up to 4 GB).
+
+The index, the head, the tail and the wear counters are saved by LOG_Sync()
+in a checkpoint, in the checkpoint banks (first blocks of the partition).
+Checkpoints are appended to the free slots of a bank; when both banks are
+full, the one of the older checkpoints is erased. The newest checkpoint
+stays on the flash until a newer one is written, and a checkpoint is only
+used if its CRC is correct: a reset during a checkpoint leaves the previous
+one.
+
+The mount reads the first bytes (number) of each checkpoint slot, the
+newest checkpoint, then the pages written after it: its cost depends on the
+number of slots and on the pages between two checkpoints, not on the size
+of the log. Without a valid checkpoint, it scans the spare areas of all the
+data pages and rebuilds the index.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define LOG_PPB(log)            ((log)->dev->pagesPerBlock)
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static INT32U logGenFirst;              // First data page of the generated image (self-test)
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void     LOG_Reset(LOG *log);
+static INT32U   LOG_Phys(const LOG *log, INT32U page);
+static void     LOG_Track(LOG *log, uint64_t time);
+static void     LOG_Drop(LOG *log, INT32U tail);
+static INT32U   LOG_CkptPage(const LOG *log, INT32U slot);
+static BOOLEAN  LOG_LoadCkpt(LOG *log);
+static BOOLEAN  LOG_ReadCkpt(LOG *log, INT32U slot);
+static void     LOG_Scan(LOG *log);
+static INT32U   LOG_Search(LOG *log, uint64_t time);
+static BOOLEAN  LOG_PageTime(LOG *log, INT32U page, uint64_t *time);
+static BOOLEAN  LOG_Erased(LOG *log, INT32U page);
+static BOOLEAN  LOG_SpareGet(const INT8U *spare, INT32U *page, uint64_t *time);
+static void     LOG_Wr(INT8U *p, uint64_t v, INT8U n);
+static uint64_t LOG_Rd(const INT8U *p, INT8U n);
+static void     LOG_TestSim(LOG_TEST *res);
+static void     LOG_TestQueries(LOG *log, LOG_TEST *res);
+static void     LOG_TestCuts(LOG_TEST *res);
+static void     LOG_TestBench(LOG_TEST *res);
+static uint64_t LOG_TestTime(INT32U page, INT32U period);
+static void     LOG_TestGen(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare);
+
+
+
+
+/********************************************************************************************************
+*                                         LOG_Init()
+*
+* @brief      Initialises an empty log on a partition of a device (see LOG_Mount() and LOG_Format())
+*
+* @param[in]  log         log
+* @param[in]  name        name of the log
+* @param[in]  dev         device
+* @param[in]  firstBlock  first block of the partition
+* @param[in]  nbBlocks    blocks of the partition
+* @exception  none
+* @return     LOG_OK, or LOG_ERR_GEOM when the partition does not hold the checkpoint banks and two data
+*             blocks
+*
+*
+********************************************************************************************************/
+
+INT8S LOG_Init(LOG *log, const char *name, FLASH_DEV *dev, INT32U firstBlock, INT32U nbBlocks){
+
+  INT32U bankBlocks;
+
+  memset(log, 0, sizeof(LOG));
+
+  log->name       = name;
+  log->dev        = dev;
+  log->firstBlock = firstBlock;
+  log->nbBlocks   = nbBlocks;
+  log->ckptPages  = (sizeof(LOG_SUMMARY) + dev->pageSize - 1) / dev->pageSize;
+  bankBlocks      = (log->ckptPages + dev->pagesPerBlock - 1) / dev->pagesPerBlock;
+  log->ckptSlots  = bankBlocks * dev->pagesPerBlock / log->ckptPages;
+  log->sumBlocks  = LOG_BANKS * bankBlocks;
+
+  if(dev->pageSize > LOG_PAGE_MAX || firstBlock + nbBlocks > dev->blocks ||
+     nbBlocks < log->sumBlocks + 2)
+    return LOG_ERR_GEOM;
+
+  log->dataPages = (nbBlocks - log->sumBlocks) * dev->pagesPerBlock;
+  LOG_Reset(log);
+
+  return LOG_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_Format()
+*
+* @brief      Erases the partition and writes the checkpoint of the empty log
+*
+* @param[in]  log         log (LOG_Init())
+* @exception  none
+* @return     LOG_OK or LOG_ERR_FLASH
+*
+*
+********************************************************************************************************/
+
+INT8S LOG_Format(LOG *log){
+
+  INT32U i;
+
+  LOG_Reset(log);
+  log->ckptNext = 0;
+
+  for(i = 0; i < log->nbBlocks; i++)
+    if(FLASH_Erase(log->dev, log->firstBlock + i) != FLASH_OK)
+      return LOG_ERR_FLASH;
+
+  return LOG_Sync(log);
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_Mount()
+*
+* @brief      Restores the state of a log from its partition
+*
+* @param[in]  log         log (LOG_Init())
+* @exception  none
+* @return     LOG_OK
+*/
+/* Notes      :(1) The pages written after the checkpoint follow its head: they are read until the first
+*                   page not carrying the next page number (erased, or older page of a block not yet
+*                   written again). The block of a page that starts a new turn of the data area was
+*                   erased before it was written.
+*
+*               (2) Reset during the erase of the block of the head (data area full): the pages of the
+*                   block are dropped when one of them is not found, the next append erases it again.
+*                   Otherwise, a page partly written at the head (reset during the program) cannot be
+*                   written again: the next append skips it.
+*
+********************************************************************************************************/
+
+INT8S LOG_Mount(LOG *log){
+
+  LOG_SUMMARY *s = &log->sum;
+  uint64_t     time;
+  INT32U       start = UTI_CycCntGet();
+  INT32U       reads = log->dev->stats.spareReads;
+  INT32U       n, end;
+
+  log->torn = false;
+  log->stats.mountSummary = LOG_LoadCkpt(log);
+
+  if(log->stats.mountSummary){
+    log->synced = s->head;
+
+    // Note(1)
+    for(n = 0; n < log->dataPages && LOG_PageTime(log, s->head, &time); n++){
+      if(s->head % LOG_PPB(log) == 0 && s->head >= log->dataPages){
+        LOG_Drop(log, s->head - log->dataPages + LOG_PPB(log));
+        s->erases++;
+      }
+      LOG_Track(log, time);
+    }
+  }
+  else {
+    LOG_Scan(log);
+    log->synced = s->tail;                // Checkpoint to be written
+  }
+
+  // Note(2)
+  if(s->head % LOG_PPB(log) == 0 && s->head >= log->dataPages){
+    end = s->head - log->dataPages + LOG_PPB(log);
+    for(n = s->tail; n < end && LOG_PageTime(log, n, &time); n++);
+    if(n < end)
+      LOG_Drop(log, end);
+  }
+  else
+    log->torn = !LOG_Erased(log, s->head);
+
+  log->stats.mountPages  = log->dev->stats.spareReads - reads;
+  log->stats.mountCycles = UTI_CycCntGet() - start;
+
+  return LOG_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_Append()
+*
+* @brief      Writes a page at the head of the log
+*
+* @param[in]  log         log
+* @param[in]  data        page (page size of the device)
+* @param[in]  time        time of the page (first record), not before the last page
+* @exception  none
+* @return     LOG_OK, LOG_ERR_TIME (page not written) or LOG_ERR_FLASH (page lost)
+*/
+/* Notes      :(1) The data area is full: the block of the head holds the oldest pages. It is erased
+*                   and the tail moves to the next block.
+*
+*               (2) A page that could not be written keeps its number and its index entry (its time is
+*                   a lower bound of the next pages): the search skips it.
+*
+*               (3) Page partly written before a reset (see LOG_Mount()): lost as in (2), the page goes
+*                   after it.
+*
+********************************************************************************************************/
+
+INT8S LOG_Append(LOG *log, const INT8U *data, uint64_t time){
+
+  LOG_SUMMARY *s = &log->sum;
+  INT8U        spare[FLASH_SPARE_SIZE];
+  INT32U       phys;
+  INT8S        ret = LOG_OK;
+
+  if(s->head != s->tail && time < s->lastTime)
+    return LOG_ERR_TIME;
+
+  if(log->torn){
+    // Note(3)
+    LOG_Track(log, time);
+    log->torn = false;
+  }
+  phys = LOG_Phys(log, s->head);
+
+  if(s->head % LOG_PPB(log) == 0 && s->head >= log->dataPages){
+    // Note(1)
+    LOG_Drop(log, s->head - log->dataPages + LOG_PPB(log));
+    s->erases++;
+    if(FLASH_Erase(log->dev, phys / LOG_PPB(log)) != FLASH_OK)
+      ret = LOG_ERR_FLASH;
+  }
+
+  LOG_SpareSet(spare, s->head, time, UTI_crc16((uint8_t *) data, log->dev->pageSize));
+  if(ret == LOG_OK && FLASH_Prog(log->dev, phys, data, spare) != FLASH_OK)
+    ret = LOG_ERR_FLASH;
+
+  if(ret != LOG_OK)
+    log->stats.errors++;
+
+  LOG_Track(log, time);                                       // Note(2)
+  log->stats.appends++;
+
+  return ret;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_Sync()
+*
+* @brief      Writes a checkpoint (head, tail, index and wear counters) of the log
+*
+* @param[in]  log         log
+* @exception  none
+* @return     LOG_OK or LOG_ERR_FLASH
+*/
+/* Notes      :(1) First slot of a bank: the bank holds older checkpoints only (the newest one is in the
+*                   other bank), it is erased.
+*
+*               (2) A slot that failed is not used again, and its number neither: it may hold a torn
+*                   checkpoint.
+*
+********************************************************************************************************/
+
+INT8S LOG_Sync(LOG *log){
+
+  LOG_SUMMARY *s = &log->sum;
+  INT8U        buf[LOG_PAGE_MAX];
+  INT8U        spare[FLASH_SPARE_SIZE];
+  const INT8U *p = (const INT8U *) s;
+  INT32U       left = sizeof(LOG_SUMMARY);
+  INT32U       slot = log->ckptNext;
+  INT32U       bankBlocks = log->sumBlocks / LOG_BANKS;
+  INT32U       page = LOG_CkptPage(log, slot);
+  INT32U       n;
+  INT32U       i;
+
+  // Note(1)
+  if(slot % log->ckptSlots == 0){
+    for(i = 0; i < bankBlocks; i++)
+      if(FLASH_Erase(log->dev, log->firstBlock + slot / log->ckptSlots * bankBlocks + i) != FLASH_OK)
+        return LOG_ERR_FLASH;
+    s->ckptErases++;
+  }
+
+  s->magic = LOG_SUM_MAGIC;
+  s->seq++;
+  s->crc   = UTI_crc16((uint8_t *) s, (INT32U) ((INT8U *) &s->crc - (INT8U *) s));
+
+  log->ckptNext = (slot + 1) % (LOG_BANKS * log->ckptSlots);   // Note(2)
+
+  memset(spare, 0xFF, FLASH_SPARE_SIZE);
+  while(left > 0){
+    n = (left < log->dev->pageSize) ? left : log->dev->pageSize;
+    memcpy(buf, p, n);
+    memset(&buf[n], 0xFF, log->dev->pageSize - n);
+    if(FLASH_Prog(log->dev, page++, buf, spare) != FLASH_OK)
+      return LOG_ERR_FLASH;
+    p    += n;
+    left -= n;
+  }
+
+  log->synced = s->head;
+  log->stats.syncs++;
+
+  return LOG_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_QueryStart()
+*
+* @brief      Searches the first page of a time range
+*
+* @param[in]  log         log
+* @param[out] q           query, for LOG_QueryNext()
+* @param[in]  from        start of the range
+* @param[in]  to          end of the range
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The first page is the last one starting before the range (it may hold records of the
+*                   range), or the tail when the range starts before the log.
+*
+********************************************************************************************************/
+
+void LOG_QueryStart(LOG *log, LOG_QUERY *q, uint64_t from, uint64_t to){
+
+  INT32U start = UTI_CycCntGet();
+  INT32U reads = log->dev->stats.spareReads;
+
+  q->log  = log;
+  q->to   = to;
+  q->next = LOG_Search(log, from);                           // Note(1)
+
+  log->stats.queries++;
+  log->stats.queryCycles = UTI_CycCntGet() - start;
+  log->stats.queryReads  = log->dev->stats.spareReads - reads;
+  if(log->stats.queryReads > log->stats.queryReadsMax)
+    log->stats.queryReadsMax = log->stats.queryReads;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_QueryNext()
+*
+* @brief      Next page of a time range
+*
+* @param[in]  q           query (LOG_QueryStart())
+* @param[out] page        log page number (see LOG_Read())
+* @param[out] time        time of the page
+* @exception  none
+* @return     false at the end of the range (or of the log)
+*/
+/* Notes      :(1) The log may be appended between two calls (the caller holds the device only during a
+*                   call): pages overwritten since the previous call are skipped.
+*
+********************************************************************************************************/
+
+BOOLEAN LOG_QueryNext(LOG_QUERY *q, INT32U *page, uint64_t *time){
+
+  LOG_SUMMARY *s = &q->log->sum;
+
+  if(q->next < s->tail)                                       // Note(1)
+    q->next = s->tail;
+
+  while(q->next < s->head){
+    if(LOG_PageTime(q->log, q->next, time)){
+      if(*time > q->to)
+        return false;
+      *page = q->next++;
+      return true;
+    }
+    q->next++;                          // Page lost
+  }
+
+  return false;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_Read()
+*
+* @brief      Reads data bytes of a page of the log
+*
+* @param[in]  log         log
+* @param[in]  page        log page number
+* @param[in]  offset      first byte in the page
+* @param[out] buf         bytes read
+* @param[in]  len         bytes to read
+* @exception  none
+* @return     LOG_OK, LOG_ERR_PAGE or LOG_ERR_FLASH
+*
+*
+********************************************************************************************************/
+
+INT8S LOG_Read(LOG *log, INT32U page, INT16U offset, INT8U *buf, INT16U len){
+
+  if(page < log->sum.tail || page >= log->sum.head)
+    return LOG_ERR_PAGE;
+
+  if(FLASH_Read(log->dev, LOG_Phys(log, page), offset, buf, len) != FLASH_OK)
+    return LOG_ERR_FLASH;
+
+  return LOG_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_SpareSet()
+*
+* @brief      Fills the spare area of a log page (also for the generators of images, see FLASH_GenInit())
+*
+* @param[out] spare       FLASH_SPARE_SIZE bytes
+* @param[in]  page        log page number
+* @param[in]  time        time of the page
+* @param[in]  dcrc        CRC-16 of the data of the page
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void LOG_SpareSet(INT8U *spare, INT32U page, uint64_t time, INT16U dcrc){
+
+  INT16U crc;
+
+  LOG_Wr(&spare[LOG_SPARE_PAGE], page, 4);
+  LOG_Wr(&spare[LOG_SPARE_TIME], time, 8);
+  LOG_Wr(&spare[LOG_SPARE_DCRC], dcrc, 2);
+
+  crc = UTI_crc16(spare, LOG_SPARE_CRC);
+  spare[LOG_SPARE_CRC]     = (INT8U) (crc >> 8);
+  spare[LOG_SPARE_CRC + 1] = (INT8U) crc;
+}
+
+
+
+/********************************************************************************************************
+*                                         LOG_SelfTest()
+*
+* @brief      Checks the log on a simulated device, then measures the cost of the search on generated
+*             images of growing size (a few s)
+*
+* @param[out] res         LOG_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Simulated device: LOG_TEST_PAGES pages are appended (the data area wraps), with a
+*                   checkpoint every LOG_TEST_SYNC pages but not after the last ones. Random queries are
+*                   compared with a linear search, after the appends, after a mount from the checkpoint
+*                   and after a mount without checkpoint.
+*
+*               (2) The same appends are cut by a power cut at a random flash operation: the mount must
+*                   start from a checkpoint, find every page written and read at most the checkpoint
+*                   slots and a checkpoint twice (the newest one torn), the pages after it and a block.
+*                   The log must then take new pages.
+*
+*               (3) Generated images of up to 2^23 pages (4 GB of 512-byte pages): the pages are indexed
+*                   as if they had been appended, without writing them. Passes if every search finds the
+*                   right page with at most log2(stride) + 1 spare areas read.
+*
+********************************************************************************************************/
+
+void LOG_SelfTest(LOG_TEST *res){
+
+  INT32U  bits;
+  INT32U  i;
+
+  memset(res, 0, sizeof(LOG_TEST));
+
+  LOG_TestSim(res);                                           // Note(1)
+  LOG_TestCuts(res);                                          // Note(2)
+  LOG_TestBench(res);                                         // Note(3)
+
+  res->pass = (res->errors == 0 && res->mountSummary && res->mountScan && res->cutErrors == 0);
+  for(i = 0; i < LOG_TEST_SIZES; i++){
+    for(bits = 0; (1u << bits) < res->size[i].stride; bits++);
+    if(res->size[i].errors != 0 || res->size[i].readsMax > bits + 1)
+      res->pass = false;
+  }
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Empty log (the partition is not read)
+static void LOG_Reset(LOG *log){
+
+  memset(&log->sum, 0, sizeof(LOG_SUMMARY));
+  log->sum.stride = 1;
+  log->synced     = 0;
+  log->torn       = false;
+}
+
+/******************************************************************************/
+
+// Device page of a log page
+static INT32U LOG_Phys(const LOG *log, INT32U page){
+
+  return (log->firstBlock + log->sumBlocks) * LOG_PPB(log) + page % log->dataPages;
+}
+
+/******************************************************************************/
+
+// Moves the head after a page, and indexes the page when it starts a stride
+static void LOG_Track(LOG *log, uint64_t time){
+
+  LOG_SUMMARY *s = &log->sum;
+  INT32U       i;
+
+  if(s->head == s->base + s->nbIdx * s->stride){
+    if(s->nbIdx == LOG_INDEX_MAX){
+      // Index full: one entry out of two, twice the stride
+      for(i = 0; i < LOG_INDEX_MAX / 2; i++)
+        s->idx[i] = s->idx[2 * i];
+      s->nbIdx   = LOG_INDEX_MAX / 2;
+      s->stride *= 2;
+    }
+    s->idx[s->nbIdx++] = time;
+  }
+
+  s->head++;
+  s->lastTime = time;
+}
+
+/******************************************************************************/
+
+// Moves the tail, and drops the index entries whose stride is before it
+static void LOG_Drop(LOG *log, INT32U tail){
+
+  LOG_SUMMARY *s = &log->sum;
+
+  if(tail <= s->tail)
+    return;
+  s->tail = tail;
+
+  while(s->nbIdx > 0 && s->base + s->stride <= tail){
+    memmove(&s->idx[0], &s->idx[1], (s->nbIdx - 1) * sizeof(uint64_t));
+    s->nbIdx--;
+    s->base += s->stride;
+  }
+}
+
+/******************************************************************************/
+
+// Device page of the first page of a checkpoint slot
+static INT32U LOG_CkptPage(const LOG *log, INT32U slot){
+
+  return (log->firstBlock + slot / log->ckptSlots * (log->sumBlocks / LOG_BANKS)) * LOG_PPB(log) +
+         slot % log->ckptSlots * log->ckptPages;
+}
+
+/******************************************************************************/
+
+// Loads the newest valid checkpoint, false (log reset) if there is none. Reads the numbers of the
+// checkpoints first, then the newest one (the previous ones if it is torn). The next checkpoint
+// goes to the slot after the newest one, with a number above all those on the flash.
+static BOOLEAN LOG_LoadCkpt(LOG *log){
+
+  INT32U  slots = LOG_BANKS * log->ckptSlots;
+  INT32U  hdr[2];                       // magic, seq
+  INT32U  limit = 0xFFFFFFFF;
+  INT32U  top = 0;
+  INT32U  topSlot = slots - 1;
+  INT32U  best;
+  INT32U  bestSeq = 0;
+  INT32U  i;
+  BOOLEAN first = true;
+  BOOLEAN found = false;
+
+  log->stats.mountReads   = 0;
+  log->stats.mountRejects = 0;
+
+  do {
+    best = slots;
+    for(i = 0; i < slots; i++){
+      log->stats.mountReads++;
+      if(FLASH_Read(log->dev, LOG_CkptPage(log, i), 0, (INT8U *) hdr, sizeof(hdr)) != FLASH_OK ||
+         hdr[0] != LOG_SUM_MAGIC)
+        continue;
+      if(first && hdr[1] >= top){
+        top     = hdr[1];
+        topSlot = i;
+      }
+      if(hdr[1] < limit && (best == slots || hdr[1] > bestSeq)){
+        best    = i;
+        bestSeq = hdr[1];
+      }
+    }
+    first = false;
+
+    if(best < slots){
+      found = LOG_ReadCkpt(log, best);
+      if(!found){
+        log->stats.mountRejects++;
+        limit = bestSeq;
+      }
+    }
+  } while(best < slots && !found);
+
+  if(!found)
+    LOG_Reset(log);
+
+  log->sum.seq  = top;
+  log->ckptNext = (topSlot + 1) % slots;
+
+  return found;
+}
+
+/******************************************************************************/
+
+// Reads a checkpoint, false when it is not valid for the partition
+static BOOLEAN LOG_ReadCkpt(LOG *log, INT32U slot){
+
+  LOG_SUMMARY *s = &log->sum;
+  INT8U       *p = (INT8U *) s;
+  INT32U       left = sizeof(LOG_SUMMARY);
+  INT32U       page = LOG_CkptPage(log, slot);
+  INT32U       n;
+
+  while(left > 0){
+    n = (left < log->dev->pageSize) ? left : log->dev->pageSize;
+    log->stats.mountReads++;
+    if(FLASH_Read(log->dev, page++, 0, p, (INT16U) n) != FLASH_OK)
+      return false;
+    p    += n;
+    left -= n;
+  }
+
+  return (s->magic == LOG_SUM_MAGIC &&
+          s->crc == UTI_crc16((uint8_t *) s, (INT32U) ((INT8U *) &s->crc - (INT8U *) s)) &&
+          s->head >= s->tail && s->head - s->tail <= log->dataPages &&
+          s->nbIdx <= LOG_INDEX_MAX && s->stride != 0 && (s->stride & (s->stride - 1)) == 0);
+}
+
+/******************************************************************************/
+
+// Finds the pages from the spare areas of the whole data area, and indexes them again
+static void LOG_Scan(LOG *log){
+
+  LOG_SUMMARY *s = &log->sum;
+  INT8U        spare[FLASH_SPARE_SIZE];
+  INT32U       first = 0xFFFFFFFF;
+  INT32U       last = 0;
+  INT32U       page;
+  uint64_t     time = 0;
+  INT32U       i;
+
+  LOG_Reset(log);
+
+  for(i = 0; i < log->dataPages; i++){
+    if(FLASH_ReadSpare(log->dev, LOG_Phys(log, i), spare) != FLASH_OK ||
+       !LOG_SpareGet(spare, &page, &time) || page % log->dataPages != i)
+      continue;
+    if(page < first)
+      first = page;
+    if(page >= last)
+      last = page;
+  }
+
+  if(first == 0xFFFFFFFF)
+    return;                             // Empty
+
+  // Smallest stride covering the pages with LOG_INDEX_MAX entries. The blocks were erased once per
+  // turn of the data area (wear of the checkpoint banks unknown).
+  s->head = last + 1;
+  s->tail = first;
+  s->base = first;
+  if(s->head > log->dataPages)
+    s->erases = (s->head - log->dataPages + LOG_PPB(log) - 1) / LOG_PPB(log);
+  while(s->head - s->tail > s->stride * LOG_INDEX_MAX)
+    s->stride *= 2;
+
+  // A page lost takes the time of the previous entry (lower bound)
+  time = 0;
+  for(page = first; page < s->head; page += s->stride){
+    LOG_PageTime(log, page, &time);
+    s->idx[s->nbIdx++] = time;
+  }
+
+  if(!LOG_PageTime(log, last, &s->lastTime))
+    s->lastTime = time;
+}
+
+/******************************************************************************/
+
+// Last page not after 'time' (or the tail): binary search of the index, then of the pages of a stride
+static INT32U LOG_Search(LOG *log, uint64_t time){
+
+  LOG_SUMMARY *s = &log->sum;
+  INT32U       lo = 0;
+  INT32U       hi = s->nbIdx;
+  INT32U       mid;
+  uint64_t     t;
+
+  if(s->head == s->tail)
+    return s->tail;
+
+  // Entries not after 'time': [0, lo)
+  while(lo < hi){
+    mid = (lo + hi) / 2;
+    if(s->idx[mid] <= time)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if(lo == 0)
+    return s->tail;
+
+  // Pages of the stride: the answer is in [lo, hi)
+  hi = s->base + lo * s->stride;
+  lo = s->base + (lo - 1) * s->stride;
+  if(lo < s->tail)
+    lo = s->tail;
+  if(hi > s->head)
+    hi = s->head;
+
+  while(hi - lo > 1){
+    mid = lo + (hi - lo) / 2;
+    if(LOG_PageTime(log, mid, &t) && t <= time)
+      lo = mid;
+    else
+      hi = mid;                         // Also a page lost: the search may start earlier
+  }
+
+  return lo;
+}
+
+/******************************************************************************/
+
+// Time of a page, false when the page is not written (or overwritten)
+static BOOLEAN LOG_PageTime(LOG *log, INT32U page, uint64_t *time){
+
+  INT8U  spare[FLASH_SPARE_SIZE];
+  INT32U n;
+
+  return (FLASH_ReadSpare(log->dev, LOG_Phys(log, page), spare) == FLASH_OK &&
+          LOG_SpareGet(spare, &n, time) && n == page);
+}
+
+/******************************************************************************/
+
+// True when the data and the spare area of the device page of a log page are erased
+static BOOLEAN LOG_Erased(LOG *log, INT32U page){
+
+  INT8U  buf[LOG_PAGE_MAX];
+  INT8U  spare[FLASH_SPARE_SIZE];
+  INT32U i;
+
+  if(FLASH_Read(log->dev, LOG_Phys(log, page), 0, buf, log->dev->pageSize) != FLASH_OK ||
+     FLASH_ReadSpare(log->dev, LOG_Phys(log, page), spare) != FLASH_OK)
+    return false;
+
+  for(i = 0; i < log->dev->pageSize; i++)
+    if(buf[i] != 0xFF)
+      return false;
+  for(i = 0; i < FLASH_SPARE_SIZE; i++)
+    if(spare[i] != 0xFF)
+      return false;
+
+  return true;
+}
+
+/******************************************************************************/
+
+// False when the spare area is not the one of a log page (erased, partly written)
+static BOOLEAN LOG_SpareGet(const INT8U *spare, INT32U *page, uint64_t *time){
+
+  if(UTI_crc16((uint8_t *) spare, FLASH_SPARE_SIZE) != CRC_OK)
+    return false;
+
+  *page = (INT32U) LOG_Rd(&spare[LOG_SPARE_PAGE], 4);
+  *time = LOG_Rd(&spare[LOG_SPARE_TIME], 8);
+
+  return (*page != 0xFFFFFFFF);
+}
+
+/******************************************************************************/
+
+// Little endian fields
+static void LOG_Wr(INT8U *p, uint64_t v, INT8U n){
+
+  INT8U i;
+
+  for(i = 0; i < n; i++)
+    p[i] = (INT8U) (v >> (8 * i));
+}
+
+static uint64_t LOG_Rd(const INT8U *p, INT8U n){
+
+  uint64_t v = 0;
+  INT8U    i;
+
+  for(i = 0; i < n; i++)
+    v |= (uint64_t) p[i] << (8 * i);
+
+  return v;
+}
+
+/******************************************************************************/
+
+// Functions of the log on a simulated device (see LOG_SelfTest() Note(1))
+static void LOG_TestSim(LOG_TEST *res){
+
+  INT8U     mem[LOG_TEST_PAGE_SIZE * LOG_TEST_PPB * LOG_TEST_BLOCKS];
+  INT8U     spare[FLASH_SPARE_SIZE * LOG_TEST_PPB * LOG_TEST_BLOCKS];
+  INT8U     page[LOG_TEST_PAGE_SIZE];
+  FLASH_DEV dev;
+  LOG       log;
+  INT32U    head, tail;
+  uint64_t  last;
+  INT32U    i;
+
+  FLASH_SimInit(&dev, "test", mem, spare, LOG_TEST_PAGE_SIZE, LOG_TEST_PPB, LOG_TEST_BLOCKS);
+  LOG_Init(&log, "test", &dev, 0, LOG_TEST_BLOCKS);
+  if(LOG_Format(&log) != LOG_OK)
+    res->errors++;
+
+  for(i = 0; i < LOG_TEST_PAGES; i++){
+    memset(page, (INT8U) i, sizeof(page));
+    if(LOG_Append(&log, page, LOG_TestTime(i, 1000)) != LOG_OK)
+      res->errors++;
+    if(i % LOG_TEST_SYNC == LOG_TEST_SYNC - 1 && i + LOG_TEST_SYNC < LOG_TEST_PAGES)
+      LOG_Sync(&log);
+  }
+
+  res->pages = log.stats.appends;
+  res->wraps = LOG_TEST_PAGES / log.dataPages;
+  res->syncs = log.stats.syncs;
+  LOG_TestQueries(&log, res);
+
+  head = log.sum.head;
+  tail = log.sum.tail;
+  last = log.sum.lastTime;
+
+  // Mount from the checkpoint, then the pages after it
+  LOG_Init(&log, "test", &dev, 0, LOG_TEST_BLOCKS);
+  LOG_Mount(&log);
+  res->mountSummary = (log.stats.mountSummary && log.sum.head == head && log.sum.tail == tail &&
+                       log.sum.lastTime == last);
+  LOG_TestQueries(&log, res);
+
+  // Mount without checkpoint
+  for(i = 0; i < log.sumBlocks; i++)
+    FLASH_Erase(&dev, i);
+  LOG_Init(&log, "test", &dev, 0, LOG_TEST_BLOCKS);
+  LOG_Mount(&log);
+  res->mountScan = (!log.stats.mountSummary && log.sum.head == head && log.sum.tail == tail &&
+                    log.sum.lastTime == last);
+  LOG_TestQueries(&log, res);
+}
+
+/******************************************************************************/
+
+// Random queries on the simulated log, compared with a linear search of the page times
+static void LOG_TestQueries(LOG *log, LOG_TEST *res){
+
+  LOG_SUMMARY *s = &log->sum;
+  LOG_QUERY    q;
+  uint32_t     seed = 12345;
+  INT32U       span = (INT32U) (LOG_TestTime(s->head, 1000) - LOG_TestTime(s->tail, 1000));
+  uint64_t     from, to, time;
+  INT32U       expected;
+  INT32U       page;
+  INT8U        byte;
+  INT32U       i;
+
+  for(i = 0; i < LOG_TEST_QUERIES; i++){
+    from = LOG_TestTime(s->tail, 1000) - 2000 + (UTI_Rand(&seed) >> 8) % (span + 4000);
+    to   = from + (UTI_Rand(&seed) >> 8) % 8000;
+
+    expected = s->tail;
+    while(expected + 1 < s->head && LOG_TestTime(expected + 1, 1000) <= from)
+      expected++;
+
+    LOG_QueryStart(log, &q, from, to);
+    while(LOG_QueryNext(&q, &page, &time)){
+      if(page != expected || time != LOG_TestTime(page, 1000) ||
+         LOG_Read(log, page, LOG_TEST_PAGE_SIZE - 1, &byte, 1) != LOG_OK || byte != (INT8U) page)
+        break;
+      expected++;
+    }
+
+    // Every page of the range returned, in order
+    if(!(expected == s->head || LOG_TestTime(expected, 1000) > to))
+      res->errors++;
+    res->queries++;
+  }
+}
+
+/******************************************************************************/
+
+// Power cuts during the appends and checkpoints (see LOG_SelfTest() Note(2))
+static void LOG_TestCuts(LOG_TEST *res){
+
+  INT8U     mem[LOG_TEST_PAGE_SIZE * LOG_TEST_PPB * LOG_TEST_BLOCKS];
+  INT8U     spare[FLASH_SPARE_SIZE * LOG_TEST_PPB * LOG_TEST_BLOCKS];
+  INT8U     page[LOG_TEST_PAGE_SIZE];
+  FLASH_DEV dev;
+  LOG       log;
+  uint32_t  seed = 2468;
+  INT32U    ops = 0;
+  INT32U    start;
+  INT32U    head;
+  INT32U    done;
+  INT32U    reads;
+  INT32U    errors;
+  INT32U    trial;
+  INT32U    i;
+  BOOLEAN   ok;
+
+  for(trial = 0; trial <= LOG_TEST_CUTS; trial++){
+
+    FLASH_SimInit(&dev, "cut", mem, spare, LOG_TEST_PAGE_SIZE, LOG_TEST_PPB, LOG_TEST_BLOCKS);
+    LOG_Init(&log, "cut", &dev, 0, LOG_TEST_BLOCKS);
+    LOG_Format(&log);
+
+    // First run without cut: operations of the sequence
+    if(trial > 0)
+      FLASH_SimCut(&dev, (INT32S) ((UTI_Rand(&seed) >> 8) % ops));
+    start = dev.stats.progs + dev.stats.erases;
+
+    done = 0;
+    for(i = 0; i < LOG_TEST_PAGES && !dev.off; i++){
+      memset(page, (INT8U) i, sizeof(page));
+      if(LOG_Append(&log, page, LOG_TestTime(i, 1000)) == LOG_OK)
+        done = i + 1;
+      if(i % LOG_TEST_SYNC == LOG_TEST_SYNC - 1)
+        LOG_Sync(&log);
+    }
+
+    if(trial == 0){
+      ops = dev.stats.progs + dev.stats.erases - start;
+      res->mountBound = 2 * (LOG_BANKS * log.ckptSlots + log.ckptPages) + LOG_TEST_SYNC + 1 + LOG_TEST_PPB;
+      continue;
+    }
+
+    // Reboot
+    FLASH_SimCut(&dev, -1);
+    reads  = dev.stats.reads + dev.stats.spareReads;
+    errors = res->errors;
+    LOG_Init(&log, "cut", &dev, 0, LOG_TEST_BLOCKS);
+    LOG_Mount(&log);
+    reads = dev.stats.reads + dev.stats.spareReads - reads;
+    if(reads > res->mountReadsMax)
+      res->mountReadsMax = reads;
+
+    // Every page written found
+    ok = (log.stats.mountSummary && log.sum.head == done && reads <= res->mountBound);
+    LOG_TestQueries(&log, res);
+
+    // The log goes on (after the page cut, if torn): more pages, a checkpoint, a mount
+    head = log.sum.head + (log.torn ? 1 : 0);
+    for(i = head; i < head + LOG_TEST_SYNC; i++){
+      memset(page, (INT8U) i, sizeof(page));
+      ok = ok && LOG_Append(&log, page, LOG_TestTime(i, 1000)) == LOG_OK;
+    }
+    ok = ok && LOG_Sync(&log) == LOG_OK;
+    LOG_Init(&log, "cut", &dev, 0, LOG_TEST_BLOCKS);
+    LOG_Mount(&log);
+
+    if(!ok || !log.stats.mountSummary || log.sum.head != head + LOG_TEST_SYNC || res->errors != errors)
+      res->cutErrors++;
+    res->cuts++;
+  }
+}
+
+/******************************************************************************/
+
+// Search cost on generated images (see LOG_SelfTest() Note(3))
+static void LOG_TestBench(LOG_TEST *res){
+
+  static const INT32U sizes[LOG_TEST_SIZES] = { 1u << 11, 1u << 15, 1u << 19, 1u << 23 };
+  FLASH_DEV dev;
+  LOG       log;
+  LOG_QUERY q;
+  uint32_t  seed = 6789;
+  uint64_t  time;
+  INT32U    expected;
+  INT32U    reads;
+  INT32U    cycles;
+  INT32U    i, k;
+
+  FLASH_GenInit(&dev, "gen", LOG_TestGen, LOG_PAGE_MAX, 64, sizes[LOG_TEST_SIZES - 1] / 64 + 2);
+  LOG_Init(&log, "gen", &dev, 0, dev.blocks);
+  logGenFirst = log.sumBlocks * 64;
+
+  for(k = 0; k < LOG_TEST_SIZES; k++){
+
+    while(log.sum.head < sizes[k])
+      LOG_Track(&log, LOG_TestTime(log.sum.head, LOG_TEST_PERIOD_US));
+
+    reads  = 0;
+    cycles = 0;
+    log.stats.queryReadsMax = 0;
+    for(i = 0; i < LOG_TEST_QUERIES; i++){
+      time = (((uint64_t) (UTI_Rand(&seed) >> 8) << 32) | (UTI_Rand(&seed) >> 8)) %
+             ((uint64_t) sizes[k] * LOG_TEST_PERIOD_US);
+
+      expected = (INT32U) (time / LOG_TEST_PERIOD_US);
+      if(expected > 0 && LOG_TestTime(expected, LOG_TEST_PERIOD_US) > time)
+        expected--;
+
+      LOG_QueryStart(&log, &q, time, time);
+      if(q.next != expected)
+        res->size[k].errors++;
+      reads  += log.stats.queryReads;
+      cycles += log.stats.queryCycles;
+    }
+
+    res->size[k].pages     = log.sum.head;
+    res->size[k].stride    = log.sum.stride;
+    res->size[k].readsAvg  = reads / LOG_TEST_QUERIES;
+    res->size[k].readsMax  = log.stats.queryReadsMax;
+    res->size[k].cyclesAvg = cycles / LOG_TEST_QUERIES;
+  }
+}
+
+/******************************************************************************/
+
+// Time of page n of a test log: regular period and jitter (less than half a period)
+static uint64_t LOG_TestTime(INT32U page, INT32U period){
+
+  INT32U h = page * 2654435761u;
+
+  h ^= h >> 15;
+
+  return (uint64_t) page * period + h % (period / 2);
+}
+
+/******************************************************************************/
+
+// Content of the generated image: empty pages (data CRC 0), times of LOG_TestTime()
+static void LOG_TestGen(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare){
+
+  (void) offset;
+
+  if(data != NULL)
+    memset(data, 0, len);
+  if(spare != NULL)
+    LOG_SpareSet(spare, page - logGenFirst, LOG_TestTime(page - logGenFirst, LOG_TEST_PERIOD_US), 0);
+}
+
@@ -0,0 +1,188 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: logstore.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Circular log of time-ordered pages on a flash partition, with a sparse time
+index kept in RAM and in checkpoints, and queries by time range
+
+******************************************************************************/
+
+
+
+#ifndef __LOGSTORE_H
+#define __LOGSTORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define LOG_PAGE_MAX            APP_CFG_LOG_PAGE_SIZE       // Largest page of a log device (bytes)
+#define LOG_INDEX_MAX           64      // Entries of the time index
+#define LOG_SUM_MAGIC           0x4C4F4743u                 // "LOGC"
+#define LOG_BANKS               2       // Checkpoint banks
+
+// Return values
+#define LOG_OK                  0
+#define LOG_ERR_FLASH          -1       // Device error (see FLASH_ERR_xxx)
+#define LOG_ERR_TIME           -2       // Page older than the last one
+#define LOG_ERR_GEOM           -3       // Partition too small or pages too large
+#define LOG_ERR_PAGE           -4       // Page not in the log (not written or overwritten)
+
+// Spare area of a log page (offsets in bytes, little endian)
+#define LOG_SPARE_PAGE          0       // 4: log page number
+#define LOG_SPARE_TIME          4       // 8: time of the page (first record)
+#define LOG_SPARE_DCRC          12      // 2: CRC-16 of the data
+#define LOG_SPARE_CRC           14      // 2: CRC-16 of the spare area, MSB first (see UTI_crc16())
+
+// Self-test (see LOG_SelfTest())
+#define LOG_TEST_PAGE_SIZE      128     // Simulated device (on the stack)
+#define LOG_TEST_PPB            4
+#define LOG_TEST_BLOCKS         6
+#define LOG_TEST_PAGES          40      // Pages appended (the data area wraps)
+#define LOG_TEST_SYNC           4       // Pages between checkpoints
+#define LOG_TEST_CUTS           48      // Power cuts
+#define LOG_TEST_QUERIES        32      // Queries per check
+#define LOG_TEST_SIZES          4       // Sizes of the generated images
+#define LOG_TEST_PERIOD_US      2500000 // Time between two generated pages
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Persistent state of a log, written as a checkpoint. Log page numbers increase from 0 and never
+// wrap (2^32 pages); page n is stored at data page n modulo the data pages.
+typedef struct LogSummary LOG_SUMMARY;
+
+struct LogSummary {
+  INT32U   magic;                       // LOG_SUM_MAGIC
+  INT32U   seq;                         // Checkpoints written
+  INT32U   head;                        // Next page
+  INT32U   tail;                        // Oldest page
+  INT32U   base;                        // Page of the first index entry
+  INT32U   stride;                      // Pages between two index entries (power of 2)
+  INT32U   nbIdx;                       // Index entries
+  INT32U   erases;                      // Wear: data blocks erased
+  INT32U   ckptErases;                  // Wear: checkpoint banks erased
+  INT32U   rsvd;
+  uint64_t lastTime;                    // Time of the last page
+  uint64_t idx[LOG_INDEX_MAX];          // Time of page base + i * stride
+  INT16U   crc;                         // CRC-16 of the bytes above
+};
+
+typedef struct LogStats LOG_STATS;
+
+struct LogStats {
+  INT32U  appends;
+  INT32U  errors;                       // Pages lost (program failed)
+  INT32U  syncs;                        // Checkpoints written
+  INT32U  mountPages;                   // Spare areas read by the last mount
+  INT32U  mountReads;                   // Checkpoint pages read by the last mount
+  INT32U  mountRejects;                 // Checkpoints with a wrong CRC (write cut)
+  INT32U  mountCycles;                  // Cost of the last mount
+  BOOLEAN mountSummary;                 // Last mount started from a checkpoint
+  INT32U  queries;
+  INT32U  queryReads;                   // Spare areas read by the last search
+  INT32U  queryReadsMax;
+  INT32U  queryCycles;                  // Cost of the last search
+};
+
+// Log on the blocks [firstBlock, firstBlock + nbBlocks) of a device: checkpoint banks, then data
+typedef struct Log LOG;
+
+struct Log {
+  const char  *name;
+  FLASH_DEV   *dev;
+  INT32U       firstBlock;
+  INT32U       nbBlocks;
+  INT32U       sumBlocks;               // Blocks of the checkpoint banks
+  INT32U       dataPages;               // Pages of the data blocks
+  INT32U       ckptPages;               // Pages of a checkpoint
+  INT32U       ckptSlots;               // Checkpoints per bank
+  INT32U       ckptNext;                // Next checkpoint slot
+  INT32U       synced;                  // Head at the last checkpoint
+  BOOLEAN      torn;                    // Page at the head partly written (reset): skipped
+  LOG_SUMMARY  sum;                     // State and index
+  LOG_STATS    stats;
+};
+
+// Pages of a time range, in order
+typedef struct LogQuery LOG_QUERY;
+
+struct LogQuery {
+  LOG     *log;
+  INT32U   next;                        // Next page
+  uint64_t to;                          // End of the range
+};
+
+// Self-test results: functions on a simulated device, then search cost on generated images
+typedef struct LogTestSize LOG_TEST_SIZE;
+
+struct LogTestSize {
+  INT32U pages;
+  INT32U stride;
+  INT32U readsAvg;                      // Spare areas read per search
+  INT32U readsMax;
+  INT32U cyclesAvg;                     // Cycles per search
+  INT32U errors;                        // Wrong first page
+};
+
+typedef struct LogTest LOG_TEST;
+
+struct LogTest {
+  INT32U        pages;                  // Appended
+  INT32U        wraps;                  // Data area overwritten
+  INT32U        syncs;
+  BOOLEAN       mountSummary;           // Mount from a checkpoint restored the state
+  BOOLEAN       mountScan;              // Mount without checkpoint restored the pages
+  INT32U        queries;
+  INT32U        errors;                 // Queries returning wrong pages
+  INT32U        cuts;                   // Power cuts during appends and checkpoints
+  INT32U        cutErrors;              // Mounts after a cut losing pages, scanning or too slow
+  INT32U        mountReadsMax;          // Pages and spare areas read by a mount after a cut
+  INT32U        mountBound;             // Limit of the above
+  LOG_TEST_SIZE size[LOG_TEST_SIZES];
+  BOOLEAN       pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+INT8S   LOG_Init(LOG *log, const char *name, FLASH_DEV *dev, INT32U firstBlock, INT32U nbBlocks);
+INT8S   LOG_Format(LOG *log);
+INT8S   LOG_Mount(LOG *log);
+INT8S   LOG_Append(LOG *log, const INT8U *data, uint64_t time);
+INT8S   LOG_Sync(LOG *log);
+
+void    LOG_QueryStart(LOG *log, LOG_QUERY *q, uint64_t from, uint64_t to);
+BOOLEAN LOG_QueryNext(LOG_QUERY *q, INT32U *page, uint64_t *time);
+INT8S   LOG_Read(LOG *log, INT32U page, INT16U offset, INT8U *buf, INT16U len);
+
+void    LOG_SpareSet(INT8U *spare, INT32U page, uint64_t time, INT16U dcrc);
+
+void    LOG_SelfTest(LOG_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __LOGSTORE_H */
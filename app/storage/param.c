@@ -0,0 +1,520 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: param.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Persistent parameter store. The tunable parameters are declared in the
+parameter table (name, range, default from app_cfg.h) and their values kept
+in RAM, at a fixed word of the value array: PARAM_Get() is a table lookup.
+
+The values are saved on two erase blocks (banks) of a NOR flash, one record
+per page: the values of all parameters, a sequence number and a CRC-16.
+A commit writes a new record to the next free page of the current bank; when
+the bank is full, the other one is erased and used. A record is only used if
+its CRC is correct, and the previous records stay on the flash until their
+bank is erased, after a newer record was written to the other bank: a write
+or an erase cut by a reset never loses the values of the last complete
+commit.
+
+At boot, PARAM_Load() reads the headers of the records of both banks, then
+checks the CRC of the newest one only (of the previous ones if it is torn).
+
+The caller serialises the accesses to the device (NORMutex).
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define PARAM_ERASED            0xFFFFFFFFu
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static const INT8U paramScnDef[PARAM_SCN_SIZE] = { 1, 0, 1, 0, 1, 0, 0, 0, 10, 0, 10, 0, 0 };
+
+// Parameter table, indexed by parameter ID (PARAM_xxx)
+static const PARAM_DESC paramTbl[PARAM_NB] = {
+  [PARAM_HK_PERIOD_MS]   = { "hk_ms",   0, 4, APP_CFG_HK_DATA_PERIOD_MS,  100, 60000, NULL },
+  [PARAM_PL_PERIOD_MS]   = { "pl_ms",   1, 4, APP_CFG_PL_DATA_PERIOD_MS,  100, 60000, NULL },
+  [PARAM_TIME_PERIOD_MS] = { "time_ms", 2, 4, APP_CFG_SEN_TIME_PERIOD_MS, 100, 60000, NULL },
+  [PARAM_DISP_PERIOD_MS] = { "disp_ms", 3, 4, DISP_FREQ_S * 1000 + DISP_FREQ_MS, 50, 59999, NULL },
+  [PARAM_SCN_DESC]       = { "scn",     4, PARAM_SCN_SIZE, 0, 0, 0, paramScnDef },
+  [PARAM_STAT_WINDOW_S]  = { "stat_s",  8, 4, APP_CFG_STAT_WINDOW_S,      1, 3600,  NULL },
+};
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void    PARAM_Defaults(PARAM_STORE *ps);
+static BOOLEAN PARAM_Valid(const PARAM_RECORD *rec);
+static BOOLEAN PARAM_TestCheck(FLASH_DEV *dev, INT32U k1, INT32U k2, PARAM_STATS *stats);
+
+
+
+
+/********************************************************************************************************
+*                                         PARAM_Init()
+*
+* @brief      Initialises a store, with the default values
+*
+* @param[in]  ps          store
+* @param[in]  dev         NOR device
+* @param[in]  firstBlock  first block of the banks
+* @exception  none
+* @return     PARAM_OK or PARAM_ERR_GEOM
+*
+*
+********************************************************************************************************/
+
+INT8S PARAM_Init(PARAM_STORE *ps, FLASH_DEV *dev, INT32U firstBlock){
+
+  memset(ps, 0, sizeof(PARAM_STORE));
+
+  ps->dev        = dev;
+  ps->firstBlock = firstBlock;
+  PARAM_Defaults(ps);
+
+  if(dev->pageSize < sizeof(PARAM_RECORD) || dev->pageSize > PARAM_PAGE_MAX ||
+     firstBlock + PARAM_BANKS > dev->blocks)
+    return PARAM_ERR_GEOM;
+
+  return PARAM_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         PARAM_Load()
+*
+* @brief      Loads the values of the newest valid record (boot)
+*
+* @param[in]  ps          store
+* @exception  none
+* @return     PARAM_OK, or PARAM_ERR_EMPTY if there is no valid record (default values)
+*/
+/* Notes      :(1) Headers only: the newest record is found before its CRC is checked. A torn record
+*                   (write cut) is rejected and the search starts again below its number.
+*
+*               (2) The pages of a bank are written in order: the next free page follows the last one
+*                   used, torn or not. The next record takes a number above all those on the device.
+*
+********************************************************************************************************/
+
+INT8S PARAM_Load(PARAM_STORE *ps){
+
+  INT32U       start = UTI_CycCntGet();
+  PARAM_RECORD rec;
+  INT16U       ppb = ps->dev->pagesPerBlock;
+  INT16U       hdr = (INT16U) ((INT8U *) rec.value - (INT8U *) &rec);
+  INT32U       base = ps->firstBlock * ppb;
+  INT32U       limit = PARAM_ERASED;
+  INT32U       best;
+  INT32U       bestSeq = 0;
+  INT32U       i;
+  INT16U       used[PARAM_BANKS] = { 0 };
+  BOOLEAN      first = true;
+
+  PARAM_Defaults(ps);
+  ps->seq   = 0;
+  ps->bank  = 0;
+  ps->stats.loaded      = false;
+  ps->stats.loadReads   = 0;
+  ps->stats.loadRejects = 0;
+
+  do {
+    // Note(1)
+    best = PARAM_BANKS * ppb;
+    for(i = 0; i < PARAM_BANKS * ppb; i++){
+      ps->stats.loadReads++;
+      if(FLASH_Read(ps->dev, base + i, 0, (INT8U *) &rec, hdr) != FLASH_OK || rec.magic == PARAM_ERASED)
+        continue;
+
+      if(first){                                              // Note(2)
+        used[i / ppb] = i % ppb + 1;
+        if(rec.magic == PARAM_MAGIC && rec.seq >= ps->seq){
+          ps->seq  = rec.seq;
+          ps->bank = i / ppb;
+        }
+      }
+      if(rec.magic == PARAM_MAGIC && rec.version == PARAM_VERSION && rec.words == PARAM_WORDS &&
+         rec.seq < limit && (best == PARAM_BANKS * ppb || rec.seq > bestSeq)){
+        best    = i;
+        bestSeq = rec.seq;
+      }
+    }
+    first = false;
+
+    if(best < PARAM_BANKS * ppb){
+      ps->stats.loadReads++;
+      if(FLASH_Read(ps->dev, base + best, 0, (INT8U *) &rec, sizeof(PARAM_RECORD)) == FLASH_OK &&
+         PARAM_Valid(&rec)){
+        memcpy(ps->value, rec.value, sizeof(ps->value));
+        ps->stats.loaded = true;
+      }
+      else {
+        ps->stats.loadRejects++;
+        limit = bestSeq;
+      }
+    }
+  } while(best < PARAM_BANKS * ppb && !ps->stats.loaded);
+
+  ps->next  = used[ps->bank];
+  ps->dirty = false;
+  ps->stats.loadCycles = UTI_CycCntGet() - start;
+
+  return ps->stats.loaded ? PARAM_OK : PARAM_ERR_EMPTY;
+}
+
+
+
+/********************************************************************************************************
+*                                         PARAM_Commit()
+*
+* @brief      Saves the values in use to a new record
+*
+* @param[in]  ps          store
+* @exception  none
+* @return     PARAM_OK or PARAM_ERR_FLASH
+*/
+/* Notes      :(1) The newest record is in the current bank: the other one can be erased.
+*
+*               (2) A page that failed is not used again, and its number neither: it may hold a torn
+*                   record.
+*
+********************************************************************************************************/
+
+INT8S PARAM_Commit(PARAM_STORE *ps){
+
+  PARAM_RECORD rec;
+  INT8U        page[PARAM_PAGE_MAX];
+  INT8U        spare[FLASH_SPARE_SIZE];
+  INT16U       ppb = ps->dev->pagesPerBlock;
+  INT8S        ret;
+
+  // Bank full                                                Note(1)
+  if(ps->next >= ppb){
+    if(FLASH_Erase(ps->dev, ps->firstBlock + (ps->bank ^ 1)) != FLASH_OK){
+      ps->stats.errors++;
+      return PARAM_ERR_FLASH;
+    }
+    ps->bank ^= 1;
+    ps->next  = 0;
+    ps->stats.bankSwitches++;
+  }
+
+  memset(&rec, 0, sizeof(PARAM_RECORD));
+  rec.magic   = PARAM_MAGIC;
+  rec.seq     = ps->seq + 1;
+  rec.version = PARAM_VERSION;
+  rec.words   = PARAM_WORDS;
+  memcpy(rec.value, ps->value, sizeof(rec.value));
+  rec.crc     = UTI_crc16((uint8_t *) &rec, (INT32U) ((INT8U *) &rec.crc - (INT8U *) &rec));
+
+  memset(page, 0xFF, ps->dev->pageSize);
+  memcpy(page, &rec, sizeof(PARAM_RECORD));
+  memset(spare, 0xFF, FLASH_SPARE_SIZE);
+
+  ret = FLASH_Prog(ps->dev, (ps->firstBlock + ps->bank) * ppb + ps->next, page, spare);
+
+  ps->next++;                                                 // Note(2)
+  ps->seq++;
+
+  if(ret != FLASH_OK){
+    ps->stats.errors++;
+    return PARAM_ERR_FLASH;
+  }
+
+  ps->dirty = false;
+  ps->stats.commits++;
+
+  return PARAM_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                         PARAM_Apply()
+*
+* @brief      Passes the values of the parameters to the modules which copy them (task periods). The
+*             other parameters are read with PARAM_Get() when used.
+*
+* @param[in]  ps          store
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void PARAM_Apply(const PARAM_STORE *ps){
+
+  TMON_SetPeriod(HK_DATA_ID,  PARAM_Get(ps, PARAM_HK_PERIOD_MS));
+  TMON_SetPeriod(PL_DATA_ID,  PARAM_Get(ps, PARAM_PL_PERIOD_MS));
+  TMON_SetPeriod(SEN_TIME_ID, PARAM_Get(ps, PARAM_TIME_PERIOD_MS));
+}
+
+
+
+/********************************************************************************************************
+*                                    PARAM_Get() / PARAM_GetBytes()
+*
+* @brief      Value of a scalar parameter (resp. bytes of an array parameter)
+*
+* @param[in]  ps          store
+* @param[in]  id          parameter (PARAM_xxx)
+* @exception  none
+* @return     value (resp. pointer on the bytes, valid until the next change)
+*
+*
+********************************************************************************************************/
+
+INT32U PARAM_Get(const PARAM_STORE *ps, INT8U id){
+
+  return ps->value[paramTbl[id].word];
+}
+
+const INT8U* PARAM_GetBytes(const PARAM_STORE *ps, INT8U id){
+
+  return (const INT8U *) &ps->value[paramTbl[id].word];
+}
+
+
+
+/********************************************************************************************************
+*                                    PARAM_Set() / PARAM_SetBytes()
+*
+* @brief      Changes the value of a scalar parameter (resp. the bytes of an array parameter), in RAM
+*             until the next commit
+*
+* @param[in]  ps          store
+* @param[in]  id          parameter (PARAM_xxx)
+* @param[in]  value       new value (resp. data, size of the parameter)
+* @exception  none
+* @return     PARAM_OK or PARAM_ERR_RANGE
+*
+*
+********************************************************************************************************/
+
+INT8S PARAM_Set(PARAM_STORE *ps, INT8U id, INT32U value){
+
+  const PARAM_DESC *desc = &paramTbl[id];
+
+  if(desc->size != 4 || value < desc->min || value > desc->max)
+    return PARAM_ERR_RANGE;
+
+  ps->value[desc->word] = value;
+  ps->dirty = true;
+
+  return PARAM_OK;
+}
+
+INT8S PARAM_SetBytes(PARAM_STORE *ps, INT8U id, const INT8U *data){
+
+  const PARAM_DESC *desc = &paramTbl[id];
+
+  if(desc->size <= 4)
+    return PARAM_ERR_RANGE;
+
+  memcpy(&ps->value[desc->word], data, desc->size);
+  ps->dirty = true;
+
+  return PARAM_OK;
+}
+
+
+
+/********************************************************************************************************
+*                                    PARAM_GetDesc() / PARAM_Find()
+*
+* @brief      Description of a parameter (resp. parameter of a name)
+*
+* @param[in]  id          parameter (PARAM_xxx)
+* @param[in]  name        name of the parameter
+* @exception  none
+* @return     description (resp. parameter, PARAM_NB if none)
+*
+*
+********************************************************************************************************/
+
+const PARAM_DESC* PARAM_GetDesc(INT8U id){
+
+  return &paramTbl[id];
+}
+
+INT8U PARAM_Find(const char *name){
+
+  INT8U id;
+
+  for(id = 0; id < PARAM_NB && strcmp(paramTbl[id].name, name) != 0; id++);
+
+  return id;
+}
+
+
+
+/********************************************************************************************************
+*                                         PARAM_SelfTest()
+*
+* @brief      Checks the store on a simulated NOR: load of an erased device, sequence of commits and
+*             reload, then a power cut at each flash operation of the sequence
+*
+* @param[out] res         PARAM_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) Commit k sets the housekeeping period to 1000 + k and the first byte of the scenario
+*                   descriptor to k: a reload with values of two commits is detected.
+*
+*               (2) The program or erase of the cut is half done, the following ones fail (see FLASH_SimCut()).
+*                   After the reboot, the values must be those of the last commit that succeeded or of the
+*                   one cut, and a new commit must succeed.
+*
+********************************************************************************************************/
+
+void PARAM_SelfTest(PARAM_TEST *res){
+
+  INT8U       mem[PARAM_TEST_PAGE_SIZE * PARAM_TEST_PPB * PARAM_BANKS];
+  INT8U       spare[FLASH_SPARE_SIZE * PARAM_TEST_PPB * PARAM_BANKS];
+  INT8U       scn[PARAM_SCN_SIZE];
+  FLASH_DEV   dev;
+  PARAM_STORE ps;
+  PARAM_STATS stats;
+  INT32U      ops;
+  INT32U      done;
+  INT32U      k;
+
+  memset(res, 0, sizeof(PARAM_TEST));
+
+  FLASH_SimInit(&dev, "ptest", mem, spare, PARAM_TEST_PAGE_SIZE, PARAM_TEST_PPB, PARAM_BANKS);
+
+  // Erased device
+  PARAM_Init(&ps, &dev, 0);
+  res->empty = (PARAM_Load(&ps) == PARAM_ERR_EMPTY &&
+                PARAM_Get(&ps, PARAM_HK_PERIOD_MS) == APP_CFG_HK_DATA_PERIOD_MS);
+
+  // Commits, then reload                                     Note(1)
+  memcpy(scn, paramScnDef, PARAM_SCN_SIZE);
+  for(k = 1; k <= PARAM_TEST_COMMITS; k++){
+    scn[0] = (INT8U) k;
+    PARAM_Set(&ps, PARAM_HK_PERIOD_MS, 1000 + k);
+    PARAM_SetBytes(&ps, PARAM_SCN_DESC, scn);
+    if(PARAM_Commit(&ps) == PARAM_OK)
+      res->commits++;
+  }
+  res->bankSwitches = ps.stats.bankSwitches;
+  ops = dev.stats.progs + dev.stats.erases;
+  res->reload = PARAM_TestCheck(&dev, PARAM_TEST_COMMITS, PARAM_TEST_COMMITS, &stats);
+  res->loadCycles = stats.loadCycles;
+
+  // Power cut at each operation                              Note(2)
+  for(res->cuts = 0; res->cuts < ops; res->cuts++){
+    FLASH_SimInit(&dev, "ptest", mem, spare, PARAM_TEST_PAGE_SIZE, PARAM_TEST_PPB, PARAM_BANKS);
+    PARAM_Init(&ps, &dev, 0);
+    PARAM_Load(&ps);
+
+    FLASH_SimCut(&dev, (INT32S) res->cuts);
+    done = 0;
+    for(k = 1; k <= PARAM_TEST_COMMITS && !dev.off; k++){
+      scn[0] = (INT8U) k;
+      PARAM_Set(&ps, PARAM_HK_PERIOD_MS, 1000 + k);
+      PARAM_SetBytes(&ps, PARAM_SCN_DESC, scn);
+      if(PARAM_Commit(&ps) == PARAM_OK)
+        done = k;
+    }
+    FLASH_SimCut(&dev, -1);
+
+    if(!PARAM_TestCheck(&dev, done, k - 1, &stats))
+      res->errors++;
+    if(stats.loadRejects > 0)
+      res->torn++;
+    if(stats.loadCycles > res->loadCycles)
+      res->loadCycles = stats.loadCycles;
+  }
+
+  res->pass = (res->empty && res->reload && res->commits == PARAM_TEST_COMMITS &&
+               res->bankSwitches >= PARAM_BANKS && res->errors == 0);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+static void PARAM_Defaults(PARAM_STORE *ps){
+
+  INT8U id;
+
+  memset(ps->value, 0, sizeof(ps->value));
+  for(id = 0; id < PARAM_NB; id++){
+    if(paramTbl[id].size == 4)
+      ps->value[paramTbl[id].word] = paramTbl[id].def;
+    else
+      memcpy(&ps->value[paramTbl[id].word], paramTbl[id].defBytes, paramTbl[id].size);
+  }
+}
+
+/******************************************************************************/
+
+static BOOLEAN PARAM_Valid(const PARAM_RECORD *rec){
+
+  return (rec->magic == PARAM_MAGIC && rec->version == PARAM_VERSION && rec->words == PARAM_WORDS &&
+          rec->crc == UTI_crc16((uint8_t *) rec, (INT32U) ((INT8U *) &rec->crc - (INT8U *) rec)));
+}
+
+/******************************************************************************/
+
+// Reboot: the values must be those of commit k1 or k2 (0: defaults), then a new commit must succeed
+static BOOLEAN PARAM_TestCheck(FLASH_DEV *dev, INT32U k1, INT32U k2, PARAM_STATS *stats){
+
+  PARAM_STORE ps;
+  INT32U      hk;
+  INT8U       scn;
+  BOOLEAN     ok;
+
+  PARAM_Init(&ps, dev, 0);
+  PARAM_Load(&ps);
+  *stats = ps.stats;
+
+  hk  = PARAM_Get(&ps, PARAM_HK_PERIOD_MS);
+  scn = PARAM_GetBytes(&ps, PARAM_SCN_DESC)[0];
+  ok  = ((k1 == 0 && hk == APP_CFG_HK_DATA_PERIOD_MS && scn == paramScnDef[0]) ||
+         (k1 != 0 && hk == 1000 + k1 && scn == (INT8U) k1) ||
+         (hk == 1000 + k2 && scn == (INT8U) k2));
+
+  PARAM_Set(&ps, PARAM_HK_PERIOD_MS, 5000);
+  ok = ok && PARAM_Commit(&ps) == PARAM_OK;
+
+  PARAM_Init(&ps, dev, 0);
+  ok = ok && PARAM_Load(&ps) == PARAM_OK && PARAM_Get(&ps, PARAM_HK_PERIOD_MS) == 5000;
+
+  return ok;
+}
@@ -0,0 +1,162 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: param.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Persistent parameter store: tunable parameters kept in RAM for O(1) access
+and saved as CRC-protected records on two banks of a NOR flash
+
+******************************************************************************/
+
+
+
+#ifndef __PARAM_H
+#define __PARAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Parameters (index in the parameter table, see param.c)
+#define PARAM_HK_PERIOD_MS      0       // Period of the housekeeping task
+#define PARAM_PL_PERIOD_MS      1       // Period of the payload task
+#define PARAM_TIME_PERIOD_MS    2       // Period of the sensor time task
+#define PARAM_DISP_PERIOD_MS    3       // Period of the serial display
+#define PARAM_SCN_DESC          4       // Descriptor of the PL scenario created by 'add'
+#define PARAM_STAT_WINDOW_S     5       // Window of the running statistics (see app_stats.c)
+#define PARAM_NB                6
+
+#define PARAM_SCN_SIZE          13      // Bytes of a PL scenario descriptor
+#define PARAM_WORDS             9       // 32-bit words of the values of all parameters
+
+// Increment when the parameter table changes: records of another version are ignored
+#define PARAM_VERSION           2
+#define PARAM_MAGIC             0x50524D53u                 // "PRMS"
+
+#define PARAM_PAGE_MAX          APP_CFG_NOR_PAGE_SIZE       // Largest page of a parameter device (bytes)
+#define PARAM_BANKS             2       // Erase blocks used by the store
+
+// Return values
+#define PARAM_OK                0
+#define PARAM_ERR_FLASH        -1       // Device error (see FLASH_ERR_xxx)
+#define PARAM_ERR_RANGE        -2       // Value outside the range of the parameter
+#define PARAM_ERR_GEOM         -3       // Pages too small or too large for a record
+#define PARAM_ERR_EMPTY        -4       // No valid record: defaults loaded
+
+// Self-test (see PARAM_SelfTest())
+#define PARAM_TEST_PAGE_SIZE    64      // Simulated NOR (on the stack)
+#define PARAM_TEST_PPB          4
+#define PARAM_TEST_COMMITS      11      // Records written by a test sequence (both banks wrap)
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Parameter: scalar (size 4, value in [min, max]) or array of bytes (size > 4, default in defBytes)
+typedef struct ParamDesc PARAM_DESC;
+
+struct ParamDesc {
+  const char  *name;
+  INT8U        word;                    // First word of the value
+  INT8U        size;                    // Bytes
+  INT32U       def;
+  INT32U       min;
+  INT32U       max;
+  const INT8U *defBytes;
+};
+
+// Record: one per NOR page. The newest valid record (highest seq, CRC correct) holds the values.
+typedef struct ParamRecord PARAM_RECORD;
+
+struct ParamRecord {
+  INT32U magic;                         // PARAM_MAGIC
+  INT32U seq;                           // Records written
+  INT16U version;                       // PARAM_VERSION
+  INT16U words;                         // PARAM_WORDS
+  INT32U value[PARAM_WORDS];
+  INT16U crc;                           // CRC-16 of the bytes above
+};
+
+typedef struct ParamStats PARAM_STATS;
+
+struct ParamStats {
+  INT32U  commits;
+  INT32U  errors;                       // Commits failed
+  INT32U  bankSwitches;                 // Bank full, the other one erased
+  BOOLEAN loaded;                       // Last load found a record (else defaults)
+  INT32U  loadReads;                    // Pages read by the last load
+  INT32U  loadRejects;                  // Records with a wrong CRC (write cut)
+  INT32U  loadCycles;                   // Cost of the last load
+};
+
+// Store on the blocks [firstBlock, firstBlock + PARAM_BANKS) of a device
+typedef struct ParamStore PARAM_STORE;
+
+struct ParamStore {
+  FLASH_DEV   *dev;
+  INT32U       firstBlock;
+  INT32U       value[PARAM_WORDS];      // Values in use
+  INT32U       seq;                     // Highest record number on the device
+  INT8U        bank;                    // Bank of the newest record
+  INT16U       next;                    // Next free page of the bank
+  BOOLEAN      dirty;                   // Values changed since the last commit
+  PARAM_STATS  stats;
+};
+
+// Self-test results: power cut at each flash operation of a sequence of commits
+typedef struct ParamTest PARAM_TEST;
+
+struct ParamTest {
+  INT32U  commits;                      // Without cut
+  INT32U  bankSwitches;
+  BOOLEAN reload;                       // Values found back after a reload
+  BOOLEAN empty;                        // Defaults on an erased device
+  INT32U  cuts;                         // Power cuts tested
+  INT32U  torn;                         // Cuts leaving a torn record
+  INT32U  errors;                       // Reloads with other values than the last or previous commit
+  INT32U  loadCycles;                   // Largest load cost
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+INT8S   PARAM_Init(PARAM_STORE *ps, FLASH_DEV *dev, INT32U firstBlock);
+INT8S   PARAM_Load(PARAM_STORE *ps);
+INT8S   PARAM_Commit(PARAM_STORE *ps);
+void    PARAM_Apply(const PARAM_STORE *ps);
+
+INT32U  PARAM_Get(const PARAM_STORE *ps, INT8U id);
+const INT8U* PARAM_GetBytes(const PARAM_STORE *ps, INT8U id);
+INT8S   PARAM_Set(PARAM_STORE *ps, INT8U id, INT32U value);
+INT8S   PARAM_SetBytes(PARAM_STORE *ps, INT8U id, const INT8U *data);
+
+const PARAM_DESC* PARAM_GetDesc(INT8U id);
+INT8U   PARAM_Find(const char *name);
+
+void    PARAM_SelfTest(PARAM_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __PARAM_H */
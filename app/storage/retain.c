@@ -0,0 +1,529 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: retain.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Retention tiers of a log of records (see logstore.c and tlmcomp.c). The raw
+log keeps the recent records at full rate, until its oldest blocks are
+written again. A tier reads the pages of a source log and summarizes the
+records of each window of 'period' (aligned on multiples of the period):
+
+  - the number of records, then the min, max and mean of each value, in one
+    summary record (TLMC record, time = start of the window),
+  - the summary records are compressed into blocks appended to the log of
+    the tier, on its own partition.
+
+The source of the first tier is the raw log, the source of the next one is
+the first tier (1 s, then 1 min, ...): the flash used is set by the
+partitions, the raw pages are written again once summarized and the long
+term trends stay in the tiers. The mean of a longer window is the mean of
+the means of its source windows, weighted by their counts.
+
+A step (RET_Step()) summarizes one source page: its cost is bounded, the
+memory management task runs the steps when it has no record to store. The
+block of a tier is stored before full when the source overwrites the pages
+of its first window: after a reset, the tier restarts after the windows of
+its last page and summarizes them again from the source.
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define RET_TEST_PPB            4       // Generated raw log
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// Self-test: raw pages written and first data page of the generated raw log. The tiers and their
+// device do not fit on the stack of the command task.
+static INT32U   retTestPages;
+static INT32U   retTestFirst;
+static LOG      retTestLog[3];
+static RET_TIER retTestTier[2];
+static INT8U    retTestMem[TLMC_BLOCK_SIZE * 2 * RET_TEST_BLOCKS];
+static INT8U    retTestSpare[FLASH_SPARE_SIZE * 2 * RET_TEST_BLOCKS];
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void     RET_Add(RET_TIER *t, uint64_t time, const int32_t *val);
+static void     RET_Close(RET_TIER *t);
+static void     RET_Store(RET_TIER *t);
+static void     RET_TestCheck(LOG *log, uint64_t period, INT32U *page, uint64_t *next, RET_TEST *res);
+static void     RET_TestExpect(uint64_t win, uint64_t period, int32_t *val);
+static uint64_t RET_TestTime(INT32U r);
+static void     RET_TestRecord(INT32U r, int32_t *val);
+static void     RET_TestGen(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare);
+
+
+
+
+
+/********************************************************************************************************
+*                                         RET_Init()
+*
+* @brief      Initialises a tier of a source log, after the mount of both logs
+*
+* @param[in]  t           tier
+* @param[in]  src         source log
+* @param[in]  srcSum      the source is a tier (summary records), else raw records
+* @param[in]  log         log of the tier
+* @param[in]  nbCh        values of a raw record (<= RET_MAX_CH)
+* @param[in]  period      window (us), multiple of the window of the source
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The windows of the last page of the tier are kept: the tier restarts after them, at
+*                   the source page of the next window. The windows not stored before the reset are
+*                   summarized again.
+*
+********************************************************************************************************/
+
+void RET_Init(RET_TIER *t, LOG *src, BOOLEAN srcSum, LOG *log, INT8U nbCh, uint64_t period){
+
+  INT8U     hdr[TLMC_HDR_SIZE];
+  uint64_t  first;
+  uint64_t  last;
+  LOG_QUERY q;
+
+  memset(t, 0, sizeof(RET_TIER));
+
+  t->src    = src;
+  t->log    = log;
+  t->nbCh   = (nbCh > RET_MAX_CH) ? RET_MAX_CH : nbCh;
+  t->srcSum = srcSum;
+  t->period = period;
+  TLMC_Init(&t->enc, RET_SUM_CH(t->nbCh), t->block);
+
+  // Note(1)
+  if(log->sum.head > log->sum.tail){
+    if(LOG_Read(log, log->sum.head - 1, 0, hdr, TLMC_HDR_SIZE) == LOG_OK && TLMC_BlockTimes(hdr, &first, &last))
+      t->resume = last + period;
+    else
+      t->resume = log->sum.lastTime;    // Last page lost: its windows again
+  }
+
+  LOG_QueryStart(src, &q, t->resume, ~(uint64_t) 0);
+  t->next = q.next;
+}
+
+
+
+/********************************************************************************************************
+*                                         RET_Step()
+*
+* @brief      Summarizes the next page of the source of a tier
+*
+* @param[in]  t           tier
+* @exception  none
+* @return     false when the tier has summarized every page of its source
+*/
+/* Notes      :(1) The pages of the first window of the block are written again: the block is stored,
+*                   a reset would lose its windows.
+*
+********************************************************************************************************/
+
+BOOLEAN RET_Step(RET_TIER *t){
+
+  LOG      *src = t->src;
+  int32_t   val[TLMC_MAX_CH];
+  uint64_t  time;
+  INT32U    start = UTI_CycCntGet();
+
+  if(t->next < src->sum.tail){
+    t->lost += src->sum.tail - t->next;
+    t->next  = src->sum.tail;
+  }
+
+  if(t->enc.count > 0 && t->blockPage < src->sum.tail){
+    // Note(1)
+    RET_Store(t);
+    t->flushes++;
+  }
+
+  if(t->next >= src->sum.head)
+    return false;
+
+  if(LOG_Read(src, t->next, 0, t->page, TLMC_BLOCK_SIZE) != LOG_OK || !TLMC_DecodeInit(&t->dec, t->page) ||
+     t->dec.nbCh != (t->srcSum ? RET_SUM_CH(t->nbCh) : t->nbCh))
+    t->lost++;
+  else {
+    while(TLMC_DecodeNext(&t->dec, &time, val))
+      if(time >= t->resume)
+        RET_Add(t, time, val);
+    t->pages++;
+  }
+  t->next++;
+
+  t->cycles = UTI_CycCntGet() - start;
+  if(t->cycles > t->cyclesMax)
+    t->cyclesMax = t->cycles;
+
+  return true;
+}
+
+
+
+/********************************************************************************************************
+*                                         RET_Compact()
+*
+* @brief      Runs one step on the first tier with pages to summarize
+*
+* @param[in]  tiers       tiers, the source of each one is the previous one (the raw log for the first)
+* @param[in]  nb          tiers
+* @exception  none
+* @return     false when no tier has pages to summarize
+*/
+/* Notes      :(1) The first tiers go first: their sources are written again sooner.
+*
+********************************************************************************************************/
+
+BOOLEAN RET_Compact(RET_TIER *tiers, INT8U nb){
+
+  INT8U i;
+
+  for(i = 0; i < nb; i++)                                     // Note(1)
+    if(RET_Step(&tiers[i]))
+      return true;
+
+  return false;
+}
+
+
+
+/********************************************************************************************************
+*                                         RET_SelfTest()
+*
+* @brief      Summarizes a generated raw log into two tiers and checks every window stored
+*
+* @param[out] res         RET_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The raw pages are written RET_TEST_STEP at a time, the tiers summarize them between
+*                   two writes. The tier logs (simulated device) hold two pages each: they wrap, the
+*                   second tier stores its blocks before full.
+*
+*               (2) Reset in the middle: the tier logs are mounted again and the tiers restart from
+*                   their last page. The windows stored, checked after each step, must follow each other
+*                   from 0 without gap or repetition.
+*
+*               (3) The cost of a step includes the generation of the raw page in place of a flash read.
+*
+********************************************************************************************************/
+
+void RET_SelfTest(RET_TEST *res){
+
+  FLASH_DEV raw;
+  FLASH_DEV dev;
+  INT32U    pages;
+  INT32U    page[2] = { 0, 0 };         // Next page to check
+  uint64_t  next[2] = { 0, 0 };         // Next window
+  INT8U     k;
+
+  memset(res, 0, sizeof(RET_TEST));
+
+  FLASH_GenInit(&raw, "raw", RET_TestGen, TLMC_BLOCK_SIZE, RET_TEST_PPB, RET_TEST_PAGES / RET_TEST_PPB + 4);
+  FLASH_SimInit(&dev, "tiers", retTestMem, retTestSpare, TLMC_BLOCK_SIZE, 1, 2 * RET_TEST_BLOCKS);
+  for(k = 1; k <= 2; k++){
+    LOG_Init(&retTestLog[k], (k == 1) ? "1 s" : "5 s", &dev, (k - 1) * RET_TEST_BLOCKS, RET_TEST_BLOCKS);
+    LOG_Format(&retTestLog[k]);
+  }
+
+  // Note(1)
+  for(pages = RET_TEST_STEP; pages <= RET_TEST_PAGES; pages += RET_TEST_STEP){
+    retTestPages = pages;
+    LOG_Init(&retTestLog[0], "raw", &raw, 0, raw.blocks);
+    retTestFirst = retTestLog[0].sumBlocks * RET_TEST_PPB;
+    LOG_Mount(&retTestLog[0]);
+
+    if(pages == RET_TEST_STEP || pages == RET_TEST_PAGES / 2 + RET_TEST_STEP){
+      if(pages > RET_TEST_STEP){
+        // Note(2)
+        for(k = 0; k < 2; k++){
+          res->windows[k] += retTestTier[k].windows;
+          res->lost       += retTestTier[k].lost;
+          LOG_Init(&retTestLog[k + 1], retTestLog[k + 1].name, &dev, k * RET_TEST_BLOCKS, RET_TEST_BLOCKS);
+          LOG_Mount(&retTestLog[k + 1]);
+        }
+      }
+      RET_Init(&retTestTier[0], &retTestLog[0], false, &retTestLog[1], RET_TEST_NB_CH, RET_TEST_T1_US);
+      RET_Init(&retTestTier[1], &retTestLog[1], true,  &retTestLog[2], RET_TEST_NB_CH, RET_TEST_T2_US);
+    }
+
+    while(RET_Compact(retTestTier, 2));
+
+    for(k = 0; k < 2; k++){
+      RET_TestCheck(&retTestLog[k + 1], (k == 0) ? RET_TEST_T1_US : RET_TEST_T2_US, &page[k], &next[k], res);
+      if(retTestTier[k].cyclesMax > res->cyclesMax)
+        res->cyclesMax = retTestTier[k].cyclesMax;                // Note(3)
+    }
+  }
+
+  for(k = 0; k < 2; k++){
+    res->windows[k] += retTestTier[k].windows;
+    res->lost       += retTestTier[k].lost;
+  }
+
+  res->records   = RET_TEST_PAGES * RET_TEST_RECORDS;
+  res->rawPages  = RET_TEST_PAGES;
+  res->tierPages = retTestLog[1].sum.head + retTestLog[2].sum.head;
+  res->pass      = (res->errors == 0 && res->lost == 0 && res->checked[0] > 0 && res->checked[1] > 0 &&
+                    res->tierPages < res->rawPages);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Adds a source record (raw or summary) to the current window, closes the window before if the record
+// is after it
+static void RET_Add(RET_TIER *t, uint64_t time, const int32_t *val){
+
+  uint64_t win = time - time % t->period;
+  INT32U   n = t->srcSum ? (INT32U) val[RET_COUNT] : 1;
+  int32_t  lo, hi, mean;
+  INT8U    ch;
+
+  if(t->count > 0 && win != t->win)
+    RET_Close(t);
+
+  if(t->count == 0){
+    t->win     = win;
+    t->winPage = t->next;
+    for(ch = 0; ch < t->nbCh; ch++){
+      t->min[ch] = INT32_MAX;
+      t->max[ch] = INT32_MIN;
+      t->sum[ch] = 0;
+    }
+  }
+
+  for(ch = 0; ch < t->nbCh; ch++){
+    lo   = t->srcSum ? val[RET_MIN(t->nbCh, ch)]  : val[ch];
+    hi   = t->srcSum ? val[RET_MAX(t->nbCh, ch)]  : val[ch];
+    mean = t->srcSum ? val[RET_MEAN(t->nbCh, ch)] : val[ch];
+    if(lo < t->min[ch])
+      t->min[ch] = lo;
+    if(hi > t->max[ch])
+      t->max[ch] = hi;
+    t->sum[ch] += (int64_t) mean * n;
+  }
+  t->count += n;
+}
+
+/******************************************************************************/
+
+// Adds the summary of the current window to the block, stores the block when full
+static void RET_Close(RET_TIER *t){
+
+  int32_t val[TLMC_MAX_CH];
+  INT8U   ch;
+
+  val[RET_COUNT] = (int32_t) t->count;
+  for(ch = 0; ch < t->nbCh; ch++){
+    val[RET_MIN(t->nbCh, ch)]  = t->min[ch];
+    val[RET_MAX(t->nbCh, ch)]  = t->max[ch];
+    val[RET_MEAN(t->nbCh, ch)] = (int32_t) (t->sum[ch] / (int64_t) t->count);
+  }
+
+  if(t->enc.count == 0)
+    t->blockPage = t->winPage;
+
+  if(!TLMC_Add(&t->enc, t->win, val)){
+    RET_Store(t);                       // Block sealed by the encoder
+    t->blockPage = t->winPage;
+    TLMC_Add(&t->enc, t->win, val);
+  }
+
+  t->windows++;
+  t->count = 0;
+}
+
+/******************************************************************************/
+
+// Appends the block to the log of the tier and starts the next one
+static void RET_Store(RET_TIER *t){
+
+  uint64_t first;
+  uint64_t last;
+
+  TLMC_Seal(&t->enc);
+  TLMC_BlockTimes(t->block, &first, &last);
+
+  if(LOG_Append(t->log, t->block, first) != LOG_OK)
+    t->errors++;
+  if(t->log->sum.head - t->log->synced >= RET_SYNC_PAGES)
+    LOG_Sync(t->log);
+
+  TLMC_Start(&t->enc, t->block);
+}
+
+/******************************************************************************/
+
+// Checks the windows of the pages stored in a tier log of the self-test since the last check (from
+// 'page', next window 'next') against the generated records
+static void RET_TestCheck(LOG *log, uint64_t period, INT32U *page, uint64_t *next, RET_TEST *res){
+
+  INT8U    block[TLMC_BLOCK_SIZE];
+  TLMC_DEC dec;
+  int32_t  val[TLMC_MAX_CH];
+  int32_t  exp[TLMC_MAX_CH];
+  uint64_t time;
+
+  if(*page < log->sum.tail)
+    res->errors++;                      // Pages written again before being checked
+
+  for(*page = (*page < log->sum.tail) ? log->sum.tail : *page; *page < log->sum.head; (*page)++){
+    if(LOG_Read(log, *page, 0, block, TLMC_BLOCK_SIZE) != LOG_OK || !TLMC_DecodeInit(&dec, block)){
+      res->errors++;
+      continue;
+    }
+    while(TLMC_DecodeNext(&dec, &time, val)){
+      RET_TestExpect(time, period, exp);
+      if(time != *next || memcmp(val, exp, RET_SUM_CH(RET_TEST_NB_CH) * sizeof(int32_t)) != 0)
+        res->errors++;
+      *next = time + period;
+      res->checked[period == RET_TEST_T1_US ? 0 : 1]++;
+    }
+  }
+}
+
+/******************************************************************************/
+
+// Summary of a window of the generated records. The mean of a longer window is computed as the tiers
+// do: mean of the 1 s means (truncated), weighted by their counts.
+static void RET_TestExpect(uint64_t win, uint64_t period, int32_t *val){
+
+  int32_t  v[RET_TEST_NB_CH];
+  int64_t  sum[RET_TEST_NB_CH];
+  int64_t  sub[RET_TEST_NB_CH];
+  uint64_t s;
+  uint64_t time;
+  INT32U   count = 0;
+  INT32U   n;
+  INT32U   r;
+  INT8U    ch;
+
+  for(ch = 0; ch < RET_TEST_NB_CH; ch++){
+    val[RET_MIN(RET_TEST_NB_CH, ch)] = INT32_MAX;
+    val[RET_MAX(RET_TEST_NB_CH, ch)] = INT32_MIN;
+    sum[ch] = 0;
+  }
+
+  for(s = win; s < win + period; s += RET_TEST_T1_US){
+    memset(sub, 0, sizeof(sub));
+    n = 0;
+    for(r = (INT32U) (s / RET_TEST_PERIOD_US); r < RET_TEST_PAGES * RET_TEST_RECORDS; r++){
+      time = RET_TestTime(r);
+      if(time >= s + RET_TEST_T1_US)
+        break;
+      if(time < s)
+        continue;
+      RET_TestRecord(r, v);
+      for(ch = 0; ch < RET_TEST_NB_CH; ch++){
+        if(v[ch] < val[RET_MIN(RET_TEST_NB_CH, ch)])
+          val[RET_MIN(RET_TEST_NB_CH, ch)] = v[ch];
+        if(v[ch] > val[RET_MAX(RET_TEST_NB_CH, ch)])
+          val[RET_MAX(RET_TEST_NB_CH, ch)] = v[ch];
+        sub[ch] += v[ch];
+      }
+      n++;
+    }
+    if(n > 0)
+      for(ch = 0; ch < RET_TEST_NB_CH; ch++)
+        sum[ch] += (int64_t) (int32_t) (sub[ch] / (int64_t) n) * n;
+    count += n;
+  }
+
+  val[RET_COUNT] = (int32_t) count;
+  for(ch = 0; ch < RET_TEST_NB_CH; ch++)
+    val[RET_MEAN(RET_TEST_NB_CH, ch)] = (count > 0) ? (int32_t) (sum[ch] / (int64_t) count) : 0;
+}
+
+/******************************************************************************/
+
+// Generated records: 10 Hz with a jitter below 5 ms, Q16.16 values with a trend and 12 bits of noise
+static uint64_t RET_TestTime(INT32U r){
+
+  INT32U h = r * 2654435761u;
+
+  h ^= h >> 15;
+
+  return (uint64_t) r * RET_TEST_PERIOD_US + h % 5000;
+}
+
+static void RET_TestRecord(INT32U r, int32_t *val){
+
+  INT32U h;
+  INT8U  ch;
+
+  for(ch = 0; ch < RET_TEST_NB_CH; ch++){
+    h  = (r * RET_TEST_NB_CH + ch) * 2654435761u;
+    h ^= h >> 13;
+    val[ch] = (int32_t) ((ch + 1) << 16) * ((ch & 1) ? -1 : 1) + (int32_t) (r * (ch + 1)) * 8 +
+              (int32_t) (h % 4096) - 2048;
+  }
+}
+
+/******************************************************************************/
+
+// Generated raw log: retTestPages pages written, page n holds the records [n, n + 1) * RET_TEST_RECORDS.
+// The tiers read whole pages only.
+static void RET_TestGen(INT32U page, INT16U offset, INT8U *data, INT16U len, INT8U *spare){
+
+  TLMC    enc;
+  int32_t val[RET_TEST_NB_CH];
+  INT32U  n = page - retTestFirst;
+  BOOLEAN written = (page >= retTestFirst && n < retTestPages);
+  INT32U  r;
+
+  if(data != NULL){
+    if(written && offset == 0 && len == TLMC_BLOCK_SIZE){
+      TLMC_Init(&enc, RET_TEST_NB_CH, data);
+      for(r = n * RET_TEST_RECORDS; r < (n + 1) * RET_TEST_RECORDS; r++){
+        RET_TestRecord(r, val);
+        TLMC_Add(&enc, RET_TestTime(r), val);
+      }
+      TLMC_Seal(&enc);
+    }
+    else
+      memset(data, 0xFF, len);
+  }
+  if(spare != NULL){
+    if(written)
+      LOG_SpareSet(spare, n, RET_TestTime(n * RET_TEST_RECORDS), 0);
+    else
+      memset(spare, 0xFF, FLASH_SPARE_SIZE);
+  }
+}
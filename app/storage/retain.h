@@ -0,0 +1,123 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: retain.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Retention tiers: records of a log summarized (count, min, max, mean) over
+windows of increasing length, each tier in its own log
+
+******************************************************************************/
+
+
+
+#ifndef __RETAIN_H
+#define __RETAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+// Summary record (TLMC record, time = start of the window): count, then min, max and mean of each value
+#define RET_MAX_CH              ((TLMC_MAX_CH - 1) / 3)     // Values of a raw record
+#define RET_COUNT               0
+#define RET_MIN(n, ch)          (1 + (ch))
+#define RET_MAX(n, ch)          (1 + (n) + (ch))
+#define RET_MEAN(n, ch)         (1 + 2 * (n) + (ch))
+#define RET_SUM_CH(n)           (1 + 3 * (n))               // Values of a summary record
+
+#define RET_SYNC_PAGES          4       // Pages of a tier between checkpoints
+
+// Self-test (see RET_SelfTest())
+#define RET_TEST_NB_CH          11      // Layout of MSGQ_SEN_DATA
+#define RET_TEST_RECORDS        16      // Records of a raw page (10 Hz)
+#define RET_TEST_PAGES          64      // Raw pages
+#define RET_TEST_STEP           4       // Raw pages written between two compactions
+#define RET_TEST_BLOCKS         6       // Blocks of a tier log (one page per block)
+#define RET_TEST_PERIOD_US      100000
+#define RET_TEST_T1_US          1000000 // Windows of the tiers
+#define RET_TEST_T2_US          5000000
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Tier: summaries of the records of a source log (raw records or summaries of a shorter window)
+typedef struct RetTier RET_TIER;
+
+struct RetTier {
+  LOG      *src;
+  LOG      *log;                        // Summaries of the tier
+  INT8U     nbCh;                       // Values of a raw record
+  BOOLEAN   srcSum;                     // Source records are summaries
+  uint64_t  period;                     // Window (us), multiple of the window of the source
+  INT32U    next;                       // Next page of the source
+  uint64_t  resume;                     // Source records before are in the tier already
+  uint64_t  win;                        // Start of the current window
+  INT32U    count;                      // Records of the current window (0: none)
+  INT32U    winPage;                    // Source page of the start of the window
+  INT32U    blockPage;                  // Source page of the start of the block
+  int32_t   min[RET_MAX_CH];
+  int32_t   max[RET_MAX_CH];
+  int64_t   sum[RET_MAX_CH];
+  TLMC      enc;
+  TLMC_DEC  dec;
+  INT8U     block[TLMC_BLOCK_SIZE];     // Summaries being compressed
+  INT8U     page[TLMC_BLOCK_SIZE];      // Source page being compacted
+  // Statistics
+  INT32U    pages;                      // Source pages compacted
+  INT32U    windows;
+  INT32U    flushes;                    // Blocks stored before being full
+  INT32U    lost;                       // Source pages overwritten or unreadable before compaction
+  INT32U    errors;                     // Tier pages lost (program failed)
+  INT32U    cycles;                     // Cost of the last step
+  INT32U    cyclesMax;
+};
+
+// Self-test results: a generated raw log compacted into two tiers, with a reboot in the middle
+typedef struct RetTest RET_TEST;
+
+struct RetTest {
+  INT32U  records;                      // Raw records
+  INT32U  windows[2];                   // Windows of each tier
+  INT32U  checked[2];                   // Windows still in the tier logs, checked
+  INT32U  errors;                       // Windows with a wrong summary, missing or repeated
+  INT32U  lost;                         // Source pages overwritten before compaction
+  INT32U  cyclesMax;                    // Largest step
+  INT32U  rawPages;                     // Flash pages of the records, raw
+  INT32U  tierPages;                    // Flash pages of the tiers for the same time
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    RET_Init(RET_TIER *t, LOG *src, BOOLEAN srcSum, LOG *log, INT8U nbCh, uint64_t period);
+BOOLEAN RET_Step(RET_TIER *t);
+BOOLEAN RET_Compact(RET_TIER *tiers, INT8U nb);
+
+void    RET_SelfTest(RET_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __RETAIN_H */
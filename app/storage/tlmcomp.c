@@ -0,0 +1,634 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: tlmcomp.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Lossless streaming compression of telemetry records. A record is a 64-bit
+time stamp and up to TLMC_MAX_CH 32-bit values (Q16.16 measurements). The
+records are coded one by one into a block of one flash page:
+
+  - the first record of a block is stored raw (time in the header), so
+    that every block decodes on its own,
+  - the time is coded as the difference between its last two differences
+    (0 for a regular rate), each value as the difference from the previous
+    record,
+  - the signed differences are zigzag mapped (0, -1, 1, -2, ... -> 0, 1, 2,
+    3, ...) and Rice coded: the quotient by 2^k in unary, then the k low
+    bits. Large values are escaped and sent raw,
+  - k follows the magnitude of each channel: it is the smallest with
+    n * 2^k >= sum of the last n coded values (adaptive Golomb-Rice, as in
+    LOCO-I), the window being halved every TLMC_WINDOW values.
+
+When a record does not fit in the block anymore, it is rejected, the block
+is sealed (header written) and must be stored before the encoder starts a
+new one. The working memory is the encoder state (~40 bytes and 12 per value
+of TLMC_MAX_CH) and the block.
+
+Compression is lossless: the ratio is set by the noise of the measurements
+(the decimated Q16.16 values keep their fractional noise bits).
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define TLMC_DATA_BITS          ((TLMC_BLOCK_SIZE - TLMC_HDR_SIZE) * 8)
+#define TLMC_TIME               TLMC_MAX_CH                 // Index of the time in the Rice states
+#define TLMC_RICE_INIT          16      // Initial window sum (k = 4)
+#define TLMC_SUM_CLAMP          (1u << TLMC_KMAX)           // Largest value added to a window sum
+
+#define TLMC_ZIGZAG32(d)        (((INT32U) (d) << 1) ^ (INT32U) ((int32_t) (d) >> 31))
+#define TLMC_ZIGZAG64(d)        (((uint64_t) (d) << 1) ^ (uint64_t) ((int64_t) (d) >> 63))
+#define TLMC_UNZIGZAG32(u)      ((int32_t) (((u) >> 1) ^ (0u - ((u) & 1u))))
+#define TLMC_UNZIGZAG64(u)      ((int64_t) (((u) >> 1) ^ (0u - ((u) & 1u))))
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static void     TLMC_RiceInit(TLMC_RICE *rice);
+static INT8U    TLMC_RiceK(const TLMC_RICE *r);
+static void     TLMC_RiceUpdate(TLMC_RICE *r, uint64_t u);
+static void     TLMC_Put(TLMC *enc, INT32U value, INT8U n);
+static void     TLMC_Code(TLMC *enc, TLMC_RICE *r, uint64_t u, INT8U width);
+static INT32U   TLMC_Get(TLMC_DEC *dec, INT8U n);
+static uint64_t TLMC_Decode(TLMC_DEC *dec, TLMC_RICE *r, INT8U width);
+static void     TLMC_Wr(INT8U *p, uint64_t v, INT8U n);
+static uint64_t TLMC_Rd(const INT8U *p, INT8U n);
+static int32_t  TLMC_TestValue(INT32U i, INT8U ch);
+
+
+
+
+/********************************************************************************************************
+*                                         TLMC_Init()
+*
+* @brief      Initialises an encoder and starts its first block
+*
+* @param[in]  enc         encoder
+* @param[in]  nbCh        values per record (<= TLMC_MAX_CH)
+* @param[in]  buf         block to fill (TLMC_BLOCK_SIZE bytes)
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void TLMC_Init(TLMC *enc, INT8U nbCh, INT8U *buf){
+
+  memset(enc, 0, sizeof(TLMC));
+  enc->nbCh = (nbCh > TLMC_MAX_CH) ? TLMC_MAX_CH : nbCh;
+
+  TLMC_Start(enc, buf);
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_Start()
+*
+* @brief      Starts a new block, after the previous one was sealed and stored
+*
+* @param[in]  enc         encoder
+* @param[in]  buf         block to fill (TLMC_BLOCK_SIZE bytes), may be the previous one
+* @exception  none
+* @return     none
+*
+*
+********************************************************************************************************/
+
+void TLMC_Start(TLMC *enc, INT8U *buf){
+
+  memset(buf, 0, TLMC_BLOCK_SIZE);
+
+  enc->buf       = buf;
+  enc->count     = 0;
+  enc->bits      = 0;
+  enc->full      = false;
+  enc->lastDelta = 0;
+  TLMC_RiceInit(enc->rice);
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_Add()
+*
+* @brief      Codes a record into the current block
+*
+* @param[in]  enc         encoder
+* @param[in]  time        time stamp (us)
+* @param[in]  val         nbCh values
+* @exception  none
+* @return     true when added. False when the block is full: it is sealed, the record is not added. Store
+*             the block, call TLMC_Start() and add the record again.
+*/
+/* Notes      :(1) The differences of the values are computed modulo 2^32: they are exact whatever the
+*                   values, and the decoder adds them back modulo 2^32.
+*
+*               (2) The state is saved before the record and restored when it does not fit, so that the
+*                   block ends on the last complete record.
+*
+********************************************************************************************************/
+
+BOOLEAN TLMC_Add(TLMC *enc, uint64_t time, const int32_t *val){
+
+  INT32U    start = UTI_CycCntGet();
+  TLMC_RICE rice[TLMC_MAX_CH + 1];
+  INT16U    bits = enc->bits;
+  int64_t   delta = 0;
+  INT16U    i;
+  INT8U     ch;
+
+  if(enc->full)                         // Sealed, not restarted
+    return false;
+
+  memcpy(rice, enc->rice, sizeof(rice));                      // Note(2)
+
+  if(enc->count == 0){
+    for(ch = 0; ch < enc->nbCh; ch++)
+      TLMC_Put(enc, (INT32U) val[ch], 32);
+  }
+  else {
+    delta = (int64_t) (time - enc->lastTime);
+    TLMC_Code(enc, &enc->rice[TLMC_TIME], TLMC_ZIGZAG64(delta - enc->lastDelta), 64);
+
+    for(ch = 0; ch < enc->nbCh; ch++)                          // Note(1)
+      TLMC_Code(enc, &enc->rice[ch], TLMC_ZIGZAG32((INT32U) val[ch] - (INT32U) enc->prev[ch]), 32);
+  }
+
+  if(enc->full){
+    // Note(2)
+    for(i = bits; i < TLMC_DATA_BITS && i < enc->bits; i++)
+      enc->buf[TLMC_HDR_SIZE + (i >> 3)] &= ~(0x80u >> (i & 7));
+    enc->bits = bits;
+    memcpy(enc->rice, rice, sizeof(rice));
+    TLMC_Seal(enc);
+    enc->cycles += UTI_CycCntGet() - start;
+    return false;
+  }
+
+  if(enc->count == 0)
+    enc->firstTime = time;
+  else
+    enc->lastDelta = delta;
+  enc->lastTime = time;
+  memcpy(enc->prev, val, enc->nbCh * sizeof(int32_t));
+  enc->count++;
+
+  enc->records++;
+  enc->bytesIn += sizeof(uint64_t) + enc->nbCh * sizeof(int32_t);
+  enc->cycles  += UTI_CycCntGet() - start;
+
+  return true;
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_Seal()
+*
+* @brief      Writes the header of the current block. The encoder must be restarted (TLMC_Start())
+*             before adding records.
+*
+* @param[in]  enc         encoder
+* @exception  none
+* @return     bytes used in the block (header included), 0 for an empty block
+*
+*
+********************************************************************************************************/
+
+INT16U TLMC_Seal(TLMC *enc){
+
+  INT16U size;
+
+  if(enc->count == 0)
+    return 0;
+
+  enc->buf[TLMC_HDR_MAGIC] = TLMC_MAGIC;
+  enc->buf[TLMC_HDR_NB_CH] = enc->nbCh;
+  TLMC_Wr(&enc->buf[TLMC_HDR_COUNT], enc->count,     2);
+  TLMC_Wr(&enc->buf[TLMC_HDR_FIRST], enc->firstTime, 8);
+  TLMC_Wr(&enc->buf[TLMC_HDR_LAST],  enc->lastTime,  8);
+  TLMC_Wr(&enc->buf[TLMC_HDR_BITS],  enc->bits,      2);
+
+  size = TLMC_HDR_SIZE + (enc->bits + 7) / 8;
+  enc->blocks++;
+  enc->bytesOut += size;
+  enc->full = true;                     // No record until restarted
+
+  return size;
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_DecodeInit()
+*
+* @brief      Prepares the decoding of a block
+*
+* @param[out] dec         decoder
+* @param[in]  block       sealed block
+* @exception  none
+* @return     false when the block is not a valid sealed block
+*
+*
+********************************************************************************************************/
+
+BOOLEAN TLMC_DecodeInit(TLMC_DEC *dec, const INT8U *block){
+
+  memset(dec, 0, sizeof(TLMC_DEC));
+
+  if(block[TLMC_HDR_MAGIC] != TLMC_MAGIC || block[TLMC_HDR_NB_CH] > TLMC_MAX_CH)
+    return false;
+
+  dec->buf      = block;
+  dec->nbCh     = block[TLMC_HDR_NB_CH];
+  dec->count    = (INT16U) TLMC_Rd(&block[TLMC_HDR_COUNT], 2);
+  dec->bits     = (INT16U) TLMC_Rd(&block[TLMC_HDR_BITS],  2);
+  dec->lastTime = TLMC_Rd(&block[TLMC_HDR_FIRST], 8);
+  TLMC_RiceInit(dec->rice);
+
+  return (dec->bits <= TLMC_DATA_BITS);
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_DecodeNext()
+*
+* @brief      Decodes the next record of a block
+*
+* @param[in]  dec         decoder (TLMC_DecodeInit())
+* @param[out] time        time stamp (us)
+* @param[out] val         nbCh values
+* @exception  none
+* @return     false after the last record, or on a corrupted block
+*
+*
+********************************************************************************************************/
+
+BOOLEAN TLMC_DecodeNext(TLMC_DEC *dec, uint64_t *time, int32_t *val){
+
+  uint64_t u;
+  int64_t  delta;
+  INT8U    ch;
+
+  if(dec->index >= dec->count)
+    return false;
+
+  if(dec->index == 0){
+    for(ch = 0; ch < dec->nbCh; ch++)
+      dec->prev[ch] = (int32_t) TLMC_Get(dec, 32);
+  }
+  else {
+    u     = TLMC_Decode(dec, &dec->rice[TLMC_TIME], 64);
+    delta = dec->lastDelta + TLMC_UNZIGZAG64(u);
+    dec->lastTime  += delta;
+    dec->lastDelta  = delta;
+
+    for(ch = 0; ch < dec->nbCh; ch++){
+      u = TLMC_Decode(dec, &dec->rice[ch], 32);
+      dec->prev[ch] = (int32_t) ((INT32U) dec->prev[ch] + (INT32U) TLMC_UNZIGZAG32((INT32U) u));
+    }
+  }
+
+  if(dec->pos > dec->bits)
+    return false;
+
+  *time = dec->lastTime;
+  memcpy(val, dec->prev, dec->nbCh * sizeof(int32_t));
+  dec->index++;
+
+  return true;
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_BlockTimes()
+*
+* @brief      Reads the time span of a sealed block from its header
+*
+* @param[in]  block       block
+* @param[out] first       time of the first record
+* @param[out] last        time of the last record
+* @exception  none
+* @return     false when the block is not a valid sealed block
+*
+*
+********************************************************************************************************/
+
+BOOLEAN TLMC_BlockTimes(const INT8U *block, uint64_t *first, uint64_t *last){
+
+  if(block[TLMC_HDR_MAGIC] != TLMC_MAGIC)
+    return false;
+
+  *first = TLMC_Rd(&block[TLMC_HDR_FIRST], 8);
+  *last  = TLMC_Rd(&block[TLMC_HDR_LAST],  8);
+
+  return true;
+}
+
+
+
+/********************************************************************************************************
+*                                         TLMC_SelfTest()
+*
+* @brief      Compresses a synthetic stream of sensor records, decodes every block and compares
+*
+* @param[out] res         TLMC_TEST structure to fill
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The records follow the layout of MSGQ_SEN_DATA at 10 Hz: slow rotation rate with the
+*                   noise of the decimated gyro, temperature, rotating field with magnetometer noise and
+*                   attitude quaternion. Each value is a function of the record index, so that a block is
+*                   checked by generating its records again.
+*
+*               (2) Passes if every record is decoded identically and the stream is compressed.
+*
+********************************************************************************************************/
+
+void TLMC_SelfTest(TLMC_TEST *res){
+
+  INT8U    block[TLMC_BLOCK_SIZE];
+  TLMC     enc;
+  TLMC_DEC dec;
+  int32_t  val[TLMC_TEST_NB_CH];
+  int32_t  out[TLMC_TEST_NB_CH];
+  uint64_t time;
+  INT32U   first = 0;                   // Index of the first record of the block
+  INT32U   decCycles = 0;
+  INT32U   start;
+  INT32U   i, j;
+  BOOLEAN  last;
+  INT8U    ch;
+
+  memset(res, 0, sizeof(TLMC_TEST));
+  TLMC_Init(&enc, TLMC_TEST_NB_CH, block);
+
+  for(i = 0; i <= TLMC_TEST_RECORDS; i++){
+
+    // Record i (Note(1)), and the end of the stream
+    last = (i == TLMC_TEST_RECORDS);
+    if(!last){
+      for(ch = 0; ch < TLMC_TEST_NB_CH; ch++)
+        val[ch] = TLMC_TestValue(i, ch);
+      if(TLMC_Add(&enc, (uint64_t) i * 100000u + 1000u + TLMC_TestValue(i, TLMC_TEST_NB_CH), val))
+        continue;
+    }
+    else
+      TLMC_Seal(&enc);
+
+    // Block sealed: decode it and compare with the records it holds
+    start = UTI_CycCntGet();
+    TLMC_DecodeInit(&dec, block);
+    for(j = first; TLMC_DecodeNext(&dec, &time, out); j++){
+      for(ch = 0; ch < TLMC_TEST_NB_CH; ch++)
+        val[ch] = TLMC_TestValue(j, ch);
+      if(memcmp(val, out, sizeof(out)) != 0 ||
+         time != (uint64_t) j * 100000u + 1000u + TLMC_TestValue(j, TLMC_TEST_NB_CH))
+        res->mismatches++;
+    }
+    decCycles += UTI_CycCntGet() - start;
+
+    if(j != i)
+      res->mismatches += i - j;         // Records missing from the block
+    first = i;
+
+    if(last)
+      break;
+
+    // Next block, starting with the rejected record
+    TLMC_Start(&enc, block);
+    i--;
+  }
+
+  res->records  = enc.records;
+  res->blocks   = enc.blocks;
+  res->bytesIn  = enc.bytesIn;
+  res->bytesOut = enc.bytesOut;
+  res->ratio100 = (enc.bytesOut > 0) ? enc.bytesIn * 100u / enc.bytesOut : 0;
+  res->cyclesPerByte       = (enc.bytesIn > 0) ? enc.cycles / enc.bytesIn : 0;
+  res->decodeCyclesPerByte = (enc.bytesIn > 0) ? decCycles / enc.bytesIn : 0;
+
+  // Note(2)
+  res->pass = (res->mismatches == 0 && res->records == TLMC_TEST_RECORDS && res->ratio100 > 100);
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+static void TLMC_RiceInit(TLMC_RICE *rice){
+
+  INT8U i;
+
+  for(i = 0; i <= TLMC_MAX_CH; i++){
+    rice[i].sum = TLMC_RICE_INIT;
+    rice[i].n   = 1;
+  }
+}
+
+/******************************************************************************/
+
+// Rice parameter: smallest k with n * 2^k >= sum
+static INT8U TLMC_RiceK(const TLMC_RICE *r){
+
+  INT8U k = 0;
+
+  while(k < TLMC_KMAX && ((INT32U) r->n << k) < r->sum)
+    k++;
+
+  return k;
+}
+
+/******************************************************************************/
+
+static void TLMC_RiceUpdate(TLMC_RICE *r, uint64_t u){
+
+  r->sum += (u > TLMC_SUM_CLAMP) ? TLMC_SUM_CLAMP : (INT32U) u;
+
+  if(++r->n >= TLMC_WINDOW){
+    r->sum >>= 1;
+    r->n   >>= 1;
+  }
+}
+
+/******************************************************************************/
+
+// Appends the n (<= 32) low bits of value, MSB first. Sets 'full' instead when they do not fit.
+static void TLMC_Put(TLMC *enc, INT32U value, INT8U n){
+
+  INT8U *p;
+  INT8U  free;
+  INT8U  take;
+
+  if(enc->full || enc->bits + n > TLMC_DATA_BITS){
+    enc->full = true;
+    return;
+  }
+
+  while(n > 0){
+    p    = &enc->buf[TLMC_HDR_SIZE + (enc->bits >> 3)];
+    free = 8 - (enc->bits & 7);
+    take = (n < free) ? n : free;
+    *p  |= (INT8U) (((value >> (n - take)) & ((1u << take) - 1)) << (free - take));
+    enc->bits += take;
+    n         -= take;
+  }
+}
+
+/******************************************************************************/
+
+// Rice code of u: quotient in unary (ones ended by a zero) and k bits, or escape and 'width' raw bits
+static void TLMC_Code(TLMC *enc, TLMC_RICE *r, uint64_t u, INT8U width){
+
+  INT8U    k = TLMC_RiceK(r);
+  uint64_t q = u >> k;
+
+  if(q < TLMC_QMAX){
+    TLMC_Put(enc, (1u << (q + 1)) - 2, (INT8U) q + 1);
+    if(k > 0)
+      TLMC_Put(enc, (INT32U) u & ((1u << k) - 1), k);
+  }
+  else {
+    TLMC_Put(enc, (1u << TLMC_QMAX) - 1, TLMC_QMAX);
+    if(width > 32)
+      TLMC_Put(enc, (INT32U) (u >> 32), width - 32);
+    TLMC_Put(enc, (INT32U) u, 32);
+  }
+
+  TLMC_RiceUpdate(r, u);
+}
+
+/******************************************************************************/
+
+// Reads n (<= 32) bits, MSB first (zeros past the end of the block)
+static INT32U TLMC_Get(TLMC_DEC *dec, INT8U n){
+
+  INT32U v = 0;
+  INT8U  avail;
+  INT8U  take;
+  INT8U  byte;
+
+  while(n > 0){
+    if(dec->pos >= TLMC_DATA_BITS){
+      dec->pos += n;
+      return v << n;
+    }
+    byte  = dec->buf[TLMC_HDR_SIZE + (dec->pos >> 3)];
+    avail = 8 - (dec->pos & 7);
+    take  = (n < avail) ? n : avail;
+    v     = (v << take) | ((byte >> (avail - take)) & ((1u << take) - 1));
+    dec->pos += take;
+    n        -= take;
+  }
+
+  return v;
+}
+
+/******************************************************************************/
+
+static uint64_t TLMC_Decode(TLMC_DEC *dec, TLMC_RICE *r, INT8U width){
+
+  INT8U    k = TLMC_RiceK(r);
+  INT8U    q = 0;
+  uint64_t u;
+
+  while(q < TLMC_QMAX && TLMC_Get(dec, 1))
+    q++;
+
+  if(q < TLMC_QMAX)
+    u = ((uint64_t) q << k) | TLMC_Get(dec, k);
+  else {
+    u = 0;
+    if(width > 32)
+      u = (uint64_t) TLMC_Get(dec, width - 32) << 32;
+    u |= TLMC_Get(dec, 32);
+  }
+
+  TLMC_RiceUpdate(r, u);
+
+  return u;
+}
+
+/******************************************************************************/
+
+// Little endian header fields
+static void TLMC_Wr(INT8U *p, uint64_t v, INT8U n){
+
+  INT8U i;
+
+  for(i = 0; i < n; i++)
+    p[i] = (INT8U) (v >> (8 * i));
+}
+
+static uint64_t TLMC_Rd(const INT8U *p, INT8U n){
+
+  uint64_t v = 0;
+  INT8U    i;
+
+  for(i = 0; i < n; i++)
+    v |= (uint64_t) p[i] << (8 * i);
+
+  return v;
+}
+
+/******************************************************************************/
+
+// Value 'ch' of the synthetic record i (ch = TLMC_TEST_NB_CH: time stamp jitter, us)
+static int32_t TLMC_TestValue(INT32U i, INT8U ch){
+
+  INT32U h = (i * TLMC_TEST_NB_CH + ch) * 2654435761u;
+  double t = i * 0.1;
+  double noise;
+  double a;
+
+  h ^= h >> 15;
+  h *= 1664525u;
+  h ^= h >> 13;
+  noise = (double) (int32_t) h / 2147483648.0;                 // [-1, 1)
+
+  a = 0.05 * t;                                                 // Rotation angle (rad)
+
+  switch(ch){
+    case 0:  return UTI_Q16FromFloat(2.0 * sin(0.02 * t) + 0.1 * noise);       // Gyro (deg/s)
+    case 1:  return UTI_Q16FromFloat(1.0 * cos(0.03 * t) + 0.1 * noise);
+    case 2:  return UTI_Q16FromFloat(2.9 + 0.1 * noise);
+    case 3:  return UTI_Q16FromFloat(25.0 + 0.001 * t + 0.05 * noise);         // Temperature (deg C)
+    case 4:  return UTI_Q16FromFloat(400.0 * cos(a) + 1.0 * noise);            // Field (mG)
+    case 5:  return UTI_Q16FromFloat(400.0 * sin(a) + 1.0 * noise);
+    case 6:  return UTI_Q16FromFloat(150.0 + 1.0 * noise);
+    case 7:  return UTI_Q16FromFloat(cos(a / 2));                               // Quaternion
+    case 8:  return 0;
+    case 9:  return 0;
+    case 10: return UTI_Q16FromFloat(sin(a / 2));
+    default: return (int32_t) (noise * 31.0);                                   // Time jitter
+  }
+}
@@ -0,0 +1,143 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: tlmcomp.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Lossless streaming compression of telemetry records (time stamp and 32-bit
+values) into self-contained blocks of one flash page
+
+******************************************************************************/
+
+
+
+#ifndef __TLMCOMP_H
+#define __TLMCOMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define TLMC_BLOCK_SIZE         APP_CFG_LOG_PAGE_SIZE       // Block = flash page (bytes)
+#define TLMC_MAX_CH             37      // Values per record (summaries of 12 values, see retain.h)
+
+// Block header (bytes, little endian)
+#define TLMC_MAGIC              0xC7
+#define TLMC_HDR_MAGIC          0       // 1: TLMC_MAGIC
+#define TLMC_HDR_NB_CH          1       // 1: values per record
+#define TLMC_HDR_COUNT          2       // 2: records
+#define TLMC_HDR_FIRST          4       // 8: time of the first record
+#define TLMC_HDR_LAST           12      // 8: time of the last record
+#define TLMC_HDR_BITS           20      // 2: bits of coded data
+#define TLMC_HDR_SIZE           24
+
+// Rice coding
+#define TLMC_QMAX               24      // Quotient escaped above (value sent raw)
+#define TLMC_KMAX               26      // Largest Rice parameter
+#define TLMC_WINDOW             16      // Values of the k adaptation window
+
+// Self-test (see TLMC_SelfTest())
+#define TLMC_TEST_RECORDS       600     // 60 s of sensor records at 10 Hz
+#define TLMC_TEST_NB_CH         11      // Layout of MSGQ_SEN_DATA
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+// Adaptation of the Rice parameter of a channel (values or time)
+typedef struct TlmcRice TLMC_RICE;
+
+struct TlmcRice {
+  INT32U sum;                           // Sum of the last coded values (window)
+  INT8U  n;                             // Values in the window
+};
+
+// Encoder: fills one block at a time
+typedef struct Tlmc TLMC;
+
+struct Tlmc {
+  INT8U    *buf;                        // Block being filled (TLMC_BLOCK_SIZE bytes)
+  INT8U     nbCh;
+  INT16U    count;                      // Records in the block
+  INT16U    bits;                       // Coded data bits in the block
+  BOOLEAN   full;                       // Write past the end of the block (record rejected)
+  uint64_t  firstTime;
+  uint64_t  lastTime;
+  int64_t   lastDelta;                  // Time difference of the last two records
+  int32_t   prev[TLMC_MAX_CH];          // Values of the last record
+  TLMC_RICE rice[TLMC_MAX_CH + 1];      // Last entry: time
+  // Statistics
+  INT32U    records;
+  INT32U    blocks;                     // Blocks sealed
+  INT32U    bytesIn;                    // Raw size of the records (time and values)
+  INT32U    bytesOut;                   // Size of the sealed blocks (used part)
+  INT32U    cycles;                     // Cycles spent coding
+};
+
+// Decoder: reads the records of one block
+typedef struct TlmcDec TLMC_DEC;
+
+struct TlmcDec {
+  const INT8U *buf;
+  INT8U     nbCh;
+  INT16U    count;                      // Records in the block
+  INT16U    index;                      // Next record
+  INT16U    bits;
+  INT16U    pos;                        // Next bit
+  uint64_t  lastTime;
+  int64_t   lastDelta;
+  int32_t   prev[TLMC_MAX_CH];
+  TLMC_RICE rice[TLMC_MAX_CH + 1];
+};
+
+typedef struct TlmcTest TLMC_TEST;
+
+struct TlmcTest {
+  INT32U  records;
+  INT32U  blocks;
+  INT32U  bytesIn;
+  INT32U  bytesOut;
+  INT32U  ratio100;                     // bytesIn / bytesOut * 100
+  INT32U  cyclesPerByte;                // Coding cost per raw byte
+  INT32U  decodeCyclesPerByte;
+  INT32U  mismatches;                   // Records not decoded identically
+  BOOLEAN pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    TLMC_Init(TLMC *enc, INT8U nbCh, INT8U *buf);
+BOOLEAN TLMC_Add(TLMC *enc, uint64_t time, const int32_t *val);
+INT16U  TLMC_Seal(TLMC *enc);
+void    TLMC_Start(TLMC *enc, INT8U *buf);
+
+BOOLEAN TLMC_DecodeInit(TLMC_DEC *dec, const INT8U *block);
+BOOLEAN TLMC_DecodeNext(TLMC_DEC *dec, uint64_t *time, int32_t *val);
+BOOLEAN TLMC_BlockTimes(const INT8U *block, uint64_t *first, uint64_t *last);
+
+void    TLMC_SelfTest(TLMC_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __TLMCOMP_H */
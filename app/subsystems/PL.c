@@ -6,11 +6,13 @@ Filename: PL.c
 Author:   Louis Masson
 
 Created:  02/07/2013
-Modified: 02/07/2013
+Modified: 19/10/2026
 
 Description:
 This library contains all the commands that are needed to communicate with
-the PL subsystem.
+the PL subsystem. The requests go through the PL request queue (plqueue.c):
+the bus is released while the PL prepares the report, and the reports not
+ready (PL_MT_REP_NRDY) are polled again.
 
 ******************************************************************************/
 
@@ -57,7 +59,6 @@ the PL subsystem.
 void PL_HK_ParseError(uint8_t* report, uint16_t repLength, uint8_t* errors, uint16_t* errorFlag);                             
 int16_t PL_HK_ParseTemp(uint8_t* report, uint16_t repLength, uint16_t* errorFlag);
 int8_t PL_FC_ParseExec(uint8_t* report, uint16_t repLength, uint16_t* errorFlag);
-int8_t PL_FC_ParseScenarioStatus(uint8_t* report, uint16_t repLength, uint16_t* errorFlag);
 uint16_t PL_FC_ParseScienceData(uint8_t* report, uint16_t repLength, uint8_t* data, uint16_t* errorFlag);
 void PL_FC_ParseMCLChanges(uint8_t* report, uint16_t repLength, uint8_t* data, uint16_t* errorFlag);
 uint8_t PL_FC_ParseScenarioCreate(uint8_t* report, uint16_t repLength, uint16_t* errorFlag);
@@ -102,8 +103,9 @@ void PL_HK_GetError(uint8_t* errors, uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -147,8 +149,9 @@ int16_t PL_HK_GetTemperature(uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return 0;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -193,8 +196,9 @@ int8_t PL_FC_MeasurementExec(uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return 0;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -240,8 +244,9 @@ int8_t PL_FC_GetScenarioStatus(uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return 0;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -286,8 +291,9 @@ uint16_t PL_FC_GetScienceData(uint8_t* data, uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return 0;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -331,8 +337,9 @@ void PL_FC_GetMCLChanges(uint8_t* buffer, uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -375,8 +382,9 @@ uint8_t PL_FC_ScenarioCreate(uint8_t op, uint8_t id, uint8_t index, uint8_t* des
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return 0;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -414,8 +422,9 @@ uint8_t PL_FC_ScenarioDelete(uint8_t id, uint16_t* errorFlag){
   // Display the request buffer on the UART console (debug purposes)
   REQ_DEBUG_MACRO;
   
-  // Start communication
-  SATI2C_Communicate(request, reqLength, report, repLength);
+  // Send the request and wait for the report, the bus released in between (see plqueue.c)
+  if(!PLQ_Call(&plQueue, request, reqLength, report, repLength, errorFlag))
+    return 0;
   
   // Display the report buffer on the UART console (debug purposes)
   REP_DEBUG_MACRO;
@@ -435,6 +444,37 @@ void    PL_FC_ScenarioCommand(uint8_t op, uint8_t id, uint8_t index, uint8_t* de
 
 
 
+/********************************************************************************************************
+*                                       PL_Request()
+*
+* @brief      Builds a request without data, for the split-phase calls (see PLQ_Submit())
+*
+* @param[out] request      buffer of HDR_SZ + PL_NODATA_REQ_SZ bytes
+* @param[in]  type         message type (PL_MT_HK_REQ or PL_MT_FC_REQ)
+* @param[in]  id           request ID (PL_HK_xxx or PL_FC_xxx)
+* @exception  none
+* @return     length of the request
+*
+********************************************************************************************************/
+
+uint16_t PL_Request(uint8_t* request, uint8_t type, uint8_t id){
+  
+  int16_t crc;                                   // CRC variable
+  
+  request[0] = type;                             // Message type
+  request[1] = PL_NODATA_REQ_SZ >> 8;            // Message size (HIGH)
+  request[2] = PL_NODATA_REQ_SZ & 0xFF;          // Message size (LOW)
+  request[3] = id;                               // Request ID
+  crc = UTI_crc16(request, HDR_SZ + PL_NODATA_REQ_SZ - CRC_SZ);   // Calculate CRC-16
+  request[4] = crc >> 8;                         // CRC (HIGH)
+  request[5] = crc & 0xFF;                       // CRC (LOW)
+  
+  return HDR_SZ + PL_NODATA_REQ_SZ;
+}
+
+
+
+
 
 
 
@@ -466,9 +506,6 @@ void PL_HK_ParseError(uint8_t* report, uint16_t repLength, uint8_t* errors, uint
         errors[i] = report[4+i];
     }
     
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
-    
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
   }
@@ -490,9 +527,6 @@ int16_t PL_HK_ParseTemp(uint8_t* report, uint16_t repLength, uint16_t* errorFlag
     // Check if the CRC is correct
     if(UTI_crc16(report, repLength) == CRC_OK)
       return (int16_t) ((report[4] << 8) + report[5]);
-        
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
@@ -517,9 +551,6 @@ int8_t PL_FC_ParseExec(uint8_t* report, uint16_t repLength, uint16_t* errorFlag)
     // Check if the CRC is correct
     if(UTI_crc16(report, repLength) == CRC_OK)
       return report[4];
-        
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
@@ -544,9 +575,6 @@ int8_t PL_FC_ParseScenarioStatus(uint8_t* report, uint16_t repLength, uint16_t*
     // Check if the CRC is correct
     if(UTI_crc16(report, repLength) == CRC_OK)
       return report[4];
-        
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
@@ -581,9 +609,6 @@ uint16_t PL_FC_ParseScienceData(uint8_t* report, uint16_t repLength, uint8_t* da
         return size - CRC_SZ;
       }
     }
-      
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
@@ -614,9 +639,6 @@ void PL_FC_ParseMCLChanges(uint8_t* report, uint16_t repLength, uint8_t* data, u
       for(i = 0; i < size-CRC_SZ; i++)
         data[i] = report[4+i];
     }
-      
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
@@ -638,9 +660,6 @@ uint8_t PL_FC_ParseScenarioCreate(uint8_t* report, uint16_t repLength, uint16_t*
     // Check if the CRC is correct
     if(UTI_crc16(report, repLength) == CRC_OK)
       return report[4];
-        
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
@@ -664,9 +683,6 @@ uint8_t PL_FC_ParseScenarioDelete(uint8_t* report, uint16_t repLength, uint16_t*
     // Check if the CRC is correct
     if(UTI_crc16(report, repLength) == CRC_OK)
       return report[4];
-        
-    else if(report[0] == PL_MT_REP_NRDY)
-      *errorFlag = REP_NRDY;
     
     else 
       *errorFlag = CRC_ERR;   // The CRC is invalid
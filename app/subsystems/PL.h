@@ -88,6 +88,7 @@ extern "C" {
 //#define PL_FC_FW_LOAD           0x07    // Load firmware request
   
 // Message sizes
+#define PL_NODATA_REQ_SZ                0x0003  // Request without data (ID and CRC, see PL_Request())
 #define PL_HK_ERROR_REQ_SZ              0x0003
 #define PL_HK_ERROR_REP_SZ             (0x03+MAX_REPORT_LENGTH)
 #define PL_HK_TEMP_REQ_SZ               0x0003
@@ -111,6 +112,8 @@ extern "C" {
 #define CRC_ERR   0x01
 #define COM_ERR   0x02
 #define REP_NRDY  0x03
+#define I2C_ERR   0x04
+#define BUSY_ERR  0x05    // Request queue full (see plqueue.h)
 
 
 
@@ -138,6 +141,10 @@ int8_t PL_FC_GetScenarioStatus(uint16_t* errorFlag);
 void PL_FC_GetMCLChanges(uint8_t* buffer, uint16_t* errorFlag);
 uint16_t PL_FC_GetScienceData(uint8_t* data, uint16_t* errorFlag);
 
+// Split-phase calls (see plqueue.h): request without data, and parse of its report
+uint16_t PL_Request(uint8_t* request, uint8_t type, uint8_t id);
+int8_t PL_FC_ParseScenarioStatus(uint8_t* report, uint16_t repLength, uint16_t* errorFlag);
+
 // SW/FW update function calls
 //void    PL_FC_FWUpdate(uint8_t* buffer);
 //void    PL_FC_SWUpdate(uint8_t* buffer);
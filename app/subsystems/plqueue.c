@@ -0,0 +1,686 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: plqueue.c
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Split-phase requests to the PL. A blocking call (write the request, read the
+report) holds the subsystem bus for as long as the PL takes to prepare the
+report, and fails when the PL answers PL_MT_REP_NRDY. Here a request only
+holds the bus for its own transfers:
+
+  - PLQ_Submit() copies the request into a free slot and returns its ID.
+  - PLQ_Step() does at most one transfer: it sends the oldest request not
+    sent yet, or reads the report of the oldest request sent once its poll
+    is due. A report not ready doubles the poll interval, from
+    PLQ_BACKOFF_MIN_MS to PLQ_BACKOFF_MAX_MS, until PLQ_TIMEOUT_MS.
+  - PLQ_Collect() returns the status of a request once its report is in.
+
+The PL prepares the reports in the order of the requests. A report is matched
+to the oldest request with the same message type and ID: the older ones were
+left without report by the PL. Up to PLQ_SLOTS requests are outstanding, the
+next ones are sent while the first are prepared.
+
+PLQ_Call() is the blocking form for the tasks (PL.c): it submits a request
+and steps the queue, sleeping between the polls. The transfers of the SATI2C
+backend take sysI2CMutex one at a time, so that the other users of the bus
+(HK, commands) go between the polls.
+
+A simulated PL with configurable response delays (PLQ_SimInit()) gives the
+bus time of the split-phase requests compared to blocking ones, see
+PLQ_SelfTest().
+
+******************************************************************************/
+
+
+
+#include <includes.h>
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+// Request n of the self-test: temperature, scenario status and measurement execution in turn
+#define PLQ_TEST_REQ_TYPE(n)    (((n) % 3 == 0) ? PL_MT_HK_REQ : PL_MT_FC_REQ)
+#define PLQ_TEST_REQ_ID(n)      (((n) % 3 == 0) ? PL_HK_TEMP : \
+                                 ((n) % 3 == 1) ? PL_FC_SCENARIO_STATUS : PL_FC_MEAS_EXEC)
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+static BOOLEAN   PLQ_I2CSend(PLQ_LINK *link, const INT8U *req, INT16U len, INT32U now);
+static BOOLEAN   PLQ_I2CRecv(PLQ_LINK *link, INT8U *rep, INT16U len, INT32U now);
+static BOOLEAN   PLQ_SimSend(PLQ_LINK *link, const INT8U *req, INT16U len, INT32U now);
+static BOOLEAN   PLQ_SimRecv(PLQ_LINK *link, INT8U *rep, INT16U len, INT32U now);
+static PLQ_SLOT* PLQ_Oldest(PLQ *q, INT8U state);
+static void      PLQ_Poll(PLQ *q, PLQ_SLOT *s, INT32U now);
+static void      PLQ_Done(PLQ *q, PLQ_SLOT *s, INT16U flag, INT32U now);
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_I2CInit()
+* @brief      Initialises the link to the PL on the subsystem bus (SATI2C)
+*
+* @param[out] link        link
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The bus is taken for each transfer (sysI2CMutex): the caller must not hold it.
+*
+*********************************************************************************************************/
+
+void PLQ_I2CInit(PLQ_LINK *link){
+
+  memset(link, 0, sizeof(PLQ_LINK));
+  link->send = PLQ_I2CSend;
+  link->recv = PLQ_I2CRecv;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_SimInit()
+* @brief      Initialises a link to a simulated PL, for the self-test
+*
+* @param[out] link        link
+* @param[out] sim         PL
+* @param[in]  delayMs     time for a report to be ready after its request (ms)
+* @param[in]  jitterMs    random extra delay, at most
+* @param[in]  bitUs       bus time of a bit (us)
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void PLQ_SimInit(PLQ_LINK *link, PLQ_SIM *sim, INT32U delayMs, INT32U jitterMs, INT32U bitUs){
+
+  memset(sim, 0, sizeof(PLQ_SIM));
+  sim->delayMs  = delayMs;
+  sim->jitterMs = jitterMs;
+  sim->bitUs    = bitUs;
+  sim->seed     = 12345;
+
+  memset(link, 0, sizeof(PLQ_LINK));
+  link->send = PLQ_SimSend;
+  link->recv = PLQ_SimRecv;
+  link->sim  = sim;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_Init()
+* @brief      Initialises a request queue, no request
+*
+* @param[out] q           queue
+* @param[in]  link        link to the PL (see PLQ_I2CInit())
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void PLQ_Init(PLQ *q, PLQ_LINK *link){
+
+  memset(q, 0, sizeof(PLQ));
+  q->link = link;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_Submit()
+* @brief      Queues a request, sent by the next PLQ_Step()
+*
+* @param[in]  q           queue
+* @param[in]  req         request (header, data and CRC), copied
+* @param[in]  reqLen      bytes, at most PLQ_REQ_SIZE
+* @param[out] rep         report buffer, written until the request is collected
+* @param[in]  repLen      bytes of the report
+* @exception  none
+* @return     ID of the request (0: all the slots outstanding, or request too long)
+*/
+/*********************************************************************************************************/
+
+INT8U PLQ_Submit(PLQ *q, const INT8U *req, INT16U reqLen, INT8U *rep, INT16U repLen){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  PLQ_SLOT  *s = NULL;
+  INT8U      tag;
+  INT8U      i;
+
+  if(reqLen > PLQ_REQ_SIZE)
+    return 0;
+
+  OS_ENTER_CRITICAL();
+  for(i = 0; i < PLQ_SLOTS && s == NULL; i++)
+    if(q->slot[i].state == PLQ_FREE)
+      s = &q->slot[i];
+  if(s == NULL){
+    OS_EXIT_CRITICAL();
+    return 0;
+  }
+  if(++q->tag == 0)
+    q->tag = 1;
+  tag        = q->tag;
+  memcpy(s->req, req, reqLen);
+  s->reqLen  = reqLen;
+  s->rep     = rep;
+  s->repLen  = repLen;
+  s->flag    = 0;
+  s->tag     = tag;
+  s->order   = q->order++;
+  s->state   = PLQ_QUEUED;
+  q->stats.requests++;
+  OS_EXIT_CRITICAL();
+
+  return tag;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_Step()
+* @brief      Advances the requests by one transfer at most: sends the oldest request queued, or polls
+*             the report of the oldest request sent, once due
+*
+* @param[in]  q           queue
+* @param[in]  now         time (ms)
+* @exception  none
+* @return     ms before the next transfer (0: call again, PLQ_IDLE: no request outstanding)
+*/
+/* Notes      :(1) One task at a time steps the queue, the others wait for 1 ms.
+*
+*********************************************************************************************************/
+
+INT32U PLQ_Step(PLQ *q, INT32U now){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  PLQ_SLOT  *s;
+  INT32U     wait = 0;
+
+  OS_ENTER_CRITICAL();                    // Note(1)
+  if(q->busy){
+    OS_EXIT_CRITICAL();
+    return 1;
+  }
+  q->busy = TRUE;
+  OS_EXIT_CRITICAL();
+
+  s = PLQ_Oldest(q, PLQ_QUEUED);
+  if(s != NULL){
+    // Send the request, its report is polled from PLQ_BACKOFF_MIN_MS
+    if(!q->link->send(q->link, s->req, s->reqLen, now))
+      PLQ_Done(q, s, I2C_ERR, now);
+    else{
+      s->state   = PLQ_SENT;
+      s->sent    = now;
+      s->due     = now + PLQ_BACKOFF_MIN_MS;
+      s->backoff = PLQ_BACKOFF_MIN_MS;
+    }
+  }
+  else{
+    s = PLQ_Oldest(q, PLQ_SENT);
+    if(s == NULL)
+      wait = PLQ_IDLE;
+    else if((INT32S) (s->due - now) > 0)
+      wait = s->due - now;
+    else
+      PLQ_Poll(q, s, now);
+  }
+
+  q->busy = FALSE;
+  return wait;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_Collect()
+* @brief      Status of a request, freed once its report is in
+*
+* @param[in]  q           queue
+* @param[in]  tag         ID of the request (see PLQ_Submit())
+* @param[out] flag        0: report in the buffer of the request, or error (CRC_ERR... of PL.h)
+* @exception  none
+* @return     TRUE: request completed (or unknown: COM_ERR), FALSE: outstanding
+*/
+/*********************************************************************************************************/
+
+BOOLEAN PLQ_Collect(PLQ *q, INT8U tag, INT16U *flag){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+  INT8U      i;
+
+  OS_ENTER_CRITICAL();
+  for(i = 0; i < PLQ_SLOTS; i++){
+    if(q->slot[i].state != PLQ_FREE && q->slot[i].tag == tag){
+      if(q->slot[i].state != PLQ_DONE){
+        OS_EXIT_CRITICAL();
+        return FALSE;
+      }
+      *flag = q->slot[i].flag;
+      q->slot[i].state = PLQ_FREE;
+      OS_EXIT_CRITICAL();
+      return TRUE;
+    }
+  }
+  OS_EXIT_CRITICAL();
+
+  *flag = COM_ERR;
+  return TRUE;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_Call()
+* @brief      Sends a request and waits for its report, the bus released between the polls
+*
+* @param[in]  q           queue
+* @param[in]  req         request (header, data and CRC)
+* @param[in]  reqLen      bytes
+* @param[out] rep         report
+* @param[in]  repLen      bytes of the report
+* @param[out] flag        error (CRC_ERR... of PL.h), unchanged when the report is in
+* @exception  none
+* @return     TRUE: report in rep
+*/
+/* Notes      :(1) OS ticks of 1 ms (OS_TICKS_PER_SEC).
+*
+*********************************************************************************************************/
+
+BOOLEAN PLQ_Call(PLQ *q, const INT8U *req, INT16U reqLen, INT8U *rep, INT16U repLen, INT16U *flag){
+
+  INT8U  tag;
+  INT16U err;
+  INT32U wait;
+  INT32U start = OSTimeGet();             // Note(1)
+
+  // Wait for a free slot
+  while((tag = PLQ_Submit(q, req, reqLen, rep, repLen)) == 0){
+    if(reqLen > PLQ_REQ_SIZE || OSTimeGet() - start >= PLQ_TIMEOUT_MS){
+      *flag = BUSY_ERR;
+      return FALSE;
+    }
+    wait = PLQ_Step(q, OSTimeGet());
+    if(wait != 0)
+      OSTimeDly(1);
+  }
+
+  while(!PLQ_Collect(q, tag, &err)){
+    wait = PLQ_Step(q, OSTimeGet());
+    if(wait > PLQ_BACKOFF_MAX_MS)
+      wait = PLQ_BACKOFF_MAX_MS;
+    if(wait != 0)
+      OSTimeDly(wait * OS_TICKS_PER_SEC / 1000);
+  }
+
+  if(err != 0){
+    *flag = err;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_GetStats()
+* @brief      Copy of the counters of a queue
+*
+* @param[in]  q           queue
+* @param[out] stats       counters
+* @exception  none
+* @return     none
+*/
+/*********************************************************************************************************/
+
+void PLQ_GetStats(const PLQ *q, PLQ_STATS *stats){
+
+#if OS_CRITICAL_METHOD == 3u
+  OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+  OS_ENTER_CRITICAL();
+  *stats = q->stats;
+  OS_EXIT_CRITICAL();
+}
+
+
+
+/*********************************************************************************************************
+*                                         PLQ_SelfTest()
+* @brief      PLQ_TEST_REQUESTS requests (temperature, scenario status and measurement execution in
+*             turn), one every PLQ_TEST_PERIOD_MS, to a simulated PL with a longer response delay in
+*             each scenario. Checks that every request gets its own report, and compares the bus time
+*             with blocking calls.
+*
+* @param[out] res         results
+* @exception  none
+* @return     none
+*/
+/* Notes      :(1) The time is simulated: it jumps to the next transfer or request, the self-test
+*                   takes a few ms of CPU.
+*
+*             :(2) A blocking call holds the bus from its request until the report is ready, then
+*                   reads it once.
+*
+*********************************************************************************************************/
+
+void PLQ_SelfTest(PLQ_TEST *res){
+
+  static const INT32U delays[PLQ_TEST_NB] = { 0, 5, 50, 200 };
+  static PLQ      q;
+  static PLQ_LINK link;
+  static PLQ_SIM  sim;
+  static INT8U    tags[PLQ_TEST_REQUESTS];
+  static INT8U    reps[PLQ_TEST_REQUESTS][HDR_SZ + PL_HK_TEMP_REP_SZ];
+  static BOOLEAN  collected[PLQ_TEST_REQUESTS];
+  PLQ_TEST_SC    *sc;
+  INT8U           req[HDR_SZ + PL_NODATA_REQ_SZ];
+  INT8U           k;
+  INT32U          now;
+  INT32U          next;
+  INT32U          sent;
+  INT32U          wait;
+  INT32U          i;
+  INT16U          flag;
+  INT8U          *r;
+
+  memset(res, 0, sizeof(PLQ_TEST));
+  res->pass = TRUE;
+
+  for(k = 0; k < PLQ_TEST_NB; k++){
+    sc = &res->sc[k];
+    sc->delayMs = delays[k];
+    PLQ_SimInit(&link, &sim, delays[k], delays[k] / 2, PLQ_TEST_BIT_US);
+    PLQ_Init(&q, &link);
+    memset(collected, 0, sizeof(collected));
+    now  = 0;
+    next = 0;
+    sent = 0;
+
+    while(sc->completed < PLQ_TEST_REQUESTS && now < PLQ_TEST_LIMIT_MS){
+
+      // Requests due (delayed while all the slots are outstanding)
+      while(sent < PLQ_TEST_REQUESTS && (INT32S) (now - next) >= 0){
+        PL_Request(req, PLQ_TEST_REQ_TYPE(sent), PLQ_TEST_REQ_ID(sent));
+        tags[sent] = PLQ_Submit(&q, req, sizeof(req), reps[sent], sizeof(reps[sent]));
+        if(tags[sent] == 0)
+          break;
+        sent++;
+        next += PLQ_TEST_PERIOD_MS;
+      }
+
+      wait = PLQ_Step(&q, now);
+
+      // Reports: type and ID of the request, order of the request in the data
+      for(i = 0; i < sent; i++){
+        if(collected[i] || !PLQ_Collect(&q, tags[i], &flag))
+          continue;
+        collected[i] = TRUE;
+        sc->completed++;
+        r = reps[i];
+        if(flag != 0 || r[0] != PLQ_TEST_REQ_TYPE(i) + 1 || r[3] != PLQ_TEST_REQ_ID(i) ||
+           r[4] != (INT8U) i || UTI_crc16(r, sizeof(reps[i])) != CRC_OK)
+          sc->errors++;
+      }
+
+      // Next event (Note(1))
+      if(wait == 0)
+        continue;
+      if(sent < PLQ_TEST_REQUESTS && (INT32S) (next - now) > 0 && next - now < wait)
+        wait = next - now;
+      if(wait == PLQ_IDLE)
+        break;
+      now += wait;
+    }
+
+    sc->polls       = q.stats.polls;
+    sc->latencyMax  = q.stats.latencyMax;
+    sc->latencyMean = (sc->completed > 0) ? q.stats.latencySum / sc->completed : 0;
+    if(now > 0){
+      sc->busyPpm = (INT32U) ((uint64_t) link.busUs * 1000 / now);
+      sc->blockBusyPpm = (INT32U) (((uint64_t) sim.waitMs * 1000 + sim.xferUs) * 1000 / now);   // Note(2)
+      if(sc->blockBusyPpm > 1000000)
+        sc->blockBusyPpm = 1000000;
+    }
+
+    if(sc->completed != PLQ_TEST_REQUESTS || sc->errors != 0 || sc->busyPpm > sc->blockBusyPpm)
+      res->pass = FALSE;
+  }
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+// Subsystem bus: one transfer under sysI2CMutex
+static BOOLEAN PLQ_I2CSend(PLQ_LINK *link, const INT8U *req, INT16U len, INT32U now){
+
+  INT8U    err;
+  BOOLEAN  ok;
+  uint64_t t0;
+
+  (void) now;
+  OSMutexPend(sysI2CMutex, 0, &err);
+  if(err != OS_ERR_NONE) {
+    if(err == OS_ERR_PIP_LOWER)         // Taken all the same, PIP below the caller (app_cfg.h)
+      OSMutexPost(sysI2CMutex);
+    return FALSE;
+  }
+  t0 = TIME_NowUs();
+  ok = (SATI2C_Send(req, len) == i2cTransferDone);
+  link->busUs += (INT32U) (TIME_NowUs() - t0);
+  OSMutexPost(sysI2CMutex);
+
+  return ok;
+}
+
+/******************************************************************************/
+
+static BOOLEAN PLQ_I2CRecv(PLQ_LINK *link, INT8U *rep, INT16U len, INT32U now){
+
+  INT8U    err;
+  BOOLEAN  ok;
+  uint64_t t0;
+
+  (void) now;
+  OSMutexPend(sysI2CMutex, 0, &err);
+  if(err != OS_ERR_NONE) {
+    if(err == OS_ERR_PIP_LOWER)         // Taken all the same, PIP below the caller (app_cfg.h)
+      OSMutexPost(sysI2CMutex);
+    return FALSE;
+  }
+  t0 = TIME_NowUs();
+  ok = (SATI2C_Receive(rep, len) == i2cTransferDone);
+  link->busUs += (INT32U) (TIME_NowUs() - t0);
+  OSMutexPost(sysI2CMutex);
+
+  return ok;
+}
+
+/******************************************************************************/
+
+// Simulated PL: the request is kept with the time its report is ready, NACK when PLQ_SLOTS reports
+// are waiting. Bus time: address and data bytes, 9 bits each.
+static BOOLEAN PLQ_SimSend(PLQ_LINK *link, const INT8U *req, INT16U len, INT32U now){
+
+  PLQ_SIM *sim = link->sim;
+  INT8U    i;
+  INT32U   ready;
+
+  link->busUs += (len + 1) * 9 * sim->bitUs;
+  if(sim->nb == PLQ_SLOTS)
+    return FALSE;
+  sim->xferUs += (len + 1) * 9 * sim->bitUs;
+
+  ready = now + sim->delayMs + ((sim->jitterMs > 0) ? (UTI_Rand(&sim->seed) >> 16) % (sim->jitterMs + 1) : 0);
+  if(sim->nb > 0){
+    i = (sim->first + sim->nb - 1) % PLQ_SLOTS;
+    if((INT32S) (ready - sim->ready[i]) < 0)
+      ready = sim->ready[i];                                  // Reports in the order of the requests
+  }
+
+  i = (sim->first + sim->nb) % PLQ_SLOTS;
+  sim->type[i]  = (UTI_crc16((uint8_t *) req, len) == CRC_OK) ? req[0] : PL_MT_ERR_REP;
+  sim->id[i]    = req[3];
+  sim->count[i] = sim->received++;
+  sim->ready[i] = ready;
+  sim->waitMs  += ready - now;
+  sim->nb++;
+
+  return TRUE;
+}
+
+/******************************************************************************/
+
+// Simulated PL: report of the oldest request, or PL_MT_REP_NRDY
+static BOOLEAN PLQ_SimRecv(PLQ_LINK *link, INT8U *rep, INT16U len, INT32U now){
+
+  PLQ_SIM *sim = link->sim;
+  INT8U    i = sim->first;
+  INT16U   size = len - HDR_SZ;
+  INT16U   j;
+  INT16U   crc;
+
+  link->busUs += (len + 1) * 9 * sim->bitUs;
+  memset(rep, 0, len);
+  if(sim->nb == 0 || (INT32S) (sim->ready[i] - now) > 0){
+    rep[0] = PL_MT_REP_NRDY;
+    return TRUE;
+  }
+  sim->xferUs += (len + 1) * 9 * sim->bitUs;
+
+  rep[0] = (sim->type[i] == PL_MT_ERR_REP) ? PL_MT_ERR_REP : sim->type[i] + 1;
+  rep[1] = size >> 8;
+  rep[2] = size & 0xFF;
+  rep[3] = sim->id[i];
+  rep[4] = sim->count[i];
+  for(j = 5; j < len - CRC_SZ; j++)
+    rep[j] = (INT8U) (sim->id[i] ^ j);
+  crc = UTI_crc16(rep, len - CRC_SZ);
+  rep[len - 2] = crc >> 8;
+  rep[len - 1] = crc & 0xFF;
+
+  sim->first = (sim->first + 1) % PLQ_SLOTS;
+  sim->nb--;
+  return TRUE;
+}
+
+/******************************************************************************/
+
+// Oldest request in a state (NULL: none)
+static PLQ_SLOT* PLQ_Oldest(PLQ *q, INT8U state){
+
+  PLQ_SLOT *s = NULL;
+  INT8U     i;
+
+  for(i = 0; i < PLQ_SLOTS; i++)
+    if(q->slot[i].state == state && (s == NULL || (INT32S) (q->slot[i].order - s->order) < 0))
+      s = &q->slot[i];
+  return s;
+}
+
+/******************************************************************************/
+
+// Reads the report of the oldest request sent. A report of a younger request completes it, the
+// older ones get no report.
+static void PLQ_Poll(PLQ *q, PLQ_SLOT *s, INT32U now){
+
+  PLQ_SLOT *t;
+  PLQ_SLOT *c;
+  INT8U     type;
+  INT8U     i;
+
+  q->stats.polls++;
+  if(!q->link->recv(q->link, s->rep, s->repLen, now)){
+    PLQ_Done(q, s, I2C_ERR, now);
+    return;
+  }
+
+  // Not ready: poll again later, up to PLQ_TIMEOUT_MS
+  type = s->rep[0];
+  if(type == PL_MT_REP_NRDY){
+    q->stats.nrdy++;
+    if(now - s->sent >= PLQ_TIMEOUT_MS){
+      q->stats.timeouts++;
+      PLQ_Done(q, s, REP_NRDY, now);
+      return;
+    }
+    s->backoff = (s->backoff * 2 > PLQ_BACKOFF_MAX_MS) ? PLQ_BACKOFF_MAX_MS : s->backoff * 2;
+    s->due     = now + s->backoff;
+    return;
+  }
+
+  // Error report: the PL rejected the request (parsed by the caller)
+  if(type == PL_MT_ERR_REP){
+    PLQ_Done(q, s, 0, now);
+    return;
+  }
+
+  // Oldest request with the message type and ID of the report (s itself, normally)
+  t = NULL;
+  for(i = 0; i < PLQ_SLOTS; i++){
+    c = &q->slot[i];
+    if(c->state == PLQ_SENT && c->req[0] + 1 == type && c->req[3] == s->rep[3] &&
+       (t == NULL || (INT32S) (c->order - t->order) < 0))
+      t = c;
+  }
+  if(t == NULL){
+    q->stats.skipped++;
+    PLQ_Done(q, s, COM_ERR, now);
+    return;
+  }
+  if(t != s){
+    memcpy(t->rep, s->rep, (t->repLen < s->repLen) ? t->repLen : s->repLen);
+    for(i = 0; i < PLQ_SLOTS; i++)
+      if(q->slot[i].state == PLQ_SENT && (INT32S) (q->slot[i].order - t->order) < 0){
+        q->stats.skipped++;
+        PLQ_Done(q, &q->slot[i], COM_ERR, now);
+      }
+  }
+  PLQ_Done(q, t, 0, now);
+}
+
+/******************************************************************************/
+
+static void PLQ_Done(PLQ *q, PLQ_SLOT *s, INT16U flag, INT32U now){
+
+  INT32U latency = (s->state == PLQ_SENT) ? now - s->sent : 0;
+
+  s->flag  = flag;
+  s->state = PLQ_DONE;
+  q->stats.completed++;
+  if(flag != 0)
+    q->stats.errors++;
+  q->stats.latencySum += latency;
+  if(latency > q->stats.latencyMax)
+    q->stats.latencyMax = latency;
+}
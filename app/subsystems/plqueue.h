@@ -0,0 +1,182 @@
+/******************************************************************************
+
+Swiss Space Center
+
+Filename: plqueue.h
+Author:   agent
+
+Created:  19/10/2026
+Modified: 19/10/2026
+
+Description:
+Split-phase requests to the PL: a request is sent and the bus released, its
+report is then polled with an exponential backoff until the PL has it ready.
+Several requests can be outstanding, matched to the reports by message type
+and ID.
+
+******************************************************************************/
+
+
+
+#ifndef __PLQUEUE_H
+#define __PLQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/********************************************************************************************************
+*                                              DEFINES
+********************************************************************************************************/
+
+#define PLQ_SLOTS               4       // Outstanding requests (reports kept by the PL)
+#define PLQ_REQ_SIZE           (HDR_SZ + PL_FC_SCENARIO_CMD_REQ_C_SZ)    // Largest request
+
+#define PLQ_BACKOFF_MIN_MS      2       // First poll after the request, doubled on each NRDY report
+#define PLQ_BACKOFF_MAX_MS      128
+#define PLQ_TIMEOUT_MS          5000    // Report still not ready: request abandoned (REP_NRDY)
+
+#define PLQ_IDLE                0xFFFFFFFFuL  // PLQ_Step(): no request outstanding
+
+// State of a slot
+#define PLQ_FREE                0
+#define PLQ_QUEUED              1       // Request not sent yet
+#define PLQ_SENT                2       // Report polled
+#define PLQ_DONE                3       // Report received (or error), not collected yet
+
+// Self-test (see PLQ_SelfTest())
+#define PLQ_TEST_NB             4       // Scenarios (response delays of the simulated PL)
+#define PLQ_TEST_REQUESTS       100     // Requests per scenario
+#define PLQ_TEST_PERIOD_MS      20      // Between two requests
+#define PLQ_TEST_BIT_US         10      // Bus at 100 kHz
+#define PLQ_TEST_LIMIT_MS       60000   // Simulated time of a scenario, at most
+
+
+
+/********************************************************************************************************
+*                                          STRUCTURES
+********************************************************************************************************/
+
+typedef struct PlqLink PLQ_LINK;
+
+// Simulated PL (see PLQ_SimInit()): each report ready 'delayMs' to 'delayMs + jitterMs' after its
+// request, and read in the order of the requests
+typedef struct PlqSim PLQ_SIM;
+
+struct PlqSim {
+  INT32U delayMs;
+  INT32U jitterMs;
+  INT32U bitUs;                         // Bus time of a bit
+  INT8U  type[PLQ_SLOTS];               // Requests received, not read yet (ring)
+  INT8U  id[PLQ_SLOTS];
+  INT8U  count[PLQ_SLOTS];              // Order of the request (first byte of the report data)
+  INT32U ready[PLQ_SLOTS];              // Time the report is ready (ms)
+  INT8U  first;
+  INT8U  nb;
+  INT8U  received;
+  uint32_t seed;
+  INT32U waitMs;                        // Request to report ready, all the requests
+  INT32U xferUs;                        // Bus time of the requests and of their reports
+};
+
+// Link to the PL. The transfer functions are set by the init of the backend, they return FALSE
+// when the transfer failed.
+struct PlqLink {
+  BOOLEAN  (*send)(PLQ_LINK *link, const INT8U *req, INT16U len, INT32U now);
+  BOOLEAN  (*recv)(PLQ_LINK *link, INT8U *rep, INT16U len, INT32U now);
+  PLQ_SIM   *sim;                       // Simulated: the PL (NULL: SATI2C)
+  INT32U     busUs;                     // Bus held for the transfers
+};
+
+// Outstanding request
+typedef struct PlqSlot PLQ_SLOT;
+
+struct PlqSlot {
+  INT8U   state;                        // PLQ_FREE...
+  INT8U   tag;                          // ID returned by PLQ_Submit()
+  INT16U  flag;                         // Error (CRC_ERR... of PL.h, 0: report received)
+  INT8U   req[PLQ_REQ_SIZE];
+  INT16U  reqLen;
+  INT8U  *rep;                          // Report buffer of the caller
+  INT16U  repLen;
+  INT32U  order;                        // Submission order, requests sent and polled in this order
+  INT32U  sent;                         // Time of the request (ms)
+  INT32U  due;                          // Next poll
+  INT32U  backoff;                      // Current poll interval
+};
+
+typedef struct PlqStats PLQ_STATS;
+
+struct PlqStats {
+  INT32U requests;
+  INT32U completed;
+  INT32U errors;                        // Completed with an error
+  INT32U polls;                         // Reports read
+  INT32U nrdy;                          // Reports not ready
+  INT32U timeouts;
+  INT32U skipped;                       // Requests left without report by the PL, or wrong reports
+  INT32U latencySum;                    // Request to report (ms)
+  INT32U latencyMax;
+};
+
+// Request queue
+typedef struct Plq PLQ;
+
+struct Plq {
+  PLQ_LINK *link;
+  PLQ_SLOT  slot[PLQ_SLOTS];
+  INT32U    order;
+  INT8U     tag;
+  BOOLEAN   busy;                       // A task is in PLQ_Step()
+  PLQ_STATS stats;
+};
+
+// Result of a self-test scenario: PLQ_TEST_REQUESTS requests to the simulated PL, compared to a
+// blocking call holding the bus from the request to the report
+typedef struct PlqTestSc PLQ_TEST_SC;
+
+struct PlqTestSc {
+  INT32U delayMs;                       // Response delay of the PL (and half of it of jitter)
+  INT32U completed;
+  INT32U errors;                        // Requests failed, or with the report of another one
+  INT32U polls;
+  INT32U latencyMean;                   // ms
+  INT32U latencyMax;
+  INT32U busyPpm;                       // Bus held, split-phase
+  INT32U blockBusyPpm;                  // Bus held, blocking
+};
+
+typedef struct PlqTest PLQ_TEST;
+
+struct PlqTest {
+  PLQ_TEST_SC sc[PLQ_TEST_NB];
+  BOOLEAN     pass;
+};
+
+
+
+/********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+********************************************************************************************************/
+
+void    PLQ_I2CInit(PLQ_LINK *link);
+void    PLQ_SimInit(PLQ_LINK *link, PLQ_SIM *sim, INT32U delayMs, INT32U jitterMs, INT32U bitUs);
+
+void    PLQ_Init(PLQ *q, PLQ_LINK *link);
+INT8U   PLQ_Submit(PLQ *q, const INT8U *req, INT16U reqLen, INT8U *rep, INT16U repLen);
+INT32U  PLQ_Step(PLQ *q, INT32U now);
+BOOLEAN PLQ_Collect(PLQ *q, INT8U tag, INT16U *flag);
+BOOLEAN PLQ_Call(PLQ *q, const INT8U *req, INT16U reqLen, INT8U *rep, INT16U repLen, INT16U *flag);
+void    PLQ_GetStats(const PLQ *q, PLQ_STATS *stats);
+
+void    PLQ_SelfTest(PLQ_TEST *res);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of __PLQUEUE_H */
@@ -6,11 +6,12 @@ Filename: sati2c.c
 Author:   Louis Masson
 
 Created:  02/07/2013
-Modified: 02/07/2013
+Modified: 19/10/2026
 
 Description:
 This library contains the driver and the functions for communication with the 
-subsystems through the EFM32GG880's I2C0 bus.
+subsystems through the EFM32GG880's I2C0 bus. The transfers, retries and bus
+recovery are handled by the common layer (i2cbus.c).
 
 ******************************************************************************/
 
@@ -21,6 +22,17 @@ subsystems through the EFM32GG880's I2C0 bus.
 
 
 
+/*
+*********************************************************************************************************
+*                                      LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+// I2C0, SCL on PD7 and SDA on PD6 (location 1)
+static I2CBUS sati2cBus = { "Subsystems", I2C0, gpioPortD, 7, 6, 1, SATI2C_TIMEOUT, { 0 }, 0, 0, 0 };
+
+
+
 
 
 /********************************************************************************************************
@@ -37,29 +49,10 @@ subsystems through the EFM32GG880's I2C0 bus.
 
 void SATI2C_Init(const I2C_Init_TypeDef *init){
   
-   int i;
-  
   CMU_ClockEnable(cmuClock_HFPER, true);
   CMU_ClockEnable(cmuClock_I2C0,  true);
   
-  // Location 1: Set GPIO pins to 1 to avoid driving the lines low
-  // Configure SCL first to ensure that it is high before SDA
-  GPIO_PinModeSet(gpioPortD, 7, gpioModeWiredAnd, 1);  
-  GPIO_PinModeSet(gpioPortD, 6, gpioModeWiredAnd, 1);  
-  
-  // The slave device could be left in an unknown state:
-  //    -> send 9 clock pulses just in case
-  for(i=0; i<9; i++){
-    GPIO_PinModeSet(gpioPortD, 7, gpioModeWiredAnd, 0);
-    GPIO_PinModeSet(gpioPortD, 7, gpioModeWiredAnd, 1);
-  }
-  
-  // Enable I2C0 pins at location 1
-  I2C0->ROUTE = I2C_ROUTE_SDAPEN |
-                I2C_ROUTE_SCLPEN |
-                (1 << _I2C_ROUTE_LOCATION_SHIFT);
-  
-  I2C_Init(I2C0, init);
+  I2CBUS_Init(&sati2cBus, init);
 }
 
 
@@ -71,54 +64,135 @@ void SATI2C_Init(const I2C_Init_TypeDef *init){
 /********************************************************************************************************
 *                                         SATI2C_Transfer()
 *
-* @brief      Satellite subsystem I2C Transfer function.
+* @brief      Satellite subsystem I2C Transfer function, with retries and bus recovery (see
+*             I2CBUS_Transfer()).
 *
 * @param[in]  seq       Contains information on the message to be sent/received
 * @exception  none
-* @return     none.
+* @return     i2cTransferDone, or the error of the transfer
 *
 *
 ********************************************************************************************************/
 
 I2C_TransferReturn_TypeDef SATI2C_Transfer(I2C_TransferSeq_TypeDef *seq){
   
-  I2C_TransferReturn_TypeDef ret;
-  uint32_t timeout = SATI2C_TIMEOUT; 
-  
-  // Do a polled transfer
-  ret = I2C_TransferInit(I2C0, seq);
-  
-  while(ret == i2cTransferInProgress && timeout--){
-    ret = I2C_Transfer(I2C0);
-  }
-  
-  return (ret);
+  return I2CBUS_Transfer(&sati2cBus, seq);
 }
 
 
 
 
 
-void SATI2C_Communicate(uint8_t* request, uint16_t reqLength, uint8_t* report, uint16_t repLength){
+/********************************************************************************************************
+*                                         SATI2C_Send()
+*
+* @brief      Sends a request to the PL (first phase of a call, see plqueue.c)
+*
+* @param[in]  request    request buffer
+*             reqLength  request length
+* @exception  none
+* @return     i2cTransferDone, or the error of the transfer
+*
+*
+********************************************************************************************************/
+
+I2C_TransferReturn_TypeDef SATI2C_Send(const uint8_t* request, uint16_t reqLength){
 
-  I2C_TransferReturn_TypeDef  ret;               // I2C Return structure
   I2C_TransferSeq_TypeDef     seq;               // I2C Message structure
   
   // Initialise I2C request parameters and initiate transfer
   seq.addr  = PL_ADDR;
   seq.flags = I2C_FLAG_WRITE;
-  seq.buf[0].data = request;
+  seq.buf[0].data = (uint8_t *) request;
   seq.buf[0].len  = reqLength;
-  ret = SATI2C_Transfer(&seq);
+  return SATI2C_Transfer(&seq);
+}
+
+
+
+
+
+/********************************************************************************************************
+*                                         SATI2C_Receive()
+*
+* @brief      Reads a report of the PL (second phase of a call, PL_MT_REP_NRDY while not ready)
+*
+* @param[out] report     report buffer
+* @param[in]  repLength  report length
+* @exception  none
+* @return     i2cTransferDone, or the error of the transfer (report not valid)
+*
+*
+********************************************************************************************************/
+
+I2C_TransferReturn_TypeDef SATI2C_Receive(uint8_t* report, uint16_t repLength){
+
+  I2C_TransferReturn_TypeDef  ret;               // I2C Return structure
+  I2C_TransferSeq_TypeDef     seq;               // I2C Message structure
   
   // Initialise I2C report parameters and initiate reception
+  seq.addr  = PL_ADDR;
   seq.flags = I2C_FLAG_READ;
   seq.buf[0].data = report;
   seq.buf[0].len  = repLength;
   ret = SATI2C_Transfer(&seq);
+  if(ret != i2cTransferDone)
+    return ret;
   
   // TEMP: Shift all the bits by 1 to the left
   int i;
   for(i = 0; i < repLength; i++)
     report[i] = report[i] << 1;
-}
\ No newline at end of file
+  
+  return ret;
+}
+
+
+
+
+
+/********************************************************************************************************
+*                                         SATI2C_Communicate()
+*
+* @brief      Sends a request to the PL and reads its report at once (the report must be ready, see
+*             plqueue.c otherwise)
+*
+* @param[in]  request    request buffer
+*             reqLength  request length
+* @param[out] report     report buffer
+* @param[in]  repLength  report length
+* @exception  none
+* @return     i2cTransferDone, or the error of the first failed transfer (report not valid)
+*
+*
+********************************************************************************************************/
+
+I2C_TransferReturn_TypeDef SATI2C_Communicate(uint8_t* request, uint16_t reqLength, uint8_t* report, uint16_t repLength){
+
+  I2C_TransferReturn_TypeDef  ret;               // I2C Return structure
+  
+  ret = SATI2C_Send(request, reqLength);
+  if(ret != i2cTransferDone)
+    return ret;
+  
+  return SATI2C_Receive(report, repLength);
+}
+
+
+
+/********************************************************************************************************
+*                                         SATI2C_GetBus()
+*
+* @brief      Returns the subsystem bus, for its statistics and the fault injection (see i2cbus.h)
+*
+* @param[in]  none
+* @exception  none
+* @return     subsystem bus
+*
+*
+********************************************************************************************************/
+
+I2CBUS* SATI2C_GetBus(void){
+  
+  return &sati2cBus;
+}
@@ -44,10 +44,14 @@ extern "C" {
 void SATI2C_Init(const I2C_Init_TypeDef *init);
 I2C_TransferReturn_TypeDef SATI2C_Transfer(I2C_TransferSeq_TypeDef *seq);
 
-void SATI2C_Communicate(uint8_t* request,
-                        uint16_t reqLength,
-                        uint8_t* report,
-                        uint16_t repLength);
+I2C_TransferReturn_TypeDef SATI2C_Send(const uint8_t* request, uint16_t reqLength);
+I2C_TransferReturn_TypeDef SATI2C_Receive(uint8_t* report, uint16_t repLength);
+I2C_TransferReturn_TypeDef SATI2C_Communicate(uint8_t* request,
+                                              uint16_t reqLength,
+                                              uint8_t* report,
+                                              uint16_t repLength);
+
+I2CBUS* SATI2C_GetBus(void);
 
 #ifdef __cplusplus
 }
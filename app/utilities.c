@@ -93,7 +93,34 @@ static void calcTable16(void)
 
 
 
+//----------------------------------------------
+
+void UTI_CycCntInit(void)
+{
+    // Enable trace in core debug, required to access the DWT unit
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    // Start the cycle counter
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
+
+//----------------------------------------------
+
+uint32_t UTI_Rand(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+
+    return *seed;
+}
 
 
 
+//----------------------------------------------
 
+double UTI_RandUniform(uint32_t *seed)
+{
+    return (double) (int32_t) UTI_Rand(seed) / 2147483648.0;
+}
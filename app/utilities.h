@@ -44,6 +44,66 @@ uint16_t UTI_crc16(uint8_t* pData, unsigned int length);
 
 
 
+// Cycle counter
+/*! Starts the free running cycle counter of the Cortex-M3 core (DWT CYCCNT).
+
+    Used for execution time measurements: read it with UTI_CycCntGet() before and after
+    the code to measure, the unsigned difference is valid as long as it is below 2^32 cycles.
+*/
+
+void UTI_CycCntInit(void);
+
+#define UTI_CycCntGet()     (DWT->CYCCNT)
+
+
+
+// Fixed-point arithmetic
+/*! Q16.16 signed fixed-point numbers: 16 integer bits (range -32768 to 32767.99998) and 16
+    fractional bits (resolution 1.5e-5). Used for the sensor data path, the EFM32GG has no FPU.
+
+    Additions and subtractions are plain integer operations. Products go through 64 bits, which
+    the Cortex-M3 does in one SMULL instruction. Conversion constants (UTI_Q16FromFloat) are folded
+    by the compiler, use floats at run time only for display.
+*/
+
+typedef int32_t q16_t;
+
+#define Q16_ONE                 ((q16_t) 0x00010000)
+
+#define UTI_Q16FromInt(i)       ((q16_t) ((i) * Q16_ONE))
+#define UTI_Q16FromFloat(f)     ((q16_t) ((f) * 65536.0 + ((f) >= 0 ? 0.5 : -0.5)))
+#define UTI_Q16ToFloat(q)       ((float) (q) * (1.0f / 65536.0f))
+#define UTI_Q16ToInt(q)         ((int32_t) (q) / Q16_ONE)         // Rounds towards zero
+
+#define UTI_Q16Mul(a, b)        ((q16_t) (((int64_t) (a) * (b)) >> 16))
+#define UTI_Q16Div(a, b)        ((q16_t) (((int64_t) (a) * Q16_ONE) / (b)))
+
+/*! Scales a raw integer reading by a constant given in Q8.24 (use UTI_Q24FromFloat), the result
+    is in Q16.16. With the 8 extra fractional bits, the scale factors of the sensors are exact to
+    1e-5 relative at worst (temperature), far below the sensor noise.
+*/
+
+#define UTI_Q24FromFloat(f)     ((int32_t) ((f) * 16777216.0 + 0.5))
+#define UTI_Q16Scale(raw, q24)  ((q16_t) (((int64_t) (raw) * (q24) + 0x80) >> 8))
+
+
+
+// Pseudo-random numbers
+/*! Linear congruential generator for the self-tests and simulations: reproducible sequences,
+    one state per user. The low bits of the result have short periods, use the high ones.
+
+    \param seed State of the generator, updated
+    \return Next value of the sequence (32 bits)
+*/
+
+uint32_t UTI_Rand(uint32_t *seed);
+
+/*! Uniform value in [-1, 1), from UTI_Rand() */
+
+double UTI_RandUniform(uint32_t *seed);
+
+
+
 #ifdef __cplusplus
 }
 #endif